@@ -485,6 +485,25 @@ void Compiler::ExportObject(const std::string& path) {
   engine_->ExportObject(path);
 }
 
+std::string Compiler::GetObjectCode() const { return engine_->GetObjectCode(); }
+
+void Compiler::LoadObjectCode(const std::string& object_code) {
+  const bool is_x86 = target_.arch.Match(
+      [&](common::X86Arch) { return true; },
+      [&](std::variant<common::UnknownArch,
+                       common::ARMArch,
+                       common::NVGPUArch,
+                       common::HygonDCUArchHIP,
+                       common::HygonDCUArchSYCL>) { return false; });
+  PADDLE_ENFORCE_EQ(is_x86,
+                    true,
+                    ::common::errors::Unimplemented(
+                        "Loading object code is only supported for the x86 "
+                        "target, but received %s.",
+                        target_.arch_str()));
+  engine_->AddObject(object_code);
+}
+
 void* Compiler::Lookup(absl::string_view fn_name) {
   PADDLE_ENFORCE_NOT_NULL(
       engine_, ::common::errors::InvalidArgument("Sorry, engine_ is nullptr"));
@@ -116,6 +116,19 @@ class Compiler final {
 
   void ExportObject(const std::string& path);
 
+  /**
+   * Get the host object code of the compiled module, only available after
+   * the first Lookup.
+   */
+  std::string GetObjectCode() const;
+
+  /**
+   * Link the host object code returned by GetObjectCode instead of calling
+   * Build and EndCompile. Only the x86 target is supported, whose object code
+   * does not refer to any device module.
+   */
+  void LoadObjectCode(const std::string& object_code);
+
   std::string GetSourceCode(const ir::Module& module);
 
   void BuildDefault(const ir::Module& module);
@@ -107,6 +107,12 @@ std::unique_ptr<llvm::MemoryBuffer> NaiveObjectCache::getObject(
   return llvm::MemoryBuffer::getMemBuffer(it->second->getMemBufferRef());
 }
 
+const llvm::MemoryBuffer *NaiveObjectCache::GetObject(
+    llvm::StringRef module_id) const {
+  auto it = cached_objects_.find(module_id);
+  return it == cached_objects_.end() ? nullptr : it->second.get();
+}
+
 /*static*/ std::unique_ptr<ExecutionEngine> ExecutionEngine::Create(
     const ExecutionOptions &config) {
   VLOG(6) << "===================== Create CINN ExecutionEngine begin "
@@ -244,9 +250,27 @@ void ExecutionEngine::RegisterModuleRuntimeSymbols(
 }
 
 bool ExecutionEngine::AddSelfModule() {
+  self_module_id_ = m->getModuleIdentifier();
   return AddModule(std::move(m), std::move(ctx));
 }
 
+std::string ExecutionEngine::GetObjectCode() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  const llvm::MemoryBuffer *object = cache_->GetObject(self_module_id_);
+  if (object == nullptr) {
+    return "";
+  }
+  return object->getBuffer().str();
+}
+
+bool ExecutionEngine::AddObject(const std::string &object_code) {
+  utils::RecordEvent("ExecutionEngine AddObject", utils::EventType::kOrdinary);
+  auto buffer = llvm::MemoryBuffer::getMemBufferCopy(
+      AsStringRef(object_code), "cinn_cached_object");
+  llvm::cantFail(jit_->addObjectFile(std::move(buffer)));
+  return true;
+}
+
 void ExecutionEngine::ExportObject(const std::string &path) {
   FILE *of = fopen(path.c_str(), "w");
   fwrite(buffer_.data(), 1, buffer_.size(), of);
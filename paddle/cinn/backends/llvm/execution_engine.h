@@ -56,6 +56,9 @@ class NaiveObjectCache : public llvm::ObjectCache {
                             llvm::MemoryBufferRef) override;
   std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *) override;
 
+  //! The object compiled from the module named \p module_id, or nullptr.
+  const llvm::MemoryBuffer *GetObject(llvm::StringRef module_id) const;
+
  private:
   llvm::StringMap<std::unique_ptr<llvm::MemoryBuffer>> cached_objects_;
 };
@@ -87,6 +90,18 @@ class ExecutionEngine {
 
   bool AddSelfModule();
 
+  /**
+   * Get the object code of the module added by AddSelfModule, which is
+   * compiled on the first Lookup. Empty if it is not compiled yet.
+   */
+  std::string GetObjectCode() const;
+
+  /**
+   * Link an object file returned by GetObjectCode of an engine, maybe of a
+   * previous process, instead of compiling the self module.
+   */
+  bool AddObject(const std::string &object_code);
+
  protected:
   explicit ExecutionEngine(bool enable_object_cache)
       : cache_(std::make_unique<NaiveObjectCache>()),
@@ -107,6 +122,7 @@ class ExecutionEngine {
   std::unique_ptr<llvm::orc::LLJIT> jit_;
   std::unique_ptr<NaiveObjectCache> cache_;
   RuntimeSymbols module_symbols_;
+  std::string self_module_id_;
 
   std::unique_ptr<llvm::LLVMContext> ctx;
   std::unique_ptr<llvm::Module> m;
@@ -57,6 +57,7 @@ class BackendResource final {
   }
   pir::CINNKernelInfo GenerateKernelInfo(bool need_x86_kernel = false) const;
   const std::string& GetHostFuncName() const { return host_fn_name_; }
+  const std::string& GetInferFuncName() const { return infer_fn_name_; }
 
  private:
   std::string host_fn_name_;
@@ -87,6 +88,8 @@ class CompilationResult final {
     return GetBackendResource()->GetHostFuncName();
   }
 
+  bool HaveCX86Kernel() const { return have_cx86_kernel_; }
+
   pir::CINNKernelInfo GetKernelInfo() {
     PADDLE_ENFORCE_NOT_NULL(backend_resource_,
                             ::common::errors::PreconditionNotMet(
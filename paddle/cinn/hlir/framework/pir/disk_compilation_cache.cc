@@ -0,0 +1,303 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/hlir/framework/pir/disk_compilation_cache.h"
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/Host.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <thread>  // NOLINT
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "paddle/common/flags.h"
+#include "paddle/fluid/framework/commit.h"
+
+PD_DECLARE_string(cinn_compilation_cache_dir);
+
+namespace cinn::hlir::framework::pir {
+
+namespace {
+
+constexpr char kEntryMagic[] = "CINNKC01";
+constexpr size_t kEntryMagicSize = sizeof(kEntryMagic) - 1;
+
+class EntryWriter {
+ public:
+  void WriteInt(int64_t value) {
+    buffer_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+  void WriteString(const std::string& value) {
+    WriteInt(value.size());
+    buffer_.append(value);
+  }
+  const std::string& buffer() const { return buffer_; }
+
+ private:
+  std::string buffer_{kEntryMagic, kEntryMagicSize};
+};
+
+// All Read* return false once the entry is found truncated.
+class EntryReader {
+ public:
+  explicit EntryReader(const std::string& buffer)
+      : cur_(buffer.data()), end_(buffer.data() + buffer.size()) {}
+
+  bool ReadMagic() {
+    if (end_ - cur_ < static_cast<int64_t>(kEntryMagicSize) ||
+        std::memcmp(cur_, kEntryMagic, kEntryMagicSize) != 0) {
+      return false;
+    }
+    cur_ += kEntryMagicSize;
+    return true;
+  }
+  bool ReadInt(int64_t* value) {
+    if (end_ - cur_ < static_cast<int64_t>(sizeof(*value))) return false;
+    std::memcpy(value, cur_, sizeof(*value));
+    cur_ += sizeof(*value);
+    return true;
+  }
+  bool ReadString(std::string* value) {
+    int64_t size = 0;
+    if (!ReadInt(&size) || size < 0 || end_ - cur_ < size) return false;
+    value->assign(cur_, size);
+    cur_ += size;
+    return true;
+  }
+  bool AtEnd() const { return cur_ == end_; }
+
+ private:
+  const char* cur_;
+  const char* end_;
+};
+
+// The features the JIT enables for the host CPU, as detectHost does, in the
+// name order.
+std::string HostCPUFeatures() {
+  llvm::StringMap<bool> features;
+  if (!llvm::sys::getHostCPUFeatures(features)) return "";
+  std::vector<std::string> names;
+  for (const auto& feature : features) {
+    if (feature.getValue()) names.push_back(feature.getKey().str());
+  }
+  std::sort(names.begin(), names.end());
+  std::ostringstream os;
+  for (size_t i = 0; i < names.size(); ++i) {
+    os << (i == 0 ? "+" : ",+") << names[i];
+  }
+  return os.str();
+}
+
+}  // namespace
+
+bool DiskCompilationCache::Enabled(const Target& target) const {
+  if (FLAGS_cinn_compilation_cache_dir.empty()) return false;
+  return target.arch.Match(
+      [&](common::X86Arch) { return true; },
+      [&](std::variant<common::UnknownArch,
+                       common::ARMArch,
+                       common::NVGPUArch,
+                       common::HygonDCUArchHIP,
+                       common::HygonDCUArchSYCL>) { return false; });
+}
+
+std::string DiskCompilationCache::Version() {
+  std::ostringstream os;
+  os << "paddle: " << paddle::framework::paddle_commit() << "\n"
+     << "llvm: " << LLVM_VERSION_STRING << "\n"
+     << "cpu: " << llvm::sys::getHostCPUName().str() << "\n"
+     << "features: " << HostCPUFeatures();
+  return os.str();
+}
+
+std::string DiskCompilationCache::EntryKey(const Target& target,
+                                           const std::string& content_key,
+                                           const std::string& version) {
+  std::ostringstream os;
+  os << version << "\n"
+     << "target: " << target << "\n"
+     << content_key;
+  return os.str();
+}
+
+std::string DiskCompilationCache::EntryPath(const std::string& key) {
+  std::ostringstream os;
+  os << std::hex << std::hash<std::string>{}(key) << ".cinnkc";
+  return (std::filesystem::path(FLAGS_cinn_compilation_cache_dir) / os.str())
+      .string();
+}
+
+bool DiskCompilationCache::ReadEntry(const std::string& key,
+                                     CompilationCacheEntry* entry) {
+  const std::string path = EntryPath(key);
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs) {
+    VLOG(4) << "No compilation cache entry " << path;
+    return false;
+  }
+  const std::string buffer((std::istreambuf_iterator<char>(ifs)),
+                           std::istreambuf_iterator<char>());
+
+  EntryReader reader(buffer);
+  int64_t have_cx86_kernel = 0, symbol_arg_num = 0, temp_space_num = 0;
+  const auto ReadMetadata = [&]() -> bool {
+    if (!reader.ReadMagic() || !reader.ReadString(&entry->key)) return false;
+    if (!reader.ReadString(&entry->host_fn_name) ||
+        !reader.ReadString(&entry->infer_fn_name) ||
+        !reader.ReadInt(&have_cx86_kernel) || !reader.ReadInt(&symbol_arg_num))
+      return false;
+    entry->have_cx86_kernel = have_cx86_kernel != 0;
+    entry->symbol_args_map.clear();
+    for (int64_t i = 0; i < symbol_arg_num; ++i) {
+      int64_t arg_idx = 0, kind = 0, tensor_idx = 0, idx = 0;
+      if (!reader.ReadInt(&arg_idx) || !reader.ReadInt(&kind) ||
+          !reader.ReadInt(&tensor_idx) || !reader.ReadInt(&idx))
+        return false;
+      if (kind == 0) {
+        entry->symbol_args_map[arg_idx] = CINNKernelInfo::ArgDimIdx{
+            static_cast<int>(tensor_idx), static_cast<int>(idx)};
+      } else {
+        entry->symbol_args_map[arg_idx] = CINNKernelInfo::ArgValueIdx{
+            static_cast<int>(tensor_idx), static_cast<int>(idx)};
+      }
+    }
+    if (!reader.ReadInt(&temp_space_num) || temp_space_num < 0) return false;
+    entry->temp_space_sizes.resize(temp_space_num);
+    for (auto& size : entry->temp_space_sizes) {
+      if (!reader.ReadInt(&size)) return false;
+    }
+    return reader.ReadString(&entry->object_code) && reader.AtEnd();
+  };
+  if (!ReadMetadata()) {
+    LOG(WARNING) << "Ignore the invalid compilation cache entry " << path;
+    return false;
+  }
+  // A different key of the same hash, treat it as a miss.
+  if (entry->key != key) {
+    VLOG(4) << "The compilation cache entry " << path << " is of another key";
+    return false;
+  }
+  return true;
+}
+
+bool DiskCompilationCache::WriteEntry(const CompilationCacheEntry& entry) {
+  EntryWriter writer;
+  writer.WriteString(entry.key);
+  writer.WriteString(entry.host_fn_name);
+  writer.WriteString(entry.infer_fn_name);
+  writer.WriteInt(entry.have_cx86_kernel);
+  writer.WriteInt(entry.symbol_args_map.size());
+  for (const auto& [arg_idx, bind_info] : entry.symbol_args_map) {
+    writer.WriteInt(arg_idx);
+    writer.WriteInt(bind_info.index());
+    std::visit(
+        [&](const auto& idx) {
+          using T = std::decay_t<decltype(idx)>;
+          if constexpr (std::is_same_v<T, CINNKernelInfo::ArgDimIdx>) {
+            writer.WriteInt(idx.arg_idx);
+            writer.WriteInt(idx.dim_idx);
+          } else {
+            writer.WriteInt(idx.arg_idx);
+            writer.WriteInt(idx.value_idx);
+          }
+        },
+        bind_info);
+  }
+  writer.WriteInt(entry.temp_space_sizes.size());
+  for (int64_t size : entry.temp_space_sizes) {
+    writer.WriteInt(size);
+  }
+  writer.WriteString(entry.object_code);
+
+  // Write to a temporary file and rename it, so that concurrent readers and
+  // writers of the same entry never see a partial file.
+  const std::string path = EntryPath(entry.key);
+  std::ostringstream tmp_path;
+  tmp_path << path << ".tmp." << getpid() << "." << std::this_thread::get_id();
+  std::error_code error;
+  std::filesystem::create_directories(FLAGS_cinn_compilation_cache_dir, error);
+  {
+    std::ofstream ofs(tmp_path.str(), std::ios::binary);
+    ofs.write(writer.buffer().data(), writer.buffer().size());
+    if (!ofs) {
+      LOG(WARNING) << "Failed to write compilation cache entry "
+                   << tmp_path.str();
+      return false;
+    }
+  }
+  std::filesystem::rename(tmp_path.str(), path, error);
+  if (error) {
+    LOG(WARNING) << "Failed to save compilation cache entry " << path << ": "
+                 << error.message();
+    std::filesystem::remove(tmp_path.str(), error);
+    return false;
+  }
+  return true;
+}
+
+std::shared_ptr<CompilationResult> DiskCompilationCache::Load(
+    const Target& target, const FusionInfo& fusion_info) const {
+  CompilationCacheEntry entry;
+  if (!ReadEntry(EntryKey(target, fusion_info.ContentKey()), &entry)) {
+    return nullptr;
+  }
+  auto backend_resource =
+      std::make_shared<BackendResource>(target,
+                                        entry.host_fn_name,
+                                        entry.infer_fn_name,
+                                        entry.symbol_args_map,
+                                        entry.temp_space_sizes);
+  backend_resource->GetBackendCompiler()->LoadObjectCode(entry.object_code);
+  auto compilation_result =
+      std::make_shared<CompilationResult>(target, entry.have_cx86_kernel);
+  compilation_result->SetBackendResource(backend_resource);
+  VLOG(4) << "Load " << entry.host_fn_name << " from compilation cache "
+          << EntryPath(entry.key);
+  return compilation_result;
+}
+
+void DiskCompilationCache::Save(const Target& target,
+                                const FusionInfo& fusion_info,
+                                const CompilationResult& result) const {
+  const auto& backend_resource = result.GetBackendResource();
+  CompilationCacheEntry entry;
+  entry.object_code = backend_resource->GetBackendCompiler()->GetObjectCode();
+  if (entry.object_code.empty()) {
+    VLOG(4) << "Skip saving " << result.GetHostFuncName()
+            << " which is not compiled into compilation cache.";
+    return;
+  }
+  entry.key = EntryKey(target, fusion_info.ContentKey());
+  entry.host_fn_name = backend_resource->GetHostFuncName();
+  entry.infer_fn_name = backend_resource->GetInferFuncName();
+  entry.have_cx86_kernel = result.HaveCX86Kernel();
+  entry.symbol_args_map = backend_resource->GetSymbolArgsMap();
+  entry.temp_space_sizes = backend_resource->GetTempSpaceSizes();
+  if (WriteEntry(entry)) {
+    VLOG(4) << "Save " << result.GetHostFuncName()
+            << " into compilation cache " << EntryPath(entry.key);
+  }
+}
+
+}  // namespace cinn::hlir::framework::pir
@@ -0,0 +1,93 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "paddle/cinn/common/macros.h"
+#include "paddle/cinn/common/target.h"
+#include "paddle/cinn/hlir/framework/pir/compilation_cache.h"
+#include "paddle/cinn/hlir/framework/pir/fusion_info.h"
+
+namespace cinn::hlir::framework::pir {
+
+// An entry of DiskCompilationCache.
+struct CompilationCacheEntry {
+  std::string key;
+  std::string host_fn_name;
+  std::string infer_fn_name;
+  bool have_cx86_kernel = false;
+  std::map<int, CINNKernelInfo::SymbolArgBindInfo> symbol_args_map;
+  std::vector<int64_t> temp_space_sizes;
+  std::string object_code;
+};
+
+/**
+ * Persistent cache of compiled fusion groups in the directory set by
+ * FLAGS_cinn_compilation_cache_dir, so that a new process loads the kernels
+ * instead of compiling them again. Only the x86 target is supported.
+ *
+ * An entry stores the host object code and the BackendResource metadata
+ * (function names, symbol arg binds and temp space sizes) of a group. It is
+ * keyed by FusionInfo::ContentKey(), the target, the versions of Paddle
+ * and LLVM and the host CPU and its features, as the JIT compiles for the
+ * host, and named by the hash of the key. The whole key is also stored
+ * in the entry to detect hash collisions.
+ */
+class DiskCompilationCache {
+ public:
+  static DiskCompilationCache& Instance() {
+    static DiskCompilationCache instance;
+    return instance;
+  }
+
+  bool Enabled(const Target& target) const;
+
+  // Returns nullptr if there is no valid entry for the fusion group.
+  std::shared_ptr<CompilationResult> Load(const Target& target,
+                                          const FusionInfo& fusion_info) const;
+
+  // The result must have been compiled, i.e. GetKernelInfo() was called.
+  void Save(const Target& target,
+            const FusionInfo& fusion_info,
+            const CompilationResult& result) const;
+
+  // The versions of Paddle and LLVM and the host CPU the kernels are
+  // compiled by and for.
+  static std::string Version();
+
+  // The key of the entry of a fusion group of the content key.
+  static std::string EntryKey(const Target& target,
+                              const std::string& content_key,
+                              const std::string& version = Version());
+
+  // Writes the entry into the cache directory, returns false on failure.
+  static bool WriteEntry(const CompilationCacheEntry& entry);
+
+  // Reads the entry of the key, returns false if the entry is missing, of
+  // another key of the same hash or corrupt.
+  static bool ReadEntry(const std::string& key, CompilationCacheEntry* entry);
+
+  // The file of the entry of the key.
+  static std::string EntryPath(const std::string& key);
+
+ private:
+  DiskCompilationCache() = default;
+  CINN_DISALLOW_COPY_AND_ASSIGN(DiskCompilationCache);
+};
+
+}  // namespace cinn::hlir::framework::pir
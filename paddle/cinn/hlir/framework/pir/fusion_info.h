@@ -14,6 +14,7 @@
 
 #pragma once
 #include <ostream>
+#include <string>
 #include "paddle/cinn/hlir/framework/pir/op_lowering_group.h"
 #include "paddle/pir/include/dialect/shape/utils/shape_or_data_expr.h"
 
@@ -25,6 +26,7 @@ class AttributeInfo {
       : name_(name), attr_(attr) {}
 
   std::size_t hash() const;
+  void PrintContent(std::ostream &os) const;
   friend std::ostream &operator<<(std::ostream &os, const AttributeInfo &info);
 
  private:
@@ -37,6 +39,7 @@ class ValueInfo {
   explicit ValueInfo(const ::pir::Value &value) : type_(value.type()) {}
 
   std::size_t hash() const;
+  void PrintContent(std::ostream &os) const;
   friend std::ostream &operator<<(std::ostream &os, const ValueInfo &info);
 
  private:
@@ -49,6 +52,7 @@ class OperationInfo {
   explicit OperationInfo(const ::pir::Operation &op);
 
   std::size_t hash() const;
+  void PrintContent(std::ostream &os) const;
   friend std::ostream &operator<<(std::ostream &os, const OperationInfo &info);
 
  private:
@@ -68,6 +72,7 @@ class OpDepInfo {
   }
 
   std::size_t hash() const;
+  size_t upstream_index() const { return upstream_index_; }
   friend std::ostream &operator<<(std::ostream &os, const OpDepInfo &info);
 
  private:
@@ -82,6 +87,7 @@ class FusionOpInfo {
       : op_info_(op), inner_deps_(deps) {}
 
   std::size_t hash() const;
+  void PrintContent(std::ostream &os) const;
   friend std::ostream &operator<<(std::ostream &os, const FusionOpInfo &info);
 
  private:
@@ -115,6 +121,11 @@ class FusionInfo {
   bool operator==(const FusionInfo &other) const {
     return this->hash() == other.hash();
   }
+
+  // Printed ops, types, attributes and input DimExprs of the group. Unlike
+  // hash(), it doesn't depend on the program or on the address of IR storages,
+  // so the same group has the same content key across processes.
+  std::string ContentKey() const;
   friend std::ostream &operator<<(std::ostream &os, const FusionInfo &info);
 
  private:
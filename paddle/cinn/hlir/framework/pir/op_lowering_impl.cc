@@ -47,6 +47,7 @@
 
 PD_DECLARE_bool(cinn_use_cuda_vectorize);
 PD_DECLARE_bool(cinn_check_tensor_buffer_map);
+PD_DECLARE_bool(cinn_enable_x86_schedule);
 const int default_priority = 100;
 
 namespace cinn {
@@ -785,14 +786,31 @@ ir::Expr OpLowererImpl::LowerX86(const OpLoweringGroupPtr& group,
 
   std::vector<ir::Expr> func_bodies =
       LowerOps(group, ops, &group_func_arg_tensors, &tensor_map);
-  this->target_ = common::DefaultDeviceTarget();
-  cinn::runtime::CurrentTarget::SetCurrentTarget(this->target_);
   ir::ModuleExpr mod_expr(func_bodies);
   ir::IRSchedule ir_sch(
       mod_expr, -1, false, cinn::utils::ErrorMessageLevel::kGeneral, true);
   ir_sch.MergeExprs();
-  auto X86Expr = ir::ir_utils::IRCopy(ir_sch.GetModule().GetExprs().at(0));
-  return X86Expr;
+  ir::Expr X86Expr = ir_sch.GetModule().GetExprs().at(0);
+
+  if (FLAGS_cinn_enable_x86_schedule) {
+    std::unordered_set<std::string> output_tensor_names;
+    for (auto value : group->GetGroupOutputValues()) {
+      output_tensor_names.insert(ValueName(value));
+    }
+    std::unique_ptr<ir::GroupScheduler> group_scheduler =
+        ir::GroupScheduler::Make(&ir_sch,
+                                 output_tensor_names,
+                                 this->target_,
+                                 /* is_dy_shape = */ true,
+                                 GetFusionGroupInfo(func_bodies));
+    group_scheduler->Schedule();
+    X86Expr = group_scheduler->GetCX86IRs().at(0).second;
+    VLOG(4) << "After x86 schedule, ir is: \n" << X86Expr;
+  }
+
+  this->target_ = common::DefaultDeviceTarget();
+  cinn::runtime::CurrentTarget::SetCurrentTarget(this->target_);
+  return ir::ir_utils::IRCopy(X86Expr);
 }
 
 }  // namespace pir
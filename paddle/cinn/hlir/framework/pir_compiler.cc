@@ -17,6 +17,7 @@
 
 #include "paddle/cinn/hlir/dialect/operator/transforms/lowering_pass/utils.h"
 #include "paddle/cinn/hlir/framework/pir/broadcast_with_cf.h"
+#include "paddle/cinn/hlir/framework/pir/disk_compilation_cache.h"
 #include "paddle/cinn/hlir/framework/pir/utils.h"
 #include "paddle/cinn/runtime/arch_device.h"
 #include "paddle/cinn/utils/multi_threading.h"
@@ -41,6 +42,10 @@ class CompilationContextMapper {
     return compilation_results_;
   }
 
+  const pir::FusionInfo& UniqueFusionInfo(size_t index) const {
+    return fusion_infos_[mapper_index_[index]];
+  }
+
   std::vector<pir::CINNKernelInfo> RecoverKernelInfos();
   void UpdateGlobalCache();
   void SetFinalize(bool val) { is_finalized_ = val; }
@@ -82,8 +87,19 @@ std::vector<pir::CINNKernelInfo> PirCompiler::Build(
     // https://developer.nvidia.com/blog/cuda-pro-tip-always-set-current-device-avoid-multithreading-bugs/
     // for details.
     const auto device_id = runtime::GetArchDevice(target_);
+    const auto& disk_cache = pir::DiskCompilationCache::Instance();
+    const bool use_disk_cache = disk_cache.Enabled(target_);
     auto worker_fn = [&](int index) {
       runtime::SetArchDevice(target_, device_id);
+      if (use_disk_cache) {
+        const auto& fusion_info = ctx_mapper.UniqueFusionInfo(index);
+        compilation_results[index] = disk_cache.Load(target_, fusion_info);
+        if (compilation_results[index] != nullptr) return;
+        compilation_results[index] =
+            Compile(&group_compilation_contexts[index]);
+        disk_cache.Save(target_, fusion_info, *compilation_results[index]);
+        return;
+      }
       compilation_results[index] = Compile(&group_compilation_contexts[index]);
     };
     utils::parallel_run(worker_fn,
@@ -13,6 +13,9 @@
 // limitations under the License.
 
 #include "paddle/cinn/ir/group_schedule/config/group_tile_config.h"
+#if defined(__linux__)
+#include <unistd.h>
+#endif
 #include "paddle/cinn/hlir/framework/pir/op_lowering_impl.h"
 
 namespace cinn {
@@ -48,6 +51,25 @@ int64_t Trim(int64_t n, int64_t min, int64_t max) {
   return std::min(std::max(n, min), max);
 }
 
+// The x86 kernel is compiled by the LLVM JIT for the host CPU, so the vector
+// width and the cache sizes are taken from the host.
+int64_t HostVectorBits() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  if (__builtin_cpu_supports("avx512f")) return 512;
+  if (__builtin_cpu_supports("avx2")) return 256;
+#endif
+  return 128;
+}
+
+int64_t HostCacheBytes(int level) {
+#if defined(__linux__) && defined(_SC_LEVEL1_DCACHE_SIZE)
+  int64_t bytes = sysconf(level == 1 ? _SC_LEVEL1_DCACHE_SIZE
+                                     : _SC_LEVEL2_CACHE_SIZE);
+  if (bytes > 0) return bytes;
+#endif
+  return level == 1 ? 32 * 1024 : 1024 * 1024;
+}
+
 }  // namespace
 
 BucketInfo::BucketInfo(int sp_lower_bound,
@@ -422,6 +444,48 @@ TileConfigMap BuildDynamicShapeConfig(
   return {{bucket_info, tile_config}};
 }
 
+TileConfigMap BuildX86Config(
+    const std::shared_ptr<ScheduleConfig::BaseInfo>& base_info,
+    const common::Target& target) {
+  // Each spatial element reads reduce_numel elements and writes one, and a
+  // dynamic reduce is assumed to be large.
+  const int64_t reduce_numel =
+      base_info->has_dynamic_reduce ? kMaxNumel : base_info->reduce_numel;
+  const int64_t sp_bytes = sizeof(float) * (reduce_numel + 1);
+
+  // 1. Allocate cache blocks
+  // Principals:
+  //   1) The data touched by the spatial elements of a block had better fit
+  //      in L2, as a block is the unit of work of a parallel task.
+  //   2) A group whose data fit in L1 runs in one block, because the parallel
+  //      launch costs more than the computation.
+  int64_t block_numel =
+      FloorPow2(Trim(HostCacheBytes(2) / sp_bytes, 1, kMaxNumel));
+  if (!base_info->has_dynamic_spatial &&
+      base_info->spatial_numel * sp_bytes <= HostCacheBytes(1)) {
+    block_numel = std::max(block_numel, base_info->spatial_numel);
+  }
+
+  int64_t sp_upper_bound =
+      (base_info->has_dynamic_spatial || base_info->spatial_numel > 1)
+          ? kMaxNumel
+          : 1;
+  int64_t rd_upper_bound =
+      (base_info->has_dynamic_reduce || base_info->reduce_numel > 1)
+          ? kMaxNumel
+          : 1;
+  BucketInfo bucket_info{/* sp_lower_bound = */ 1,
+                         sp_upper_bound,
+                         /* rb_lower_bound = */ 1,
+                         rd_upper_bound,
+                         base_info->has_dynamic_spatial,
+                         base_info->has_dynamic_reduce};
+  TileConfig tile_config;
+  tile_config.vectorize_factor = HostVectorBits() / 32;
+  tile_config.spatial_block_numel = block_numel;
+  return {{bucket_info, tile_config}};
+}
+
 std::unordered_map<BucketInfo, ScheduleConfig, BucketInfoHash>
 CombineBaseInfoAndConfig(
     const TileConfigMap& config_map,
@@ -458,5 +522,15 @@ BuildScheduleConfig(const std::shared_ptr<FusionGroupInfo>& group_info,
   }
 }
 
+std::unordered_map<BucketInfo, ScheduleConfig, BucketInfoHash>
+BuildX86ScheduleConfig(const std::shared_ptr<FusionGroupInfo>& group_info,
+                       const common::Target& target) {
+  std::shared_ptr<ScheduleConfig::BaseInfo> base_info =
+      InitBasicInfo(group_info);
+  VLOG(6) << "Building x86 config.";
+  return CombineBaseInfoAndConfig(BuildX86Config(base_info, target),
+                                  base_info);
+}
+
 }  // namespace ir
 }  // namespace cinn
@@ -49,6 +49,10 @@ struct ScheduleConfig {
     int64_t grid_reduce_num{1};
     int64_t spatial_inner_num{1};
     ReduceMethod reduce_method{NoneReduceMethod()};
+    // Only used by the x86 tactics: the vector lanes of a 32-bit element, and
+    // the spatial elements of a cache block that a parallel task computes.
+    int64_t vectorize_factor{1};
+    int64_t spatial_block_numel{1};
   };
 
   std::shared_ptr<BaseInfo> base_info;
@@ -130,5 +134,9 @@ std::unordered_map<BucketInfo, ScheduleConfig, BucketInfoHash>
 BuildScheduleConfig(const std::shared_ptr<FusionGroupInfo>& group_info,
                     const common::Target& target);
 
+std::unordered_map<BucketInfo, ScheduleConfig, BucketInfoHash>
+BuildX86ScheduleConfig(const std::shared_ptr<FusionGroupInfo>& group_info,
+                       const common::Target& target);
+
 }  // namespace ir
 }  // namespace cinn
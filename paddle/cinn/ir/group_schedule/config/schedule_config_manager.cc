@@ -42,6 +42,19 @@ ScheduleConfigMap ScheduleConfigManager::ExtractConfigs(
     return CombineBaseInfoAndConfig(tile_config_map, base_info);
   };
 
+  // The stored configs are tuned for GPU, and the x86 tactics only read the
+  // x86 config.
+  bool is_x86 = target.arch.Match(
+      [&](common::X86Arch) { return true; },
+      [&](std::variant<common::UnknownArch,
+                       common::ARMArch,
+                       common::NVGPUArch,
+                       common::HygonDCUArchHIP,
+                       common::HygonDCUArchSYCL>) { return false; });
+  if (is_x86) {
+    return BuildX86ScheduleConfig(group_info, target);
+  }
+
   if (policy_ == "default" || tile_config_data_.count(policy_) == 0) {
     return BuildScheduleConfig(group_info, target);
   } else if (policy_ == "hybrid") {
@@ -20,6 +20,7 @@
 #include "paddle/cinn/ir/group_schedule/tactic/compute_inline_tactic.h"
 #include "paddle/cinn/ir/group_schedule/tactic/tile_broadcast_tactic.h"
 #include "paddle/cinn/ir/group_schedule/tactic/tile_first_general_tactic.h"
+#include "paddle/cinn/ir/group_schedule/tactic/x86_tile_tactic.h"
 #include "paddle/cinn/ir/ir_analyzer/ir_analyzer.h"
 #include "paddle/cinn/ir/op/ir_operators.h"
 #include "paddle/common/enforce.h"
@@ -33,10 +34,21 @@ void DynamicShapeGroupScheduler::Init() {
   VLOG(4) << "original group func body: \n"
           << ir_sch_->GetModule().GetExprs()[0];
   InitBuckets();
-  tactics_.emplace_back(CreateTileBroadcastTactic());
-  tactics_.emplace_back(CreateTileFirstGeneralTactic());
-  tactics_.emplace_back(CreateComputeInlineTactic());
-  tactics_.emplace_back(CreateComputeAtReductionTactic());
+  target_.arch.Match(
+      [&](common::X86Arch) {
+        tactics_.emplace_back(CreateComputeInlineTactic());
+        tactics_.emplace_back(CreateX86TileTactic());
+      },
+      [&](std::variant<common::UnknownArch,
+                       common::ARMArch,
+                       common::NVGPUArch,
+                       common::HygonDCUArchHIP,
+                       common::HygonDCUArchSYCL>) {
+        tactics_.emplace_back(CreateTileBroadcastTactic());
+        tactics_.emplace_back(CreateTileFirstGeneralTactic());
+        tactics_.emplace_back(CreateComputeInlineTactic());
+        tactics_.emplace_back(CreateComputeAtReductionTactic());
+      });
 }
 
 void DynamicShapeGroupScheduler::InitBuckets() {
@@ -128,9 +140,13 @@ std::vector<int> DynamicShapeGroupScheduler::GetPriorities() {
 
 std::vector<std::pair<SymbolicPredicate, ir::Expr>>
 DynamicShapeGroupScheduler::GetCX86IRs() {
+  // The x86 config has only one bucket, whose kernel is the fallback of all
+  // the shapes.
   std::vector<std::pair<SymbolicPredicate, ir::Expr>> irs(1);
   irs[0].first = ir::EQ::Make(ir::Expr(1), ir::Expr(1));
-  irs[1].second = ir_sch_->GetModule().GetExprs()[0];
+  irs[0].second = bucket_contexts_.empty()
+                      ? ir_sch_->GetModule().GetExprs()[0]
+                      : bucket_contexts_[0].ir_sch->GetModule().GetExprs()[0];
   return irs;
 }
 
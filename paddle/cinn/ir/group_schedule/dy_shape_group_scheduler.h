@@ -21,7 +21,7 @@ namespace ir {
 
 /**
  * The class used for scheduling fusion groups with dynamic shape.
- * Note: Currently only CUDA backend is supported.
+ * Note: Currently CUDA backend and the x86 kernel are supported.
  */
 class DynamicShapeGroupScheduler : public GroupScheduler {
  public:
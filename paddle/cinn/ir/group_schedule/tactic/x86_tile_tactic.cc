@@ -0,0 +1,284 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/ir/group_schedule/tactic/x86_tile_tactic.h"
+#include <numeric>
+#include <unordered_set>
+#include <vector>
+#include "paddle/cinn/common/target.h"
+#include "paddle/cinn/ir/ir.h"
+#include "paddle/cinn/ir/ir_analyzer/ir_analyzer.h"
+#include "paddle/cinn/ir/schedule/ir_schedule_util.h"
+#include "paddle/cinn/ir/utils/ir_nodes_collector.h"
+
+namespace cinn {
+namespace ir {
+
+using cinn::ir::analyzer::IsReductionSBlock;
+
+/**
+ * Tiles the loops of a block for the x86 kernel:
+ *   [S..., R...] => [S(parallel), S(block), S(vector), R]
+ * or, when the reduce axis is the last one in memory,
+ *   [S..., R...] => [S(parallel), S(block), R, R(vector)]
+ * where the spatial loop of a parallel task is cut into cache blocks, and the
+ * vector loop has the lanes of the host vector register. A vectorized reduce
+ * is factorized, so that each lane accumulates a strided part of the reduce
+ * axis while the innermost loop loads continuous elements, and the write back
+ * block adds up the lanes.
+ */
+class X86TileTactic final : public ScheduleTactic {
+ public:
+  void Init(ScheduleContext* context, ir::IRSchedule* sch) override;
+
+  void Apply(ir::IRSchedule* sch, const std::string& block_id) override;
+
+  std::string TacticName() const override { return "X86TileTactic"; }
+
+ private:
+  std::vector<bool> GetReduceLoopMask(ir::IRSchedule* sch,
+                                      const std::string& block_id);
+  int GetVectorLanes(ir::IRSchedule* sch, const std::string& block_id);
+  bool CanVectorizeReduce(ir::IRSchedule* sch,
+                          const std::string& block_id,
+                          int vector_lanes);
+  void MergeLoops(ir::IRSchedule* sch,
+                  const std::string& block_id,
+                  int sp_num,
+                  int rd_num);
+  void TileSpatial(ir::IRSchedule* sch,
+                   const std::string& block_id,
+                   int vector_lanes);
+  void VectorizeReduce(ir::IRSchedule* sch,
+                       const std::string& block_id,
+                       int vector_lanes);
+
+ private:
+  ScheduleContext* context_;
+  bool can_apply_;
+};
+
+void X86TileTactic::Init(ScheduleContext* context, ir::IRSchedule* sch) {
+  context_ = context;
+  can_apply_ = false;
+
+  bool is_x86 = context->target.arch.Match(
+      [&](common::X86Arch) { return true; },
+      [&](std::variant<common::UnknownArch,
+                       common::ARMArch,
+                       common::NVGPUArch,
+                       common::HygonDCUArchHIP,
+                       common::HygonDCUArchSYCL>) { return false; });
+  if (!is_x86) return;
+
+  // Check whether this group has been tiled by previous tactic.
+  ir::Expr module_root = sch->GetModule().GetExprs().front();
+  ir::Expr root_block = ir::analyzer::GetRootSBlock(module_root);
+  auto* root_node = root_block.As<ir::ScheduleBlockRealize>()
+                        ->schedule_block.As<ir::ScheduleBlock>();
+  if (root_node->attrs.count(kTileMethod) > 0) {
+    return;
+  }
+  can_apply_ = true;
+  root_node->attrs[kTileMethod] = TacticName();
+}
+
+void X86TileTactic::Apply(ir::IRSchedule* sch, const std::string& block_id) {
+  if (!can_apply_) return;
+  if (ir::IsReduceInitTensorName(block_id)) return;
+
+  std::vector<bool> reduce_mask = GetReduceLoopMask(sch, block_id);
+  if (reduce_mask.empty()) return;
+  int sp_num = 0;
+  while (sp_num < reduce_mask.size() && !reduce_mask[sp_num]) {
+    ++sp_num;
+  }
+  int rd_num = reduce_mask.size() - sp_num;
+  for (int i = sp_num; i < reduce_mask.size(); ++i) {
+    if (!reduce_mask[i]) {
+      VLOG(4) << "The reduce loops of block [" << block_id
+              << "] are not the innermost, skip X86TileTactic";
+      return;
+    }
+  }
+
+  MergeLoops(sch, block_id, sp_num, rd_num);
+  VLOG(6) << "After MergeLoops on block: [" << block_id << "], loop nest:\n"
+          << sch->GetLoops(block_id)[0];
+
+  // The reduce is vectorized only if the reduce axis is continuous in memory
+  // and splits into whole vectors, otherwise the spatial lanes are loaded
+  // from continuous addresses.
+  int lanes = GetVectorLanes(sch, block_id);
+  bool vectorize_reduce =
+      rd_num > 0 && lanes > 1 &&
+      context_->config.base_info->iter_space_type.back().first == "R" &&
+      CanVectorizeReduce(sch, block_id, lanes);
+  if (sp_num > 0) {
+    TileSpatial(sch, block_id, vectorize_reduce ? 1 : lanes);
+    VLOG(6) << "After TileSpatial on block: [" << block_id << "], loop nest:\n"
+            << sch->GetLoops(block_id)[0];
+  }
+  if (vectorize_reduce) {
+    VectorizeReduce(sch, block_id, lanes);
+    VLOG(6) << "After VectorizeReduce on block: [" << block_id
+            << "], func body:\n"
+            << sch->GetModule().GetExprs().front();
+  }
+}
+
+std::vector<bool> X86TileTactic::GetReduceLoopMask(
+    ir::IRSchedule* sch, const std::string& block_id) {
+  ir::Expr block = sch->GetBlock(block_id);
+  auto* block_realize = block.As<ir::ScheduleBlockRealize>();
+  auto* sch_block = block_realize->schedule_block.As<ir::ScheduleBlock>();
+  std::unordered_set<std::string> reduce_loop_vars;
+  for (int i = 0; i < sch_block->iter_vars.size(); ++i) {
+    if (!sch_block->iter_vars[i]->is_reduce_axis) continue;
+    ir::ir_utils::CollectIRNodesWithoutTensor(
+        block_realize->iter_values[i], [&](const ir::Expr* x) {
+          if (x->as_var()) {
+            reduce_loop_vars.insert(x->as_var()->name);
+          }
+          return false;
+        });
+  }
+
+  std::vector<bool> reduce_mask;
+  for (const ir::Expr& loop : sch->GetLoops(block_id)) {
+    reduce_mask.push_back(
+        reduce_loop_vars.count(loop.As<ir::For>()->loop_var->name) > 0);
+  }
+  return reduce_mask;
+}
+
+int X86TileTactic::GetVectorLanes(ir::IRSchedule* sch,
+                                  const std::string& block_id) {
+  ir::Tensor tensor =
+      analyzer::GetStoreTensorOfSBlock(sch->GetBlock(block_id));
+  const common::Type type = tensor->type();
+  if (!type.is_float(32) && !type.is_float(64) && !type.is_int(32) &&
+      !type.is_int(64)) {
+    return 1;
+  }
+  return context_->config.tile_config.vectorize_factor * 32 / type.bits();
+}
+
+bool X86TileTactic::CanVectorizeReduce(ir::IRSchedule* sch,
+                                       const std::string& block_id,
+                                       int vector_lanes) {
+  if (!IsReductionSBlock(sch->GetBlock(block_id))) return false;
+  // The merged reduce loop is the innermost one. It is split into more than
+  // one vector without tail.
+  ir::Expr extent = sch->GetLoops(block_id).back().As<ir::For>()->extent;
+  return extent.is_constant() && extent.as_int64() % vector_lanes == 0 &&
+         extent.as_int64() != vector_lanes;
+}
+
+void X86TileTactic::MergeLoops(ir::IRSchedule* sch,
+                               const std::string& block_id,
+                               int sp_num,
+                               int rd_num) {
+  // Merge the reduce loops first, so that the indices of the spatial loops
+  // are kept.
+  if (rd_num > 1) {
+    std::vector<int> rd_loops(rd_num);
+    std::iota(rd_loops.begin(), rd_loops.end(), sp_num);
+    sch->Fuse(block_id, rd_loops);
+  }
+  if (sp_num > 1) {
+    std::vector<int> sp_loops(sp_num);
+    std::iota(sp_loops.begin(), sp_loops.end(), 0);
+    sch->Fuse(block_id, sp_loops);
+  }
+}
+
+void X86TileTactic::TileSpatial(ir::IRSchedule* sch,
+                                const std::string& block_id,
+                                int vector_lanes) {
+  std::vector<ir::Expr> loops = sch->GetLoops(block_id);
+  const ir::Expr& extent = loops[0].As<ir::For>()->extent;
+  // -1 for a dynamic extent
+  int64_t sp_numel = extent.is_constant() ? extent.as_int64() : -1;
+  int64_t block_numel = context_->config.tile_config.spatial_block_numel;
+
+  // A vector loop must have a constant extent without tail, or the lanes
+  // would be guarded by an if.
+  if (vector_lanes > 1 && sp_numel > 0 && sp_numel % vector_lanes == 0) {
+    // [S, ...] => [S(-1), S(vector), ...]
+    sch->Split(loops[0], {-1, vector_lanes});
+    loops = sch->GetLoops(block_id);
+    sch->Vectorize(loops[1], vector_lanes);
+    sp_numel /= vector_lanes;
+    block_numel = std::max<int64_t>(block_numel / vector_lanes, 1);
+  }
+
+  // A group run in one block is not launched in parallel.
+  if (sp_numel > 0 && sp_numel <= block_numel) {
+    return;
+  }
+#ifdef CINN_USE_OPENMP
+  loops = sch->GetLoops(block_id);
+  if (block_numel > 1) {
+    // [S, ...] => [S(-1), S(block), ...]
+    sch->Split(loops[0], {-1, static_cast<int>(block_numel)});
+    loops = sch->GetLoops(block_id);
+  }
+  // The tasks of cinn_backend_parallel_launch take continuous ranges of the
+  // parallel loop, so a task computes whole cache blocks.
+  sch->Parallel(loops[0]);
+#endif
+}
+
+void X86TileTactic::VectorizeReduce(ir::IRSchedule* sch,
+                                    const std::string& block_id,
+                                    int vector_lanes) {
+  std::vector<ir::Expr> loops = sch->GetLoops(block_id);
+  const int rd_index = loops.size() - 1;
+
+  // [..., R] => [..., R(vector), R(-1)]
+  // The lane loop is factorized as the outer one, so that the init of the rf
+  // tensor is put outside of the loop that accumulates it.
+  sch->Split(loops[rd_index], {-1, vector_lanes});
+  loops = sch->GetLoops(block_id);
+  sch->Reorder({loops[rd_index + 1], loops[rd_index]});
+
+  // The rf tensor keeps the lanes in the last axis, so that a vector of
+  // partial results is loaded and stored at once.
+  loops = sch->GetLoops(block_id);
+  ir::Tensor reduce_tensor =
+      analyzer::GetStoreTensorOfSBlock(sch->GetBlock(block_id));
+  int rf_axis = reduce_tensor->domain_without_reduce_axis().size();
+  ir::Expr rf_tensor = sch->FactorizeReduction(loops[rd_index], rf_axis);
+  std::string rf_block_id = rf_tensor.as_tensor_ref()->name;
+
+  // The rf block is reordered to [..., R(-1), R(vector)], which moves the
+  // init to a loop of its own, so that the innermost loop reads continuous
+  // elements and each lane accumulates its own partial result.
+  std::vector<ir::Expr> rf_loops = sch->GetLoops(rf_block_id);
+  sch->Reorder({rf_loops[rd_index + 1], rf_loops[rd_index]});
+  rf_loops = sch->GetLoops(rf_block_id);
+  sch->Vectorize(rf_loops[rd_index + 1], vector_lanes);
+
+  // The write back block is [..., R(vector)], which adds up the lanes.
+  loops = sch->GetLoops(block_id);
+  sch->Unroll(loops.back());
+}
+
+std::unique_ptr<ScheduleTactic> CreateX86TileTactic() {
+  return std::make_unique<X86TileTactic>();
+}
+
+}  // namespace ir
+}  // namespace cinn
@@ -0,0 +1,227 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/ir/group_schedule/tactic/x86_tile_tactic.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle/cinn/cinn.h"
+#include "paddle/cinn/hlir/framework/pir/trivial_op_impl.h"
+#include "paddle/cinn/ir/group_schedule/base_group_scheduler.h"
+#include "paddle/cinn/ir/group_schedule/config/schedule_config_manager.h"
+#include "paddle/cinn/ir/ir.h"
+#include "paddle/cinn/ir/schedule/ir_schedule.h"
+#include "paddle/cinn/ir/utils/ir_nodes_collector.h"
+#include "paddle/cinn/optim/optimize.h"
+#include "paddle/cinn/utils/string.h"
+
+namespace cinn {
+namespace ir {
+
+namespace {
+
+std::shared_ptr<FusionGroupInfo> MakeGroupInfo(
+    const std::vector<int64_t>& loop_ranges,
+    const std::vector<int64_t>& reduce_axis) {
+  auto group_info = std::make_shared<FusionGroupInfo>();
+  group_info->loop_ranges = loop_ranges;
+  group_info->reduce_axis = reduce_axis;
+  group_info->can_apply_grid_reduce = false;
+  return group_info;
+}
+
+std::vector<const ir::For*> CollectLoops(const ir::Expr& expr) {
+  std::vector<const ir::For*> loops;
+  ir::ir_utils::CollectIRNodesWithoutTensor(expr, [&](const ir::Expr* x) {
+    if (x->As<ir::For>()) {
+      loops.push_back(x->As<ir::For>());
+    }
+    return false;
+  });
+  return loops;
+}
+
+// Returns the loop whose body has the loop, or nullptr.
+const ir::For* GetParentLoop(const ir::Expr& expr, const ir::For* loop) {
+  for (const ir::For* parent : CollectLoops(expr)) {
+    const ir::Block* body = parent->body.As<ir::Block>();
+    if (body == nullptr) continue;
+    for (const ir::Expr& stmt : body->stmts) {
+      if (stmt.As<ir::For>() == loop) return parent;
+    }
+  }
+  return nullptr;
+}
+
+// B[i] = sum(A[i, j]) with A of shape [64, cols], scheduled for the host.
+class X86RowReduce {
+ public:
+  explicit X86RowReduce(int cols = 128) {
+    Context::Global().ResetNameId();
+    Placeholder<float> A("A", {Expr(64), Expr(cols)});
+    Var reduce_j(cols, "reduce_j");
+    ir::Tensor B = Compute(
+        {Expr(64)},
+        [&](Var i) { return lang::ReduceSum(A(i, reduce_j), {reduce_j}); },
+        "B");
+    ast_gen_ius::TensorGroup tensor_group({A, B});
+    auto func = lang::LowerToAst("reduce_sum", {A, B}, &tensor_group);
+
+    ir::ModuleExpr mod_expr({func->body});
+    ir_sch_ = std::make_unique<ir::IRSchedule>(
+        mod_expr, -1, false, utils::ErrorMessageLevel::kGeneral, true);
+    group_scheduler_ = ir::GroupScheduler::Make(ir_sch_.get(),
+                                                {"B"},
+                                                common::DefaultHostTarget(),
+                                                /* is_dy_shape = */ true,
+                                                MakeGroupInfo({64, cols}, {1}));
+    group_scheduler_->Schedule();
+  }
+
+  ir::GroupScheduler* group_scheduler() { return group_scheduler_.get(); }
+
+ private:
+  std::unique_ptr<ir::IRSchedule> ir_sch_;
+  std::unique_ptr<ir::GroupScheduler> group_scheduler_;
+};
+
+int64_t GetHostLanes() {
+  ScheduleConfigMap configs = ScheduleConfigManager::Instance().ExtractConfigs(
+      common::DefaultHostTarget(), MakeGroupInfo({64, 128}, {1}));
+  return configs.begin()->second.tile_config.vectorize_factor;
+}
+
+}  // namespace
+
+TEST(X86TileTactic, config) {
+  common::Target target = common::DefaultHostTarget();
+  ScheduleConfigManager& manager = ScheduleConfigManager::Instance();
+
+  // A single bucket covers all the shapes.
+  ScheduleConfigMap configs =
+      manager.ExtractConfigs(target, MakeGroupInfo({64, 128}, {1}));
+  ASSERT_EQ(configs.size(), 1UL);
+  const BucketInfo& bucket = configs.begin()->first;
+  ASSERT_EQ(bucket.space.size(), 2UL);
+  EXPECT_EQ(bucket.space[0].iter_type, "S");
+  EXPECT_EQ(bucket.space[0].upper_bound, BucketInfo::kMaxNumel);
+  EXPECT_EQ(bucket.space[1].iter_type, "R");
+  EXPECT_EQ(bucket.space[1].upper_bound, BucketInfo::kMaxNumel);
+
+  // The lanes of a 32-bit element in a SSE, AVX2 or AVX512 register.
+  const ScheduleConfig::TileConfig& tile_config =
+      configs.begin()->second.tile_config;
+  EXPECT_TRUE(tile_config.vectorize_factor == 4 ||
+              tile_config.vectorize_factor == 8 ||
+              tile_config.vectorize_factor == 16);
+  EXPECT_GE(tile_config.spatial_block_numel, 1);
+  EXPECT_EQ(tile_config.spatial_block_numel &
+                (tile_config.spatial_block_numel - 1),
+            0);
+
+  // A group that fits in L1 runs in one block.
+  configs = manager.ExtractConfigs(target, MakeGroupInfo({16, 32}, {}));
+  ASSERT_EQ(configs.size(), 1UL);
+  EXPECT_GE(configs.begin()->second.tile_config.spatial_block_numel, 512);
+
+  configs = manager.ExtractConfigs(target, MakeGroupInfo({-1, 128}, {1}));
+  ASSERT_EQ(configs.size(), 1UL);
+  EXPECT_TRUE(configs.begin()->first.space[0].is_dynamic);
+  EXPECT_FALSE(configs.begin()->first.space[1].is_dynamic);
+}
+
+TEST(X86TileTactic, reduce_loops) {
+  X86RowReduce reduce;
+  const int64_t lanes = GetHostLanes();
+
+  // GetCX86IRs returns the one scheduled bucket, without writing past it.
+  auto irs = reduce.group_scheduler()->GetCX86IRs();
+  ASSERT_EQ(irs.size(), 1UL);
+  ir::Expr func_body = irs[0].second;
+  EXPECT_EQ(utils::GetStreamCnt(func_body),
+            utils::GetStreamCnt(reduce.group_scheduler()->GetIRs()[0].second));
+  VLOG(6) << "x86 func body:\n" << func_body;
+
+  // The rf block accumulates [i, R(128 / lanes), R(lanes)], where only the
+  // innermost loop, which reads continuous elements of A, is vectorized.
+  std::vector<const ir::For*> vectorized;
+  std::vector<const ir::For*> unrolled;
+  for (const ir::For* loop : CollectLoops(func_body)) {
+    if (loop->is_vectorized()) vectorized.push_back(loop);
+    if (loop->is_unrolled()) unrolled.push_back(loop);
+  }
+  ASSERT_EQ(vectorized.size(), 1UL);
+  const ir::For* lane_loop = vectorized[0];
+  EXPECT_EQ(lane_loop->extent.as_int64(), lanes);
+  EXPECT_EQ(lane_loop->vectorize_info().factor, lanes);
+  EXPECT_TRUE(CollectLoops(lane_loop->body).empty());
+  const ir::For* outer_loop = GetParentLoop(func_body, lane_loop);
+  ASSERT_NE(outer_loop, nullptr);
+  EXPECT_FALSE(outer_loop->is_vectorized());
+  EXPECT_EQ(outer_loop->extent.as_int64(), 128 / lanes);
+
+  // The write back block adds up the lanes.
+  ASSERT_EQ(unrolled.size(), 1UL);
+  EXPECT_EQ(unrolled[0]->extent.as_int64(), lanes);
+}
+
+TEST(X86TileTactic, reduce_with_tail) {
+  // 130 is not a multiple of the lanes of SSE, AVX2 or AVX512.
+  X86RowReduce reduce(130);
+  const int64_t lanes = GetHostLanes();
+  ir::Expr func_body = reduce.group_scheduler()->GetCX86IRs()[0].second;
+  VLOG(6) << "x86 func body:\n" << func_body;
+
+  // The reduce is not factorized, and the lanes go to the spatial loop
+  // instead: [..., i(lanes), R(130)].
+  std::vector<const ir::For*> vectorized;
+  for (const ir::For* loop : CollectLoops(func_body)) {
+    EXPECT_FALSE(loop->is_unrolled());
+    if (loop->is_vectorized()) vectorized.push_back(loop);
+  }
+  ASSERT_EQ(vectorized.size(), 1UL);
+  const ir::For* lane_loop = vectorized[0];
+  EXPECT_EQ(lane_loop->extent.as_int64(), lanes);
+  EXPECT_NE(GetParentLoop(func_body, lane_loop), nullptr);
+  std::vector<const ir::For*> inner_loops = CollectLoops(lane_loop->body);
+  ASSERT_EQ(inner_loops.size(), 1UL);
+  EXPECT_EQ(inner_loops[0]->extent.as_int64(), 130);
+}
+
+TEST(X86TileTactic, optimize) {
+  X86RowReduce reduce;
+  ir::Expr func_body = reduce.group_scheduler()->GetCX86IRs()[0].second;
+  std::vector<ir::Argument> args{
+      ir::Argument(ir::Var("A"), ir::Argument::IO::kInput),
+      ir::Argument(ir::Var("B"), ir::Argument::IO::kOutput)};
+  auto func = ir::_LoweredFunc_::Make("reduce_sum", args, func_body, {});
+  auto optimized = optim::Optimize(func, common::DefaultHostTarget());
+  VLOG(6) << "After Optimize:\n" << optimized->body;
+
+  // The vectorized loop is widened to Ramp and the unrolled one is expanded.
+  for (const ir::For* loop : CollectLoops(optimized->body)) {
+    EXPECT_FALSE(loop->is_vectorized());
+    EXPECT_FALSE(loop->is_unrolled());
+  }
+  auto ramps = ir::ir_utils::CollectIRNodesWithoutTensor(
+      optimized->body, [](const ir::Expr* x) { return x->As<ir::Ramp>(); });
+  EXPECT_FALSE(ramps.empty());
+}
+
+}  // namespace ir
+}  // namespace cinn
@@ -127,7 +127,8 @@ ir::LoweredFunc Optimize(ir::LoweredFunc fn,
       },
       [](auto) {});
 
-  VectorizeForTrans(&copied->body);
+  target.arch.Match([&](common::X86Arch) {},
+                     [&](auto) { VectorizeForTrans(&copied->body); });
   VLOG(10) << "After Optimize vectorize" << copied;
 
   Simplify(&copied->body);
@@ -137,6 +138,16 @@ ir::LoweredFunc Optimize(ir::LoweredFunc fn,
   pass_manager.Run(copied);
   VLOG(10) << "After RemoveScheduleBlock:" << copied;
 
+  // The vectorized loops of x86 are widened to Ramp after the schedule blocks
+  // are removed, and LLVM lowers them to the vector width of the host.
+  target.arch.Match(
+      [&](common::X86Arch) {
+        VectorizeLoops(&copied->body, target);
+        UnrollLoop(&copied->body);
+        VLOG(10) << "After x86 VectorizeLoops and UnrollLoop:" << copied;
+      },
+      [](auto) {});
+
   StmtPassManager stmt_pass_manager;
   stmt_pass_manager.AddPass(CreateIfFoldPass());
   stmt_pass_manager.Run(copied);
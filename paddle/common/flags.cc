@@ -740,6 +740,24 @@ PHI_DEFINE_EXPORTED_int32(
     "less FLAGS_max_inplace_grad_add, than it will be use several grad_add"
     "instead of sum. Default is 0.");
 
+/**
+ * Performance related FLAG
+ * Name: eager_backward_thread_num
+ * Since Version: 3.0.0
+ * Value Range: int32, default=0
+ * Example: FLAGS_eager_backward_thread_num=4
+ * Note: The number of threads to run the independent grad nodes of the eager
+ * backward on CPU. 0 or 1 runs them one by one on the calling thread. The
+ * gradients are accumulated in the same order whatever the thread number is
+ * as long as it is larger than 1. The backward with create_graph=True and
+ * paddle.grad always run sequentially. A new value takes effect from the next
+ * backward.
+ */
+PHI_DEFINE_EXPORTED_int32(eager_backward_thread_num,
+                          0,
+                          "The number of threads to run the grad nodes of "
+                          "the eager backward on CPU.");
+
 /**
  * Tensor.numpy() has a hack, and this flag can close this hack
  * [true]: set 0D Tensor to 1D Numpy
@@ -1059,6 +1077,20 @@ PHI_DEFINE_EXPORTED_int64(
     cinn_compile_thread_num,
     -1,
     "It controls how many thread numbers applying compilation cache.");
+
+/*
+ * CINN related FLAG
+ * Name: FLAGS_cinn_compilation_cache_dir
+ * Since Version: 3.0
+ * Value Range: string, default=""
+ * Example: FLAGS_cinn_compilation_cache_dir="./cinn_cache/" would save the
+ * compiled x86 kernels into "./cinn_cache/" and load them from there in later
+ * runs instead of compiling them again. Empty disables the disk cache.
+ */
+PHI_DEFINE_EXPORTED_string(cinn_compilation_cache_dir,
+                           "",
+                           "Directory of the persistent cinn compilation "
+                           "cache of x86 kernels.");
 /*
  * CINN related FLAG
  * Name: FLAGS_enable_interpretercore_launch_cinn
@@ -1325,6 +1357,37 @@ PHI_DEFINE_EXPORTED_int64(
     "The maximum length of the queue for completely established sockets "
     "waiting to be accepted for tcp, default is 2048.");
 
+/**
+ * ProcessGroupGloo related FLAG
+ * Name: gloo_async_comm
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_gloo_async_comm=true
+ * Note: Run the collectives of each ProcessGroupGloo on its communication
+ * thread in submission order, so that ops with sync_op=false return before
+ * they finish and overlap with the computation, e.g. gradient allreduce in
+ * the backward of data parallel.
+ */
+PHI_DEFINE_EXPORTED_bool(gloo_async_comm,
+                         false,
+                         "Run gloo collectives on a communication thread.");
+
+/**
+ * ProcessGroupGloo related FLAG
+ * Name: gloo_shm_buffer_size
+ * Since Version: 3.0.0
+ * Value Range: int64, default=4194304
+ * Example: FLAGS_gloo_shm_buffer_size=0 disables the shared memory
+ * collectives.
+ * Note: Size in bytes of the shared memory buffer of every rank, used by the
+ * allreduce, allgather and broadcast of a ProcessGroupGloo whose ranks are
+ * all on the same host instead of the gloo tcp transport.
+ */
+PHI_DEFINE_EXPORTED_int64(gloo_shm_buffer_size,
+                          4 << 20,
+                          "Size of the per rank shared memory buffer of gloo "
+                          "collectives among the ranks of one host.");
+
 /**
  * Autotune related FLAG
  * Name: FLAGS_use_autotune
@@ -1545,6 +1608,22 @@ PHI_DEFINE_EXPORTED_bool(dataloader_use_file_descriptor,
                          false,
                          "Use file descriptor in mmap_allocator.");
 
+/**
+ * mmap_allocator related FLAG
+ * Name: load_params_with_mmap
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, load_combine and the pir parameter loading map the params
+ * file copy-on-write and CPU tensors alias the mapped pages instead of
+ * copying them, so that processes loading the same file share its memory.
+ * Tensors whose data is not aligned in the file are still copied.
+ */
+PHI_DEFINE_EXPORTED_bool(load_params_with_mmap,
+                         false,
+                         "Map params files and alias CPU tensors to them when "
+                         "loading parameters.");
+
 /**
  * Tensor operants related FLAG
  * Name: tensor_operants_mode
@@ -1646,6 +1725,20 @@ PHI_DEFINE_EXPORTED_bool(pir_apply_inplace_pass,
                          "Whether to apply inplace pass on lowering "
                          "::pir::Program to Kernel Dialect");
 
+/**
+ * Apply memory plan pass to PIR FLAG
+ * Name: pir_apply_memory_plan_pass
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, the static shape CPU tensors of the lowered program are
+ * planned into one arena, which the interpreter allocates once.
+ */
+PHI_DEFINE_EXPORTED_bool(pir_apply_memory_plan_pass,
+                         false,
+                         "Whether to apply memory plan pass on lowering "
+                         "::pir::Program to Kernel Dialect");
+
 PHI_DEFINE_EXPORTED_string(
     ir_inplace_kernel_blacklist,
     "",
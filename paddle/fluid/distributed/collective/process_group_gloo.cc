@@ -29,9 +29,12 @@
 #include "glog/logging.h"
 #include "paddle/fluid/distributed/collective/common.h"
 #include "paddle/fluid/distributed/collective/process_group_gloo.h"
+#include "paddle/common/flags.h"
 #include "paddle/phi/core/distributed/comm_context_manager.h"
 #include "paddle/phi/core/enforce.h"
 
+COMMON_DECLARE_bool(gloo_async_comm);
+
 namespace paddle::distributed {
 
 #ifdef _WIN32
@@ -152,6 +155,44 @@ ProcessGroupGloo::GlooTask::GlooTask(
     int rank, const std::vector<phi::DenseTensor>& inputs, CommType comm_type)
     : ProcessGroup::Task(rank, inputs, comm_type) {}
 
+bool ProcessGroupGloo::GlooTask::Wait(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (timeout == kWaitTimeout) {
+    cv_.wait(lock, [&] { return is_completed_; });
+  } else {
+    cv_.wait_for(lock, timeout, [&] { return is_completed_; });
+    PADDLE_ENFORCE_EQ(
+        is_completed_,
+        true,
+        common::errors::Unavailable("Gloo operation timeout after %d ms.",
+                                    timeout.count()));
+  }
+  if (exception_) {
+    std::rethrow_exception(exception_);
+  }
+  return true;
+}
+
+bool ProcessGroupGloo::GlooTask::IsCompleted() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return is_completed_;
+}
+
+void ProcessGroupGloo::GlooTask::Execute() {
+  std::exception_ptr exception = nullptr;
+  try {
+    Run();
+  } catch (...) {
+    exception = std::current_exception();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_completed_ = true;
+    exception_ = exception;
+  }
+  cv_.notify_all();
+}
+
 ProcessGroupGloo::ProcessGroupGloo(
     const std::shared_ptr<phi::distributed::Store>& store,
     int rank,
@@ -160,14 +201,67 @@ ProcessGroupGloo::ProcessGroupGloo(
     const std::shared_ptr<GlooOptions> options)
     : ProcessGroupWithoutStream(rank, world_size, gid),
       _tag(0),
-      _store(new GlooStore(store)) {
+      _store(new GlooStore(store)),
+      _async_comm(FLAGS_gloo_async_comm) {
   _context = std::make_shared<gloo::rendezvous::Context>(rank, world_size);
   _context->connectFullMesh(*_store, options->device);
+  _shm_comm = ShmComm::Create(
+      store, "shm_comm/" + std::to_string(gid), rank, world_size);
+  if (_async_comm) {
+    _worker_thread = std::thread(&ProcessGroupGloo::WorkLoop, this);
+  }
+}
+
+ProcessGroupGloo::~ProcessGroupGloo() {
+  if (!_async_comm) return;
+  std::unique_lock<std::mutex> lock(_queue_mutex);
+  _queue_consume.wait(lock, [&] { return _queue.empty(); });
+  _stop = true;
+  lock.unlock();
+  _queue_produce.notify_all();
+  _worker_thread.join();
+}
+
+void ProcessGroupGloo::WorkLoop() {
+  std::unique_lock<std::mutex> lock(_queue_mutex);
+  while (!_stop) {
+    if (_queue.empty()) {
+      _queue_produce.wait(lock);
+      continue;
+    }
+    auto task = std::move(_queue.front());
+    _queue.pop_front();
+    lock.unlock();
+    _queue_consume.notify_one();
+
+    task->Execute();
+
+    lock.lock();
+  }
+}
+
+void ProcessGroupGloo::Enqueue(const std::shared_ptr<GlooTask>& task,
+                               bool sync_op) {
+  if (!_async_comm) {
+    task->Execute();
+    // rethrow the exception of the task
+    task->Wait();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(_queue_mutex);
+    _queue.push_back(task);
+  }
+  _queue_produce.notify_one();
+  if (sync_op) {
+    task->Wait();
+  }
 }
 
 class BroadcastGlooTask : public ProcessGroupGloo::GlooTask {
  public:
   BroadcastGlooTask(phi::distributed::GlooCommContext* comm_context,
+                    ShmComm* shm_comm,
                     std::vector<phi::DenseTensor>& inputs,   // NOLINT
                     std::vector<phi::DenseTensor>& outputs,  // NOLINT
                     int rank,
@@ -175,6 +269,7 @@ class BroadcastGlooTask : public ProcessGroupGloo::GlooTask {
                     uint32_t tag)
       : ProcessGroupGloo::GlooTask(rank, inputs, CommType::BROADCAST),
         _comm_context(comm_context),
+        _shm_comm(shm_comm),
         _root(root),
         _inputs(inputs),
         _outputs(outputs),
@@ -184,12 +279,17 @@ class BroadcastGlooTask : public ProcessGroupGloo::GlooTask {
 
  private:
   phi::distributed::GlooCommContext* _comm_context;
+  ShmComm* _shm_comm;
   const int _root;
   std::vector<phi::DenseTensor> _inputs{};
   std::vector<phi::DenseTensor> _outputs{};
   const uint32_t _tag;
 
   void _do_broadcast(phi::DenseTensor& in, phi::DenseTensor& out) {  // NOLINT
+    if (_shm_comm) {
+      _shm_comm->Broadcast(&(out), in, _root);
+      return;
+    }
     _comm_context->Broadcast(&(out), in, _root, _tag);
   }
 };
@@ -202,7 +302,7 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::Broadcast(
     bool sync_op) {
   std::vector<phi::DenseTensor> in_wrapper{in_tensor};
   std::vector<phi::DenseTensor> out_wrapper{*out_tensor};
-  return Broadcast(in_wrapper, out_wrapper, opts, true);
+  return Broadcast(in_wrapper, out_wrapper, opts, sync_op);
 }
 
 std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::Broadcast(
@@ -221,12 +321,12 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::Broadcast(
   CheckTensorContiguous(outputs);
 
   auto root = opts.source_rank;
-  std::unique_ptr<BroadcastGlooTask> task;
+  std::shared_ptr<BroadcastGlooTask> task;
   auto tag = next_tag();
   auto comm_context = this->GetCommContext();
-  task = std::make_unique<BroadcastGlooTask>(
-      comm_context, inputs, outputs, rank_, root, tag);
-  task->Run();
+  task = std::make_shared<BroadcastGlooTask>(
+      comm_context, _shm_comm.get(), inputs, outputs, rank_, root, tag);
+  Enqueue(task, sync_op);
   return task;
 }
 
@@ -265,12 +365,12 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::Send(
 std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::Send(
     std::vector<phi::DenseTensor>& inputs, int dst_rank) {
   CheckTensorContiguous(inputs);
-  std::unique_ptr<SendGlooTask> task;
+  std::shared_ptr<SendGlooTask> task;
   auto tag = next_tag();
   auto comm_context = this->GetCommContext();
-  task = std::make_unique<SendGlooTask>(
+  task = std::make_shared<SendGlooTask>(
       comm_context, &inputs, rank_, dst_rank, tag);
-  task->Run();
+  Enqueue(task, true);
 
   return task;
 }
@@ -309,13 +409,13 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::Recv(
 
 std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::Recv(
     std::vector<phi::DenseTensor>& outputs, int src_rank) {
-  std::unique_ptr<RecvGlooTask> task;
+  std::shared_ptr<RecvGlooTask> task;
   auto tag = next_tag();
   auto comm_context = this->GetCommContext();
 
-  task = std::make_unique<RecvGlooTask>(
+  task = std::make_shared<RecvGlooTask>(
       comm_context, &outputs, rank_, src_rank, tag);
-  task->Run();
+  Enqueue(task, true);
   return task;
 }
 
@@ -323,12 +423,14 @@ class AllreduceGlooTask : public ProcessGroupGloo::GlooTask {
  public:
   AllreduceGlooTask(int rank,
                     phi::distributed::GlooCommContext* comm_context,
+                    ShmComm* shm_comm,
                     std::vector<phi::DenseTensor>& inputs,   // NOLINT
                     std::vector<phi::DenseTensor>& outputs,  // NOLINT
                     ReduceOp reduce_op,
                     uint32_t tag)
       : ProcessGroupGloo::GlooTask(rank, inputs, CommType::ALLREDUCE),
         _comm_context(comm_context),
+        _shm_comm(shm_comm),
         _inputs(inputs),
         _outputs(outputs),
         _reduce_op(reduce_op),
@@ -338,6 +440,7 @@ class AllreduceGlooTask : public ProcessGroupGloo::GlooTask {
 
  private:
   phi::distributed::GlooCommContext* _comm_context;
+  ShmComm* _shm_comm;
   std::vector<phi::DenseTensor> _inputs;
   std::vector<phi::DenseTensor> _outputs;
   const ReduceOp _reduce_op;
@@ -345,6 +448,10 @@ class AllreduceGlooTask : public ProcessGroupGloo::GlooTask {
 
   void _do_allreduce(std::vector<phi::DenseTensor>& ins,     // NOLINT
                      std::vector<phi::DenseTensor>& outs) {  // NOLINT
+    if (_shm_comm && ShmComm::CanAllReduce(ins[0].dtype(), _reduce_op)) {
+      _shm_comm->AllReduce(&(outs[0]), ins[0], _reduce_op);
+      return;
+    }
     _comm_context->AllReduce(
         &(outs[0]), ins[0], static_cast<int>(_reduce_op), _tag);
   }
@@ -357,14 +464,16 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::AllReduce(
     bool sync_op) {
   std::vector<phi::DenseTensor> in_wrapper{in_tensor};
   std::vector<phi::DenseTensor> out_wrapper{*out_tensor};
-  return AllReduce(in_wrapper, out_wrapper, opts, true);
+  return AllReduce(in_wrapper, out_wrapper, opts, sync_op);
 }
 
 std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::AllReduce(
     std::vector<phi::DenseTensor>& inputs,
     std::vector<phi::DenseTensor>& outputs,
     const AllreduceOptions& opts) {
-  return AllReduce(inputs, outputs, opts, true);
+  // Same as ProcessGroup, the legacy API is asynchronous, e.g. EagerReducer
+  // synchronizes the tasks of all buckets at the end of backward.
+  return AllReduce(inputs, outputs, opts, false);
 }
 
 std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::AllReduce(
@@ -378,9 +487,14 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::AllReduce(
   auto tag = next_tag();
   std::shared_ptr<GlooTask> task;
   auto comm_context = this->GetCommContext();
-  task = std::make_shared<AllreduceGlooTask>(
-      rank_, comm_context, inputs, outputs, opts.reduce_op, tag);
-  task->Run();
+  task = std::make_shared<AllreduceGlooTask>(rank_,
+                                             comm_context,
+                                             _shm_comm.get(),
+                                             inputs,
+                                             outputs,
+                                             opts.reduce_op,
+                                             tag);
+  Enqueue(task, sync_op);
   return task;
 }
 
@@ -404,7 +518,7 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::Barrier(
   std::shared_ptr<BarrierGlooTask> task;
   auto comm_context = this->GetCommContext();
   task = std::make_shared<BarrierGlooTask>(rank_, comm_context);
-  task->Run();
+  Enqueue(task, true);
   return task;
 }
 
@@ -412,11 +526,13 @@ class AllgatherGlooTask : public ProcessGroupGloo::GlooTask {
  public:
   AllgatherGlooTask(int rank,
                     phi::distributed::GlooCommContext* comm_context,
+                    ShmComm* shm_comm,
                     std::vector<phi::DenseTensor>& inputs,   // NOLINT
                     std::vector<phi::DenseTensor>& outputs,  // NOLINT
                     uint32_t tag)
       : ProcessGroupGloo::GlooTask(rank, inputs, CommType::ALLGATHER),
         _comm_context(comm_context),
+        _shm_comm(shm_comm),
         _inputs(inputs),
         _outputs(outputs),
         _tag(tag) {}
@@ -425,12 +541,17 @@ class AllgatherGlooTask : public ProcessGroupGloo::GlooTask {
 
  private:
   phi::distributed::GlooCommContext* _comm_context;
+  ShmComm* _shm_comm;
   std::vector<phi::DenseTensor> _inputs;
   std::vector<phi::DenseTensor> _outputs;
   uint32_t _tag;
 
   void _do_allgather(std::vector<phi::DenseTensor>& in,     // NOLINT
                      std::vector<phi::DenseTensor>& out) {  // NOLINT
+    if (_shm_comm) {
+      _shm_comm->AllGather(&(out[0]), in[0]);
+      return;
+    }
     _comm_context->AllGather(&(out[0]), in[0], _tag);
   }
 };
@@ -443,7 +564,7 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::AllGather(
     bool sync_op) {
   std::vector<phi::DenseTensor> in_wrapper{in_tensor};
   std::vector<phi::DenseTensor> out_wrapper{*out_tensor};
-  return AllGather(in_wrapper, out_wrapper, true);
+  return AllGather(in_wrapper, out_wrapper, sync_op);
 }
 
 std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::AllGather(
@@ -462,8 +583,8 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::AllGather(
   auto tag = next_tag();
   auto comm_context = this->GetCommContext();
   task = std::make_shared<AllgatherGlooTask>(
-      rank_, comm_context, in_tensors, out_tensors, tag);
-  task->Run();
+      rank_, comm_context, _shm_comm.get(), in_tensors, out_tensors, tag);
+  Enqueue(task, sync_op);
   return task;
 }
 
@@ -506,8 +627,7 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::Reduce(
     phi::DenseTensor* out_tensor,
     const phi::DenseTensor& in_tensor,
     const ReduceOptions& opts,
-    bool sync_op  // for compatibility, no use now
-) {
+    bool sync_op) {
   CheckTensorContiguous(in_tensor);
   CheckTensorContiguous(*out_tensor);
 
@@ -523,7 +643,7 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::Reduce(
                                           opts.reduce_op,
                                           opts.root_rank,
                                           tag);
-  task->Run();
+  Enqueue(task, sync_op);
   return task;
 }
 
@@ -583,7 +703,7 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::Scatter(
   std::vector<phi::DenseTensor> out_wrapper{*out_tensor};
   task = std::make_shared<ScatterGlooTask>(
       rank_, comm_context, in_wrapper, out_wrapper, opts.root_rank, size_, tag);
-  task->Run();
+  Enqueue(task, sync_op);
   return task;
 }
 
@@ -643,7 +763,7 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::Gather(
   auto comm_context = this->GetCommContext();
   task = std::make_shared<GatherGlooTask>(
       rank_, comm_context, in_tensor, out_tensor, opts.root_rank, tag);
-  task->Run();
+  Enqueue(task, sync_op);
   return task;
 }
 
@@ -14,12 +14,17 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <future>
 #include <memory>
 #include <mutex>
+#include <thread>
 
 #include "paddle/fluid/distributed/collective/process_group.h"
 #include "paddle/fluid/distributed/collective/process_group_without_stream.h"
+#include "paddle/fluid/distributed/collective/shm_comm.h"
 #include "paddle/phi/backends/context_pool.h"
 #include "paddle/phi/core/distributed/gloo_comm_context.h"
 #include "paddle/phi/core/distributed/store/store.h"
@@ -40,12 +45,20 @@ class ProcessGroupGloo : public ProcessGroupWithoutStream {
     ~GlooTask() = default;
 
     virtual void Run() = 0;
-    bool Wait(std::chrono::milliseconds timeout) override { return true; }
-    bool IsCompleted() override { return true; }
-    void Synchronize() override {}
+    bool Wait(std::chrono::milliseconds timeout = kWaitTimeout) override;
+    bool IsCompleted() override;
+    void Synchronize() override { Wait(); }
 
    protected:
     friend class ProcessGroupGloo;
+
+   private:
+    // Runs the task, then marks it completed with the exception thrown if
+    // any, which is rethrown by Wait.
+    void Execute();
+
+    std::condition_variable cv_;
+    std::exception_ptr exception_;
   };
 
   class GlooStore : public ::gloo::rendezvous::Store {
@@ -89,7 +102,7 @@ class ProcessGroupGloo : public ProcessGroupWithoutStream {
       int world_size,
       int gid);
 
-  ~ProcessGroupGloo() = default;
+  ~ProcessGroupGloo();
 
   std::shared_ptr<ProcessGroup::Task> AllGather(
       phi::DenseTensor* out_tensor,
@@ -213,9 +226,27 @@ class ProcessGroupGloo : public ProcessGroupWithoutStream {
   static std::shared_ptr<::gloo::transport::Device> createDefaultDevice();
 
  private:
+  // Runs the task on the caller thread, or on the communication thread if
+  // FLAGS_gloo_async_comm is set, in which case only a sync_op waits for it.
+  void Enqueue(const std::shared_ptr<GlooTask>& task, bool sync_op);
+  void WorkLoop();
+
   uint32_t _tag;
   std::shared_ptr<gloo::rendezvous::Context> _context;
   std::shared_ptr<::gloo::rendezvous::Store> _store;
+  // Set if all ranks are on the same host, used instead of the gloo
+  // transport by the collectives it supports.
+  std::unique_ptr<ShmComm> _shm_comm;
+
+  // Tasks are executed one by one in submission order, which keeps the order
+  // of collectives the same on all ranks.
+  bool _async_comm{false};
+  bool _stop{false};
+  std::mutex _queue_mutex;
+  std::condition_variable _queue_produce;
+  std::condition_variable _queue_consume;
+  std::deque<std::shared_ptr<GlooTask>> _queue;
+  std::thread _worker_thread;
 };
 
 }  // namespace distributed
@@ -30,6 +30,15 @@ static bool IsStreamSafeAllocator() {
           FLAGS_use_stream_safe_cuda_allocator);
 }
 
+// Whether the dense contents of a group are split back into the gradients
+// right after the allreduce is scheduled, ordered by the stream of the
+// communication. A CPU task has no stream to order the split after, e.g.
+// gloo with FLAGS_gloo_async_comm runs it in a worker thread, so the split is
+// left to FinalizeBackward after the task is synchronized.
+static bool SplitAfterAllReduceScheduled(const phi::Place &place) {
+  return IsStreamSafeAllocator() && !phi::is_cpu_place(place);
+}
+
 static Backend TransToBackend(phi::Place place) {
   static const std::map<phi::AllocationType, Backend> type_backend = {
       {phi::AllocationType::GPU, Backend::GPU},
@@ -1068,7 +1077,7 @@ void EagerReducer::FinalizeBackward() {
   for (auto &group : groups_) {
     if (!group.is_sparse_) {
       group.task->Synchronize();
-      if (!IsStreamSafeAllocator()) {
+      if (!SplitAfterAllReduceScheduled(inner_place_)) {
         auto *default_ctx =
             phi::DeviceContextPool::Instance().Get(inner_place_);
         group.SplitTensors(*default_ctx);
@@ -1112,7 +1121,7 @@ void EagerReducer::FusedAllReduceSchedule(EagerGroup *group,
 
   auto *context = process_group_->GetDeviceContext(inner_place_);
 
-  if (IsStreamSafeAllocator()) {
+  if (SplitAfterAllReduceScheduled(inner_place_)) {
     // NOTE(shenliang03): The best_fit allocator strategy is multi-stream
     // insecure. In the Split operator, additional memory will be applied for
     // calculation, and if it is asynchronous, an illegal memory access may be
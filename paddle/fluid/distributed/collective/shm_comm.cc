@@ -0,0 +1,360 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/collective/shm_comm.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+#include "paddle/phi/core/enforce.h"
+
+COMMON_DECLARE_int64(gloo_shm_buffer_size);
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+std::vector<uint8_t> ToBytes(const std::string& str) {
+  return std::vector<uint8_t>(str.begin(), str.end());
+}
+
+std::string FromBytes(const std::vector<uint8_t>& bytes) {
+  return std::string(bytes.begin(), bytes.end());
+}
+
+// Every rank publishes its value, then reads the values of all ranks.
+std::vector<std::string> ExchangeAll(
+    const std::shared_ptr<phi::distributed::Store>& store,
+    const std::string& key,
+    int rank,
+    int world_size,
+    const std::string& value) {
+  store->set(key + "/" + std::to_string(rank), ToBytes(value));
+  std::vector<std::string> values(world_size);
+  for (int i = 0; i < world_size; ++i) {
+    values[i] = FromBytes(store->get(key + "/" + std::to_string(i)));
+  }
+  return values;
+}
+
+template <typename T>
+void ReduceInto(T* out, const T* in, int64_t numel, ReduceOp reduce_op) {
+  switch (reduce_op) {
+    case ReduceOp::SUM:
+      for (int64_t i = 0; i < numel; ++i) out[i] = out[i] + in[i];
+      break;
+    case ReduceOp::MAX:
+      for (int64_t i = 0; i < numel; ++i) out[i] = std::max(out[i], in[i]);
+      break;
+    case ReduceOp::MIN:
+      for (int64_t i = 0; i < numel; ++i) out[i] = std::min(out[i], in[i]);
+      break;
+    case ReduceOp::PRODUCT:
+      for (int64_t i = 0; i < numel; ++i) out[i] = out[i] * in[i];
+      break;
+    default:
+      PADDLE_THROW(common::errors::Unimplemented(
+          "Reduce op %d is not supported by shared memory allreduce.",
+          static_cast<int>(reduce_op)));
+  }
+}
+
+}  // namespace
+
+std::unique_ptr<ShmComm> ShmComm::Create(
+    const std::shared_ptr<phi::distributed::Store>& store,
+    const std::string& prefix,
+    int rank,
+    int world_size) {
+#ifdef _WIN32
+  return nullptr;
+#else
+  const int64_t buffer_size = FLAGS_gloo_shm_buffer_size / 64 * 64;
+  if (world_size <= 1 || buffer_size <= 0) {
+    return nullptr;
+  }
+
+  std::array<char, 256> hostname{};
+  if (gethostname(hostname.data(), hostname.size() - 1) != 0) {
+    hostname[0] = '\0';
+  }
+  auto hostnames =
+      ExchangeAll(store, prefix + "/host", rank, world_size, hostname.data());
+  if (std::count(hostnames.begin(), hostnames.end(), hostnames[0]) !=
+      world_size) {
+    VLOG(3) << "Not use shared memory collectives for " << prefix
+            << ", the ranks are on different hosts.";
+    return nullptr;
+  }
+
+  // The name is unique to the job, ranks of another host with the same host
+  // name fail to open it and all ranks fall back to gloo.
+  const size_t segment_size = world_size * (sizeof(Flag) + buffer_size);
+  std::string name;
+  int fd = -1;
+  if (rank == 0) {
+    name = "/paddle_shm_comm_" + std::to_string(getpid()) + "_" +
+           std::to_string(std::hash<std::string>{}(prefix));
+    fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    // Allocate the pages now, a full /dev/shm then fails here instead of
+    // raising SIGBUS on the first write to a page of a sparse segment.
+    if (fd != -1 && posix_fallocate(fd, 0, segment_size) != 0) {
+      close(fd);
+      shm_unlink(name.c_str());
+      fd = -1;
+    }
+    store->set(prefix + "/name", ToBytes(fd == -1 ? "" : name));
+  } else {
+    name = FromBytes(store->get(prefix + "/name"));
+    if (!name.empty()) {
+      fd = shm_open(name.c_str(), O_RDWR, 0600);
+    }
+  }
+  void* segment = MAP_FAILED;
+  if (fd != -1) {
+    segment = mmap(
+        nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+  }
+
+  const bool mapped = segment != MAP_FAILED;
+  auto status = ExchangeAll(
+      store, prefix + "/status", rank, world_size, mapped ? "1" : "0");
+  // All ranks have opened the segment or failed, it's released on the unmap
+  // of the last rank from now on.
+  if (rank == 0 && !name.empty()) {
+    shm_unlink(name.c_str());
+  }
+  if (std::count(status.begin(), status.end(), "1") != world_size) {
+    LOG(WARNING) << "Failed to map the shared memory of " << prefix
+                 << " on some ranks, fall back to gloo collectives.";
+    if (mapped) munmap(segment, segment_size);
+    return nullptr;
+  }
+
+  VLOG(3) << "Use shared memory collectives for " << prefix << " of "
+          << world_size << " ranks, buffer size " << buffer_size;
+  return std::unique_ptr<ShmComm>(
+      new ShmComm(rank,
+                  world_size,
+                  segment,
+                  segment_size,
+                  buffer_size,
+                  std::chrono::seconds(store->timeout())));
+#endif
+}
+
+ShmComm::ShmComm(int rank,
+                 int world_size,
+                 void* segment,
+                 size_t segment_size,
+                 size_t buffer_size,
+                 std::chrono::seconds timeout)
+    : rank_(rank),
+      world_size_(world_size),
+      segment_(segment),
+      segment_size_(segment_size),
+      buffer_size_(buffer_size),
+      timeout_(timeout),
+      flags_(static_cast<Flag*>(segment)),
+      buffers_(static_cast<char*>(segment) + world_size * sizeof(Flag)) {}
+
+ShmComm::~ShmComm() {
+#ifndef _WIN32
+  munmap(segment_, segment_size_);
+#endif
+}
+
+void ShmComm::Barrier() {
+  ++barrier_count_;
+  flags_[rank_].value.store(barrier_count_, std::memory_order_release);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < world_size_; ++i) {
+    for (size_t spin = 1;
+         flags_[i].value.load(std::memory_order_acquire) < barrier_count_;
+         ++spin) {
+      if (spin % 1024 != 0) continue;
+      std::this_thread::yield();
+      if (std::chrono::steady_clock::now() - start > timeout_) {
+        PADDLE_THROW(common::errors::Unavailable(
+            "Timeout waiting for rank %d in shared memory collectives.", i));
+      }
+    }
+  }
+}
+
+bool ShmComm::CanAllReduce(phi::DataType dtype, ReduceOp reduce_op) {
+  if (reduce_op != ReduceOp::SUM && reduce_op != ReduceOp::MAX &&
+      reduce_op != ReduceOp::MIN && reduce_op != ReduceOp::PRODUCT) {
+    return false;
+  }
+  switch (dtype) {
+    case phi::DataType::FLOAT32:
+    case phi::DataType::FLOAT64:
+    case phi::DataType::FLOAT16:
+    case phi::DataType::BFLOAT16:
+    case phi::DataType::INT32:
+    case phi::DataType::INT64:
+      return true;
+    default:
+      return false;
+  }
+}
+
+template <typename T>
+void ShmComm::AllReduceImpl(T* out,
+                            const T* in,
+                            int64_t numel,
+                            ReduceOp reduce_op) {
+  const int64_t segment_numel = buffer_size_ / sizeof(T);
+  const auto PartBegin = [&](int64_t size, int part) {
+    return size * part / world_size_;
+  };
+  for (int64_t offset = 0; offset < numel; offset += segment_numel) {
+    const int64_t size = std::min(segment_numel, numel - offset);
+    std::memcpy(Buffer(rank_), in + offset, size * sizeof(T));
+    Barrier();
+
+    // Reduce the part of this rank in the order of ranks, which gives the
+    // same result on all ranks, then put it back to the own buffer.
+    const int64_t begin = PartBegin(size, rank_);
+    const int64_t end = PartBegin(size, rank_ + 1);
+    T* part = out + offset + begin;
+    std::memcpy(part,
+                reinterpret_cast<T*>(Buffer(0)) + begin,
+                (end - begin) * sizeof(T));
+    for (int i = 1; i < world_size_; ++i) {
+      ReduceInto(part,
+                 reinterpret_cast<T*>(Buffer(i)) + begin,
+                 end - begin,
+                 reduce_op);
+    }
+    std::memcpy(reinterpret_cast<T*>(Buffer(rank_)) + begin,
+                part,
+                (end - begin) * sizeof(T));
+    Barrier();
+
+    for (int i = 0; i < world_size_; ++i) {
+      if (i == rank_) continue;
+      const int64_t other_begin = PartBegin(size, i);
+      const int64_t other_end = PartBegin(size, i + 1);
+      std::memcpy(out + offset + other_begin,
+                  reinterpret_cast<T*>(Buffer(i)) + other_begin,
+                  (other_end - other_begin) * sizeof(T));
+    }
+    // the buffers are reused by the next segment
+    Barrier();
+  }
+}
+
+void ShmComm::AllReduce(phi::DenseTensor* out_tensor,
+                        const phi::DenseTensor& in_tensor,
+                        ReduceOp reduce_op) {
+  const int64_t numel = in_tensor.numel();
+  switch (in_tensor.dtype()) {
+    case phi::DataType::FLOAT32:
+      AllReduceImpl(out_tensor->data<float>(),
+                    in_tensor.data<float>(),
+                    numel,
+                    reduce_op);
+      break;
+    case phi::DataType::FLOAT64:
+      AllReduceImpl(out_tensor->data<double>(),
+                    in_tensor.data<double>(),
+                    numel,
+                    reduce_op);
+      break;
+    case phi::DataType::FLOAT16:
+      AllReduceImpl(out_tensor->data<phi::dtype::float16>(),
+                    in_tensor.data<phi::dtype::float16>(),
+                    numel,
+                    reduce_op);
+      break;
+    case phi::DataType::BFLOAT16:
+      AllReduceImpl(out_tensor->data<phi::dtype::bfloat16>(),
+                    in_tensor.data<phi::dtype::bfloat16>(),
+                    numel,
+                    reduce_op);
+      break;
+    case phi::DataType::INT32:
+      AllReduceImpl(out_tensor->data<int32_t>(),
+                    in_tensor.data<int32_t>(),
+                    numel,
+                    reduce_op);
+      break;
+    case phi::DataType::INT64:
+      AllReduceImpl(out_tensor->data<int64_t>(),
+                    in_tensor.data<int64_t>(),
+                    numel,
+                    reduce_op);
+      break;
+    default:
+      PADDLE_THROW(common::errors::Unimplemented(
+          "Data type %s is not supported by shared memory allreduce.",
+          in_tensor.dtype()));
+  }
+}
+
+void ShmComm::Broadcast(phi::DenseTensor* out_tensor,
+                        const phi::DenseTensor& in_tensor,
+                        int root) {
+  const size_t bytes = in_tensor.numel() * phi::SizeOf(in_tensor.dtype());
+  const char* in = static_cast<const char*>(in_tensor.data());
+  char* out = static_cast<char*>(out_tensor->data());
+  for (size_t offset = 0; offset < bytes; offset += buffer_size_) {
+    const size_t size = std::min(buffer_size_, bytes - offset);
+    if (rank_ == root) {
+      std::memcpy(Buffer(root), in + offset, size);
+    }
+    Barrier();
+    if (out != in || rank_ != root) {
+      std::memcpy(out + offset, Buffer(root), size);
+    }
+    Barrier();
+  }
+}
+
+void ShmComm::AllGather(phi::DenseTensor* out_tensor,
+                        const phi::DenseTensor& in_tensor) {
+  const size_t bytes = in_tensor.numel() * phi::SizeOf(in_tensor.dtype());
+  const char* in = static_cast<const char*>(in_tensor.data());
+  char* out = static_cast<char*>(out_tensor->data());
+  for (size_t offset = 0; offset < bytes; offset += buffer_size_) {
+    const size_t size = std::min(buffer_size_, bytes - offset);
+    std::memcpy(Buffer(rank_), in + offset, size);
+    Barrier();
+    for (int i = 0; i < world_size_; ++i) {
+      std::memcpy(out + i * bytes + offset, Buffer(i), size);
+    }
+    Barrier();
+  }
+}
+
+}  // namespace distributed
+}  // namespace paddle
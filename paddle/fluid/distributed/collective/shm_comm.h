@@ -0,0 +1,105 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/distributed/store/store.h"
+#include "paddle/phi/core/distributed/types.h"
+
+namespace paddle {
+namespace distributed {
+
+using phi::distributed::ReduceOp;
+
+/**
+ * Collectives of a process group whose ranks are all on the same host. The
+ * ranks exchange data through a POSIX shared memory segment instead of the
+ * gloo tcp transport.
+ *
+ * The segment holds a flag and a buffer of FLAGS_gloo_shm_buffer_size bytes
+ * for every rank. Tensors are processed in segments that fit in the buffers,
+ * each segment in steps separated by barriers on the flags:
+ *   AllReduce: copy in; each rank reduces its 1/n part of the segment over
+ *              all buffers in place; copy all parts out.
+ *   Broadcast: the root copies in; the others copy out.
+ *   AllGather: copy in; copy all buffers out.
+ */
+class ShmComm {
+ public:
+  /**
+   * Meet the other ranks through the store and map a segment shared by all
+   * of them. Must be called by all ranks of the group. Returns nullptr on all
+   * ranks if any rank is on another host or fails to map the segment.
+   */
+  static std::unique_ptr<ShmComm> Create(
+      const std::shared_ptr<phi::distributed::Store>& store,
+      const std::string& prefix,
+      int rank,
+      int world_size);
+
+  ~ShmComm();
+
+  static bool CanAllReduce(phi::DataType dtype, ReduceOp reduce_op);
+
+  void AllReduce(phi::DenseTensor* out_tensor,
+                 const phi::DenseTensor& in_tensor,
+                 ReduceOp reduce_op);
+
+  void Broadcast(phi::DenseTensor* out_tensor,
+                 const phi::DenseTensor& in_tensor,
+                 int root);
+
+  void AllGather(phi::DenseTensor* out_tensor,
+                 const phi::DenseTensor& in_tensor);
+
+ private:
+  struct alignas(64) Flag {
+    std::atomic<uint64_t> value;
+  };
+
+  ShmComm(int rank,
+          int world_size,
+          void* segment,
+          size_t segment_size,
+          size_t buffer_size,
+          std::chrono::seconds timeout);
+
+  template <typename T>
+  void AllReduceImpl(T* out, const T* in, int64_t numel, ReduceOp reduce_op);
+
+  // Waits until all ranks have reached the same number of barriers.
+  void Barrier();
+
+  char* Buffer(int rank) const { return buffers_ + rank * buffer_size_; }
+
+  const int rank_;
+  const int world_size_;
+  void* segment_;
+  const size_t segment_size_;
+  const size_t buffer_size_;
+  const std::chrono::seconds timeout_;
+
+  Flag* flags_;
+  char* buffers_;
+  uint64_t barrier_count_{0};
+};
+
+}  // namespace distributed
+}  // namespace paddle
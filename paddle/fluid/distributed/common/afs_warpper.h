@@ -14,6 +14,9 @@
 
 #pragma once
 
+#include <sys/stat.h>
+
+#include <cstdio>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -70,6 +73,16 @@ class FsReadChannel {
     return fread(data, 1, size, _file.get());
   }
 
+  // The bytes left to read, or -1 if unknown, e.g. for a pipe.
+  inline int64_t remaining_size() {
+    struct stat st;
+    if (fstat(fileno(_file.get()), &st) != 0 || !S_ISREG(st.st_mode)) {
+      return -1;
+    }
+    int64_t offset = ftell(_file.get());
+    return offset < 0 ? -1 : st.st_size - offset;
+  }
+
  private:
   uint32_t _buffer_size;
   FsChannelConfig _config;
@@ -79,6 +79,25 @@ PD_DEFINE_int32(pserver_sparse_table_shard_num,
                 1000,
                 "sparse table shard for save & load");
 
+PD_DEFINE_int32(pserver_sparse_pull_cache_mb,
+                0,
+                "memory limit of the local cache of pulled sparse values per "
+                "table, 0 to disable the cache");
+
+PD_DEFINE_int32(pserver_sparse_pull_cache_admit_count,
+                2,
+                "misses of a key before its pulled value is cached");
+
+PD_DEFINE_int32(pserver_sparse_pull_cache_stale_steps,
+                10,
+                "pull_sparse steps a cached value is used before it is "
+                "pulled again, <= 0 for no limit");
+
+PD_DEFINE_int32(pserver_sparse_pull_cache_stale_ms,
+                10000,
+                "milliseconds a cached value is used before it is pulled "
+                "again, <= 0 for no limit");
+
 inline size_t get_sparse_shard(uint32_t shard_num,
                                uint32_t server_num,
                                uint64_t key) {
@@ -342,6 +361,18 @@ int32_t BrpcPsClient::Initialize() {
       _push_sparse_task_queue_map[table_id] =
           ::paddle::framework::MakeChannel<SparseAsyncTask *>();
       _push_sparse_merge_count_map[table_id] = 0;
+      if (FLAGS_pserver_sparse_pull_cache_mb > 0) {
+        SparsePullCache::Options options;
+        options.value_size =
+            GetTableAccessor(table_id)->GetAccessorInfo().select_size;
+        options.capacity_bytes =
+            static_cast<size_t>(FLAGS_pserver_sparse_pull_cache_mb) << 20;
+        options.admit_count = FLAGS_pserver_sparse_pull_cache_admit_count;
+        options.max_stale_steps = FLAGS_pserver_sparse_pull_cache_stale_steps;
+        options.max_stale_ms = FLAGS_pserver_sparse_pull_cache_stale_ms;
+        _sparse_pull_cache_map[table_id] =
+            std::make_shared<SparsePullCache>(options);
+      }
     }
   }
 
@@ -558,16 +589,19 @@ std::future<int32_t> BrpcPsClient::SendSaveCmd(
 
 std::future<int32_t> BrpcPsClient::Shrink(uint32_t table_id,
                                           const std::string threshold) {
+  ClearSparsePullCache(table_id);
   return SendCmd(table_id, PS_SHRINK_TABLE, {threshold});
 }
 
 std::future<int32_t> BrpcPsClient::Load(const std::string &epoch,
                                         const std::string &mode) {
+  ClearSparsePullCache(-1);
   return SendCmd(-1, PS_LOAD_ALL_TABLE, {epoch, mode});
 }
 std::future<int32_t> BrpcPsClient::Load(uint32_t table_id,
                                         const std::string &epoch,
                                         const std::string &mode) {
+  ClearSparsePullCache(table_id);
   return SendCmd(table_id, PS_LOAD_ONE_TABLE, {epoch, mode});
 }
 
@@ -665,13 +699,16 @@ std::future<int32_t> BrpcPsClient::GetCacheThreshold(uint32_t table_id,
 }
 
 std::future<int32_t> BrpcPsClient::Clear() {
+  ClearSparsePullCache(-1);
   return SendCmd(-1, PS_CLEAR_ALL_TABLE, {});
 }
 std::future<int32_t> BrpcPsClient::Clear(uint32_t table_id) {
+  ClearSparsePullCache(table_id);
   return SendCmd(table_id, PS_CLEAR_ONE_TABLE, {});
 }
 
 std::future<int32_t> BrpcPsClient::Revert() {
+  ClearSparsePullCache(-1);
   return SendCmd(-1, PS_REVERT, {});
 }
 
@@ -704,6 +741,14 @@ void BrpcPsClient::PrintQueueSize() {
             << " size: " << queue_size;
   }
 
+  for (auto &cache_itr : _sparse_pull_cache_map) {
+    auto &cache = cache_itr.second;
+    VLOG(0) << "BrpcPsClient::PrintQueueSize: table " << cache_itr.first
+            << " pull cache size: " << cache->Size()
+            << " hit: " << cache->HitCount()
+            << " miss: " << cache->MissCount();
+  }
+
   for (auto &task_queue_itr : _push_dense_task_queue_map) {
     auto table_id = task_queue_itr.first;
     auto queue_size = task_queue_itr.second->Size();
@@ -712,6 +757,26 @@ void BrpcPsClient::PrintQueueSize() {
   }
 }
 
+bool BrpcPsClient::GetSparsePullCacheStat(size_t table_id,
+                                          uint64_t *hit_count,
+                                          uint64_t *miss_count) {
+  auto cache = GetSparsePullCache(table_id);
+  if (cache == nullptr) {
+    return false;
+  }
+  *hit_count = cache->HitCount();
+  *miss_count = cache->MissCount();
+  return true;
+}
+
+void BrpcPsClient::ClearSparsePullCache(int table_id) {
+  for (auto &cache_itr : _sparse_pull_cache_map) {
+    if (table_id < 0 || cache_itr.first == static_cast<uint32_t>(table_id)) {
+      cache_itr.second->Clear();
+    }
+  }
+}
+
 void BrpcPsClient::PrintQueueSizeThread() {
   while (_running) {
     usleep(1000000 * 60 * 2);
@@ -1159,7 +1224,19 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
     }
   }
 
+  // The fresh cached values are copied out, only the others are pulled. A
+  // pull starts a step whatever API pushes the gradients, so the cached
+  // values age a step.
+  auto cache = GetSparsePullCache(table_id);
+  uint64_t cache_generation = 0;
+  if (cache != nullptr) {
+    cache->AdvanceStep();
+    cache_generation = cache->Generation();
+  }
   for (size_t i = 0; i < num; ++i) {
+    if (cache != nullptr && cache->Lookup(keys[i], select_values[i])) {
+      continue;
+    }
     size_t shard_id = get_sparse_shard(shard_num, request_call_num, keys[i]);
     shard_sorted_kvs->at(shard_id).push_back({keys[i], select_values[i]});
   }
@@ -1169,7 +1246,8 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
   size_t value_size = accessor->GetAccessorInfo().select_size;
 
   DownpourBrpcClosure *closure = new DownpourBrpcClosure(
-      request_call_num, [shard_sorted_kvs, value_size](void *done) {
+      request_call_num,
+      [shard_sorted_kvs, value_size, cache, cache_generation](void *done) {
         int ret = 0;
         auto *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
         for (size_t i = 0; i < shard_sorted_kvs->size(); ++i) {
@@ -1199,6 +1277,9 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
                 ret = -1;
                 break;
               }
+              if (cache != nullptr) {
+                cache->Insert(last_key, last_value_data, cache_generation);
+              }
             }
           }
         }
@@ -27,6 +27,7 @@
 #include "paddle/fluid/distributed/ps/service/brpc_utils.h"
 #include "paddle/fluid/distributed/ps/service/ps_client.h"
 #include "paddle/fluid/distributed/ps/service/sendrecv.pb.h"
+#include "paddle/fluid/distributed/ps/service/sparse_pull_cache.h"
 #include "paddle/fluid/framework/channel.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
@@ -318,6 +319,11 @@ class BrpcPsClient : public PSClient {
   void PrintQueueSize();
   void PrintQueueSizeThread();
 
+  // Returns false if the pull cache of the table is disabled.
+  bool GetSparsePullCacheStat(size_t table_id,
+                              uint64_t *hit_count,
+                              uint64_t *miss_count);
+
  protected:
   virtual size_t GetServerNums() { return _server_channels.size(); }
   inline brpc::Channel *GetSparseChannel(size_t server_id) {
@@ -353,6 +359,14 @@ class BrpcPsClient : public PSClient {
                                    int cmd_id,
                                    const std::vector<std::string> &param);
 
+  std::shared_ptr<SparsePullCache> GetSparsePullCache(size_t table_id) {
+    auto itr = _sparse_pull_cache_map.find(table_id);
+    return itr == _sparse_pull_cache_map.end() ? nullptr : itr->second;
+  }
+  // Drops the cached values of the table, or of all tables if table_id is
+  // -1, once the values on the servers are replaced.
+  void ClearSparsePullCache(int table_id);
+
   bool _running = false;
   bool _flushing = false;
   std::atomic<uint32_t> _async_call_num;  // 异步请求计数
@@ -368,6 +382,9 @@ class BrpcPsClient : public PSClient {
   std::unordered_map<uint32_t, paddle::framework::Channel<SparseAsyncTask *>>
       _push_sparse_task_queue_map;
   std::unordered_map<uint32_t, uint32_t> _push_sparse_merge_count_map;
+  // 训练侧缓存的热点 sparse 参数
+  std::unordered_map<uint32_t, std::shared_ptr<SparsePullCache>>
+      _sparse_pull_cache_map;
 
   std::thread _print_thread;
 
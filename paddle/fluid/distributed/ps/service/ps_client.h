@@ -180,6 +180,17 @@ class PSClient {
     promise.set_value(-1);
     return fut;
   }
+  // Hints the keys of shard_id the next pass will pull with PullSparsePtr,
+  // the clients without a local table ignore it.
+  virtual ::std::future<int32_t> PrefetchSparse(int shard_id UNUSED,
+                                                size_t table_id UNUSED,
+                                                const uint64_t *keys UNUSED,
+                                                size_t num UNUSED) {
+    std::promise<int32_t> promise;
+    std::future<int> fut = promise.get_future();
+    promise.set_value(0);
+    return fut;
+  }
 
   virtual std::future<int32_t> PrintTableStat(uint32_t table_id,
                                               uint16_t pass_id,
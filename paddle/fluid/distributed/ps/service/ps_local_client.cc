@@ -256,6 +256,14 @@ int32_t PsLocalClient::Initialize() {
   return done();
 }
 
+::std::future<int32_t> PsLocalClient::PrefetchSparse(int shard_id,
+                                                    size_t table_id,
+                                                    const uint64_t* keys,
+                                                    size_t num) {
+  GetTable(table_id)->PrefetchSparse(shard_id, keys, num);
+  return done();
+}
+
 ::std::future<int32_t> PsLocalClient::PrintTableStat(uint32_t table_id,
                                                      uint16_t pass_id,
                                                      size_t threshold) {
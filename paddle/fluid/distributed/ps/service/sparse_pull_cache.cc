@@ -0,0 +1,159 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/service/sparse_pull_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+
+namespace paddle::distributed {
+
+namespace {
+
+// The approximate bytes of the list node and the hash map node of an entry.
+constexpr size_t kEntryOverhead = 96;
+
+int64_t NowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+SparsePullCache::SparsePullCache(const Options &options) : _options(options) {
+  _options.shard_num = std::max<size_t>(_options.shard_num, 1);
+  _max_shard_entries = _options.capacity_bytes / _options.shard_num /
+                       (_options.value_size + kEntryOverhead);
+  for (size_t i = 0; i < _options.shard_num; ++i) {
+    _shards.emplace_back(std::make_unique<Shard>());
+  }
+}
+
+bool SparsePullCache::IsStale(const Entry &entry, int64_t now_ms) const {
+  if (_options.max_stale_steps > 0 &&
+      _step - entry.step >= _options.max_stale_steps) {
+    return true;
+  }
+  return _options.max_stale_ms > 0 &&
+         now_ms - entry.time_ms >= _options.max_stale_ms;
+}
+
+void SparsePullCache::CountMiss(Shard *shard, uint64_t key, uint32_t count) {
+  auto &miss_count = shard->miss_counts[key];
+  miss_count = std::max(miss_count + 1, count);
+  // Halve the counts once there are too many keys, so the keys missed once
+  // in a while do not pile up and the admission follows the recent misses.
+  if (shard->miss_counts.size() > 4 * _max_shard_entries + 1024) {
+    for (auto it = shard->miss_counts.begin();
+         it != shard->miss_counts.end();) {
+      it->second /= 2;
+      if (it->second == 0) {
+        it = shard->miss_counts.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+}
+
+bool SparsePullCache::Lookup(uint64_t key, float *value) {
+  auto &shard = GetShard(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.entries.find(key);
+  if (it != shard.entries.end()) {
+    auto entry = it->second;
+    if (!IsStale(*entry, NowMs())) {
+      memcpy(value, entry->value.get(), _options.value_size);
+      shard.lru.splice(shard.lru.begin(), shard.lru, entry);
+      ++_hit_count;
+      return true;
+    }
+    // A stale key is hot, so its refreshed value is admitted right away.
+    shard.lru.erase(entry);
+    shard.entries.erase(it);
+    CountMiss(&shard, key, _options.admit_count);
+  } else {
+    CountMiss(&shard, key, 0);
+  }
+  ++_miss_count;
+  return false;
+}
+
+void SparsePullCache::Insert(uint64_t key,
+                             const float *value,
+                             uint64_t generation) {
+  if (_max_shard_entries == 0) {
+    return;
+  }
+  auto &shard = GetShard(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  // Clear bumps the generation before it clears the shards, so a value of
+  // an older generation is either dropped here or cleared after.
+  if (generation != _generation) {
+    return;
+  }
+  auto it = shard.entries.find(key);
+  if (it != shard.entries.end()) {
+    // Another pull of the key refreshed it first.
+    memcpy(it->second->value.get(), value, _options.value_size);
+    it->second->step = _step;
+    it->second->time_ms = NowMs();
+    return;
+  }
+  auto count_it = shard.miss_counts.find(key);
+  if (count_it == shard.miss_counts.end() ||
+      count_it->second < _options.admit_count) {
+    return;
+  }
+  shard.miss_counts.erase(count_it);
+
+  if (shard.entries.size() >= _max_shard_entries) {
+    // Reuse the buffer of the least recently used entry.
+    shard.entries.erase(shard.lru.back().key);
+    shard.lru.splice(shard.lru.begin(), shard.lru, std::prev(shard.lru.end()));
+  } else {
+    shard.lru.push_front(
+        {0, 0, 0, std::make_unique<char[]>(_options.value_size)});
+  }
+  auto &entry = shard.lru.front();
+  entry.key = key;
+  entry.step = _step;
+  entry.time_ms = NowMs();
+  memcpy(entry.value.get(), value, _options.value_size);
+  shard.entries[key] = shard.lru.begin();
+}
+
+void SparsePullCache::Clear() {
+  ++_generation;
+  for (auto &shard : _shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    shard->lru.clear();
+    shard->entries.clear();
+    shard->miss_counts.clear();
+  }
+}
+
+size_t SparsePullCache::Size() {
+  size_t size = 0;
+  for (auto &shard : _shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    size += shard->entries.size();
+  }
+  return size;
+}
+
+}  // namespace paddle::distributed
@@ -0,0 +1,103 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace paddle {
+namespace distributed {
+
+// Trainer side cache of the pulled values of one sparse table. A key is
+// admitted after it is missed admit_count times, and its value is served
+// until it is max_stale_steps steps or max_stale_ms milliseconds old, so the
+// hot keys of a skewed workload are pulled from the servers once every few
+// steps instead of every step. The least recently used values are evicted
+// to keep the cache within capacity_bytes.
+//
+// Every Clear starts a new generation. A pull takes the generation before
+// sending its requests and passes it to Insert, so the values of a pull in
+// flight across a Clear, which may predate a load of the table, are dropped.
+class SparsePullCache {
+ public:
+  struct Options {
+    size_t value_size = 0;  // bytes of a pulled value
+    size_t capacity_bytes = 0;
+    size_t shard_num = 16;
+    uint32_t admit_count = 2;
+    int64_t max_stale_steps = 10;  // no limit if <= 0
+    int64_t max_stale_ms = 10000;  // no limit if <= 0
+  };
+
+  explicit SparsePullCache(const Options &options);
+
+  // Copies the fresh value of key to value and returns true, or counts a
+  // miss of key and returns false.
+  bool Lookup(uint64_t key, float *value);
+
+  // Caches the value pulled from the servers if key is admitted and no
+  // Clear happened since the pull took generation.
+  void Insert(uint64_t key, const float *value, uint64_t generation);
+
+  // Ages all the cached values by one step, called once a pull.
+  void AdvanceStep() { ++_step; }
+
+  uint64_t Generation() const { return _generation; }
+
+  void Clear();
+
+  size_t Size();
+  uint64_t HitCount() const { return _hit_count; }
+  uint64_t MissCount() const { return _miss_count; }
+
+ private:
+  struct Entry {
+    uint64_t key;
+    int64_t step;
+    int64_t time_ms;
+    std::unique_ptr<char[]> value;
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    // The front is the most recently used.
+    std::list<Entry> lru;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> entries;
+    // The miss counts of the keys not cached yet.
+    std::unordered_map<uint64_t, uint32_t> miss_counts;
+  };
+
+  Shard &GetShard(uint64_t key) {
+    return *_shards[(key ^ (key >> 32)) % _shards.size()];
+  }
+  bool IsStale(const Entry &entry, int64_t now_ms) const;
+  void CountMiss(Shard *shard, uint64_t key, uint32_t count);
+
+  Options _options;
+  size_t _max_shard_entries;
+  std::vector<std::unique_ptr<Shard>> _shards;
+  std::atomic<int64_t> _step{0};
+  std::atomic<uint64_t> _generation{0};
+  std::atomic<uint64_t> _hit_count{0};
+  std::atomic<uint64_t> _miss_count{0};
+};
+
+}  // namespace distributed
+}  // namespace paddle
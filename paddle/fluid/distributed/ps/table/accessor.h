@@ -94,6 +94,14 @@ class ValueAccessor {
 
   virtual bool NeedExtendMF(float* value UNUSED) { return false; }
   virtual bool HasMF(size_t size UNUSED) { return false; }
+  // embedx weights of value are [offset, offset + dim), used to store them in
+  // low precision, returns false if value has no embedx weights
+  virtual bool EmbedxWRange(const float* value UNUSED,
+                            size_t size UNUSED,
+                            size_t* offset UNUSED,
+                            size_t* dim UNUSED) {
+    return false;
+  }
   // converter for save
   virtual std::string GetConverter(int param) {
     auto itr = _data_converter_map.find(param);
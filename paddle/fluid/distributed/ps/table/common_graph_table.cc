@@ -1612,6 +1612,9 @@ void GraphTable::stat_graph_edge_info(int type) {
 #endif  // PADDLE_WITH_HETERPS
 
 void GraphTable::clear_graph(int idx) {
+  if (static_cast<size_t>(idx) < frozen_edge_shards_.size()) {
+    frozen_edge_shards_[idx].clear();
+  }
   for (auto p : edge_shards[idx]) {
     p->clear();
     delete p;
@@ -1625,6 +1628,7 @@ void GraphTable::clear_graph(int idx) {
 
 void GraphTable::clear_edge_shard() {
   VLOG(0) << "begin clear edge shard";
+  frozen_edge_shards_.clear();
   std::vector<std::future<int>> tasks;
   for (auto &type_shards : edge_shards) {
     for (auto &shard : type_shards) {
@@ -1846,6 +1850,7 @@ GraphTable::~GraphTable() {  // NOLINT
 int32_t GraphTable::Load(const std::string &path, const std::string &param) {
   bool load_edge = (param[0] == 'e');
   bool load_node = (param[0] == 'n');
+  bool load_frozen_edge = (param[0] == 'f');
   if (load_edge) {
     bool reverse_edge = (param[1] == '<');
     std::string edge_type = param.substr(2);
@@ -1865,6 +1870,31 @@ int32_t GraphTable::Load(const std::string &path, const std::string &param) {
       return -1;
     }
   }
+  if (load_frozen_edge) {
+    std::string edge_type = param.substr(1);
+    auto iter = edge_to_id.find(edge_type);
+    if (iter == edge_to_id.end() ||
+        this->load_frozen_edge_shards(iter->second,
+                                      path + "/" + edge_type) != 0) {
+      VLOG(0) << "Fail to load frozen edges, path[" << path << "] edge_type["
+              << edge_type << "]";
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int32_t GraphTable::Save(const std::string &path,
+                         const std::string &converter UNUSED) {
+  for (size_t idx = 0; idx < frozen_edge_shards_.size(); idx++) {
+    if (frozen_edge_shards_[idx].empty()) continue;
+    std::string edge_path = path + "/" + id_to_edge[idx];
+    ::paddle::framework::localfs_mkdir(edge_path);
+    if (save_frozen_edge_shards(static_cast<int>(idx), edge_path) != 0) {
+      VLOG(0) << "Fail to save frozen edges, path[" << edge_path << "]";
+      return -1;
+    }
+  }
   return 0;
 }
 
@@ -2493,6 +2523,12 @@ int32_t GraphTable::load_nodes(const std::string &path,
 }
 
 int32_t GraphTable::build_sampler(int idx, std::string sample_type) {
+  if (sample_type == "weighted" &&
+      static_cast<size_t>(idx) < frozen_edge_shards_.size()) {
+    for (auto &frozen_shard : frozen_edge_shards_[idx]) {
+      frozen_shard->build_alias_tables();
+    }
+  }
   for (auto &shard : edge_shards[idx]) {
     auto bucket = shard->get_bucket();
     for (auto item : bucket) {
@@ -2502,6 +2538,99 @@ int32_t GraphTable::build_sampler(int idx, std::string sample_type) {
   return 0;
 }
 
+int32_t GraphTable::freeze_edge_shards(int idx, bool release_nodes) {
+  if (frozen_edge_shards_.size() < edge_shards.size()) {
+    frozen_edge_shards_.resize(edge_shards.size());
+  }
+  auto &shards = edge_shards[idx];
+  auto &frozen_shards = frozen_edge_shards_[idx];
+  frozen_shards.resize(shards.size());
+  std::vector<std::future<size_t>> tasks;
+  for (size_t i = 0; i < shards.size(); i++) {
+    tasks.push_back(_shards_task_pool[i % task_pool_size_]->enqueue(
+        [&, i, release_nodes]() -> size_t {
+          auto frozen_shard = std::make_unique<GraphCsrShard>();
+          frozen_shard->build(
+              shards[i]->get_bucket(), is_weighted_, frozen_shards[i].get());
+          if (release_nodes) {
+            shards[i]->clear();
+          }
+          frozen_shards[i] = std::move(frozen_shard);
+          return frozen_shards[i]->memory_size();
+        }));
+  }
+  size_t memory_size = 0;
+  for (auto &task : tasks) {
+    memory_size += task.get();
+  }
+  VLOG(0) << "freeze edge shards of idx[" << idx << "], memory size "
+          << memory_size << " bytes";
+  return 0;
+}
+
+int32_t GraphTable::save_frozen_edge_shards(int idx, const std::string &path) {
+  if (static_cast<size_t>(idx) >= frozen_edge_shards_.size() ||
+      frozen_edge_shards_[idx].empty()) {
+    VLOG(0) << "edge shards of idx[" << idx << "] are not frozen";
+    return -1;
+  }
+  auto &frozen_shards = frozen_edge_shards_[idx];
+  std::vector<std::future<int32_t>> tasks;
+  for (size_t i = 0; i < frozen_shards.size(); i++) {
+    tasks.push_back(_shards_task_pool[i % task_pool_size_]->enqueue(
+        [&, i]() -> int32_t {
+          return frozen_shards[i]->save(paddle::string::format_string(
+              "%s/part-%05d",
+              path.c_str(),
+              static_cast<int>(shard_start + i)));
+        }));
+  }
+  int32_t ret = 0;
+  for (auto &task : tasks) {
+    if (task.get() != 0) ret = -1;
+  }
+  return ret;
+}
+
+int32_t GraphTable::load_frozen_edge_shards(int idx, const std::string &path) {
+  if (frozen_edge_shards_.size() < edge_shards.size()) {
+    frozen_edge_shards_.resize(edge_shards.size());
+  }
+  auto &frozen_shards = frozen_edge_shards_[idx];
+  frozen_shards.resize(shard_num_per_server);
+  std::vector<std::future<int32_t>> tasks;
+  for (size_t i = 0; i < frozen_shards.size(); i++) {
+    tasks.push_back(_shards_task_pool[i % task_pool_size_]->enqueue(
+        [&, i]() -> int32_t {
+          frozen_shards[i] = std::make_unique<GraphCsrShard>();
+          return frozen_shards[i]->load(paddle::string::format_string(
+              "%s/part-%05d",
+              path.c_str(),
+              static_cast<int>(shard_start + i)));
+        }));
+  }
+  int32_t ret = 0;
+  for (auto &task : tasks) {
+    if (task.get() != 0) ret = -1;
+  }
+  if (ret != 0) {
+    frozen_shards.clear();
+  }
+  return ret;
+}
+
+const GraphCsrShard *GraphTable::find_frozen_edge_shard(int idx, uint64_t id) {
+  if (static_cast<size_t>(idx) >= frozen_edge_shards_.size() ||
+      frozen_edge_shards_[idx].empty()) {
+    return nullptr;
+  }
+  size_t shard_id = id % shard_num;
+  if (shard_id >= shard_end || shard_id < shard_start) {
+    return nullptr;
+  }
+  return frozen_edge_shards_[idx][shard_id - shard_start].get();
+}
+
 std::pair<uint64_t, uint64_t> GraphTable::parse_edge_file(
     const std::string &path, int idx, bool reverse, bool use_weight) {
   is_weighted_ = use_weight;
@@ -2646,7 +2775,10 @@ std::pair<uint64_t, uint64_t> GraphTable::load_edges(
   }
 #endif
 
-  if (!build_sampler_on_cpu) {
+  if (freeze_edges_) {
+    // The frozen shards are sampled without the samplers of the nodes.
+    freeze_edge_shards(idx, true);
+  } else if (!build_sampler_on_cpu) {
     // To reduce memory overhead, CPU samplers won't be created in gpugraph.
     // In order not to affect the sampler function of other scenario,
     // this optimization is only performed in load_edges function.
@@ -2827,6 +2959,8 @@ int32_t GraphTable::random_sample_neighbors(
       std::vector<SampleResult> sample_res;
       std::vector<SampleKey> sample_keys;
       auto &rng = _shards_task_rng_pool[i];
+      std::vector<uint64_t> frozen_ids;
+      std::vector<float> frozen_weights;
       for (size_t k = 0; k < id_list[i].size(); k++) {
         if (index < r.size() &&
             r[index].first.node_key == id_list[i][k].node_key) {
@@ -2836,9 +2970,51 @@ int32_t GraphTable::random_sample_neighbors(
           index++;
         } else {
           node_id = id_list[i][k].node_key;
-          Node *node = find_node(GraphTableType::EDGE_TABLE, idx, node_id);
           int idy = seq_id[i][k];
           int &actual_size = actual_sizes[idy];
+          const GraphCsrShard *frozen_shard =
+              find_frozen_edge_shard(idx, node_id);
+          if (frozen_shard != nullptr) {
+            int64_t frozen_index = frozen_shard->find(node_id);
+            int sample_num = 0;
+            if (frozen_index >= 0) {
+              frozen_ids.resize(sample_size);
+              frozen_weights.resize(sample_size);
+              sample_num = frozen_shard->sample_k(frozen_index,
+                                                  sample_size,
+                                                  rng.get(),
+                                                  frozen_ids.data(),
+                                                  frozen_weights.data());
+            }
+            actual_size =
+                sample_num * (need_weight ? (Node::id_size + Node::weight_size)
+                                          : Node::id_size);
+            if (actual_size == 0) continue;
+            char *buffer_addr = new char[actual_size];
+            if (response == LRUResponse::ok) {
+              sample_keys.emplace_back(idx, node_id, sample_size, need_weight);
+              sample_res.emplace_back(actual_size, buffer_addr);
+              buffers[idy] = sample_res.back().buffer;
+            } else {
+              buffers[idy].reset(buffer_addr, char_del);
+            }
+            for (int x = 0; x < sample_num; x++) {
+              memcpy(buffer_addr, &frozen_ids[x], Node::id_size);
+              buffer_addr += Node::id_size;
+              if (need_weight) {
+                // The same weights as from the nodes below.
+#if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
+                float weight = frozen_weights[x];
+#else
+                float weight = 1.0;
+#endif
+                memcpy(buffer_addr, &weight, Node::weight_size);
+                buffer_addr += Node::weight_size;
+              }
+            }
+            continue;
+          }
+          Node *node = find_node(GraphTableType::EDGE_TABLE, idx, node_id);
           if (node == nullptr) {
 #ifdef PADDLE_WITH_HETERPS
             if (search_level == 2) {
@@ -3444,6 +3620,7 @@ void GraphTable::load_node_weight(int type_id, int idx, std::string path) {
 int32_t GraphTable::Initialize(const GraphParameter &graph) {
   task_pool_size_ = graph.task_pool_size();
   build_sampler_on_cpu = graph.build_sampler_on_cpu();
+  freeze_edges_ = graph.freeze_edges();
 
 #ifdef PADDLE_WITH_HETERPS
   _db = NULL;
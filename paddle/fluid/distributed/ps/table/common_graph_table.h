@@ -42,6 +42,7 @@
 #include "paddle/fluid/distributed/ps/table/accessor.h"
 #include "paddle/fluid/distributed/ps/table/common_table.h"
 #include "paddle/fluid/distributed/ps/table/graph/class_macro.h"
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr_shard.h"
 #include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
 #include "paddle/fluid/distributed/ps/thirdparty/round_robin.h"
 #include "paddle/phi/core/utils/rw_lock.h"
@@ -651,10 +652,10 @@ class GraphTable : public Table {
   virtual int32_t Flush() { return 0; }
   virtual int32_t Shrink(const std::string &param UNUSED) { return 0; }
   // 指定保存路径
-  virtual int32_t Save(const std::string &path UNUSED,
-                       const std::string &converter UNUSED) {
-    return 0;
-  }
+  // Saves the frozen edge shards of each edge type to the local directory
+  // path/<edge_type>, which Load reads back with the param "f<edge_type>".
+  virtual int32_t Save(const std::string &path,
+                       const std::string &converter UNUSED);
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
   virtual int32_t Save_v2(const std::string &path,
                           const std::string &converter) {
@@ -770,6 +771,17 @@ class GraphTable : public Table {
 #endif
   virtual int32_t add_comm_edge(int idx, uint64_t src_id, uint64_t dst_id);
   virtual int32_t build_sampler(int idx, std::string sample_type = "random");
+  // Packs the edge shards of idx into GraphCsrShard, which are used by
+  // random_sample_neighbors instead of the nodes. Edges already frozen are
+  // kept. release_nodes frees the nodes of the edge shards, after which the
+  // other apis see no edges of idx. load_edges calls it with release_nodes
+  // if freeze_edges is set in the GraphParameter.
+  int32_t freeze_edge_shards(int idx, bool release_nodes);
+  // Saves or loads the frozen edge shards of idx as one file per shard in
+  // the directory path.
+  int32_t save_frozen_edge_shards(int idx, const std::string &path);
+  int32_t load_frozen_edge_shards(int idx, const std::string &path);
+  const GraphCsrShard *find_frozen_edge_shard(int idx, uint64_t id);
   void set_slot_feature_separator(const std::string &ch);
   void set_feature_separator(const std::string &ch);
 
@@ -800,6 +812,8 @@ class GraphTable : public Table {
   int task_pool_size_ = 64;
   int load_thread_num_ = 160;
   std::vector<std::vector<std::vector<uint64_t>>> edge_shards_keys_;
+  // Empty for the edge types that are not frozen.
+  std::vector<std::vector<std::unique_ptr<GraphCsrShard>>> frozen_edge_shards_;
 
   const int random_sample_nodes_ranges = 3;
 
@@ -834,6 +848,7 @@ class GraphTable : public Table {
   int cache_ttl;
   mutable std::mutex mutex_;
   bool build_sampler_on_cpu;
+  bool freeze_edges_ = false;
   bool is_load_reverse_edge = false;
   std::shared_ptr<pthread_rwlock_t> rw_lock;
 #ifdef PADDLE_WITH_HETERPS
@@ -199,6 +199,18 @@ bool CtrCommonAccessor::HasMF(int size) {
   return size > common_feature_value.EmbedxG2SumIndex();
 }
 
+bool CtrCommonAccessor::EmbedxWRange(const float* value,
+                                     size_t size,
+                                     size_t* offset,
+                                     size_t* dim) {
+  if (size < static_cast<size_t>(common_feature_value.Dim())) {
+    return false;
+  }
+  *offset = common_feature_value.EmbedxWIndex();
+  *dim = common_feature_value.embedx_dim;
+  return true;
+}
+
 // from CommonFeatureValue to CtrCommonPullValue
 int32_t CtrCommonAccessor::Select(float** select_values,
                                   const float** values,
@@ -246,6 +258,17 @@ int32_t CtrCommonAccessor::Merge(float** update_values,
 int32_t CtrCommonAccessor::Update(float** update_values,
                                   const float** push_values,
                                   size_t num) {
+  // the rows are gathered for the sgd rules to update them in a batch
+  thread_local std::vector<float*> embed_w, embed_g2sum, embedx_w, embedx_g2sum;
+  thread_local std::vector<const float*> embed_g, embedx_g;
+  thread_local std::vector<float> scales;
+  embed_w.resize(num);
+  embed_g2sum.resize(num);
+  embedx_w.resize(num);
+  embedx_g2sum.resize(num);
+  embed_g.resize(num);
+  embedx_g.resize(num);
+  scales.resize(num);
   for (size_t value_item = 0; value_item < num; ++value_item) {
     float* update_value = update_values[value_item];
     const float* push_value = push_values[value_item];
@@ -265,17 +288,23 @@ int32_t CtrCommonAccessor::Update(float** update_values,
     }
     VLOG(3) << "accessor show scale:" << _show_scale
             << ", push_show:" << push_show;
-    _embed_sgd_rule->UpdateValue(
-        update_value + common_feature_value.EmbedWIndex(),
-        update_value + common_feature_value.EmbedG2SumIndex(),
-        push_value + CtrCommonPushValue::EmbedGIndex(),
-        push_show);
-    _embedx_sgd_rule->UpdateValue(
-        update_value + common_feature_value.EmbedxWIndex(),
-        update_value + common_feature_value.EmbedxG2SumIndex(),
-        push_value + CtrCommonPushValue::EmbedxGIndex(),
-        push_show);
+    embed_w[value_item] = update_value + common_feature_value.EmbedWIndex();
+    embed_g2sum[value_item] =
+        update_value + common_feature_value.EmbedG2SumIndex();
+    embed_g[value_item] = push_value + CtrCommonPushValue::EmbedGIndex();
+    embedx_w[value_item] = update_value + common_feature_value.EmbedxWIndex();
+    embedx_g2sum[value_item] =
+        update_value + common_feature_value.EmbedxG2SumIndex();
+    embedx_g[value_item] = push_value + CtrCommonPushValue::EmbedxGIndex();
+    scales[value_item] = push_show;
   }
+  _embed_sgd_rule->UpdateValueBatch(
+      embed_w.data(), embed_g2sum.data(), embed_g.data(), scales.data(), num);
+  _embedx_sgd_rule->UpdateValueBatch(embedx_w.data(),
+                                     embedx_g2sum.data(),
+                                     embedx_g.data(),
+                                     scales.data(),
+                                     num);
   return 0;
 }
 
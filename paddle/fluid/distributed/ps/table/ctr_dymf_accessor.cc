@@ -269,6 +269,24 @@ bool CtrDymfAccessor::HasMF(int size) {
   return size > common_feature_value.EmbedxG2SumIndex();
 }
 
+// embedx_w is at the end of the value, and its dim is mf_dim
+bool CtrDymfAccessor::EmbedxWRange(const float* value,
+                                   size_t size,
+                                   size_t* offset,
+                                   size_t* dim) {
+  if (size <= static_cast<size_t>(common_feature_value.EmbedxG2SumIndex())) {
+    return false;
+  }
+  auto mf_dim = static_cast<size_t>(
+      common_feature_value.MfDim(const_cast<float*>(value)));
+  if (mf_dim == 0 || mf_dim > size) {
+    return false;
+  }
+  *offset = size - mf_dim;
+  *dim = mf_dim;
+  return true;
+}
+
 // from CommonFeatureValue to CtrDymfPullValue
 int32_t CtrDymfAccessor::Select(float** select_values,
                                 const float** values,
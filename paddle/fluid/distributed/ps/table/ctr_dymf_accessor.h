@@ -203,6 +203,10 @@ class CtrDymfAccessor : public ValueAccessor {
   // virtual bool save_ssd(float* value);
   virtual bool NeedExtendMF(float* value);
   virtual bool HasMF(int size);
+  bool EmbedxWRange(const float* value,
+                    size_t size,
+                    size_t* offset,
+                    size_t* dim) override;
   // 判断该value是否在save阶段dump,
   // param作为参数用于标识save阶段，如downpour的xbox与batch_model
   // param = 0, save all feature
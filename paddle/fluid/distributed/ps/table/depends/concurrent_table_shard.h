@@ -0,0 +1,403 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>         // NOLINT
+#include <shared_mutex>  // NOLINT
+#include <thread>        // NOLINT
+#include <utility>
+
+#include "paddle/fluid/distributed/common/chunk_allocator.h"
+
+namespace paddle {
+namespace distributed {
+
+// A small spin lock guarding a value of ConcurrentSparseTableShard.
+class ShardValueLock {
+ public:
+  void lock() {
+    while (_locked.exchange(true, std::memory_order_acquire)) {
+      while (_locked.load(std::memory_order_relaxed)) {
+        std::this_thread::yield();
+      }
+    }
+  }
+  void unlock() { _locked.store(false, std::memory_order_release); }
+
+ private:
+  std::atomic<bool> _locked{false};
+};
+
+// ConcurrentSparseTableShard is an open addressing hash map with the same
+// interface as SparseTableShard, on which find/operator[]/emplace can be
+// called by many threads at the same time.
+//
+// Slots are organized in groups of 16, each slot has a one byte control tag
+// holding 7 bits of the key hash, so that a probe compares the tags of a whole
+// group with one SIMD instruction. An insertion claims an empty slot by CAS on
+// its tag and publishes the key and value before the tag, and lookups wait on
+// claimed slots, so that a key is never inserted twice. Growing the map takes
+// an exclusive lock, all other accesses to the slots hold it shared.
+//
+// Iterators are invalidated when the map grows, but values are allocated
+// separately and never move, so callers keep value_ptr() instead. The map does
+// not guard the content of values: callers hold ValueLock(key) while reading
+// or updating a value which may be updated concurrently. erase/clear and
+// iteration must not run concurrently with other accesses.
+template <class KEY, class VALUE>
+struct alignas(64) ConcurrentSparseTableShard {
+ public:
+  static constexpr bool kConcurrent = true;
+  static constexpr size_t kGroupSize = 16;
+  static constexpr size_t kValueLockNum = 256;
+
+ private:
+  static constexpr uint8_t kEmpty = 0x80;
+  static constexpr uint8_t kDeleted = 0xFE;
+  static constexpr uint8_t kBusy = 0xFF;
+  static constexpr size_t kNotFound = static_cast<size_t>(-1);
+
+  struct Slots {
+    explicit Slots(size_t group_num)
+        : capacity(group_num * kGroupSize),
+          group_mask(group_num - 1),
+          tags(new std::atomic<uint8_t>[capacity]),
+          keys(new KEY[capacity]),
+          values(new VALUE*[capacity]) {
+      for (size_t i = 0; i < capacity; ++i) {
+        tags[i].store(kEmpty, std::memory_order_relaxed);
+      }
+    }
+    size_t capacity;
+    size_t group_mask;
+    std::unique_ptr<std::atomic<uint8_t>[]> tags;
+    std::unique_ptr<KEY[]> keys;
+    std::unique_ptr<VALUE*[]> values;
+  };
+
+ public:
+  // The key and the value pointer are copied into the iterator, so that an
+  // iterator returned by find/emplace stays usable after the map grows, but
+  // only iteration over a map that is not modified may advance it.
+  struct iterator {
+    iterator() {}
+    iterator(Slots* slots, size_t slot) : slots(slots), slot(slot) { Load(); }
+    friend bool operator==(const iterator& a, const iterator& b) {
+      return a.slot == b.slot;
+    }
+    friend bool operator!=(const iterator& a, const iterator& b) {
+      return a.slot != b.slot;
+    }
+    const KEY& key() const { return cur_key; }
+    VALUE& value() const { return *cur_value; }
+    VALUE* value_ptr() const { return cur_value; }
+    iterator& operator++() {
+      slot = NextFull(slots, slot + 1);
+      Load();
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator ret = *this;
+      ++*this;
+      return ret;
+    }
+
+    Slots* slots = nullptr;
+    size_t slot = 0;
+
+   private:
+    void Load() {
+      if (slot < slots->capacity) {
+        cur_key = slots->keys[slot];
+        cur_value = slots->values[slot];
+      }
+    }
+    KEY cur_key{};
+    VALUE* cur_value = nullptr;
+  };
+
+  ConcurrentSparseTableShard() : _slots(new Slots(1)) {}
+  ~ConcurrentSparseTableShard() { clear(); }
+  ConcurrentSparseTableShard(const ConcurrentSparseTableShard&) = delete;
+
+  bool empty() { return size() == 0; }
+  size_t size() { return _size.load(std::memory_order_relaxed); }
+
+  iterator begin() {
+    return {_slots.get(), NextFull(_slots.get(), 0)};
+  }
+  iterator end() { return {_slots.get(), kNotFound}; }
+
+  iterator find(const KEY& key) {
+    size_t hash = Hash(key);
+    std::shared_lock<std::shared_mutex> guard(_resize_mutex);
+    return {_slots.get(), Lookup(_slots.get(), key, hash)};
+  }
+
+  VALUE& operator[](const KEY& key) { return emplace(key).first.value(); }
+  std::pair<iterator, bool> insert(const KEY& key, const VALUE& val) {
+    return emplace(key, val);
+  }
+  std::pair<iterator, bool> insert(const KEY& key, VALUE&& val) {
+    return emplace(key, std::move(val));
+  }
+  template <class... ARGS>
+  std::pair<iterator, bool> emplace(const KEY& key, ARGS&&... args) {
+    size_t hash = Hash(key);
+    while (true) {
+      std::pair<iterator, bool> ret;
+      int status = 0;
+      bool need_grow = false;
+      {
+        std::shared_lock<std::shared_mutex> guard(_resize_mutex);
+        Slots* slots = _slots.get();
+        size_t slot = kNotFound;
+        status = LookupOrClaim(
+            slots, key, hash, &slot, std::forward<ARGS>(args)...);
+        ret = {{slots, slot}, status == 1};
+        if (status == 1) {
+          _size.fetch_add(1, std::memory_order_relaxed);
+          size_t used = _used.fetch_add(1, std::memory_order_relaxed) + 1;
+          need_grow = used * 8 > slots->capacity * 7;
+        }
+      }
+      if (status < 0) {
+        // filled up by concurrent insertions before any of them grew it
+        Grow(true);
+        continue;
+      }
+      if (need_grow) {
+        Grow(false);
+        // the slots are rebuilt, find the key again
+        ret.first = find(key);
+      }
+      return ret;
+    }
+  }
+
+  iterator erase(iterator it) {
+    EraseSlot(it.slot);
+    return {_slots.get(), NextFull(_slots.get(), it.slot + 1)};
+  }
+  void quick_erase(iterator it) { EraseSlot(it.slot); }
+  size_t erase(const KEY& key) {
+    auto it = find(key);
+    if (it == end()) {
+      return 0;
+    }
+    quick_erase(it);
+    return 1;
+  }
+  void clear() {
+    std::unique_lock<std::shared_mutex> guard(_resize_mutex);
+    Slots* slots = _slots.get();
+    for (size_t i = 0; i < slots->capacity; ++i) {
+      if (IsFull(slots->tags[i].load(std::memory_order_relaxed))) {
+        ReleaseValue(slots->values[i]);
+      }
+    }
+    _slots.reset(new Slots(1));
+    _size.store(0, std::memory_order_relaxed);
+    _used.store(0, std::memory_order_relaxed);
+  }
+
+  ShardValueLock& ValueLock(const KEY& key) {
+    return _value_locks[Hash(key) % kValueLockNum];
+  }
+
+ private:
+  static bool IsFull(uint8_t tag) { return (tag & 0x80) == 0; }
+
+  static size_t Hash(const KEY& key) {
+    // std::hash of integers is the identity, mix the bits like murmur3 so
+    // that both the group index and the tag are well distributed.
+    uint64_t h = static_cast<uint64_t>(std::hash<KEY>()(key));
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return static_cast<size_t>(h);
+  }
+  static uint8_t Tag(size_t hash) { return hash >> (sizeof(size_t) * 8 - 7); }
+
+  // bit i is set if the tag of slot i of the group equals `tag`
+  static uint32_t MatchGroup(const std::atomic<uint8_t>* group, uint8_t tag) {
+#if defined(__SSE2__)
+    __m128i tags =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));  // NOLINT
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(tags, _mm_set1_epi8(tag))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kGroupSize; ++i) {
+      if (group[i].load(std::memory_order_acquire) == tag) {
+        mask |= 1u << i;
+      }
+    }
+    return mask;
+#endif
+  }
+
+  // the first full slot from `slot` on, or kNotFound
+  static size_t NextFull(Slots* slots, size_t slot) {
+    for (; slot < slots->capacity; ++slot) {
+      if (IsFull(slots->tags[slot].load(std::memory_order_relaxed))) {
+        return slot;
+      }
+    }
+    return kNotFound;
+  }
+
+  // Waits for a claimed slot to be published, returns its tag.
+  static uint8_t LoadTag(Slots* slots, size_t slot) {
+    uint8_t tag = slots->tags[slot].load(std::memory_order_acquire);
+    while (tag == kBusy) {
+      std::this_thread::yield();
+      tag = slots->tags[slot].load(std::memory_order_acquire);
+    }
+    return tag;
+  }
+
+  size_t Lookup(Slots* slots, const KEY& key, size_t hash) {
+    uint8_t tag = Tag(hash);
+    size_t group = hash & slots->group_mask;
+    for (size_t probe = 1; probe <= slots->group_mask + 1; ++probe) {
+      const std::atomic<uint8_t>* tags = &slots->tags[group * kGroupSize];
+      uint32_t match = MatchGroup(tags, tag) | MatchGroup(tags, kBusy);
+      while (match != 0) {
+        size_t i = __builtin_ctz(match);
+        match &= match - 1;
+        size_t slot = group * kGroupSize + i;
+        if (LoadTag(slots, slot) == tag && slots->keys[slot] == key) {
+          return slot;
+        }
+      }
+      if (MatchGroup(tags, kEmpty) != 0) {
+        return kNotFound;
+      }
+      group = (group + probe) & slots->group_mask;
+    }
+    return kNotFound;
+  }
+
+  // Returns 1 if the key is inserted into *slot, 0 if it exists, and -1 if
+  // there is no empty slot left.
+  template <class... ARGS>
+  int LookupOrClaim(
+      Slots* slots, const KEY& key, size_t hash, size_t* slot, ARGS&&... args) {
+    uint8_t tag = Tag(hash);
+    size_t group = hash & slots->group_mask;
+    for (size_t probe = 1; probe <= slots->group_mask + 1; ++probe) {
+      for (size_t i = 0; i < kGroupSize; ++i) {
+        size_t cur = group * kGroupSize + i;
+        uint8_t cur_tag = LoadTag(slots, cur);
+        while (cur_tag == kEmpty) {
+          if (slots->tags[cur].compare_exchange_weak(
+                  cur_tag, kBusy, std::memory_order_acq_rel)) {
+            slots->keys[cur] = key;
+            slots->values[cur] = AcquireValue(std::forward<ARGS>(args)...);
+            slots->tags[cur].store(tag, std::memory_order_release);
+            *slot = cur;
+            return 1;
+          }
+          // lost the race, wait for the winner to publish the slot
+          cur_tag = LoadTag(slots, cur);
+        }
+        if (cur_tag == tag && slots->keys[cur] == key) {
+          *slot = cur;
+          return 0;
+        }
+      }
+      group = (group + probe) & slots->group_mask;
+    }
+    return -1;
+  }
+
+  void Grow(bool force) {
+    std::unique_lock<std::shared_mutex> guard(_resize_mutex);
+    Slots* old_slots = _slots.get();
+    size_t live = _size.load(std::memory_order_relaxed);
+    if (!force &&
+        _used.load(std::memory_order_relaxed) * 8 <= old_slots->capacity * 7) {
+      return;  // grown by another thread
+    }
+    size_t group_num = old_slots->group_mask + 1;
+    // double the map unless most of the used slots are tombstones
+    if (force || live * 2 > old_slots->capacity) {
+      group_num *= 2;
+    }
+    std::unique_ptr<Slots> new_slots(new Slots(group_num));
+    for (size_t i = 0; i < old_slots->capacity; ++i) {
+      uint8_t tag = old_slots->tags[i].load(std::memory_order_relaxed);
+      if (!IsFull(tag)) {
+        continue;
+      }
+      size_t hash = Hash(old_slots->keys[i]);
+      size_t group = hash & new_slots->group_mask;
+      for (size_t probe = 1;; ++probe) {
+        auto* tags = &new_slots->tags[group * kGroupSize];
+        uint32_t empty = MatchGroup(tags, kEmpty);
+        if (empty != 0) {
+          size_t slot = group * kGroupSize + __builtin_ctz(empty);
+          new_slots->keys[slot] = old_slots->keys[i];
+          new_slots->values[slot] = old_slots->values[i];
+          new_slots->tags[slot].store(tag, std::memory_order_relaxed);
+          break;
+        }
+        group = (group + probe) & new_slots->group_mask;
+      }
+    }
+    _slots = std::move(new_slots);
+    _used.store(live, std::memory_order_relaxed);
+  }
+
+  void EraseSlot(size_t slot) {
+    Slots* slots = _slots.get();
+    ReleaseValue(slots->values[slot]);
+    slots->tags[slot].store(kDeleted, std::memory_order_relaxed);
+    _size.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  template <class... ARGS>
+  VALUE* AcquireValue(ARGS&&... args) {
+    std::lock_guard<ShardValueLock> guard(_alloc_lock);
+    return _alloc.acquire(std::forward<ARGS>(args)...);
+  }
+  void ReleaseValue(VALUE* value) {
+    std::lock_guard<ShardValueLock> guard(_alloc_lock);
+    _alloc.release(value);
+  }
+
+  std::unique_ptr<Slots> _slots;
+  std::shared_mutex _resize_mutex;
+  std::atomic<size_t> _size{0};
+  // full, deleted and claimed slots
+  std::atomic<size_t> _used{0};
+  ShardValueLock _alloc_lock;
+  ChunkAllocator<VALUE> _alloc;
+  ShardValueLock _value_locks[kValueLockNum];
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -14,6 +14,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
 #include <vector>
 
 #include <mct/hash-map.hpp>
@@ -28,22 +34,189 @@ static const int CTR_SPARSE_SHARD_BUCKET_NUM_BITS = 6;
 static const size_t CTR_SPARSE_SHARD_BUCKET_NUM =
     static_cast<size_t>(1) << CTR_SPARSE_SHARD_BUCKET_NUM_BITS;
 
+// The float arrays of the FixedFeatureValues, in chunks of the arrays of one
+// size. A table holds millions of values of a few sizes, so the arrays are
+// packed back to back without the header of a heap block and its rounding.
+// The free arrays are kept in the lists of a few stripes, picked by the
+// thread, so the threads of the different shards rarely share a lock. Like
+// ChunkAllocator, the chunks are not returned; a freed array is reused by a
+// value of the same size.
+class FeatureValueArena {
+ public:
+  // the arrays longer than that are allocated by malloc
+  static constexpr size_t kMaxPooledSize = 512;
+  static constexpr size_t kStripeNum = 8;
+  static constexpr size_t kChunkBytes = 64 * 1024;
+
+  static FeatureValueArena& Instance() {
+    // never destroyed, the values of a static table may outlive it
+    static FeatureValueArena* arena = new FeatureValueArena();
+    return *arena;
+  }
+
+  float* Allocate(size_t size) {
+    if (size == 0) {
+      return nullptr;
+    }
+    if (size > kMaxPooledSize) {
+      return Malloc(size);
+    }
+    SizeClass& size_class = _stripes[StripeId()].classes[size];
+    std::lock_guard<std::mutex> guard(size_class.mutex);
+    if (size_class.free_list == nullptr) {
+      NewChunk(&size_class, size);
+    }
+    float* array = size_class.free_list;
+    size_class.free_list = NextOf(array);
+    return array;
+  }
+
+  void Free(float* array, size_t size) {
+    if (array == nullptr) {
+      return;
+    }
+    if (size > kMaxPooledSize) {
+      free(array);
+      return;
+    }
+    SizeClass& size_class = _stripes[StripeId()].classes[size];
+    std::lock_guard<std::mutex> guard(size_class.mutex);
+    SetNextOf(array, size_class.free_list);
+    size_class.free_list = array;
+  }
+
+ private:
+  struct SizeClass {
+    std::mutex mutex;
+    float* free_list = nullptr;  // linked through the free arrays
+    float* chunks = nullptr;     // linked through their first floats
+  };
+  struct Stripe {
+    SizeClass classes[kMaxPooledSize + 1];
+  };
+
+  FeatureValueArena() = default;
+
+  static size_t StripeId() {
+    static std::atomic<size_t> thread_num{0};
+    thread_local size_t stripe_id = thread_num++ % kStripeNum;
+    return stripe_id;
+  }
+
+  // the floats of a link, an array of one float is allocated as two to hold
+  // the link in the free list
+  static constexpr size_t kLinkSize = 2;
+  static_assert(sizeof(float*) <= kLinkSize * sizeof(float),
+                "a link should fit in kLinkSize floats");
+  static float* NextOf(float* array) {
+    float* next;
+    memcpy(&next, array, sizeof(next));
+    return next;
+  }
+  static void SetNextOf(float* array, float* next) {
+    memcpy(array, &next, sizeof(next));
+  }
+
+  static float* Malloc(size_t size) {
+    void* ptr = malloc(size * sizeof(float));
+    PADDLE_ENFORCE_NOT_NULL(
+        ptr,
+        common::errors::ResourceExhausted(
+            "Fail to alloc memory of %ld size.", size * sizeof(float)));
+    return static_cast<float*>(ptr);
+  }
+
+  void NewChunk(SizeClass* size_class, size_t size) {
+    size_t block_size = std::max(size, kLinkSize);
+    size_t block_num =
+        std::max<size_t>(kChunkBytes / (block_size * sizeof(float)), 16);
+    float* chunk = Malloc(kLinkSize + block_num * block_size);
+    SetNextOf(chunk, size_class->chunks);
+    size_class->chunks = chunk;
+    for (size_t i = 0; i < block_num; ++i) {
+      float* array = chunk + kLinkSize + i * block_size;
+      SetNextOf(array, size_class->free_list);
+      size_class->free_list = array;
+    }
+  }
+
+  Stripe _stripes[kStripeNum];
+};
+
+// The values of the sparse tables: a float array from FeatureValueArena, and
+// its size and capacity in 16 bytes instead of the 24 of a std::vector.
 class FixedFeatureValue {
  public:
   FixedFeatureValue() {}
-  ~FixedFeatureValue() {}
-  float* data() { return _data.data(); }
-  size_t size() { return _data.size(); }
-  void resize(size_t size) { _data.resize(size); }
-  void shrink_to_fit() { _data.shrink_to_fit(); }
+  FixedFeatureValue(const FixedFeatureValue& other) { *this = other; }
+  FixedFeatureValue(FixedFeatureValue&& other) noexcept { swap(other); }
+  FixedFeatureValue& operator=(const FixedFeatureValue& other) {
+    if (this != &other) {
+      resize(other._size);
+      if (_size != 0) {
+        memcpy(_data, other._data, _size * sizeof(float));
+      }
+    }
+    return *this;
+  }
+  FixedFeatureValue& operator=(FixedFeatureValue&& other) noexcept {
+    swap(other);
+    return *this;
+  }
+  ~FixedFeatureValue() { FeatureValueArena::Instance().Free(_data, _capacity); }
+  float* data() { return _data; }
+  size_t size() { return _size; }
+  size_t capacity() { return _capacity; }
+  // as std::vector, the new floats are zero
+  void resize(size_t size) {
+    if (size > _capacity) {
+      reallocate(size);
+    }
+    if (size > _size) {
+      std::fill(_data + _size, _data + size, 0.0f);
+    }
+    _size = static_cast<uint32_t>(size);
+  }
+  void shrink_to_fit() {
+    if (_capacity > _size) {
+      reallocate(_size);
+    }
+  }
+  void swap(FixedFeatureValue& other) noexcept {
+    std::swap(_data, other._data);
+    std::swap(_size, other._size);
+    std::swap(_capacity, other._capacity);
+  }
 
  private:
-  std::vector<float> _data;
+  void reallocate(size_t capacity) {
+    PADDLE_ENFORCE_LE(capacity,
+                      std::numeric_limits<uint32_t>::max(),
+                      common::errors::InvalidArgument(
+                          "The size of a feature value should be at most "
+                          "%u, but received %u.",
+                          std::numeric_limits<uint32_t>::max(),
+                          capacity));
+    auto& arena = FeatureValueArena::Instance();
+    float* data = arena.Allocate(capacity);
+    if (_size != 0 && capacity != 0) {
+      memcpy(data, _data, std::min<size_t>(_size, capacity) * sizeof(float));
+    }
+    arena.Free(_data, _capacity);
+    _data = data;
+    _capacity = static_cast<uint32_t>(capacity);
+  }
+
+  float* _data = nullptr;
+  uint32_t _size = 0;
+  uint32_t _capacity = 0;
 };
 
 template <class KEY, class VALUE>
 struct alignas(64) SparseTableShard {
  public:
+  // accessed by one thread at a time, see ConcurrentSparseTableShard
+  static constexpr bool kConcurrent = false;
   typedef typename mct::closed_hash_map<KEY, mct::Pointer, std::hash<KEY>>
       map_type;
   struct iterator {
@@ -26,8 +26,11 @@
 #include <rocksdb/write_batch.h>
 
 #include <iostream>
+#include <memory>
 #include <string>
 
+#include "paddle/fluid/distributed/ps/table/depends/ssd_value_store.h"
+
 namespace paddle {
 namespace distributed {
 
@@ -252,5 +255,109 @@ class RocksDBHandler {
   std::vector<rocksdb::DB*> _dbs;
   Uint64Comparator _comparator;
 };
+
+class RocksDBValueIterator : public SSDValueIterator {
+ public:
+  explicit RocksDBValueIterator(rocksdb::Iterator* it) : _it(it) {}
+  ~RocksDBValueIterator() { delete _it; }
+  void SeekToFirst() override { _it->SeekToFirst(); }
+  bool Valid() const override { return _it->Valid(); }
+  void Next() override { _it->Next(); }
+  std::string_view key() const override {
+    return std::string_view(_it->key().data(), _it->key().size());
+  }
+  std::string_view value() const override {
+    return std::string_view(_it->value().data(), _it->value().size());
+  }
+
+ private:
+  rocksdb::Iterator* _it;
+};
+
+// The values of a multi_get, pinned until the batch is reset.
+class RocksDBValuePins : public SSDValuePins {
+ public:
+  void reset() override {
+    for (auto& value : values) {
+      value.Reset();
+    }
+  }
+  std::vector<rocksdb::PinnableSlice> values;
+};
+
+// SSDValueStore on the RocksDBHandler instance.
+class RocksDBValueStore : public SSDValueStore {
+ public:
+  RocksDBValueStore() : _handler(RocksDBHandler::GetInstance()) {}
+
+  RocksDBHandler* handler() { return _handler; }
+
+  int initialize(const std::string& db_path, const int colnum) override {
+    return _handler->initialize(db_path, colnum);
+  }
+  int put(int id,
+          const char* key,
+          int key_len,
+          const char* value,
+          int value_len) override {
+    return _handler->put(id, key, key_len, value, value_len);
+  }
+  int put_batch(int id,
+                std::vector<std::pair<char*, int>>& ssd_keys,    // NOLINT
+                std::vector<std::pair<char*, int>>& ssd_values,  // NOLINT
+                int n) override {
+    return _handler->put_batch(id, ssd_keys, ssd_values, n);
+  }
+  int get(int id,
+          const char* key,
+          int key_len,
+          std::string& value) override {  // NOLINT
+    return _handler->get(id, key, key_len, value);
+  }
+  void multi_get(int id, SSDValueBatch* batch) override {
+    size_t num = batch->keys.size();
+    std::vector<rocksdb::Slice> keys;
+    keys.reserve(num);
+    for (auto& key : batch->keys) {
+      keys.emplace_back(reinterpret_cast<const char*>(&key), sizeof(uint64_t));
+    }
+    // The values are left pinned in the batch rather than copied out.
+    auto* pins = dynamic_cast<RocksDBValuePins*>(batch->pins.get());
+    if (pins == nullptr) {
+      pins = new RocksDBValuePins();
+      batch->pins.reset(pins);
+    }
+    if (pins->values.size() < num) {
+      pins->values = std::vector<rocksdb::PinnableSlice>(num);
+    }
+    std::vector<rocksdb::Status> status(num);
+    _handler->multi_get(
+        id, num, keys.data(), pins->values.data(), status.data());
+    batch->values.resize(num);
+    batch->sizes.resize(num);
+    for (size_t i = 0; i < num; ++i) {
+      if (status[i].IsNotFound()) {
+        batch->values[i] = nullptr;
+        batch->sizes[i] = 0;
+      } else {
+        batch->values[i] = pins->values[i].data();
+        batch->sizes[i] = pins->values[i].size();
+      }
+    }
+  }
+  int del_data(int id, const char* key, int key_len) override {
+    return _handler->del_data(id, key, key_len);
+  }
+  int flush(int id) override { return _handler->flush(id); }
+  SSDValueIterator* get_iterator(int id) override {
+    return new RocksDBValueIterator(_handler->get_iterator(id));
+  }
+  int get_estimate_key_num(uint64_t& num_keys) override {  // NOLINT
+    return _handler->get_estimate_key_num(num_keys);
+  }
+
+ private:
+  RocksDBHandler* _handler;
+};
 }  // namespace distributed
 }  // namespace paddle
@@ -0,0 +1,155 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "paddle/fluid/distributed/ps/table/accessor.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+#include "paddle/phi/common/float16.h"
+
+namespace paddle {
+namespace distributed {
+
+// SparseValueCodec stores the embedx weights of a sparse value in fp16 or in
+// int8 with a per-row scale, the other fields are kept in fp32 so that the
+// accessor can still read show/click/unseen_days etc. from an encoded value.
+//
+// An encoded value of n floats whose embedx weights are [offset, offset + dim)
+// is laid out as
+//
+//   [0, offset) | [offset + dim, n) | (scale) | packed weights | meta
+//
+// where meta packs offset and dim into the bits of the last float. Values
+// without embedx (size <= plain_size) are stored as is, and other values
+// which can not be packed are followed by a zero meta.
+class SparseValueCodec {
+ public:
+  // An encoded value is at most kMaxExtraSize floats longer than the plain
+  // one.
+  static constexpr size_t kMaxExtraSize = 2;
+
+  SparseValueCodec() {}
+
+  void Initialize(SparseValueType type,
+                  ValueAccessor* accessor,
+                  size_t plain_size) {
+    _type = type;
+    _accessor = accessor;
+    _plain_size = plain_size;
+  }
+
+  bool Enabled() const { return _type != SPARSE_VALUE_FP32; }
+
+  // Encodes `size` floats of value into out, returns the encoded size.
+  size_t Encode(const float* value, size_t size, float* out) const {
+    size_t offset = 0;
+    size_t dim = 0;
+    if (size <= _plain_size) {
+      memcpy(out, value, size * sizeof(float));
+      return size;
+    }
+    if (!_accessor->EmbedxWRange(value, size, &offset, &dim) || dim == 0 ||
+        offset + dim > size || offset >= (1 << 16) || dim >= (1 << 16)) {
+      // kept in fp32, marked by a zero meta
+      memcpy(out, value, size * sizeof(float));
+      out[size] = 0.0f;
+      return size + 1;
+    }
+    size_t tail = size - offset - dim;
+    memcpy(out, value, offset * sizeof(float));
+    memcpy(out + offset, value + offset + dim, tail * sizeof(float));
+    float* packed = out + offset + tail;
+    const float* w = value + offset;
+    if (_type == SPARSE_VALUE_FP16) {
+      auto* dst = reinterpret_cast<phi::dtype::float16*>(packed);
+      for (size_t i = 0; i < dim; ++i) {
+        dst[i] = static_cast<phi::dtype::float16>(w[i]);
+      }
+      if (dim % 2 != 0) {
+        dst[dim] = static_cast<phi::dtype::float16>(0.0f);
+      }
+    } else {
+      float max_abs = 0.0f;
+      for (size_t i = 0; i < dim; ++i) {
+        max_abs = std::max(max_abs, std::fabs(w[i]));
+      }
+      float scale = max_abs / 127.0f;
+      float inv_scale = scale > 0.0f ? 1.0f / scale : 0.0f;
+      packed[0] = scale;
+      auto* dst = reinterpret_cast<int8_t*>(packed + 1);
+      for (size_t i = 0; i < dim; ++i) {
+        dst[i] = static_cast<int8_t>(std::lround(w[i] * inv_scale));
+      }
+      memset(dst + dim, 0, PackedSize(dim) * sizeof(float) - dim);
+    }
+    size_t encoded_size = offset + tail + ScaleSize() + PackedSize(dim) + 1;
+    uint32_t meta = static_cast<uint32_t>((offset << 16) | dim);
+    memcpy(out + encoded_size - 1, &meta, sizeof(meta));
+    return encoded_size;
+  }
+
+  // Decodes `size` floats of an encoded value into out, returns the plain
+  // size.
+  size_t Decode(const float* value, size_t size, float* out) const {
+    if (size <= _plain_size) {
+      memcpy(out, value, size * sizeof(float));
+      return size;
+    }
+    uint32_t meta = 0;
+    memcpy(&meta, value + size - 1, sizeof(meta));
+    if (meta == 0) {
+      memcpy(out, value, (size - 1) * sizeof(float));
+      return size - 1;
+    }
+    size_t offset = meta >> 16;
+    size_t dim = meta & 0xffff;
+    size_t tail = size - 1 - PackedSize(dim) - ScaleSize() - offset;
+    memcpy(out, value, offset * sizeof(float));
+    memcpy(out + offset + dim, value + offset, tail * sizeof(float));
+    const float* packed = value + offset + tail;
+    float* w = out + offset;
+    if (_type == SPARSE_VALUE_FP16) {
+      auto* src = reinterpret_cast<const phi::dtype::float16*>(packed);
+      for (size_t i = 0; i < dim; ++i) {
+        w[i] = static_cast<float>(src[i]);
+      }
+    } else {
+      float scale = packed[0];
+      auto* src = reinterpret_cast<const int8_t*>(packed + 1);
+      for (size_t i = 0; i < dim; ++i) {
+        w[i] = src[i] * scale;
+      }
+    }
+    return offset + dim + tail;
+  }
+
+ private:
+  size_t ScaleSize() const { return _type == SPARSE_VALUE_INT8 ? 1 : 0; }
+  // number of floats holding dim packed weights
+  size_t PackedSize(size_t dim) const {
+    return _type == SPARSE_VALUE_FP16 ? (dim + 1) / 2 : (dim + 3) / 4;
+  }
+
+  SparseValueType _type = SPARSE_VALUE_FP32;
+  ValueAccessor* _accessor = nullptr;
+  size_t _plain_size = 0;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,121 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace paddle {
+namespace distributed {
+
+class SSDValueIterator {
+ public:
+  virtual ~SSDValueIterator() {}
+  virtual void SeekToFirst() = 0;
+  virtual bool Valid() const = 0;
+  virtual void Next() = 0;
+  virtual std::string_view key() const = 0;
+  virtual std::string_view value() const = 0;
+};
+
+// The memory a store keeps the values of a batch in, e.g. the blocks pinned
+// by rocksdb, until the batch is reset.
+class SSDValuePins {
+ public:
+  virtual ~SSDValuePins() {}
+  virtual void reset() = 0;
+};
+
+// The keys of a multi_get and the values read for them. The value of
+// keys[i] is at values[i], which is nullptr if it is not found. The values
+// point into buffer or pins and are valid until reset.
+class SSDValueBatch {
+ public:
+  void reset() {
+    keys.clear();
+    index.clear();
+    values.clear();
+    sizes.clear();
+    buffer.clear();
+    if (pins) {
+      pins->reset();
+    }
+  }
+  bool found(size_t i) const { return values[i] != nullptr; }
+  const char* value(size_t i) const { return values[i]; }
+
+  std::vector<uint64_t> keys;
+  std::vector<int> index;  // positions of the keys in the pull
+  std::vector<const char*> values;
+  std::vector<size_t> sizes;
+  std::vector<char> buffer;
+  std::unique_ptr<SSDValuePins> pins;
+};
+
+class SSDValueCtx {
+ public:
+  SSDValueCtx() {
+    items[0].reset();
+    items[1].reset();
+    cur_index = 0;
+  }
+  SSDValueBatch* switch_item() {
+    cur_index = (cur_index + 1) % 2;
+    return &items[cur_index];
+  }
+  SSDValueBatch items[2];
+  int cur_index;
+};
+
+// The cold tier of SSDSparseTable. The values are stored in colnum columns,
+// one for each local shard, and keyed by the uint64_t feasign.
+class SSDValueStore {
+ public:
+  virtual ~SSDValueStore() {}
+
+  virtual int initialize(const std::string& db_path, const int colnum) = 0;
+  virtual int put(int id,
+                  const char* key,
+                  int key_len,
+                  const char* value,
+                  int value_len) = 0;
+  virtual int put_batch(
+      int id,
+      std::vector<std::pair<char*, int>>& ssd_keys,    // NOLINT
+      std::vector<std::pair<char*, int>>& ssd_values,  // NOLINT
+      int n) = 0;
+  // Returns 1 if key is not found.
+  virtual int get(int id,
+                  const char* key,
+                  int key_len,
+                  std::string& value) = 0;  // NOLINT
+  virtual void multi_get(int id, SSDValueBatch* batch) = 0;
+  // Advises the store that the values of the keys are read soon, e.g. by the
+  // next multi_gets of the same pull, so that the disk reads them ahead
+  // while the earlier batches are processed. Nothing is read or cached by
+  // the call itself.
+  virtual void advise_will_need(int id, const uint64_t* keys, size_t num) {}
+  virtual int del_data(int id, const char* key, int key_len) = 0;
+  virtual int flush(int id) = 0;
+  // The caller owns the iterator.
+  virtual SSDValueIterator* get_iterator(int id) = 0;
+  virtual int get_estimate_key_num(uint64_t& num_keys) = 0;  // NOLINT
+};
+
+}  // namespace distributed
+}  // namespace paddle
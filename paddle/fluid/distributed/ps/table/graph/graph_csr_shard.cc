@@ -0,0 +1,290 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr_shard.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace paddle::distributed {
+
+namespace {
+
+constexpr char kMagic[] = "PDGCSR01";
+constexpr size_t kMagicSize = sizeof(kMagic) - 1;
+
+float weight_to_float(float weight) { return weight; }
+#ifdef PADDLE_WITH_CUDA
+float weight_to_float(half weight) { return __half2float(weight); }
+#endif
+
+template <typename T>
+void write_vector(std::ofstream &ofs, const std::vector<T> &data) {  // NOLINT
+  uint64_t size = data.size();
+  ofs.write(reinterpret_cast<const char *>(&size), sizeof(size));
+  ofs.write(reinterpret_cast<const char *>(data.data()), size * sizeof(T));
+}
+
+template <typename T>
+bool read_vector(std::ifstream &ifs, std::vector<T> *data) {  // NOLINT
+  uint64_t size = 0;
+  if (!ifs.read(reinterpret_cast<char *>(&size), sizeof(size))) return false;
+  data->resize(size);
+  return static_cast<bool>(
+      ifs.read(reinterpret_cast<char *>(data->data()), size * sizeof(T)));
+}
+
+}  // namespace
+
+void GraphCsrShard::build(const std::vector<Node *> &nodes,
+                          bool is_weighted,
+                          const GraphCsrShard *base) {
+  std::vector<Node *> sorted_nodes(nodes);
+  std::sort(sorted_nodes.begin(), sorted_nodes.end(), [](Node *a, Node *b) {
+    return a->get_id() < b->get_id();
+  });
+  size_t base_node_num = base == nullptr ? 0 : base->node_num();
+  size_t edge_num = base == nullptr ? 0 : base->edge_num();
+  for (auto *node : sorted_nodes) {
+    edge_num += node->get_neighbor_size();
+  }
+
+  GraphCsrShard shard;
+  shard.is_weighted_ = is_weighted;
+  shard.ids_.reserve(base_node_num + sorted_nodes.size());
+  shard.offsets_.reserve(base_node_num + sorted_nodes.size() + 1);
+  shard.neighbors_.reserve(edge_num);
+  if (is_weighted) {
+    shard.weights_.reserve(edge_num);
+  }
+  auto add_base_edges = [&](size_t b) {
+    for (uint64_t j = base->offsets_[b]; j < base->offsets_[b + 1]; j++) {
+      shard.neighbors_.push_back(base->neighbors_[j]);
+      if (is_weighted) {
+        shard.weights_.push_back(base->is_weighted_
+                                     ? base->weights_[j]
+                                     : phi::dtype::float16(1.0f));
+      }
+    }
+  };
+  auto add_node_edges = [&](Node *node) {
+    size_t neighbor_size = node->get_neighbor_size();
+    for (size_t j = 0; j < neighbor_size; j++) {
+      shard.neighbors_.push_back(node->get_neighbor_id(j));
+      if (is_weighted) {
+        shard.weights_.emplace_back(
+            weight_to_float(node->get_neighbor_weight(j)));
+      }
+    }
+  };
+  // Merges the sorted ids of base and the nodes.
+  size_t b = 0, i = 0;
+  while (b < base_node_num || i < sorted_nodes.size()) {
+    bool from_base =
+        b < base_node_num && (i == sorted_nodes.size() ||
+                              base->ids_[b] <= sorted_nodes[i]->get_id());
+    bool from_nodes =
+        i < sorted_nodes.size() &&
+        (b == base_node_num || sorted_nodes[i]->get_id() <= base->ids_[b]);
+    shard.ids_.push_back(from_base ? base->ids_[b]
+                                   : sorted_nodes[i]->get_id());
+    if (from_base) add_base_edges(b++);
+    if (from_nodes) add_node_edges(sorted_nodes[i++]);
+    shard.offsets_.push_back(shard.neighbors_.size());
+  }
+  // Keeps the sampling of base.
+  if (base != nullptr && base->has_alias_tables()) {
+    shard.build_alias_tables();
+  }
+  *this = std::move(shard);
+}
+
+void GraphCsrShard::build_alias_tables() {
+  if (!is_weighted_ || has_alias_tables()) return;
+  alias_probs_.resize(neighbors_.size());
+  alias_indices_.resize(neighbors_.size());
+  for (size_t i = 0; i < ids_.size(); i++) {
+    build_alias_table(offsets_[i], offsets_[i + 1]);
+  }
+}
+
+void GraphCsrShard::clear() { *this = GraphCsrShard(); }
+
+// Vose's alias method.
+void GraphCsrShard::build_alias_table(size_t begin, size_t end) {
+  size_t n = end - begin;
+  if (n == 0) return;
+  double sum = 0;
+  for (size_t j = begin; j < end; j++) {
+    sum += static_cast<float>(weights_[j]);
+  }
+  std::vector<double> scaled(n);
+  std::vector<uint32_t> small, large;
+  for (size_t j = 0; j < n; j++) {
+    scaled[j] =
+        sum > 0 ? static_cast<float>(weights_[begin + j]) * n / sum : 1.0;
+    if (scaled[j] < 1.0) {
+      small.push_back(j);
+    } else {
+      large.push_back(j);
+    }
+  }
+  while (!small.empty() && !large.empty()) {
+    uint32_t s = small.back();
+    uint32_t l = large.back();
+    small.pop_back();
+    alias_probs_[begin + s] = scaled[s];
+    alias_indices_[begin + s] = l;
+    scaled[l] = scaled[l] + scaled[s] - 1.0;
+    if (scaled[l] < 1.0) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  // The rest are 1.0 up to rounding errors.
+  for (uint32_t j : small) {
+    alias_probs_[begin + j] = 1.0;
+    alias_indices_[begin + j] = j;
+  }
+  for (uint32_t j : large) {
+    alias_probs_[begin + j] = 1.0;
+    alias_indices_[begin + j] = j;
+  }
+}
+
+size_t GraphCsrShard::memory_size() const {
+  return ids_.size() * sizeof(uint64_t) + offsets_.size() * sizeof(uint64_t) +
+         neighbors_.size() * sizeof(uint64_t) +
+         weights_.size() * sizeof(phi::dtype::float16) +
+         alias_probs_.size() * sizeof(float) +
+         alias_indices_.size() * sizeof(uint32_t);
+}
+
+int64_t GraphCsrShard::find(uint64_t id) const {
+  auto iter = std::lower_bound(ids_.begin(), ids_.end(), id);
+  if (iter == ids_.end() || *iter != id) return -1;
+  return iter - ids_.begin();
+}
+
+int GraphCsrShard::sample_k(int64_t index,
+                            int k,
+                            std::mt19937_64 *rng,
+                            uint64_t *out_ids,
+                            float *out_weights) const {
+  const uint64_t begin = offsets_[index];
+  const int n = static_cast<int>(offsets_[index + 1] - begin);
+  if (n == 0 || k <= 0) return 0;
+  auto write = [&](int pos, uint64_t j) {
+    out_ids[pos] = neighbors_[begin + j];
+    if (out_weights != nullptr) {
+      out_weights[pos] =
+          is_weighted_ ? static_cast<float>(weights_[begin + j]) : 1.0;
+    }
+  };
+
+  if (k >= n) {
+    for (int j = 0; j < n; j++) {
+      write(j, j);
+    }
+    return n;
+  }
+
+  if (has_alias_tables()) {
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    std::uniform_real_distribution<float> coin(0, 1);
+    for (int i = 0; i < k; i++) {
+      uint32_t j = pick(*rng);
+      if (coin(*rng) >= alias_probs_[begin + j]) {
+        j = alias_indices_[begin + j];
+      }
+      write(i, j);
+    }
+    return k;
+  }
+
+  // Floyd's algorithm, the local indices are kept in out_ids first.
+  for (int i = 0, j = n - k; j < n; i++, j++) {
+    uint64_t t = std::uniform_int_distribution<int>(0, j)(*rng);
+    if (std::find(out_ids, out_ids + i, t) != out_ids + i) {
+      t = j;
+    }
+    out_ids[i] = t;
+  }
+  for (int i = 0; i < k; i++) {
+    write(i, out_ids[i]);
+  }
+  return k;
+}
+
+void GraphCsrShard::sample_batch(const uint64_t *ids,
+                                 size_t n,
+                                 int k,
+                                 std::mt19937_64 *rng,
+                                 uint64_t *out_ids,
+                                 float *out_weights,
+                                 int *actual_sizes) const {
+  for (size_t i = 0; i < n; i++) {
+    int64_t index = find(ids[i]);
+    actual_sizes[i] =
+        index < 0 ? 0
+                  : sample_k(index,
+                             k,
+                             rng,
+                             out_ids + i * k,
+                             out_weights ? out_weights + i * k : nullptr);
+  }
+}
+
+int32_t GraphCsrShard::save(const std::string &path) const {
+  std::ofstream ofs(path, std::ios::binary);
+  ofs.write(kMagic, kMagicSize);
+  uint8_t is_weighted = is_weighted_;
+  ofs.write(reinterpret_cast<const char *>(&is_weighted), sizeof(is_weighted));
+  write_vector(ofs, ids_);
+  write_vector(ofs, offsets_);
+  write_vector(ofs, neighbors_);
+  write_vector(ofs, weights_);
+  if (!ofs) {
+    LOG(WARNING) << "Failed to save graph csr shard to " << path;
+    return -1;
+  }
+  return 0;
+}
+
+int32_t GraphCsrShard::load(const std::string &path) {
+  std::ifstream ifs(path, std::ios::binary);
+  alias_probs_.clear();
+  alias_indices_.clear();
+  char magic[kMagicSize];
+  uint8_t is_weighted = 0;
+  bool ok = ifs.read(magic, kMagicSize) &&
+            std::memcmp(magic, kMagic, kMagicSize) == 0 &&
+            ifs.read(reinterpret_cast<char *>(&is_weighted),
+                     sizeof(is_weighted)) &&
+            read_vector(ifs, &ids_) && read_vector(ifs, &offsets_) &&
+            read_vector(ifs, &neighbors_) && read_vector(ifs, &weights_);
+  is_weighted_ = is_weighted;
+  ok = ok && offsets_.size() == ids_.size() + 1 &&
+       offsets_.back() == neighbors_.size() &&
+       weights_.size() == (is_weighted_ ? neighbors_.size() : 0);
+  if (!ok) {
+    LOG(WARNING) << "Failed to load graph csr shard from " << path;
+    clear();
+    return -1;
+  }
+  return 0;
+}
+
+}  // namespace paddle::distributed
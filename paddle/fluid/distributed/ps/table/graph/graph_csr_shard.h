@@ -0,0 +1,107 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
+#include "paddle/phi/common/float16.h"
+namespace paddle {
+namespace distributed {
+
+/**
+ * Immutable CSR storage of the edges of a graph shard, built from the nodes
+ * of a GraphShard after loading. The neighbors of the node ids_[i] are
+ * neighbors_[offsets_[i], offsets_[i + 1]), with fp16 weights for weighted
+ * graphs. ids_ is sorted, so that a node is found by binary search.
+ *
+ * Sampling draws k neighbors uniformly without replacement like
+ * RandomSampler. After build_alias_tables, it draws k neighbors with
+ * replacement in proportion to the weights instead, at O(1) per draw. The
+ * alias tables cost 8 bytes per edge, so they are only built when weighted
+ * sampling is asked for, and are not saved.
+ */
+class GraphCsrShard {
+ public:
+  GraphCsrShard() {}
+
+  // Builds the shard from the nodes. The edges of a node also in base, if it
+  // is not null, follow the edges of that node in base.
+  void build(const std::vector<Node *> &nodes,
+             bool is_weighted,
+             const GraphCsrShard *base = nullptr);
+  // Builds the alias tables of a weighted shard. It must not be called
+  // concurrently with sampling.
+  void build_alias_tables();
+  void clear();
+
+  size_t node_num() const { return ids_.size(); }
+  size_t edge_num() const { return neighbors_.size(); }
+  bool is_weighted() const { return is_weighted_; }
+  bool has_alias_tables() const { return !alias_probs_.empty(); }
+  // The bytes held by the arrays.
+  size_t memory_size() const;
+
+  // Returns the index of the node in the shard, or -1 if it is not found.
+  int64_t find(uint64_t id) const;
+  size_t get_neighbor_size(int64_t index) const {
+    return offsets_[index + 1] - offsets_[index];
+  }
+
+  // Samples at most k neighbors of the node at index into out_ids and,
+  // if it is not null, out_weights, returns the number sampled. It does
+  // not allocate memory.
+  int sample_k(int64_t index,
+               int k,
+               std::mt19937_64 *rng,
+               uint64_t *out_ids,
+               float *out_weights) const;
+
+  // Samples at most k neighbors for each of the n ids. The neighbors of
+  // ids[i] are written to out_ids[i * k, ...) and out_weights[i * k, ...),
+  // their number to actual_sizes[i], which is 0 if ids[i] is not in the shard.
+  void sample_batch(const uint64_t *ids,
+                    size_t n,
+                    int k,
+                    std::mt19937_64 *rng,
+                    uint64_t *out_ids,
+                    float *out_weights,
+                    int *actual_sizes) const;
+
+  int32_t save(const std::string &path) const;
+  int32_t load(const std::string &path);
+
+ private:
+  void build_alias_table(size_t begin, size_t end);
+
+  bool is_weighted_ = false;
+  std::vector<uint64_t> ids_;
+  std::vector<uint64_t> offsets_{0};
+  std::vector<uint64_t> neighbors_;
+  // Only for weighted graphs.
+  std::vector<phi::dtype::float16> weights_;
+  // The alias table of the neighbors of each node, empty until
+  // build_alias_tables. A draw of the j-th
+  // neighbor is kept with probability alias_probs_[j], otherwise replaced
+  // by the alias_indices_[j]-th neighbor of the same node.
+  std::vector<float> alias_probs_;
+  std::vector<uint32_t> alias_indices_;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <omp.h>
+#include <algorithm>
 #include <sstream>
 
 #include "glog/logging.h"
@@ -20,6 +21,7 @@
 #include "paddle/fluid/distributed/common/local_random.h"
 #include "paddle/fluid/distributed/common/topk_calculator.h"
 #include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
+#include "paddle/fluid/distributed/ps/table/sparse_binary_shard.h"
 #include "paddle/fluid/framework/archive.h"
 #include "paddle/fluid/framework/io/fs.h"
 
@@ -38,10 +40,58 @@ PD_DEFINE_bool(pserver_enable_create_feasign_randomly,
 PD_DEFINE_int32(pserver_table_save_max_retry,
                 3,
                 "pserver_table_save_max_retry");
+PD_DEFINE_int32(pserver_sparse_update_batch_size,
+                64,
+                "rows of a push the accessor updates at once, 1 to update "
+                "them one by one");
 
 namespace paddle::distributed {
 
-int32_t MemorySparseTable::Initialize() {
+namespace {
+
+// Gathers the rows of a push that are updated in place, so that the accessor
+// runs the sgd rules over them in batches. If disabled, e.g. when the rows
+// are locked one at a time or read right after the update, each row is
+// updated as it is added.
+class UpdateBatch {
+ public:
+  UpdateBatch(ValueAccessor *accessor, bool enabled)
+      : _accessor(accessor),
+        _batch_size(enabled ? std::max(FLAGS_pserver_sparse_update_batch_size,
+                                       1)
+                            : 1) {
+    _values.reserve(_batch_size);
+    _updates.reserve(_batch_size);
+  }
+  ~UpdateBatch() { Flush(); }
+
+  void Add(float *value, const float *update) {
+    _values.push_back(value);
+    _updates.push_back(update);
+    if (_values.size() >= _batch_size) {
+      Flush();
+    }
+  }
+
+  void Flush() {
+    if (!_values.empty()) {
+      _accessor->Update(_values.data(), _updates.data(), _values.size());
+      _values.clear();
+      _updates.clear();
+    }
+  }
+
+ private:
+  ValueAccessor *_accessor;
+  size_t _batch_size;
+  std::vector<float *> _values;
+  std::vector<const float *> _updates;
+};
+
+}  // namespace
+
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::Initialize() {
   auto &profiler = CostProfiler::instance();
   profiler.register_profiler("pserver_sparse_update_all");
   profiler.register_profiler("pserver_sparse_select_all");
@@ -54,7 +104,8 @@ int32_t MemorySparseTable::Initialize() {
   return 0;
 }
 
-int32_t MemorySparseTable::InitializeValue() {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::InitializeValue() {
   _sparse_table_shard_num = static_cast<int>(_config.shard_num());
   _avg_local_shard_num =
       sparse_local_shard_num(_sparse_table_shard_num, _shard_num);
@@ -70,6 +121,17 @@ int32_t MemorySparseTable::InitializeValue() {
   _task_pool_size = _sparse_table_shard_num;
 #endif
   _use_gpu_graph = _config.use_gpu_graph();
+  size_t plain_value_size = (_value_accessor->GetAccessorInfo().size -
+                             _value_accessor->GetAccessorInfo().mf_size) /
+                            sizeof(float);
+  _value_codec.Initialize(
+      _config.sparse_value_type(), _value_accessor.get(), plain_value_size);
+  // PullSparsePtr hands out the stored values to the gpu ps
+  PADDLE_ENFORCE_EQ(
+      _value_codec.Enabled() && _use_gpu_graph,
+      false,
+      common::errors::InvalidArgument(
+          "The compact sparse_value_type is not supported with gpu graph."));
   VLOG(1) << "memory sparse table _avg_local_shard_num: "
           << _avg_local_shard_num
           << " _real_local_shard_num: " << _real_local_shard_num
@@ -120,8 +182,9 @@ int32_t MemorySparseTable::InitializeValue() {
   return 0;
 }
 
-int32_t MemorySparseTable::Load(const std::string &path,
-                                const std::string &param) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::Load(const std::string &path,
+                                           const std::string &param) {
   std::string table_path = TableDir(path);
   auto file_list = _afs_client.list(table_path);
 
@@ -173,9 +236,14 @@ int32_t MemorySparseTable::Load(const std::string &path,
     channel_config.path = file_list[file_start_idx + i];
     VLOG(1) << "MemorySparseTable::load begin load " << channel_config.path
             << " into local shard " << i;
-    channel_config.converter = _value_accessor->Converter(load_param).converter;
-    channel_config.deconverter =
-        _value_accessor->Converter(load_param).deconverter;
+    // the accessor converters work on text lines
+    bool is_binary = IsSparseBinaryShardFile(channel_config.path);
+    if (!is_binary) {
+      channel_config.converter =
+          _value_accessor->Converter(load_param).converter;
+      channel_config.deconverter =
+          _value_accessor->Converter(load_param).deconverter;
+    }
 
     bool is_read_failed = false;
     int retry_num = 0;
@@ -188,7 +256,30 @@ int32_t MemorySparseTable::Load(const std::string &path,
       char *end = nullptr;
       auto &shard = _local_shards[i];
       try {
-        while (read_channel->read_line(line_data) == 0 &&
+        if (is_binary) {
+          SparseBinaryShardReader reader(read_channel);
+          SparseBinaryBlock block;
+          int ret = 0;
+          while ((ret = reader.Next(&block)) > 0 &&
+                 block.value_dim <= feature_value_size) {
+            for (size_t k = 0; k < block.KeyNum(); ++k) {
+              WriteValue(
+                  &shard[block.keys[k]], block.Value(k), block.value_dim);
+            }
+            mem_count += block.KeyNum();
+            if (block.value_dim > feature_value_size - mf_value_size) {
+              mem_mf_count += block.KeyNum();
+            }
+          }
+          if (ret > 0) {
+            LOG(ERROR) << "MemorySparseTable value dim " << block.value_dim
+                       << " exceeds " << feature_value_size;
+          }
+          if (ret != 0) {
+            err_no = -1;
+          }
+        }
+        while (!is_binary && read_channel->read_line(line_data) == 0 &&
                line_data.size() > 1) {
           uint64_t key = std::strtoul(line_data.data(), &end, 10);
           auto &value = shard[key];
@@ -197,6 +288,9 @@ int32_t MemorySparseTable::Load(const std::string &path,
               _value_accessor->ParseFromString(++end, value.data());
           mem_count++;
           value.resize(parse_size);
+          if (_value_codec.Enabled()) {
+            WriteValue(&value, value.data(), parse_size);
+          }
           if (parse_size >
               static_cast<int>(feature_value_size - mf_value_size)) {
             mem_mf_count++;
@@ -230,8 +324,9 @@ int32_t MemorySparseTable::Load(const std::string &path,
   return 0;
 }
 
-int32_t MemorySparseTable::LoadPatch(const std::vector<std::string> &file_list,
-                                     int load_param) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::LoadPatch(
+    const std::vector<std::string> &file_list, int load_param) {
   if (!_config.enable_revert()) {
     LOG(INFO) << "MemorySparseTable should be enabled revert.";
     return 0;
@@ -257,9 +352,13 @@ int32_t MemorySparseTable::LoadPatch(const std::vector<std::string> &file_list,
   for (int i = start_idx; i < end_idx; ++i) {
     FsChannelConfig channel_config = {};
     channel_config.path = file_list[i];
-    channel_config.converter = _value_accessor->Converter(load_param).converter;
-    channel_config.deconverter =
-        _value_accessor->Converter(load_param).deconverter;
+    bool is_binary = IsSparseBinaryShardFile(channel_config.path);
+    if (!is_binary) {
+      channel_config.converter =
+          _value_accessor->Converter(load_param).converter;
+      channel_config.deconverter =
+          _value_accessor->Converter(load_param).deconverter;
+    }
 
     bool is_read_failed = false;
     int retry_num = 0;
@@ -281,7 +380,37 @@ int32_t MemorySparseTable::LoadPatch(const std::vector<std::string> &file_list,
         }
       }
       try {
-        while (read_channel->read_line(line_data) == 0 &&
+        if (is_binary) {
+          SparseBinaryShardReader reader(read_channel);
+          SparseBinaryBlock block;
+          int ret = 0;
+          while ((ret = reader.Next(&block)) > 0 &&
+                 block.value_dim <= feature_value_size) {
+            for (size_t k = 0; k < block.KeyNum(); ++k) {
+              uint64_t key = block.keys[k];
+              auto index_iter =
+                  global_shard_idx.find(key % _sparse_table_shard_num);
+              if (index_iter == global_shard_idx.end()) {
+                LOG(WARNING) << "MemorySparseTable key:" << key
+                             << " not match shard,"
+                             << " file_idx:" << i
+                             << " global_shard_idx:" << global_shard_idx_str
+                             << " file:" << channel_config.path;
+                continue;
+              }
+              auto &shard = _local_shards[*index_iter % _avg_local_shard_num];
+              WriteValue(&shard[key], block.Value(k), block.value_dim);
+            }
+          }
+          if (ret > 0) {
+            LOG(ERROR) << "MemorySparseTable value dim " << block.value_dim
+                       << " exceeds " << feature_value_size;
+          }
+          if (ret != 0) {
+            err_no = -1;
+          }
+        }
+        while (!is_binary && read_channel->read_line(line_data) == 0 &&
                line_data.size() > 1) {
           uint64_t key = std::strtoul(line_data.data(), &end, 10);
 
@@ -304,6 +433,9 @@ int32_t MemorySparseTable::LoadPatch(const std::vector<std::string> &file_list,
           int parse_size =
               _value_accessor->ParseFromString(++end, value.data());
           value.resize(parse_size);
+          if (_value_codec.Enabled()) {
+            WriteValue(&value, value.data(), parse_size);
+          }
         }
         read_channel->close();
         if (err_no == -1) {
@@ -330,18 +462,21 @@ int32_t MemorySparseTable::LoadPatch(const std::vector<std::string> &file_list,
   return 0;
 }
 
-void MemorySparseTable::Revert() {
+template <class SHARD>
+void MemorySparseTableImpl<SHARD>::Revert() {
   for (int i = 0; i < _real_local_shard_num; ++i) {
     _local_shards_new[i].clear();
   }
 }
 
-void MemorySparseTable::CheckSavePrePatchDone() {
+template <class SHARD>
+void MemorySparseTableImpl<SHARD>::CheckSavePrePatchDone() {
   _save_patch_model_thread.join();
 }
 
-int32_t MemorySparseTable::Save(const std::string &dirname,
-                                const std::string &param) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::Save(const std::string &dirname,
+                                           const std::string &param) {
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
   // gpu graph mode
   if (_use_gpu_graph) {
@@ -364,8 +499,11 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
   if (save_param == 5) {
     _local_shards_patch_model.reset(_local_shards_new.release());
     _local_shards_new.reset(new shard_type[_real_local_shard_num]);  // NOLINT
-    _save_patch_model_thread = std::thread(std::bind(
-        &MemorySparseTable::SavePatch, this, std::string(dirname), save_param));
+    _save_patch_model_thread =
+        std::thread(std::bind(&MemorySparseTableImpl<SHARD>::SavePatch,
+                              this,
+                              std::string(dirname),
+                              save_param));
     return 0;
   }
 
@@ -379,6 +517,11 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
   std::atomic<uint32_t> feasign_size_all{0};
 
   size_t file_start_idx = _avg_local_shard_num * _shard_idx;
+  // only checkpoints are saved in binary, xbox models are consumed as text
+  bool save_binary =
+      _config.save_binary_format() && (save_param == 0 || save_param == 3);
+  bool compress =
+      _config.compress_in_save() && (save_param == 0 || save_param == 3);
 
 #ifdef PADDLE_WITH_HETERPS
   int thread_num = _real_local_shard_num;
@@ -389,21 +532,18 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
 #pragma omp parallel for schedule(dynamic)
   for (int i = 0; i < _real_local_shard_num; ++i) {
     FsChannelConfig channel_config = {};
-    if (_config.compress_in_save() && (save_param == 0 || save_param == 3)) {
-      channel_config.path =
-          ::paddle::string::format_string("%s/part-%03d-%05d.gz",
-                                          table_path.c_str(),
-                                          _shard_idx,
-                                          file_start_idx + i);
-    } else {
-      channel_config.path = ::paddle::string::format_string("%s/part-%03d-%05d",
-                                                            table_path.c_str(),
-                                                            _shard_idx,
-                                                            file_start_idx + i);
+    channel_config.path = ::paddle::string::format_string(
+        "%s/part-%03d-%05d%s",
+        table_path.c_str(),
+        _shard_idx,
+        file_start_idx + i,
+        SparseShardFileSuffix(save_binary, compress).c_str());
+    if (!save_binary) {
+      channel_config.converter =
+          _value_accessor->Converter(save_param).converter;
+      channel_config.deconverter =
+          _value_accessor->Converter(save_param).deconverter;
     }
-    channel_config.converter = _value_accessor->Converter(save_param).converter;
-    channel_config.deconverter =
-        _value_accessor->Converter(save_param).deconverter;
     bool is_write_failed = false;
     int feasign_size = 0;
     int retry_num = 0;
@@ -417,12 +557,18 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
       }
     }
 #endif
+    std::vector<float> value_buffer(
+        _value_accessor->GetAccessorInfo().size / sizeof(float));
     do {
       err_no = 0;
       feasign_size = 0;
       is_write_failed = false;
       auto write_channel =
           _afs_client.open_w(channel_config, 1024 * 1024 * 40, &err_no);
+      std::unique_ptr<SparseBinaryShardWriter> binary_writer;
+      if (save_binary) {
+        binary_writer.reset(new SparseBinaryShardWriter(write_channel));
+      }
       for (auto it = shard.begin(); it != shard.end(); ++it) {
         if (_config.enable_sparse_table_cache() &&
             (save_param == 1 || save_param == 2) &&
@@ -432,10 +578,18 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
         }
 
         if (_value_accessor->Save(it.value().data(), save_param)) {
-          std::string format_value = _value_accessor->ParseToString(
-              it.value().data(), it.value().size());
-          if (0 != write_channel->write_line(::paddle::string::format_string(
-                       "%lu %s", it.key(), format_value.c_str()))) {
+          size_t value_size = ReadValue(it.value(), value_buffer.data());
+          int ret = 0;
+          if (save_binary) {
+            ret = binary_writer->Append(
+                it.key(), value_buffer.data(), value_size);
+          } else {
+            std::string format_value = _value_accessor->ParseToString(
+                value_buffer.data(), value_size);
+            ret = write_channel->write_line(::paddle::string::format_string(
+                "%lu %s", it.key(), format_value.c_str()));
+          }
+          if (0 != ret) {
             ++retry_num;
             is_write_failed = true;
             LOG(ERROR)
@@ -446,6 +600,12 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
           ++feasign_size;
         }
       }
+      if (!is_write_failed && save_binary && 0 != binary_writer->Finish()) {
+        ++retry_num;
+        is_write_failed = true;
+        LOG(ERROR) << "MemorySparseTable save prefix failed, retry it! path:"
+                   << channel_config.path << " , retry_num=" << retry_num;
+      }
       write_channel->close();
       if (err_no == -1) {
         ++retry_num;
@@ -481,8 +641,9 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
 }
 
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
-int32_t MemorySparseTable::Save_v2(const std::string &dirname,
-                                   const std::string &param) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::Save_v2(const std::string &dirname,
+                                              const std::string &param) {
   if (_real_local_shard_num == 0) {
     _local_show_threshold = -1;
     return 0;
@@ -496,8 +657,11 @@ int32_t MemorySparseTable::Save_v2(const std::string &dirname,
   if (save_param == 5) {
     _local_shards_patch_model.reset(_local_shards_new.release());
     _local_shards_new.reset(new shard_type[_real_local_shard_num]);
-    _save_patch_model_thread = std::thread(std::bind(
-        &MemorySparseTable::SavePatch, this, std::string(dirname), save_param));
+    _save_patch_model_thread =
+        std::thread(std::bind(&MemorySparseTableImpl<SHARD>::SavePatch,
+                              this,
+                              std::string(dirname),
+                              save_param));
     return 0;
   }
 
@@ -515,6 +679,11 @@ int32_t MemorySparseTable::Save_v2(const std::string &dirname,
   std::atomic<uint32_t> feasign_size_all_for_slot_feature{0};
 
   size_t file_start_idx = _avg_local_shard_num * _shard_idx;
+  bool save_binary =
+      _config.save_binary_format() && (save_param == 0 || save_param == 3);
+  bool compress =
+      _config.compress_in_save() && (save_param == 0 || save_param == 3);
+  std::string suffix = SparseShardFileSuffix(save_binary, compress);
 
 #ifdef PADDLE_WITH_HETERPS
   int thread_num = _real_local_shard_num;
@@ -528,35 +697,27 @@ int32_t MemorySparseTable::Save_v2(const std::string &dirname,
     FsChannelConfig channel_config = {};
     FsChannelConfig channel_config_for_slot_feature;
 
-    if (_config.compress_in_save() && (save_param == 0 || save_param == 3)) {
-      channel_config.path =
-          paddle::string::format_string("%s/part-%03d-%05d.gz",
-                                        table_path.c_str(),
-                                        _shard_idx,
-                                        file_start_idx + i);
-      channel_config_for_slot_feature.path =
-          paddle::string::format_string("%s/slot_feature/part-%03d-%05d.gz",
-                                        table_path.c_str(),
-                                        _shard_idx,
-                                        file_start_idx + i);
-    } else {
-      channel_config.path = paddle::string::format_string("%s/part-%03d-%05d",
-                                                          table_path.c_str(),
-                                                          _shard_idx,
-                                                          file_start_idx + i);
-      channel_config_for_slot_feature.path =
-          paddle::string::format_string("%s/slot_feature/part-%03d-%05d",
-                                        table_path.c_str(),
-                                        _shard_idx,
-                                        file_start_idx + i);
+    channel_config.path = paddle::string::format_string("%s/part-%03d-%05d%s",
+                                                        table_path.c_str(),
+                                                        _shard_idx,
+                                                        file_start_idx + i,
+                                                        suffix.c_str());
+    channel_config_for_slot_feature.path =
+        paddle::string::format_string("%s/slot_feature/part-%03d-%05d%s",
+                                      table_path.c_str(),
+                                      _shard_idx,
+                                      file_start_idx + i,
+                                      suffix.c_str());
+    if (!save_binary) {
+      channel_config.converter =
+          _value_accessor->Converter(save_param).converter;
+      channel_config.deconverter =
+          _value_accessor->Converter(save_param).deconverter;
+      channel_config_for_slot_feature.converter =
+          _value_accessor->Converter(save_param).converter;
+      channel_config_for_slot_feature.deconverter =
+          _value_accessor->Converter(save_param).deconverter;
     }
-    channel_config.converter = _value_accessor->Converter(save_param).converter;
-    channel_config.deconverter =
-        _value_accessor->Converter(save_param).deconverter;
-    channel_config_for_slot_feature.converter =
-        _value_accessor->Converter(save_param).converter;
-    channel_config_for_slot_feature.deconverter =
-        _value_accessor->Converter(save_param).deconverter;
 
     bool is_write_failed = false;
     bool is_write_failed_for_slot_feature = false;
@@ -575,6 +736,8 @@ int32_t MemorySparseTable::Save_v2(const std::string &dirname,
       }
     }
 #endif
+    std::vector<float> value_buffer(
+        _value_accessor->GetAccessorInfo().size / sizeof(float));
     do {
       err_no = 0;
       err_no_for_slot_feature = 0;
@@ -587,6 +750,13 @@ int32_t MemorySparseTable::Save_v2(const std::string &dirname,
           _afs_client.open_w(channel_config_for_slot_feature,
                              1024 * 1024 * 40,
                              &err_no_for_slot_feature);
+      std::unique_ptr<SparseBinaryShardWriter> binary_writer;
+      std::unique_ptr<SparseBinaryShardWriter> binary_writer_for_slot_feature;
+      if (save_binary) {
+        binary_writer.reset(new SparseBinaryShardWriter(write_channel));
+        binary_writer_for_slot_feature.reset(
+            new SparseBinaryShardWriter(write_channel_for_slot_feature));
+      }
 
       for (auto it = shard.begin(); it != shard.end(); ++it) {
         if (_config.enable_sparse_table_cache() &&
@@ -597,10 +767,19 @@ int32_t MemorySparseTable::Save_v2(const std::string &dirname,
         }
 
         if (_value_accessor->Save(it.value().data(), save_param)) {
-          std::string format_value = _value_accessor->ParseToString(
-              it.value().data(), it.value().size());
-          if (0 != write_channel->write_line(::paddle::string::format_string(
-                       "%lu %s", it.key(), format_value.c_str()))) {
+          size_t value_size = ReadValue(it.value(), value_buffer.data());
+          std::string format_value;
+          int ret = 0;
+          if (save_binary) {
+            ret = binary_writer->Append(
+                it.key(), value_buffer.data(), value_size);
+          } else {
+            format_value = _value_accessor->ParseToString(value_buffer.data(),
+                                                          value_size);
+            ret = write_channel->write_line(::paddle::string::format_string(
+                "%lu %s", it.key(), format_value.c_str()));
+          }
+          if (0 != ret) {
             ++retry_num;
             is_write_failed = true;
             LOG(ERROR)
@@ -611,9 +790,15 @@ int32_t MemorySparseTable::Save_v2(const std::string &dirname,
           ++feasign_size;
           // save non 9008 slot's feasign
           if (_value_accessor->SaveFilterSlot(it.value().data())) {
-            if (0 != write_channel_for_slot_feature->write_line(
-                         paddle::string::format_string(
-                             "%lu %s", it.key(), format_value.c_str()))) {
+            if (save_binary) {
+              ret = binary_writer_for_slot_feature->Append(
+                  it.key(), value_buffer.data(), value_size);
+            } else {
+              ret = write_channel_for_slot_feature->write_line(
+                  paddle::string::format_string(
+                      "%lu %s", it.key(), format_value.c_str()));
+            }
+            if (0 != ret) {
               ++retry_num_for_slot_feature;
               is_write_failed_for_slot_feature = true;
               LOG(ERROR) << "MemorySparseTable save slot feature failed, retry "
@@ -626,6 +811,17 @@ int32_t MemorySparseTable::Save_v2(const std::string &dirname,
           }
         }
       }
+      if (save_binary) {
+        if (!is_write_failed && 0 != binary_writer->Finish()) {
+          ++retry_num;
+          is_write_failed = true;
+        }
+        if (!is_write_failed_for_slot_feature &&
+            0 != binary_writer_for_slot_feature->Finish()) {
+          ++retry_num_for_slot_feature;
+          is_write_failed_for_slot_feature = true;
+        }
+      }
       write_channel->close();
       write_channel_for_slot_feature->close();
       if (err_no == -1) {
@@ -682,7 +878,9 @@ int32_t MemorySparseTable::Save_v2(const std::string &dirname,
 }
 #endif
 
-int32_t MemorySparseTable::SavePatch(const std::string &path, int save_param) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::SavePatch(const std::string &path,
+                                                int save_param) {
   if (!_config.enable_revert()) {
     LOG(INFO) << "MemorySparseTable should be enabled revert.";
     return 0;
@@ -694,41 +892,60 @@ int32_t MemorySparseTable::SavePatch(const std::string &path, int save_param) {
   int thread_num = _m_real_local_shard_num < 20 ? _m_real_local_shard_num : 20;
 
   std::atomic<uint32_t> feasign_size_all{0};
+  bool save_binary = _config.save_binary_format();
 
   omp_set_num_threads(thread_num);
 #pragma omp parallel for schedule(dynamic)
   for (int i = 0; i < _m_real_local_shard_num; ++i) {
     FsChannelConfig channel_config = {};
-    channel_config.path = ::paddle::string::format_string("%s/part-%03d-%05d",
-                                                          table_path.c_str(),
-                                                          _shard_idx,
-                                                          file_start_idx + i);
-
-    channel_config.converter = _value_accessor->Converter(save_param).converter;
-    channel_config.deconverter =
-        _value_accessor->Converter(save_param).deconverter;
+    channel_config.path = ::paddle::string::format_string(
+        "%s/part-%03d-%05d%s",
+        table_path.c_str(),
+        _shard_idx,
+        file_start_idx + i,
+        SparseShardFileSuffix(save_binary, false).c_str());
+
+    if (!save_binary) {
+      channel_config.converter =
+          _value_accessor->Converter(save_param).converter;
+      channel_config.deconverter =
+          _value_accessor->Converter(save_param).deconverter;
+    }
 
     bool is_write_failed = false;
     int feasign_size = 0;
     int retry_num = 0;
     int err_no = 0;
+    std::vector<float> value_buffer(
+        _value_accessor->GetAccessorInfo().size / sizeof(float));
     do {
       err_no = 0;
       feasign_size = 0;
       is_write_failed = false;
       auto write_channel =
           _afs_client.open_w(channel_config, 1024 * 1024 * 40, &err_no);
+      std::unique_ptr<SparseBinaryShardWriter> binary_writer;
+      if (save_binary) {
+        binary_writer.reset(new SparseBinaryShardWriter(write_channel));
+      }
 
       for (int j = 0; j < _real_local_shard_num; ++j) {
         if (j % _m_real_local_shard_num == i) {
           auto &shard = _local_shards_patch_model[j];
           for (auto it = shard.begin(); it != shard.end(); ++it) {
             if (_value_accessor->Save(it.value().data(), save_param)) {
-              std::string format_value = _value_accessor->ParseToString(
-                  it.value().data(), it.value().size());
-              if (0 !=
-                  write_channel->write_line(::paddle::string::format_string(
-                      "%lu %s", it.key(), format_value.c_str()))) {
+              size_t value_size = ReadValue(it.value(), value_buffer.data());
+              int ret = 0;
+              if (save_binary) {
+                ret = binary_writer->Append(
+                    it.key(), value_buffer.data(), value_size);
+              } else {
+                std::string format_value = _value_accessor->ParseToString(
+                    value_buffer.data(), value_size);
+                ret = write_channel->write_line(::paddle::string::format_string(
+                    "%lu %s", it.key(), format_value.c_str()));
+              }
+              if (0 != ret) {
                 ++retry_num;
                 is_write_failed = true;
                 LOG(ERROR) << "MemorySparseTable save failed, retry it! path:"
@@ -742,6 +959,12 @@ int32_t MemorySparseTable::SavePatch(const std::string &path, int save_param) {
         }
         if (is_write_failed) break;
       }
+      if (!is_write_failed && save_binary && 0 != binary_writer->Finish()) {
+        ++retry_num;
+        is_write_failed = true;
+        LOG(ERROR) << "MemorySparseTable save failed, retry it! path:"
+                   << channel_config.path << " , retry_num=" << retry_num;
+      }
       write_channel->close();
       if (err_no == -1) {
         ++retry_num;
@@ -771,7 +994,8 @@ int32_t MemorySparseTable::SavePatch(const std::string &path, int save_param) {
   return 0;
 }
 
-int64_t MemorySparseTable::CacheShuffle(
+template <class SHARD>
+int64_t MemorySparseTableImpl<SHARD>::CacheShuffle(
     const std::string &path,
     const std::string &param,
     double cache_threshold,
@@ -792,6 +1016,21 @@ int64_t MemorySparseTable::CacheShuffle(
   LOG(INFO) << "Table>> shuffle node num is: " << shuffle_node_num;
   // TODO(zhaocaibei123): check shuffle_node_num <= server_node_num
   int thread_num = _real_local_shard_num < 20 ? _real_local_shard_num : 20;
+  bool save_binary = _config.save_binary_format();
+
+  // the tables share the shard type of this one, checked out of the omp loop
+  std::vector<MemorySparseTableImpl<SHARD> *> sparse_tables;
+  for (auto table_ptr : table_ptrs) {
+    auto *sparse_table =
+        dynamic_cast<MemorySparseTableImpl<SHARD> *>(table_ptr);
+    PADDLE_ENFORCE_NOT_NULL(
+        sparse_table,
+        common::errors::InvalidArgument(
+            "The tables of CacheShuffle should be of the same type as "
+            "table %d.",
+            _config.table_id()));
+    sparse_tables.push_back(sparse_table);
+  }
 
   std::vector<
       ::paddle::framework::ChannelWriter<std::pair<uint64_t, std::string>>>
@@ -814,16 +1053,29 @@ int64_t MemorySparseTable::CacheShuffle(
         &writer = writers[i];
     writer.Reset(tmp_channels[i].get());
 
-    for (auto table_ptr : table_ptrs) {
-      auto value_accessor = table_ptr->GetValueAccessor();
-      shard_type *shard_ptr = static_cast<shard_type *>(table_ptr->GetShard(i));
+    for (auto *sparse_table : sparse_tables) {
+      auto value_accessor = sparse_table->GetValueAccessor();
+      shard_type *shard_ptr =
+          static_cast<shard_type *>(sparse_table->GetShard(i));
+      std::vector<float> value_buffer(
+          value_accessor->GetAccessorInfo().size / sizeof(float));
 
       for (auto it = shard_ptr->begin(); it != shard_ptr->end(); ++it) {
         if (value_accessor->SaveCache(
                 it.value().data(), save_param, cache_threshold)) {
-          std::string format_value = value_accessor->ParseToString(
-              it.value().data(), it.value().size());
-          std::pair<uint64_t, std::string> pkv(it.key(), format_value.c_str());
+          size_t value_size =
+              sparse_table->ReadValue(it.value(), value_buffer.data());
+          std::pair<uint64_t, std::string> pkv;
+          pkv.first = it.key();
+          if (save_binary) {
+            // raw values, written as is by SaveCache
+            pkv.second.assign(
+                reinterpret_cast<const char *>(value_buffer.data()),
+                value_size * sizeof(float));
+          } else {
+            pkv.second = value_accessor->ParseToString(value_buffer.data(),
+                                                       value_size);
+          }
           writer << pkv;
           ++feasign_size;
         }
@@ -884,7 +1136,8 @@ int64_t MemorySparseTable::CacheShuffle(
   return 0;
 }
 
-int32_t MemorySparseTable::SaveCache(
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::SaveCache(
     const std::string &path,
     const std::string &param,
     ::paddle::framework::Channel<std::pair<uint64_t, std::string>>
@@ -896,24 +1149,44 @@ int32_t MemorySparseTable::SaveCache(
   std::string table_path = ::paddle::string::format_string(
       "%s/%03d_cache/", path.c_str(), _config.table_id());
   _afs_client.remove(::paddle::string::format_string(
-      "%s/part-%03d", table_path.c_str(), _shard_idx));
+      "%s/part-%03d*", table_path.c_str(), _shard_idx));
   uint32_t feasign_size = 0;
+  // values in shuffled_channel are raw floats, see CacheShuffle
+  bool save_binary = _config.save_binary_format();
   FsChannelConfig channel_config = {};
   // not compress cache model
   channel_config.path = ::paddle::string::format_string(
-      "%s/part-%03d", table_path.c_str(), _shard_idx);
-  channel_config.converter = _value_accessor->Converter(save_param).converter;
-  channel_config.deconverter =
-      _value_accessor->Converter(save_param).deconverter;
+      "%s/part-%03d%s",
+      table_path.c_str(),
+      _shard_idx,
+      SparseShardFileSuffix(save_binary, false).c_str());
+  if (!save_binary) {
+    channel_config.converter = _value_accessor->Converter(save_param).converter;
+    channel_config.deconverter =
+        _value_accessor->Converter(save_param).deconverter;
+  }
   auto write_channel = _afs_client.open_w(channel_config, 1024 * 1024 * 40);
+  std::unique_ptr<SparseBinaryShardWriter> binary_writer;
+  if (save_binary) {
+    binary_writer.reset(new SparseBinaryShardWriter(write_channel));
+  }
   std::vector<std::pair<uint64_t, std::string>> data;
   bool is_write_failed = false;
   shuffled_channel->Close();
   while (shuffled_channel->Read(data)) {
     for (auto &t : data) {
       ++feasign_size;
-      if (0 != write_channel->write_line(::paddle::string::format_string(
-                   "%lu %s", t.first, t.second.c_str()))) {
+      int ret = 0;
+      if (save_binary) {
+        ret = binary_writer->Append(t.first,
+                                    reinterpret_cast<const float *>(
+                                        t.second.data()),
+                                    t.second.size() / sizeof(float));
+      } else {
+        ret = write_channel->write_line(::paddle::string::format_string(
+            "%lu %s", t.first, t.second.c_str()));
+      }
+      if (0 != ret) {
         LOG(ERROR) << "Cache Table save failed, "
                       "path:"
                    << channel_config.path << ", retry it!";
@@ -923,6 +1196,10 @@ int32_t MemorySparseTable::SaveCache(
     }
     data = std::vector<std::pair<uint64_t, std::string>>();
   }
+  if (!is_write_failed && save_binary && 0 != binary_writer->Finish()) {
+    LOG(ERROR) << "Cache Table save failed, path:" << channel_config.path;
+    is_write_failed = true;
+  }
   if (is_write_failed) {
     _afs_client.remove(channel_config.path);
   }
@@ -933,7 +1210,8 @@ int32_t MemorySparseTable::SaveCache(
   return feasign_size;
 }
 
-int64_t MemorySparseTable::LocalSize() {
+template <class SHARD>
+int64_t MemorySparseTableImpl<SHARD>::LocalSize() {
   int64_t local_size = 0;
   for (int i = 0; i < _real_local_shard_num; ++i) {
     local_size += _local_shards[i].size();
@@ -941,7 +1219,8 @@ int64_t MemorySparseTable::LocalSize() {
   return local_size;
 }
 
-int64_t MemorySparseTable::LocalMFSize() {
+template <class SHARD>
+int64_t MemorySparseTableImpl<SHARD>::LocalMFSize() {
   std::vector<int64_t> size_arr(_real_local_shard_num, 0);
   std::vector<std::future<int>> tasks(_real_local_shard_num);
   int64_t ret_size = 0;
@@ -968,13 +1247,15 @@ int64_t MemorySparseTable::LocalMFSize() {
   return ret_size;
 }
 
-std::pair<int64_t, int64_t> MemorySparseTable::PrintTableStat() {
+template <class SHARD>
+std::pair<int64_t, int64_t> MemorySparseTableImpl<SHARD>::PrintTableStat() {
   int64_t feasign_size = LocalSize();
   int64_t mf_size = LocalMFSize();
   return {feasign_size, mf_size};
 }
 
-int32_t MemorySparseTable::Pull(TableContext &context) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::Pull(TableContext &context) {
   PADDLE_ENFORCE_EQ(
       context.value_type,
       Sparse,
@@ -993,7 +1274,8 @@ int32_t MemorySparseTable::Pull(TableContext &context) {
   }
 }
 
-int32_t MemorySparseTable::Push(TableContext &context) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::Push(TableContext &context) {
   PADDLE_ENFORCE_EQ(
       context.value_type,
       Sparse,
@@ -1010,11 +1292,10 @@ int32_t MemorySparseTable::Push(TableContext &context) {
   }
 }
 
-int32_t MemorySparseTable::PullSparse(float *pull_values,
-                                      const PullSparseValue &pull_value) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::PullSparse(
+    float *pull_values, const PullSparseValue &pull_value) {
   CostTimer timer("pserver_sparse_select_all");
-  std::vector<std::future<int>> tasks(_real_local_shard_num);
-
   const size_t value_size =
       _value_accessor->GetAccessorInfo().size / sizeof(float);
   size_t mf_value_size =
@@ -1023,31 +1304,27 @@ int32_t MemorySparseTable::PullSparse(float *pull_values,
       _value_accessor->GetAccessorInfo().select_size / sizeof(float);
   // std::atomic<uint32_t> missed_keys{0};
 
-  std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
-      _real_local_shard_num);
-  size_t num = pull_value.numel_;
-  for (size_t i = 0; i < num; ++i) {
-    int shard_id = (pull_value.feasigns_[i] % _sparse_table_shard_num) %
-                   _avg_local_shard_num;
-    task_keys[shard_id].push_back({pull_value.feasigns_[i], i});
-  }
-  for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
-    tasks[shard_id] =
-        _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
+  std::vector<std::vector<std::pair<uint64_t, int>>> task_keys;
+  SplitTaskKeys(pull_value.feasigns_, pull_value.numel_, &task_keys);
+  std::vector<std::future<int>> tasks(task_keys.size());
+  for (size_t task_id = 0; task_id < task_keys.size(); ++task_id) {
+    tasks[task_id] =
+        _shards_task_pool[task_id % _shards_task_pool.size()]->enqueue(
             [this,
-             shard_id,
+             task_id,
              &task_keys,
              value_size,
              pull_values,
              mf_value_size,
              select_value_size]() -> int {
-              auto &local_shard = _local_shards[shard_id];
               float data_buffer[value_size];  // NOLINT
               float *data_buffer_ptr = data_buffer;
 
-              auto &keys = task_keys[shard_id];
+              auto &keys = task_keys[task_id];
               for (auto &item : keys) {
                 uint64_t key = item.first;
+                auto &local_shard = _local_shards[LocalShardId(key)];
+                auto value_lock = LockValue(local_shard, key);
                 auto itr = local_shard.find(key);
                 size_t data_size = value_size - mf_value_size;
                 if (itr == local_shard.end()) {
@@ -1063,10 +1340,7 @@ int32_t MemorySparseTable::PullSparse(float *pull_values,
                         data_ptr, data_buffer_ptr, data_size * sizeof(float));
                   }
                 } else {
-                  data_size = itr.value().size();
-                  memcpy(data_buffer_ptr,
-                         itr.value().data(),
-                         data_size * sizeof(float));
+                  data_size = ReadValue(itr.value(), data_buffer_ptr);
                 }
                 for (size_t mf_idx = data_size; mf_idx < value_size; ++mf_idx) {
                   data_buffer[mf_idx] = 0.0;
@@ -1087,39 +1361,42 @@ int32_t MemorySparseTable::PullSparse(float *pull_values,
   return 0;
 }
 
-int32_t MemorySparseTable::PullSparsePtr(int shard_id,  // fake num
-                                         char **pull_values,
-                                         const uint64_t *keys,
-                                         size_t num,
-                                         uint16_t pass_id) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::PullSparsePtr(int shard_id,  // fake num
+                                                    char **pull_values,
+                                                    const uint64_t *keys,
+                                                    size_t num,
+                                                    uint16_t pass_id) {
   CostTimer timer("pscore_sparse_select_all");
+  PADDLE_ENFORCE_EQ(_value_codec.Enabled(),
+                    false,
+                    common::errors::Unimplemented(
+                        "PullSparsePtr does not support the compact "
+                        "sparse_value_type."));
   size_t value_size = _value_accessor->GetAccessorInfo().size / sizeof(float);
   size_t mf_value_size =
       _value_accessor->GetAccessorInfo().mf_size / sizeof(float);
 
-  std::vector<std::future<int>> tasks(_real_local_shard_num);
-  std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
-      _real_local_shard_num);
-  for (size_t i = 0; i < num; ++i) {
-    int shard_id = (keys[i] % _sparse_table_shard_num) % _avg_local_shard_num;
-    task_keys[shard_id].push_back({keys[i], i});
-  }
+  std::vector<std::vector<std::pair<uint64_t, int>>> task_keys;
+  SplitTaskKeys(keys, num, &task_keys);
+  std::vector<std::future<int>> tasks(task_keys.size());
   // std::atomic<uint32_t> missed_keys{0};
-  for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
-    tasks[shard_id] =
-        _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
+  for (size_t task_id = 0; task_id < task_keys.size(); ++task_id) {
+    tasks[task_id] =
+        _shards_task_pool[task_id % _shards_task_pool.size()]->enqueue(
             [this,
-             shard_id,
+             task_id,
              &task_keys,
              pull_values,
              value_size,
              mf_value_size]() -> int {
-              auto &keys = task_keys[shard_id];
-              auto &local_shard = _local_shards[shard_id];
+              auto &keys = task_keys[task_id];
               float data_buffer[value_size];  // NOLINT
               float *data_buffer_ptr = data_buffer;
               for (auto &item : keys) {
                 uint64_t key = item.first;
+                auto &local_shard = _local_shards[LocalShardId(key)];
+                auto value_lock = LockValue(local_shard, key);
                 auto itr = local_shard.find(key);
                 size_t data_size = value_size - mf_value_size;
                 FixedFeatureValue *ret = NULL;
@@ -1146,17 +1423,14 @@ int32_t MemorySparseTable::PullSparsePtr(int shard_id,  // fake num
   return 0;
 }
 
-int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
-                                      const float *values,
-                                      size_t num) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::PushSparse(const uint64_t *keys,
+                                                 const float *values,
+                                                 size_t num) {
   CostTimer timer("pserver_sparse_update_all");
-  std::vector<std::future<int>> tasks(_real_local_shard_num);
-  std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
-      _real_local_shard_num);
-  for (size_t i = 0; i < num; ++i) {
-    int shard_id = (keys[i] % _sparse_table_shard_num) % _avg_local_shard_num;
-    task_keys[shard_id].push_back({keys[i], i});
-  }
+  std::vector<std::vector<std::pair<uint64_t, int>>> task_keys;
+  SplitTaskKeys(keys, num, &task_keys);
+  std::vector<std::future<int>> tasks(task_keys.size());
 
   const size_t value_col =
       _value_accessor->GetAccessorInfo().size / sizeof(float);
@@ -1165,23 +1439,27 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
   size_t update_value_col =
       _value_accessor->GetAccessorInfo().update_size / sizeof(float);
 
-  for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
-    tasks[shard_id] = _shards_task_pool[shard_id % _task_pool_size]->enqueue(
+  for (size_t task_id = 0; task_id < task_keys.size(); ++task_id) {
+    tasks[task_id] = _shards_task_pool[task_id % _task_pool_size]->enqueue(
         [this,
-         shard_id,
+         task_id,
          value_col,
          mf_value_col,
          update_value_col,
          values,
          &task_keys]() -> int {
-          auto &keys = task_keys[shard_id];
-          auto &local_shard = _local_shards[shard_id];
-          auto &local_shard_new = _local_shards_new[shard_id];
+          auto &keys = task_keys[task_id];
           float data_buffer[value_col];  // NOLINT
           float *data_buffer_ptr = data_buffer;
+          UpdateBatch update_batch(
+              _value_accessor.get(),
+              !shard_type::kConcurrent && !_config.enable_revert());
           for (auto &item : keys) {
             uint64_t key = item.first;
             uint64_t push_data_idx = item.second;
+            int shard_id = LocalShardId(key);
+            auto &local_shard = _local_shards[shard_id];
+            auto value_lock = LockValue(local_shard, key);
             const float *update_data =
                 values + push_data_idx * update_value_col;
             auto itr = local_shard.find(key);
@@ -1204,8 +1482,11 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
             float *value_data = feature_value.data();
             size_t value_size = feature_value.size();
 
-            if (value_size == value_col) {  // 已拓展到最大size, 则就地update
-              _value_accessor->Update(&value_data, &update_data, 1);
+            if (_value_codec.Enabled()) {
+              UpdateCompactValue(&feature_value, update_data);
+            } else if (value_size == value_col) {
+              // 已拓展到最大size, 则就地update
+              update_batch.Add(value_data, update_data);
             } else {
               // 拷入buffer区进行update，然后再回填，不需要的mf则回填时抛弃了
               memcpy(data_buffer_ptr, value_data, value_size * sizeof(float));
@@ -1219,11 +1500,12 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
               memcpy(value_data, data_buffer_ptr, value_size * sizeof(float));
             }
             if (_config.enable_revert()) {
-              FixedFeatureValue *feature_value_new = &(local_shard_new[key]);
+              FixedFeatureValue *feature_value_new =
+                  &(_local_shards_new[shard_id][key]);
               auto new_size = feature_value.size();
               feature_value_new->resize(new_size);
               memcpy(feature_value_new->data(),
-                     value_data,
+                     feature_value.data(),
                      new_size * sizeof(float));
             }
           }
@@ -1237,31 +1519,31 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
   return 0;
 }
 
-int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
-                                      const float **values,
-                                      size_t num) {
-  std::vector<std::future<int>> tasks(_real_local_shard_num);
-  std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
-      _real_local_shard_num);
-  for (size_t i = 0; i < num; ++i) {
-    int shard_id = (keys[i] % _sparse_table_shard_num) % _avg_local_shard_num;
-    task_keys[shard_id].push_back({keys[i], i});
-  }
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::PushSparse(const uint64_t *keys,
+                                                 const float **values,
+                                                 size_t num) {
+  std::vector<std::vector<std::pair<uint64_t, int>>> task_keys;
+  SplitTaskKeys(keys, num, &task_keys);
+  std::vector<std::future<int>> tasks(task_keys.size());
 
   size_t value_col = _value_accessor->GetAccessorInfo().size / sizeof(float);
   size_t mf_value_col =
       _value_accessor->GetAccessorInfo().mf_size / sizeof(float);
 
-  for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
-    tasks[shard_id] = _shards_task_pool[shard_id % _task_pool_size]->enqueue(
-        [this, shard_id, value_col, mf_value_col, values, &task_keys]() -> int {
-          auto &keys = task_keys[shard_id];
-          auto &local_shard = _local_shards[shard_id];
+  for (size_t task_id = 0; task_id < task_keys.size(); ++task_id) {
+    tasks[task_id] = _shards_task_pool[task_id % _task_pool_size]->enqueue(
+        [this, task_id, value_col, mf_value_col, values, &task_keys]() -> int {
+          auto &keys = task_keys[task_id];
           float data_buffer[value_col];  // NOLINT
           float *data_buffer_ptr = data_buffer;
+          UpdateBatch update_batch(_value_accessor.get(),
+                                   !shard_type::kConcurrent);
           for (auto &item : keys) {
             uint64_t key = item.first;
             uint64_t push_data_idx = item.second;
+            auto &local_shard = _local_shards[LocalShardId(key)];
+            auto value_lock = LockValue(local_shard, key);
             const float *update_data = values[push_data_idx];
             auto itr = local_shard.find(key);
             if (itr == local_shard.end()) {
@@ -1281,8 +1563,11 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
             auto &feature_value = itr.value();
             float *value_data = feature_value.data();
             size_t value_size = feature_value.size();
-            if (value_size == value_col) {  // 已拓展到最大size, 则就地update
-              _value_accessor->Update(&value_data, &update_data, 1);
+            if (_value_codec.Enabled()) {
+              UpdateCompactValue(&feature_value, update_data);
+            } else if (value_size == value_col) {
+              // 已拓展到最大size, 则就地update
+              update_batch.Add(value_data, update_data);
             } else {
               // 拷入buffer区进行update，然后再回填，不需要的mf则回填时抛弃了
               memcpy(data_buffer_ptr, value_data, value_size * sizeof(float));
@@ -1305,9 +1590,91 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
   return 0;
 }
 
-int32_t MemorySparseTable::Flush() { return 0; }
+template <class SHARD>
+size_t MemorySparseTableImpl<SHARD>::ReadValue(FixedFeatureValue &value,
+                                               float *buffer) {
+  if (!_value_codec.Enabled()) {
+    memcpy(buffer, value.data(), value.size() * sizeof(float));
+    return value.size();
+  }
+  return _value_codec.Decode(value.data(), value.size(), buffer);
+}
+
+template <class SHARD>
+void MemorySparseTableImpl<SHARD>::WriteValue(FixedFeatureValue *value,
+                                              const float *data,
+                                              size_t size) {
+  if (!_value_codec.Enabled()) {
+    value->resize(size);
+    if (value->data() != data) {
+      memcpy(value->data(), data, size * sizeof(float));
+    }
+    return;
+  }
+  thread_local std::vector<float> encode_buffer;
+  encode_buffer.resize(size + SparseValueCodec::kMaxExtraSize);
+  size_t encoded_size = _value_codec.Encode(data, size, encode_buffer.data());
+  value->resize(encoded_size);
+  memcpy(value->data(), encode_buffer.data(), encoded_size * sizeof(float));
+  // a value parsed in place, as the text Load does, has the capacity of its
+  // fp32 floats
+  value->shrink_to_fit();
+}
 
-int32_t MemorySparseTable::Shrink(const std::string &param) {
+template <class SHARD>
+void MemorySparseTableImpl<SHARD>::UpdateCompactValue(
+    FixedFeatureValue *value, const float *update_data) {
+  size_t value_col = _value_accessor->GetAccessorInfo().size / sizeof(float);
+  thread_local std::vector<float> data_buffer;
+  thread_local std::vector<float> create_buffer;
+  data_buffer.resize(value_col);
+  float *data_buffer_ptr = data_buffer.data();
+  size_t value_size = ReadValue(*value, data_buffer_ptr);
+  _value_accessor->Update(&data_buffer_ptr, &update_data, 1);
+  if (value_size != value_col &&
+      _value_accessor->NeedExtendMF(data_buffer_ptr)) {
+    // the same as the fp32 path: create the mf part, keep the updated fields
+    create_buffer.resize(value_col);
+    float *create_buffer_ptr = create_buffer.data();
+    _value_accessor->Create(&create_buffer_ptr, 1);
+    memcpy(create_buffer_ptr, data_buffer_ptr, value_size * sizeof(float));
+    WriteValue(value, create_buffer_ptr, value_col);
+  } else {
+    WriteValue(value, data_buffer_ptr, value_size);
+  }
+}
+
+template <class SHARD>
+void MemorySparseTableImpl<SHARD>::SplitTaskKeys(
+    const uint64_t *keys,
+    size_t num,
+    std::vector<std::vector<std::pair<uint64_t, int>>> *task_keys) {
+  if constexpr (shard_type::kConcurrent) {
+    // contiguous ranges of keys, at least 64 keys per task
+    size_t task_num = std::min(_shards_task_pool.size(), (num + 63) / 64);
+    task_keys->resize(task_num);
+    for (size_t task_id = 0; task_id < task_num; ++task_id) {
+      size_t begin = num * task_id / task_num;
+      size_t end = num * (task_id + 1) / task_num;
+      auto &task = (*task_keys)[task_id];
+      task.reserve(end - begin);
+      for (size_t i = begin; i < end; ++i) {
+        task.push_back({keys[i], i});
+      }
+    }
+  } else {
+    task_keys->resize(_real_local_shard_num);
+    for (size_t i = 0; i < num; ++i) {
+      (*task_keys)[LocalShardId(keys[i])].push_back({keys[i], i});
+    }
+  }
+}
+
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::Flush() { return 0; }
+
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::Shrink(const std::string &param) {
   VLOG(0) << "MemorySparseTable::Shrink";
   std::atomic<uint32_t> shrink_size_all{0};
   int thread_num = _real_local_shard_num;
@@ -1332,6 +1699,12 @@ int32_t MemorySparseTable::Shrink(const std::string &param) {
   return 0;
 }
 
-void MemorySparseTable::Clear() { VLOG(0) << "clear coming soon"; }
+template <class SHARD>
+void MemorySparseTableImpl<SHARD>::Clear() { VLOG(0) << "clear coming soon"; }
+
+template class MemorySparseTableImpl<
+    SparseTableShard<uint64_t, FixedFeatureValue>>;
+template class MemorySparseTableImpl<
+    ConcurrentSparseTableShard<uint64_t, FixedFeatureValue>>;
 
 }  // namespace paddle::distributed
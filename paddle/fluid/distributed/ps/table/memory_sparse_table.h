@@ -28,7 +28,9 @@
 #include "Eigen/Dense"
 #include "paddle/fluid/distributed/ps/table/accessor.h"
 #include "paddle/fluid/distributed/ps/table/common_table.h"
+#include "paddle/fluid/distributed/ps/table/depends/concurrent_table_shard.h"
 #include "paddle/fluid/distributed/ps/table/depends/feature_value.h"
+#include "paddle/fluid/distributed/ps/table/depends/sparse_value_codec.h"
 #include "paddle/utils/string/string_helper.h"
 
 #define PSERVER_SAVE_SUFFIX ".shard"
@@ -36,11 +38,15 @@
 namespace paddle {
 namespace distributed {
 
-class MemorySparseTable : public Table {
+// SHARD is SparseTableShard, of which each shard is accessed by its own task
+// thread, or ConcurrentSparseTableShard, whose keys are spread evenly over the
+// task pool regardless of their shard.
+template <class SHARD>
+class MemorySparseTableImpl : public Table {
  public:
-  typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
-  MemorySparseTable() {}
-  virtual ~MemorySparseTable() {}
+  typedef SHARD shard_type;
+  MemorySparseTableImpl() {}
+  virtual ~MemorySparseTableImpl() {}
 
   // unused method end
   static int32_t sparse_local_shard_num(uint32_t shard_num,
@@ -119,6 +125,32 @@ class MemorySparseTable : public Table {
   virtual int32_t LoadPatch(const std::vector<std::string>& file_list,
                             int save_param);
 
+  // With TableParameter.sparse_value_type, values are stored encoded by
+  // _value_codec. ReadValue decodes value into buffer and returns its size,
+  // WriteValue encodes data into value.
+  size_t ReadValue(FixedFeatureValue& value, float* buffer);  // NOLINT
+  void WriteValue(FixedFeatureValue* value, const float* data, size_t size);
+  // Applies update_data to an encoded value.
+  void UpdateCompactValue(FixedFeatureValue* value, const float* update_data);
+
+  // Splits keys into the tasks of a pull/push, keeping their index.
+  void SplitTaskKeys(
+      const uint64_t* keys,
+      size_t num,
+      std::vector<std::vector<std::pair<uint64_t, int>>>* task_keys);
+  int LocalShardId(uint64_t key) const {
+    return (key % _sparse_table_shard_num) % _avg_local_shard_num;
+  }
+  // Locks the value of key if the shard may be accessed concurrently.
+  std::unique_lock<ShardValueLock> LockValue(shard_type& shard,  // NOLINT
+                                             uint64_t key) {
+    if constexpr (shard_type::kConcurrent) {
+      return std::unique_lock<ShardValueLock>(shard.ValueLock(key));
+    } else {
+      return std::unique_lock<ShardValueLock>();
+    }
+  }
+
   int _task_pool_size = 24;
   int _avg_local_shard_num;
   int _real_local_shard_num;
@@ -137,7 +169,23 @@ class MemorySparseTable : public Table {
   std::unique_ptr<shard_type[]> _local_shards_patch_model;
   std::thread _save_patch_model_thread;
   bool _use_gpu_graph = false;
+  SparseValueCodec _value_codec;
 };
 
+extern template class MemorySparseTableImpl<
+    SparseTableShard<uint64_t, FixedFeatureValue>>;
+extern template class MemorySparseTableImpl<
+    ConcurrentSparseTableShard<uint64_t, FixedFeatureValue>>;
+
+class MemorySparseTable
+    : public MemorySparseTableImpl<
+          SparseTableShard<uint64_t, FixedFeatureValue>> {};
+
+// Pull/push of ConcurrentMemorySparseTable use all the task threads even if
+// the keys are skewed to a few shards.
+class ConcurrentMemorySparseTable
+    : public MemorySparseTableImpl<
+          ConcurrentSparseTableShard<uint64_t, FixedFeatureValue>> {};
+
 }  // namespace distributed
 }  // namespace paddle
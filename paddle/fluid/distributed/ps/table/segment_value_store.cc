@@ -0,0 +1,613 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/segment_value_store.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "glog/logging.h"
+#include "paddle/common/enforce.h"
+
+namespace paddle::distributed {
+
+namespace {
+
+// A record is the key, the value size and the value.
+constexpr size_t kHeaderSize = sizeof(uint64_t) + sizeof(uint32_t);
+// The bytes read at once by the iterators and the compaction.
+constexpr size_t kWindowBytes = 4 * 1024 * 1024;
+
+// Reads up to len bytes at offset, and returns the bytes read.
+size_t ReadAt(int fd, char* buf, size_t len, uint64_t offset) {
+  size_t done = 0;
+  while (done < len) {
+    ssize_t ret = pread(fd, buf + done, len - done, offset + done);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    PADDLE_ENFORCE_GE(
+        ret,
+        0,
+        common::errors::Unavailable("Failed to read the ssd segment, %s.",
+                                    strerror(errno)));
+    if (ret == 0) {
+      break;
+    }
+    done += ret;
+  }
+  return done;
+}
+
+void WriteAt(int fd, const char* buf, size_t len, uint64_t offset) {
+  size_t done = 0;
+  while (done < len) {
+    ssize_t ret = pwrite(fd, buf + done, len - done, offset + done);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    PADDLE_ENFORCE_GT(
+        ret,
+        0,
+        common::errors::Unavailable("Failed to write the ssd segment, %s.",
+                                    strerror(errno)));
+    done += ret;
+  }
+}
+
+// Reads len bytes of indexed values at offset, which are all written.
+void ReadValues(int fd,
+                const std::string& path,
+                char* buf,
+                size_t len,
+                uint64_t offset) {
+  size_t done = ReadAt(fd, buf, len, offset);
+  PADDLE_ENFORCE_EQ(done,
+                    len,
+                    common::errors::Unavailable(
+                        "The ssd segment %s is truncated, read %d of %d bytes "
+                        "at offset %d.",
+                        path.c_str(),
+                        done,
+                        len,
+                        offset));
+}
+
+}  // namespace
+
+SegmentValueStore::Segment::Segment(const std::string& path, uint32_t id)
+    : path(path), id(id) {
+  fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  PADDLE_ENFORCE_GE(fd,
+                    0,
+                    common::errors::Unavailable(
+                        "Failed to open the ssd segment %s, %s.",
+                        path.c_str(),
+                        strerror(errno)));
+}
+
+SegmentValueStore::Segment::~Segment() { close(fd); }
+
+// Reads the values of one column through a window of the segment, so the
+// values sorted by offset are read sequentially.
+class SegmentValueStore::Reader {
+ public:
+  const char* Read(const std::shared_ptr<Segment>& segment,
+                   const Location& loc) {
+    if (segment != _segment || loc.offset < _begin ||
+        loc.offset + loc.size > _begin + _window.size()) {
+      _window.resize(std::max<size_t>(kWindowBytes, loc.size));
+      size_t len =
+          ReadAt(segment->fd, _window.data(), _window.size(), loc.offset);
+      PADDLE_ENFORCE_GE(len,
+                        loc.size,
+                        common::errors::Unavailable(
+                            "The ssd segment %s is truncated.",
+                            segment->path.c_str()));
+      _window.resize(len);
+      _segment = segment;
+      _begin = loc.offset;
+    }
+    return _window.data() + (loc.offset - _begin);
+  }
+
+ private:
+  std::shared_ptr<Segment> _segment;
+  uint64_t _begin = 0;
+  std::vector<char> _window;
+};
+
+// Iterates a snapshot of the index in the order of the segments, so the
+// column can be updated while it is iterated, as SSDSparseTable::Shrink does.
+class SegmentValueStore::Iterator : public SSDValueIterator {
+ public:
+  Iterator(std::vector<std::pair<uint64_t, Location>> entries,
+           std::map<uint32_t, std::shared_ptr<Segment>> segments)
+      : _entries(std::move(entries)), _segments(std::move(segments)) {}
+
+  void SeekToFirst() override {
+    _pos = 0;
+    Load();
+  }
+  bool Valid() const override { return _pos < _entries.size(); }
+  void Next() override {
+    ++_pos;
+    Load();
+  }
+  std::string_view key() const override {
+    const uint64_t* key = &_entries[_pos].first;
+    return std::string_view(reinterpret_cast<const char*>(key),
+                            sizeof(uint64_t));
+  }
+  std::string_view value() const override {
+    return std::string_view(_value, _entries[_pos].second.size);
+  }
+
+ private:
+  void Load() {
+    if (Valid()) {
+      const Location& loc = _entries[_pos].second;
+      _value = _reader.Read(_segments.at(loc.segment), loc);
+    }
+  }
+
+  std::vector<std::pair<uint64_t, Location>> _entries;
+  std::map<uint32_t, std::shared_ptr<Segment>> _segments;
+  Reader _reader;
+  size_t _pos = 0;
+  const char* _value = nullptr;
+};
+
+SegmentValueStore::SegmentValueStore(const Options& options)
+    : _options(options) {}
+
+SegmentValueStore::~SegmentValueStore() {
+  {
+    std::lock_guard<std::mutex> lock(_gc_mutex);
+    _gc_stop = true;
+  }
+  _gc_cv.notify_all();
+  if (_gc_thread.joinable()) {
+    _gc_thread.join();
+  }
+}
+
+int SegmentValueStore::initialize(const std::string& db_path,
+                                  const int colnum) {
+  VLOG(0) << "segment store path: " << db_path << " colnum: " << colnum;
+  _columns.clear();
+  for (int i = 0; i < colnum; ++i) {
+    auto column = std::make_unique<Column>();
+    column->path = db_path + "_" + std::to_string(i);
+    std::string rm_cmd = "rm -rf " + column->path;
+    system(rm_cmd.c_str());
+    PADDLE_ENFORCE_EQ(mkdir(column->path.c_str(), 0755),
+                      0,
+                      common::errors::Unavailable(
+                          "Failed to create the ssd directory %s, %s.",
+                          column->path.c_str(),
+                          strerror(errno)));
+    RollSegment(column.get());
+    _columns.emplace_back(std::move(column));
+  }
+  if (!_gc_thread.joinable()) {
+    _gc_thread = std::thread([this] { GcLoop(); });
+  }
+  return 0;
+}
+
+void SegmentValueStore::RollSegment(Column* column) {
+  uint32_t id = column->next_segment++;
+  char name[32];
+  snprintf(name, sizeof(name), "/segment-%06u.log", id);
+  column->active = std::make_shared<Segment>(column->path + name, id);
+  column->segments[id] = column->active;
+}
+
+void SegmentValueStore::DropLocked(Column* column, const Location& loc) {
+  auto it = column->segments.find(loc.segment);
+  if (it != column->segments.end()) {
+    it->second->live_bytes -= kHeaderSize + loc.size;
+  }
+}
+
+void SegmentValueStore::Append(Column* column,
+                               size_t num,
+                               const uint64_t* keys,
+                               const char* const* values,
+                               const uint32_t* sizes,
+                               const Location* expected) {
+  if (num == 0) {
+    return;
+  }
+  thread_local std::vector<char> records;
+  records.clear();
+  for (size_t i = 0; i < num; ++i) {
+    const char* key = reinterpret_cast<const char*>(&keys[i]);
+    const char* size = reinterpret_cast<const char*>(&sizes[i]);
+    records.insert(records.end(), key, key + sizeof(uint64_t));
+    records.insert(records.end(), size, size + sizeof(uint32_t));
+    records.insert(records.end(), values[i], values[i] + sizes[i]);
+  }
+
+  std::shared_ptr<Segment> segment;
+  uint64_t offset = 0;
+  {
+    std::lock_guard<std::mutex> lock(column->mutex);
+    if (column->active->size > 0 &&
+        column->active->size + records.size() > _options.segment_bytes) {
+      RollSegment(column);
+    }
+    segment = column->active;
+    offset = segment->size;
+    segment->size += records.size();
+    ++segment->writers;
+  }
+  // On a failed write the space stays reserved as garbage, and the segment
+  // is not compacted any more.
+  WriteAt(segment->fd, records.data(), records.size(), offset);
+
+  std::lock_guard<std::mutex> lock(column->mutex);
+  --segment->writers;
+  for (size_t i = 0; i < num; ++i) {
+    Location loc{segment->id, sizes[i], offset + kHeaderSize};
+    offset += kHeaderSize + sizes[i];
+    auto it = column->index.find(keys[i]);
+    if (expected != nullptr) {
+      // Updated or deleted during the compaction, the copy is garbage.
+      if (it == column->index.end() || !(it->second == expected[i])) {
+        continue;
+      }
+    }
+    if (it == column->index.end()) {
+      column->index.emplace(keys[i], loc);
+    } else {
+      DropLocked(column, it->second);
+      it->second = loc;
+    }
+    segment->live_bytes += kHeaderSize + sizes[i];
+  }
+}
+
+int SegmentValueStore::put(
+    int id, const char* key, int key_len, const char* value, int value_len) {
+  PADDLE_ENFORCE_EQ(static_cast<size_t>(key_len),
+                    sizeof(uint64_t),
+                    common::errors::InvalidArgument(
+                        "The key of the segment store must be uint64_t."));
+  uint64_t k = *reinterpret_cast<const uint64_t*>(key);
+  uint32_t size = value_len;
+  Append(_columns[id].get(), 1, &k, &value, &size, nullptr);
+  return 0;
+}
+
+int SegmentValueStore::put_batch(
+    int id,
+    std::vector<std::pair<char*, int>>& ssd_keys,    // NOLINT
+    std::vector<std::pair<char*, int>>& ssd_values,  // NOLINT
+    int n) {
+  std::vector<uint64_t> keys(n);
+  std::vector<const char*> values(n);
+  std::vector<uint32_t> sizes(n);
+  for (int i = 0; i < n; ++i) {
+    PADDLE_ENFORCE_EQ(static_cast<size_t>(ssd_keys[i].second),
+                      sizeof(uint64_t),
+                      common::errors::InvalidArgument(
+                          "The key of the segment store must be uint64_t."));
+    keys[i] = *reinterpret_cast<uint64_t*>(ssd_keys[i].first);
+    values[i] = ssd_values[i].first;
+    sizes[i] = ssd_values[i].second;
+  }
+  Append(_columns[id].get(),
+         n,
+         keys.data(),
+         values.data(),
+         sizes.data(),
+         nullptr);
+  return 0;
+}
+
+int SegmentValueStore::get(int id,
+                           const char* key,
+                           int key_len,
+                           std::string& value) {  // NOLINT
+  uint64_t k = *reinterpret_cast<const uint64_t*>(key);
+  auto reads = Locate(_columns[id].get(), &k, 1);
+  if (reads.empty()) {
+    return 1;
+  }
+  value.resize(reads[0].loc.size);
+  const auto& segment = reads[0].segment;
+  ReadValues(segment->fd,
+             segment->path,
+             value.data(),
+             value.size(),
+             reads[0].loc.offset);
+  return 0;
+}
+
+std::vector<SegmentValueStore::Read> SegmentValueStore::Locate(
+    Column* column, const uint64_t* keys, size_t num) {
+  std::vector<Read> reads;
+  reads.reserve(num);
+  {
+    std::lock_guard<std::mutex> lock(column->mutex);
+    for (size_t i = 0; i < num; ++i) {
+      auto it = column->index.find(keys[i]);
+      if (it != column->index.end()) {
+        reads.push_back(
+            {i, it->second, column->segments.at(it->second.segment)});
+      }
+    }
+  }
+  std::sort(reads.begin(), reads.end(), [](const Read& a, const Read& b) {
+    return a.loc.segment < b.loc.segment ||
+           (a.loc.segment == b.loc.segment && a.loc.offset < b.loc.offset);
+  });
+  return reads;
+}
+
+void SegmentValueStore::multi_get(int id, SSDValueBatch* batch) {
+  size_t num = batch->keys.size();
+  auto reads = Locate(_columns[id].get(), batch->keys.data(), num);
+  batch->sizes.assign(num, 0);
+  size_t total = 0;
+  for (auto& read : reads) {
+    batch->sizes[read.pos] = read.loc.size;
+    total += read.loc.size;
+  }
+  batch->buffer.resize(total);
+  // The values are read straight into their place in the buffer.
+  batch->values.assign(num, nullptr);
+  std::vector<char*> dst(reads.size());
+  char* value = batch->buffer.data();
+  for (size_t i = 0; i < reads.size(); ++i) {
+    dst[i] = value;
+    batch->values[reads[i].pos] = value;
+    value += reads[i].loc.size;
+  }
+
+  // The values sorted by offset are read with one pread for each run of
+  // values no farther than read_gap_bytes apart.
+  thread_local std::vector<char> span;
+  for (size_t begin = 0; begin < reads.size();) {
+    size_t end = begin + 1;
+    uint64_t span_begin = reads[begin].loc.offset;
+    uint64_t span_end = span_begin + reads[begin].loc.size;
+    while (end < reads.size() &&
+           reads[end].loc.segment == reads[begin].loc.segment &&
+           reads[end].loc.offset <= span_end + _options.read_gap_bytes &&
+           reads[end].loc.offset + reads[end].loc.size - span_begin <=
+               kWindowBytes) {
+      span_end =
+          std::max(span_end, reads[end].loc.offset + reads[end].loc.size);
+      ++end;
+    }
+    const auto& segment = reads[begin].segment;
+    if (end - begin == 1) {
+      ReadValues(segment->fd,
+                 segment->path,
+                 dst[begin],
+                 reads[begin].loc.size,
+                 span_begin);
+    } else {
+      span.resize(span_end - span_begin);
+      ReadValues(
+          segment->fd, segment->path, span.data(), span.size(), span_begin);
+      for (size_t i = begin; i < end; ++i) {
+        memcpy(dst[i],
+               span.data() + (reads[i].loc.offset - span_begin),
+               reads[i].loc.size);
+      }
+    }
+    begin = end;
+  }
+}
+
+void SegmentValueStore::advise_will_need(int id,
+                                         const uint64_t* keys,
+                                         size_t num) {
+  auto reads = Locate(_columns[id].get(), keys, num);
+  for (size_t begin = 0; begin < reads.size();) {
+    size_t end = begin + 1;
+    uint64_t span_begin = reads[begin].loc.offset;
+    uint64_t span_end = span_begin + reads[begin].loc.size;
+    while (end < reads.size() &&
+           reads[end].loc.segment == reads[begin].loc.segment &&
+           reads[end].loc.offset <= span_end + _options.read_gap_bytes) {
+      span_end =
+          std::max(span_end, reads[end].loc.offset + reads[end].loc.size);
+      ++end;
+    }
+    posix_fadvise(reads[begin].segment->fd,
+                  span_begin,
+                  span_end - span_begin,
+                  POSIX_FADV_WILLNEED);
+    begin = end;
+  }
+}
+
+int SegmentValueStore::del_data(int id, const char* key, int key_len) {
+  uint64_t k = *reinterpret_cast<const uint64_t*>(key);
+  auto* column = _columns[id].get();
+  std::lock_guard<std::mutex> lock(column->mutex);
+  auto it = column->index.find(k);
+  if (it != column->index.end()) {
+    DropLocked(column, it->second);
+    column->index.erase(it);
+  }
+  return 0;
+}
+
+int SegmentValueStore::flush(int id) {
+  _gc_cv.notify_one();
+  return 0;
+}
+
+SSDValueIterator* SegmentValueStore::get_iterator(int id) {
+  auto* column = _columns[id].get();
+  std::vector<std::pair<uint64_t, Location>> entries;
+  std::map<uint32_t, std::shared_ptr<Segment>> segments;
+  {
+    std::lock_guard<std::mutex> lock(column->mutex);
+    entries.assign(column->index.begin(), column->index.end());
+    segments = column->segments;
+  }
+  std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+    return a.second.segment < b.second.segment ||
+           (a.second.segment == b.second.segment &&
+            a.second.offset < b.second.offset);
+  });
+  return new Iterator(std::move(entries), std::move(segments));
+}
+
+int SegmentValueStore::get_estimate_key_num(uint64_t& num_keys) {  // NOLINT
+  num_keys = 0;
+  for (auto& column : _columns) {
+    std::lock_guard<std::mutex> lock(column->mutex);
+    num_keys += column->index.size();
+  }
+  return 0;
+}
+
+void SegmentValueStore::CompactSegment(
+    Column* column, const std::shared_ptr<Segment>& segment) {
+  std::vector<std::pair<uint64_t, Location>> entries;
+  {
+    std::lock_guard<std::mutex> lock(column->mutex);
+    for (auto& item : column->index) {
+      if (item.second.segment == segment->id) {
+        entries.emplace_back(item);
+      }
+    }
+  }
+  std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+    return a.second.offset < b.second.offset;
+  });
+
+  Reader reader;
+  std::vector<char> buffer;
+  std::vector<uint64_t> keys;
+  std::vector<size_t> offsets;
+  std::vector<uint32_t> sizes;
+  std::vector<Location> expected;
+  auto append = [&]() {
+    std::vector<const char*> values;
+    for (auto offset : offsets) {
+      values.push_back(buffer.data() + offset);
+    }
+    Append(column,
+           keys.size(),
+           keys.data(),
+           values.data(),
+           sizes.data(),
+           expected.data());
+    buffer.clear();
+    keys.clear();
+    offsets.clear();
+    sizes.clear();
+    expected.clear();
+  };
+  for (auto& entry : entries) {
+    const char* value = reader.Read(segment, entry.second);
+    offsets.push_back(buffer.size());
+    buffer.insert(buffer.end(), value, value + entry.second.size);
+    keys.push_back(entry.first);
+    sizes.push_back(entry.second.size);
+    expected.push_back(entry.second);
+    if (buffer.size() >= kWindowBytes) {
+      append();
+    }
+  }
+  append();
+
+  {
+    std::lock_guard<std::mutex> lock(column->mutex);
+    column->segments.erase(segment->id);
+  }
+  // The iterators and the reads holding the segment still read it through
+  // the open file.
+  unlink(segment->path.c_str());
+  VLOG(1) << "compacted ssd segment " << segment->path << ", moved "
+          << entries.size() << " values";
+}
+
+uint64_t SegmentValueStore::Compact(int id) {
+  auto* column = _columns[id].get();
+  std::lock_guard<std::mutex> compact_lock(column->compact_mutex);
+  std::vector<std::shared_ptr<Segment>> segments;
+  {
+    std::lock_guard<std::mutex> lock(column->mutex);
+    for (auto& item : column->segments) {
+      auto& segment = item.second;
+      if (segment == column->active || segment->size == 0 ||
+          segment->writers > 0) {
+        continue;
+      }
+      double garbage = segment->size - segment->live_bytes;
+      if (garbage >= _options.gc_ratio * segment->size) {
+        segments.push_back(segment);
+      }
+    }
+  }
+  uint64_t reclaimed = 0;
+  for (auto& segment : segments) {
+    uint64_t live_bytes = 0;
+    {
+      std::lock_guard<std::mutex> lock(column->mutex);
+      live_bytes = segment->live_bytes;
+    }
+    CompactSegment(column, segment);
+    reclaimed += segment->size - live_bytes;
+  }
+  return reclaimed;
+}
+
+void SegmentValueStore::GcLoop() {
+  std::unique_lock<std::mutex> lock(_gc_mutex);
+  while (!_gc_stop) {
+    _gc_cv.wait_for(lock, std::chrono::milliseconds(_options.gc_interval_ms));
+    if (_gc_stop) {
+      break;
+    }
+    lock.unlock();
+    for (size_t i = 0; i < _columns.size(); ++i) {
+      Compact(i);
+    }
+    lock.lock();
+  }
+}
+
+uint64_t SegmentValueStore::DiskBytes(int id) {
+  auto* column = _columns[id].get();
+  std::lock_guard<std::mutex> lock(column->mutex);
+  uint64_t bytes = 0;
+  for (auto& item : column->segments) {
+    bytes += item.second->size;
+  }
+  return bytes;
+}
+
+size_t SegmentValueStore::SegmentNum(int id) {
+  auto* column = _columns[id].get();
+  std::lock_guard<std::mutex> lock(column->mutex);
+  return column->segments.size();
+}
+
+}  // namespace paddle::distributed
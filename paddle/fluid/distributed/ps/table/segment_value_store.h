@@ -0,0 +1,149 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/distributed/ps/table/depends/ssd_value_store.h"
+
+namespace paddle {
+namespace distributed {
+
+// Log structured SSDValueStore for the fixed width float rows of a sparse
+// table. The values of a column are appended to segment files, and an in
+// memory index maps a key to the segment and the offset of its value, so a
+// value is read with one pread and never merged like the levels of an LSM
+// tree. An overwritten or deleted value leaves garbage in its segment, and a
+// background thread rewrites the live values of the sealed segments whose
+// garbage ratio reaches gc_ratio and removes the segments.
+class SegmentValueStore : public SSDValueStore {
+ public:
+  struct Options {
+    size_t segment_bytes = 256 * 1024 * 1024;
+    double gc_ratio = 0.5;
+    int64_t gc_interval_ms = 10000;
+    // The reads of a multi_get closer than this are merged into one pread.
+    size_t read_gap_bytes = 64 * 1024;
+  };
+
+  explicit SegmentValueStore(const Options& options);
+  ~SegmentValueStore();
+
+  int initialize(const std::string& db_path, const int colnum) override;
+  int put(int id,
+          const char* key,
+          int key_len,
+          const char* value,
+          int value_len) override;
+  int put_batch(int id,
+                std::vector<std::pair<char*, int>>& ssd_keys,    // NOLINT
+                std::vector<std::pair<char*, int>>& ssd_values,  // NOLINT
+                int n) override;
+  int get(int id,
+          const char* key,
+          int key_len,
+          std::string& value) override;  // NOLINT
+  void multi_get(int id, SSDValueBatch* batch) override;
+  void advise_will_need(int id, const uint64_t* keys, size_t num) override;
+  int del_data(int id, const char* key, int key_len) override;
+  // Wakes up the compaction, the appended values are readable already.
+  int flush(int id) override;
+  SSDValueIterator* get_iterator(int id) override;
+  int get_estimate_key_num(uint64_t& num_keys) override;  // NOLINT
+
+  // Compacts the segments of column id over gc_ratio, and returns the bytes
+  // reclaimed.
+  uint64_t Compact(int id);
+  uint64_t DiskBytes(int id);
+  size_t SegmentNum(int id);
+
+ private:
+  struct Location {
+    uint32_t segment;
+    uint32_t size;
+    uint64_t offset;  // of the value in the segment
+    bool operator==(const Location& other) const {
+      return segment == other.segment && size == other.size &&
+             offset == other.offset;
+    }
+  };
+
+  struct Segment {
+    Segment(const std::string& path, uint32_t id);
+    ~Segment();
+    std::string path;
+    uint32_t id;
+    int fd;
+    uint64_t size = 0;  // including the appends being written
+    uint64_t live_bytes = 0;
+    // The appends whose records are being written, the segment is not
+    // compacted until they point the keys at their records.
+    uint32_t writers = 0;
+  };
+
+  struct Column {
+    std::mutex mutex;
+    // Serializes the compactions of the column.
+    std::mutex compact_mutex;
+    std::string path;
+    std::unordered_map<uint64_t, Location> index;
+    std::map<uint32_t, std::shared_ptr<Segment>> segments;
+    std::shared_ptr<Segment> active;
+    uint32_t next_segment = 0;
+  };
+
+  struct Read {
+    size_t pos;  // in the batch
+    Location loc;
+    std::shared_ptr<Segment> segment;
+  };
+
+  class Reader;
+  class Iterator;
+
+  // Appends the values and points the keys at them. With expected, a key is
+  // only moved if it is still at expected[i], as the compaction needs. The
+  // records are written without the column lock, between reserving their
+  // space and updating the index.
+  void Append(Column* column,
+              size_t num,
+              const uint64_t* keys,
+              const char* const* values,
+              const uint32_t* sizes,
+              const Location* expected);
+  void RollSegment(Column* column);
+  void DropLocked(Column* column, const Location& loc);
+  std::vector<Read> Locate(Column* column, const uint64_t* keys, size_t num);
+  void CompactSegment(Column* column, const std::shared_ptr<Segment>& segment);
+  void GcLoop();
+
+  Options _options;
+  std::vector<std::unique_ptr<Column>> _columns;
+  std::thread _gc_thread;
+  std::mutex _gc_mutex;
+  std::condition_variable _gc_cv;
+  bool _gc_stop = false;
+};
+
+}  // namespace distributed
+}  // namespace paddle
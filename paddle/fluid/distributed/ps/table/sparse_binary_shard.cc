@@ -0,0 +1,239 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/sparse_binary_shard.h"
+
+#include <xxhash.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "glog/logging.h"
+
+namespace paddle::distributed {
+
+namespace {
+
+constexpr uint32_t kFileMagic = 0x42535350;   // "PSSB"
+constexpr uint32_t kBlockMagic = 0x4B4C4253;  // "SBLK"
+constexpr uint32_t kEndMagic = 0x444E4553;    // "SEND"
+constexpr uint32_t kFormatVersion = 1;
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t version;
+};
+
+struct BlockHeader {
+  uint32_t magic;
+  uint32_t value_dim;
+  // number of keys of this block, or total number of keys for the EndBlock
+  uint64_t key_num;
+  uint64_t checksum;
+};
+
+// Reads num elements into vec, which grows as they are read, so that a
+// corrupted num in a pipe ends at the end of the data before all of it is
+// allocated.
+template <typename T>
+int ReadArray(FsReadChannel* channel, uint64_t num, std::vector<T>* vec) {
+  constexpr uint64_t kChunkNum = (1 << 20) / sizeof(T);
+  vec->clear();
+  while (vec->size() < num) {
+    size_t offset = vec->size();
+    size_t chunk_num = std::min(num - offset, kChunkNum);
+    vec->resize(offset + chunk_num);
+    int size = static_cast<int>(chunk_num * sizeof(T));
+    if (channel->read(reinterpret_cast<char*>(vec->data() + offset), size) !=
+        size) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+uint64_t BlockChecksum(const SparseBinaryBlock& block) {
+  uint64_t seed = XXH64(
+      block.keys.data(), block.keys.size() * sizeof(uint64_t), kFormatVersion);
+  return XXH64(
+      block.values.data(), block.values.size() * sizeof(float), seed);
+}
+
+}  // namespace
+
+SparseBinaryShardWriter::SparseBinaryShardWriter(
+    std::shared_ptr<FsWriteChannel> channel, size_t block_key_num)
+    : channel_(std::move(channel)),
+      block_key_num_(block_key_num == 0 ? kDefaultBlockKeyNum
+                                        : block_key_num) {}
+
+int SparseBinaryShardWriter::WriteHeader() {
+  if (header_written_) {
+    return 0;
+  }
+  FileHeader header{kFileMagic, kFormatVersion};
+  if (0 != channel_->write(reinterpret_cast<const char*>(&header),
+                           sizeof(header))) {
+    return -1;
+  }
+  header_written_ = true;
+  return 0;
+}
+
+int SparseBinaryShardWriter::Append(uint64_t key,
+                                    const float* value,
+                                    size_t value_dim) {
+  auto& block = pending_[static_cast<uint32_t>(value_dim)];
+  if (block.keys.empty()) {
+    block.value_dim = static_cast<uint32_t>(value_dim);
+    block.keys.reserve(block_key_num_);
+    block.values.reserve(block_key_num_ * value_dim);
+  }
+  block.keys.push_back(key);
+  block.values.insert(block.values.end(), value, value + value_dim);
+  ++key_num_;
+  if (block.keys.size() >= block_key_num_) {
+    return FlushBlock(&block);
+  }
+  return 0;
+}
+
+int SparseBinaryShardWriter::FlushBlock(SparseBinaryBlock* block) {
+  if (block->keys.empty()) {
+    return 0;
+  }
+  if (0 != WriteHeader()) {
+    return -1;
+  }
+  BlockHeader header{
+      kBlockMagic, block->value_dim, block->keys.size(), BlockChecksum(*block)};
+  if (0 != channel_->write(reinterpret_cast<const char*>(&header),
+                           sizeof(header)) ||
+      0 != channel_->write(reinterpret_cast<const char*>(block->keys.data()),
+                           block->keys.size() * sizeof(uint64_t)) ||
+      0 != channel_->write(reinterpret_cast<const char*>(block->values.data()),
+                           block->values.size() * sizeof(float))) {
+    return -1;
+  }
+  block->keys.clear();
+  block->values.clear();
+  return 0;
+}
+
+int SparseBinaryShardWriter::Finish() {
+  for (auto& pair : pending_) {
+    if (0 != FlushBlock(&pair.second)) {
+      return -1;
+    }
+  }
+  if (0 != WriteHeader()) {
+    return -1;
+  }
+  BlockHeader end{kEndMagic, 0, key_num_, 0};
+  return channel_->write(reinterpret_cast<const char*>(&end), sizeof(end)) == 0
+             ? 0
+             : -1;
+}
+
+SparseBinaryShardReader::SparseBinaryShardReader(
+    std::shared_ptr<FsReadChannel> channel)
+    : channel_(std::move(channel)) {}
+
+int SparseBinaryShardReader::ReadExact(void* data, size_t size) {
+  if (size == 0) {
+    return 0;
+  }
+  int read_size = channel_->read(static_cast<char*>(data), size);
+  return read_size == static_cast<int>(size) ? 0 : -1;
+}
+
+int SparseBinaryShardReader::Next(SparseBinaryBlock* block) {
+  if (finished_) {
+    return 0;
+  }
+  if (!header_read_) {
+    FileHeader header;
+    if (0 != ReadExact(&header, sizeof(header)) ||
+        header.magic != kFileMagic || header.version != kFormatVersion) {
+      LOG(ERROR) << "SparseBinaryShardReader invalid file header";
+      return -1;
+    }
+    header_read_ = true;
+  }
+  BlockHeader header;
+  if (0 != ReadExact(&header, sizeof(header))) {
+    LOG(ERROR) << "SparseBinaryShardReader truncated file, " << key_num_
+               << " keys read";
+    return -1;
+  }
+  if (header.magic == kEndMagic) {
+    if (header.key_num != key_num_) {
+      LOG(ERROR) << "SparseBinaryShardReader key num mismatch, expect "
+                 << header.key_num << " but read " << key_num_;
+      return -1;
+    }
+    finished_ = true;
+    return 0;
+  }
+  if (header.magic != kBlockMagic) {
+    LOG(ERROR) << "SparseBinaryShardReader invalid block header";
+    return -1;
+  }
+  // A corrupted key num of a regular file fails before it is allocated.
+  const uint64_t value_size =
+      static_cast<uint64_t>(header.value_dim) * sizeof(float);
+  const uint64_t row_size = sizeof(uint64_t) + value_size;
+  const int64_t remaining_size = channel_->remaining_size();
+  if (header.key_num > std::numeric_limits<uint64_t>::max() / row_size ||
+      (remaining_size >= 0 &&
+       header.key_num * row_size > static_cast<uint64_t>(remaining_size))) {
+    LOG(ERROR) << "SparseBinaryShardReader block of " << header.key_num
+               << " keys is larger than the rest of the file";
+    return -1;
+  }
+  block->value_dim = header.value_dim;
+  if (0 != ReadArray(channel_.get(), header.key_num, &block->keys) ||
+      0 != ReadArray(channel_.get(),
+                     header.key_num * header.value_dim,
+                     &block->values)) {
+    LOG(ERROR) << "SparseBinaryShardReader truncated block";
+    return -1;
+  }
+  if (BlockChecksum(*block) != header.checksum) {
+    LOG(ERROR) << "SparseBinaryShardReader block checksum mismatch";
+    return -1;
+  }
+  key_num_ += header.key_num;
+  return 1;
+}
+
+std::string SparseShardFileSuffix(bool binary, bool compress) {
+  std::string suffix = binary ? ".bin" : "";
+  if (compress) {
+    suffix.append(".gz");
+  }
+  return suffix;
+}
+
+bool IsSparseBinaryShardFile(const std::string& path) {
+  auto ends_with = [&path](const std::string& suffix) {
+    return path.size() >= suffix.size() &&
+           path.compare(path.size() - suffix.size(), suffix.size(), suffix) ==
+               0;
+  };
+  return ends_with(".bin") || ends_with(".bin.gz");
+}
+
+}  // namespace paddle::distributed
@@ -0,0 +1,102 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/distributed/common/afs_warpper.h"
+
+namespace paddle {
+namespace distributed {
+
+// Binary shard file of sparse tables, used instead of the "key value-text"
+// lines when TableParameter.save_binary_format is set:
+//
+//   FileHeader | Block | Block | ... | EndBlock
+//
+// A Block holds the keys and the raw float values of features whose values
+// have the same width, stored column by column: first all the keys, then all
+// the values. Every Block carries an XXH64 checksum of its payload, and the
+// EndBlock records the total number of keys, so that truncated or corrupted
+// files are detected on load. Data is stored in host byte order.
+//
+// Compression is left to the file channel, i.e. a ".gz" path is piped through
+// gzip like the text format.
+struct SparseBinaryBlock {
+  uint32_t value_dim = 0;
+  std::vector<uint64_t> keys;
+  std::vector<float> values;  // keys.size() * value_dim
+
+  size_t KeyNum() const { return keys.size(); }
+  const float* Value(size_t i) const { return values.data() + i * value_dim; }
+};
+
+class SparseBinaryShardWriter {
+ public:
+  static constexpr size_t kDefaultBlockKeyNum = 8192;
+
+  explicit SparseBinaryShardWriter(std::shared_ptr<FsWriteChannel> channel,
+                                   size_t block_key_num = kDefaultBlockKeyNum);
+
+  // All methods return 0 on success and -1 if writing to the channel failed.
+  int Append(uint64_t key, const float* value, size_t value_dim);
+  // Writes the pending blocks and the EndBlock, must be called before the
+  // channel is closed.
+  int Finish();
+
+  uint64_t KeyNum() const { return key_num_; }
+
+ private:
+  int WriteHeader();
+  int FlushBlock(SparseBinaryBlock* block);
+
+  std::shared_ptr<FsWriteChannel> channel_;
+  size_t block_key_num_;
+  bool header_written_ = false;
+  uint64_t key_num_ = 0;
+  // value_dim -> pending block
+  std::map<uint32_t, SparseBinaryBlock> pending_;
+};
+
+class SparseBinaryShardReader {
+ public:
+  explicit SparseBinaryShardReader(std::shared_ptr<FsReadChannel> channel);
+
+  // Reads the next block into `block`. Returns 1 if a block is read, 0 at the
+  // end of the file, and -1 if the file is truncated or corrupted.
+  int Next(SparseBinaryBlock* block);
+
+  uint64_t KeyNum() const { return key_num_; }
+
+ private:
+  int ReadExact(void* data, size_t size);
+
+  std::shared_ptr<FsReadChannel> channel_;
+  bool header_read_ = false;
+  bool finished_ = false;
+  uint64_t key_num_ = 0;
+};
+
+// Suffix of the shard files, e.g. ".bin.gz" for compressed binary shards.
+std::string SparseShardFileSuffix(bool binary, bool compress);
+
+bool IsSparseBinaryShardFile(const std::string& path);
+
+}  // namespace distributed
+}  // namespace paddle
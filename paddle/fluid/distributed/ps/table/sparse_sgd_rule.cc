@@ -14,6 +14,10 @@
 
 #include "paddle/fluid/distributed/ps/table/sparse_sgd_rule.h"
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
 #include "glog/logging.h"
 
 #include "paddle/common/flags.h"
@@ -24,6 +28,127 @@ PD_DEFINE_bool(enable_show_scale_gradient, true, "enable show scale gradient");
 
 namespace paddle::distributed {
 
+namespace {
+
+// The lanes the batched updates run the optimizer math on. The intrinsics are
+// chosen at compile time like the other intrinsic kernels, e.g. a build for
+// AVX runs the AVX path on an AVX512 machine too.
+struct ScalarLanes {
+  using Type = float;
+  static Type Load(const float *p) { return *p; }
+  static void Store(float *p, Type v) { *p = v; }
+  static Type Set(float v) { return v; }
+  static Type Add(Type a, Type b) { return a + b; }
+  static Type Sub(Type a, Type b) { return a - b; }
+  static Type Mul(Type a, Type b) { return a * b; }
+  static Type Div(Type a, Type b) { return a / b; }
+  static Type Sqrt(Type a) { return std::sqrt(a); }
+  // b if a is NaN, the same as the SIMD max and min.
+  static Type Max(Type a, Type b) { return a > b ? a : b; }
+  static Type Min(Type a, Type b) { return a < b ? a : b; }
+};
+
+#if defined(__AVX512F__)
+#define PADDLE_PS_SGD_RULE_SIMD
+struct SimdLanes {
+  using Type = __m512;
+  static constexpr size_t kWidth = 16;
+  static Type Load(const float *p) { return _mm512_loadu_ps(p); }
+  static void Store(float *p, Type v) { _mm512_storeu_ps(p, v); }
+  static Type Set(float v) { return _mm512_set1_ps(v); }
+  static Type Add(Type a, Type b) { return _mm512_add_ps(a, b); }
+  static Type Sub(Type a, Type b) { return _mm512_sub_ps(a, b); }
+  static Type Mul(Type a, Type b) { return _mm512_mul_ps(a, b); }
+  static Type Div(Type a, Type b) { return _mm512_div_ps(a, b); }
+  static Type Sqrt(Type a) { return _mm512_sqrt_ps(a); }
+  static Type Max(Type a, Type b) { return _mm512_max_ps(a, b); }
+  static Type Min(Type a, Type b) { return _mm512_min_ps(a, b); }
+  static float Sum(Type a) { return _mm512_reduce_add_ps(a); }
+};
+#elif defined(__AVX__)
+#define PADDLE_PS_SGD_RULE_SIMD
+struct SimdLanes {
+  using Type = __m256;
+  static constexpr size_t kWidth = 8;
+  static Type Load(const float *p) { return _mm256_loadu_ps(p); }
+  static void Store(float *p, Type v) { _mm256_storeu_ps(p, v); }
+  static Type Set(float v) { return _mm256_set1_ps(v); }
+  static Type Add(Type a, Type b) { return _mm256_add_ps(a, b); }
+  static Type Sub(Type a, Type b) { return _mm256_sub_ps(a, b); }
+  static Type Mul(Type a, Type b) { return _mm256_mul_ps(a, b); }
+  static Type Div(Type a, Type b) { return _mm256_div_ps(a, b); }
+  static Type Sqrt(Type a) { return _mm256_sqrt_ps(a); }
+  static Type Max(Type a, Type b) { return _mm256_max_ps(a, b); }
+  static Type Min(Type a, Type b) { return _mm256_min_ps(a, b); }
+  static float Sum(Type a) {
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(a),
+                            _mm256_extractf128_ps(a, 1));
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+    return _mm_cvtss_f32(sum);
+  }
+};
+#endif
+
+// Runs fn(lanes, i) over [0, dim), on full vectors first and then on the
+// scalars of the tail.
+template <typename Fn>
+void ForEachLane(size_t dim, Fn &&fn) {
+  size_t i = 0;
+#ifdef PADDLE_PS_SGD_RULE_SIMD
+  for (; i + SimdLanes::kWidth <= dim; i += SimdLanes::kWidth) {
+    fn(SimdLanes(), i);
+  }
+#endif
+  for (; i < dim; ++i) {
+    fn(ScalarLanes(), i);
+  }
+}
+
+// The same as ForEachLane, and returns the sum of the results of fn.
+template <typename Fn>
+double SumLanes(size_t dim, Fn &&fn) {
+  size_t i = 0;
+  double sum = 0;
+#ifdef PADDLE_PS_SGD_RULE_SIMD
+  auto vec_sum = SimdLanes::Set(0);
+  for (; i + SimdLanes::kWidth <= dim; i += SimdLanes::kWidth) {
+    vec_sum = SimdLanes::Add(vec_sum, fn(SimdLanes(), i));
+  }
+  sum = SimdLanes::Sum(vec_sum);
+#endif
+  for (; i < dim; ++i) {
+    sum += fn(ScalarLanes(), i);
+  }
+  return sum;
+}
+
+template <typename L>
+typename L::Type BoundLanes(typename L::Type w, float min, float max) {
+  return L::Min(L::Max(w, L::Set(min)), L::Set(max));
+}
+
+// Runs fn(k) for the rows in order, and prefetches the next row meanwhile.
+template <typename Fn>
+void ForEachRow(float **w,
+                float **sgd,
+                const float **grad,
+                size_t num,
+                Fn &&fn) {
+  for (size_t k = 0; k < num; ++k) {
+#if defined(__GNUC__)
+    if (k + 1 < num) {
+      __builtin_prefetch(w[k + 1], 1);
+      __builtin_prefetch(sgd[k + 1], 1);
+      __builtin_prefetch(grad[k + 1], 0);
+    }
+#endif
+    fn(k);
+  }
+}
+
+}  // namespace
+
 void SparseNaiveSGDRule::LoadConfig(const SparseCommonSGDRuleParameter &param,
                                     size_t emb_dim) {
   _embedding_dim = emb_dim;
@@ -54,6 +179,23 @@ void SparseNaiveSGDRule::UpdateValueWork(float *w,
   }
 }
 
+void SparseNaiveSGDRule::UpdateValueBatch(float **w,
+                                          float **sgd,
+                                          const float **push_values,
+                                          const float *scales,
+                                          size_t num) {
+  ForEachRow(w, sgd, push_values, num, [&](size_t k) {
+    float *row_w = w[k];
+    const float *g = push_values[k];
+    ForEachLane(_embedding_dim, [&](auto lanes, size_t i) {
+      using L = decltype(lanes);
+      auto new_w = L::Sub(L::Load(row_w + i),
+                          L::Mul(L::Set(learning_rate_), L::Load(g + i)));
+      L::Store(row_w + i, BoundLanes<L>(new_w, _min_bound, _max_bound));
+    });
+  });
+}
+
 void SparseNaiveSGDRule::InitValueWork(float *value,
                                        float *sgd,
                                        bool zero_init) {
@@ -111,6 +253,30 @@ void SparseAdaGradSGDRule::UpdateValueWork(float *w,
   g2sum += add_g2sum / _embedding_dim;
 }
 
+void SparseAdaGradSGDRule::UpdateValueBatch(float **w,
+                                            float **sgd,
+                                            const float **push_values,
+                                            const float *scales,
+                                            size_t num) {
+  ForEachRow(w, sgd, push_values, num, [&](size_t k) {
+    float *row_w = w[k];
+    const float *g = push_values[k];
+    float &g2sum = sgd[k][G2SumIndex()];
+    float scale = scales[k];
+    float ratio =
+        learning_rate_ * sqrt(_initial_g2sum / (_initial_g2sum + g2sum));
+    double add_g2sum = SumLanes(_embedding_dim, [&](auto lanes, size_t i) {
+      using L = decltype(lanes);
+      auto scaled_grad = L::Div(L::Load(g + i), L::Set(scale));
+      auto new_w =
+          L::Sub(L::Load(row_w + i), L::Mul(L::Set(ratio), scaled_grad));
+      L::Store(row_w + i, BoundLanes<L>(new_w, _min_bound, _max_bound));
+      return L::Mul(scaled_grad, scaled_grad);
+    });
+    g2sum += add_g2sum / _embedding_dim;
+  });
+}
+
 void SparseAdaGradSGDRule::InitValueWork(float *value,
                                          float *sgd,
                                          bool zero_init) {
@@ -166,6 +332,33 @@ void StdAdaGradSGDRule::UpdateValueWork(float *w,
   }
 }
 
+void StdAdaGradSGDRule::UpdateValueBatch(float **w,
+                                         float **sgd,
+                                         const float **push_values,
+                                         const float *scales,
+                                         size_t num) {
+  ForEachRow(w, sgd, push_values, num, [&](size_t k) {
+    float *row_w = w[k];
+    float *g2sum = sgd[k] + G2SumIndex();
+    const float *g = push_values[k];
+    float scale = scales[k];
+    ForEachLane(_embedding_dim, [&](auto lanes, size_t i) {
+      using L = decltype(lanes);
+      auto initial_g2sum = L::Set(_initial_g2sum);
+      auto old_g2sum = L::Load(g2sum + i);
+      auto scaled_grad = L::Div(L::Load(g + i), L::Set(scale));
+      auto ratio = L::Sqrt(
+          L::Div(initial_g2sum, L::Add(initial_g2sum, old_g2sum)));
+      auto new_w = L::Sub(
+          L::Load(row_w + i),
+          L::Mul(L::Mul(L::Set(learning_rate_), scaled_grad), ratio));
+      L::Store(row_w + i, BoundLanes<L>(new_w, _min_bound, _max_bound));
+      L::Store(g2sum + i,
+               L::Add(old_g2sum, L::Mul(scaled_grad, scaled_grad)));
+    });
+  });
+}
+
 void StdAdaGradSGDRule::InitValueWork(float *value,
                                       float *sgd,
                                       bool zero_init) {
@@ -236,6 +429,42 @@ void SparseAdamSGDRule::UpdateValueWork(float *w,
   (*beta2_pow) *= _beta2_decay_rate;
 }
 
+void SparseAdamSGDRule::UpdateValueBatch(float **w,
+                                         float **sgd,
+                                         const float **push_values,
+                                         const float *scales,
+                                         size_t num) {
+  ForEachRow(w, sgd, push_values, num, [&](size_t k) {
+    float *row_w = w[k];
+    float *gsum = sgd[k] + GSumIndex();
+    float *g2sum = sgd[k] + G2SumIndex();
+    float *beta1_pow = sgd[k] + Beta1PowIndex();
+    float *beta2_pow = sgd[k] + Beta2PowIndex();
+    const float *g = push_values[k];
+    float lr = learning_rate_ * sqrt(1 - *beta2_pow) / (1 - *beta1_pow);
+    ForEachLane(_embedding_dim, [&](auto lanes, size_t i) {
+      using L = decltype(lanes);
+      auto grad = L::Load(g + i);
+      auto new_gsum =
+          L::Add(L::Mul(L::Set(_beta1_decay_rate), L::Load(gsum + i)),
+                 L::Mul(L::Set(1 - _beta1_decay_rate), grad));
+      auto new_g2sum =
+          L::Add(L::Mul(L::Set(_beta2_decay_rate), L::Load(g2sum + i)),
+                 L::Mul(L::Set(1 - _beta2_decay_rate), L::Mul(grad, grad)));
+      auto new_w = L::Sub(
+          L::Load(row_w + i),
+          L::Mul(L::Set(lr),
+                 L::Div(new_gsum,
+                        L::Add(L::Sqrt(new_g2sum), L::Set(_ada_epsilon)))));
+      L::Store(gsum + i, new_gsum);
+      L::Store(g2sum + i, new_g2sum);
+      L::Store(row_w + i, BoundLanes<L>(new_w, _min_bound, _max_bound));
+    });
+    (*beta1_pow) *= _beta1_decay_rate;
+    (*beta2_pow) *= _beta2_decay_rate;
+  });
+}
+
 void SparseAdamSGDRule::InitValueWork(float *value,
                                       float *sgd,
                                       bool zero_init) {
@@ -321,6 +550,50 @@ void SparseSharedAdamSGDRule::UpdateValueWork(float *w,
   (*beta2_pow) *= _beta2_decay_rate;
 }
 
+void SparseSharedAdamSGDRule::UpdateValueBatch(float **w,
+                                               float **sgd,
+                                               const float **push_values,
+                                               const float *scales,
+                                               size_t num) {
+  ForEachRow(w, sgd, push_values, num, [&](size_t k) {
+    float *row_w = w[k];
+    float *gsum = sgd[k] + GSumIndex();
+    float *g2sum = sgd[k] + G2SumIndex();
+    float *beta1_pow = sgd[k] + Beta1PowIndex();
+    float *beta2_pow = sgd[k] + Beta2PowIndex();
+    const float *g = push_values[k];
+    float lr = learning_rate_ * sqrt(1 - *beta2_pow) / (1 - *beta1_pow);
+    float decayed_gsum = _beta1_decay_rate * *gsum;
+    float decayed_g2sum = _beta2_decay_rate * *g2sum;
+    double sum_g2sum = SumLanes(_embedding_dim, [&](auto lanes, size_t i) {
+      using L = decltype(lanes);
+      auto grad = L::Load(g + i);
+      auto new_gsum = L::Add(L::Set(decayed_gsum),
+                             L::Mul(L::Set(1 - _beta1_decay_rate), grad));
+      auto new_g2sum =
+          L::Add(L::Set(decayed_g2sum),
+                 L::Mul(L::Set(1 - _beta2_decay_rate), L::Mul(grad, grad)));
+      auto new_w = L::Sub(
+          L::Load(row_w + i),
+          L::Mul(L::Set(lr),
+                 L::Div(new_gsum,
+                        L::Add(L::Sqrt(new_g2sum), L::Set(_ada_epsilon)))));
+      L::Store(row_w + i, BoundLanes<L>(new_w, _min_bound, _max_bound));
+      return new_g2sum;
+    });
+    // The mean of the new gsum is the decayed gsum plus the mean gradient.
+    double sum_grad = SumLanes(_embedding_dim, [&](auto lanes, size_t i) {
+      using L = decltype(lanes);
+      return L::Load(g + i);
+    });
+    (*gsum) = decayed_gsum +
+              (1 - _beta1_decay_rate) * sum_grad / _embedding_dim;
+    (*g2sum) = sum_g2sum / _embedding_dim;
+    (*beta1_pow) *= _beta1_decay_rate;
+    (*beta2_pow) *= _beta2_decay_rate;
+  });
+}
+
 void SparseSharedAdamSGDRule::InitValueWork(float *value,
                                             float *sgd,
                                             bool zero_init) {
@@ -389,6 +662,35 @@ void SparseAdaGradV2SGDRule::UpdateValueWork(float *w,
   }
 }
 
+void SparseAdaGradV2SGDRule::UpdateValueBatch(float **w,
+                                              float **sgd,
+                                              const float **push_values,
+                                              const float *scales,
+                                              size_t num) {
+  const float epsilon = 1e-8;
+  ForEachRow(w, sgd, push_values, num, [&](size_t k) {
+    float *row_w = w[k];
+    const float *g = push_values[k];
+    float &g2sum = sgd[k][G2SumIndex()];
+    float scale = scales[k];
+    double add_g2sum = SumLanes(_embedding_dim, [&](auto lanes, size_t i) {
+      using L = decltype(lanes);
+      auto scaled_grad = L::Div(L::Load(g + i), L::Set(scale));
+      return L::Mul(scaled_grad, scaled_grad);
+    });
+    g2sum += add_g2sum / _embedding_dim;
+
+    float ratio = learning_rate_ / (sqrt(g2sum) + epsilon);
+    ForEachLane(_embedding_dim, [&](auto lanes, size_t i) {
+      using L = decltype(lanes);
+      auto scaled_grad = L::Div(L::Load(g + i), L::Set(scale));
+      auto new_w =
+          L::Sub(L::Load(row_w + i), L::Mul(L::Set(ratio), scaled_grad));
+      L::Store(row_w + i, BoundLanes<L>(new_w, _min_bound, _max_bound));
+    });
+  });
+}
+
 void SparseAdaGradV2SGDRule::InitValueWork(float *value,
                                            float *sgd,
                                            bool zero_init) {
@@ -39,6 +39,17 @@ class SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale) = 0;
+  // Updates the num rows of a push at once. w[k], sgd[k] and push_values[k]
+  // point to the fields of the k-th row, and scales[k] is its scale.
+  virtual void UpdateValueBatch(float** w,
+                                float** sgd,
+                                const float** push_values,
+                                const float* scales,
+                                size_t num) {
+    for (size_t k = 0; k < num; ++k) {
+      UpdateValueWork(w[k], sgd[k], push_values[k], scales[k]);
+    }
+  }
   virtual void InitValueWork(float* value, float* sgd, bool zero_init) = 0;
   virtual size_t Dim() = 0;
   const std::string& GetName() const { return _name; }
@@ -82,6 +93,11 @@ class SparseNaiveSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  virtual void UpdateValueBatch(float** w,
+                                float** sgd,
+                                const float** push_values,
+                                const float* scales,
+                                size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return 0; }
 
@@ -97,6 +113,11 @@ class SparseAdaGradSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  virtual void UpdateValueBatch(float** w,
+                                float** sgd,
+                                const float** push_values,
+                                const float* scales,
+                                size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return 1; }
   size_t G2SumIndex() { return 0; }
@@ -117,6 +138,11 @@ class SparseAdaGradV2SGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  virtual void UpdateValueBatch(float** w,
+                                float** sgd,
+                                const float** push_values,
+                                const float* scales,
+                                size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return 1; }
   size_t G2SumIndex() { return 0; }
@@ -134,6 +160,11 @@ class StdAdaGradSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  virtual void UpdateValueBatch(float** w,
+                                float** sgd,
+                                const float** push_values,
+                                const float* scales,
+                                size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return _embedding_dim; }
   size_t G2SumIndex() { return 0; }
@@ -151,6 +182,11 @@ class SparseAdamSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  virtual void UpdateValueBatch(float** w,
+                                float** sgd,
+                                const float** push_values,
+                                const float* scales,
+                                size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return _embedding_dim * 2 + 2; }
   size_t GSumIndex() { return 0; }
@@ -173,6 +209,11 @@ class SparseSharedAdamSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  virtual void UpdateValueBatch(float** w,
+                                float** sgd,
+                                const float** push_values,
+                                const float* scales,
+                                size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return 4; }
   size_t GSumIndex() { return 0; }
@@ -18,6 +18,7 @@
 #include "paddle/fluid/distributed/common/cost_timer.h"
 #include "paddle/fluid/distributed/common/local_random.h"
 #include "paddle/fluid/distributed/common/topk_calculator.h"
+#include "paddle/fluid/distributed/ps/table/segment_value_store.h"
 #include "paddle/fluid/framework/archive.h"
 #include "paddle/utils/string/string_helper.h"
 PD_DECLARE_bool(pserver_print_missed_key_num_every_push);
@@ -28,12 +29,92 @@ PD_DEFINE_int32(pserver_load_batch_size, 5000, "load batch size for ssd");
 PHI_DEFINE_EXPORTED_string(rocksdb_path,
                            "database",
                            "path of sparse table rocksdb file");
+PD_DEFINE_string(pserver_ssd_value_store,
+                 "rocksdb",
+                 "the cold tier of ssd sparse table, rocksdb or segment, the "
+                 "segment store appends the values to segment files under "
+                 "rocksdb_path");
+PD_DEFINE_int32(pserver_ssd_segment_size_mb,
+                256,
+                "segment file size of the segment ssd value store");
+PD_DEFINE_double(pserver_ssd_segment_gc_ratio,
+                 0.5,
+                 "garbage ratio of a segment file to compact it in the "
+                 "segment ssd value store");
 
 namespace paddle::distributed {
 
+namespace {
+
+// Puts the values to an ssd store without sst files in batches of
+// pserver_load_batch_size.
+class SSDBatchWriter {
+ public:
+  SSDBatchWriter(SSDValueStore* db, int shard_id)
+      : _db(db), _shard_id(shard_id) {}
+  ~SSDBatchWriter() { Flush(); }
+
+  void Put(uint64_t key, const float* value, size_t dim) {
+    _keys.push_back(key);
+    _offsets.push_back(_values.size());
+    _values.insert(_values.end(), value, value + dim);
+    if (static_cast<int>(_keys.size()) >= FLAGS_pserver_load_batch_size) {
+      Flush();
+    }
+  }
+
+  void Flush() {
+    if (_keys.empty()) {
+      return;
+    }
+    std::vector<std::pair<char*, int>> ssd_keys;
+    std::vector<std::pair<char*, int>> ssd_values;
+    _offsets.push_back(_values.size());
+    for (size_t i = 0; i < _keys.size(); ++i) {
+      ssd_keys.emplace_back(reinterpret_cast<char*>(&_keys[i]),
+                            sizeof(uint64_t));
+      ssd_values.emplace_back(
+          reinterpret_cast<char*>(_values.data() + _offsets[i]),
+          (_offsets[i + 1] - _offsets[i]) * sizeof(float));
+    }
+    _db->put_batch(_shard_id, ssd_keys, ssd_values, ssd_keys.size());
+    _keys.clear();
+    _offsets.clear();
+    _values.clear();
+  }
+
+ private:
+  SSDValueStore* _db;
+  int _shard_id;
+  std::vector<uint64_t> _keys;
+  std::vector<size_t> _offsets;
+  std::vector<float> _values;
+};
+
+}  // namespace
+
 int32_t SSDSparseTable::Initialize() {
   MemorySparseTable::Initialize();
-  _db = ::paddle::distributed::RocksDBHandler::GetInstance();
+  PADDLE_ENFORCE_EQ(_value_codec.Enabled(),
+                    false,
+                    common::errors::Unimplemented(
+                        "SSDSparseTable does not support the compact "
+                        "sparse_value_type."));
+  if (FLAGS_pserver_ssd_value_store == "segment") {
+    SegmentValueStore::Options options;
+    options.segment_bytes =
+        static_cast<size_t>(FLAGS_pserver_ssd_segment_size_mb) << 20;
+    options.gc_ratio = FLAGS_pserver_ssd_segment_gc_ratio;
+    _db = std::make_unique<SegmentValueStore>(options);
+  } else if (FLAGS_pserver_ssd_value_store == "rocksdb") {
+    auto rocksdb = std::make_unique<RocksDBValueStore>();
+    _rocksdb = rocksdb->handler();
+    _db = std::move(rocksdb);
+  } else {
+    PADDLE_THROW(common::errors::InvalidArgument(
+        "Unknown pserver_ssd_value_store %s, expected rocksdb or segment.",
+        FLAGS_pserver_ssd_value_store));
+  }
   _db->initialize(FLAGS_rocksdb_path, _real_local_shard_num);
   VLOG(0) << "initialize SSDSparseTable succ";
   VLOG(0) << "SSD FLAGS_pserver_print_missed_key_num_every_push:"
@@ -204,146 +285,110 @@ int32_t SSDSparseTable::PullSparsePtr(int shard_id,
       _value_accessor->GetAccessorInfo().mf_size / sizeof(float);
 
   {  // 从table取值 or create
-    RocksDBCtx context;
-    std::vector<std::future<int>> tasks;
-    RocksDBItem* cur_ctx = context.switch_item();
-    cur_ctx->reset();
-    FixedFeatureValue* ret = nullptr;
     auto& local_shard = _local_shards[shard_id];
     float data_buffer[value_size];  // NOLINT
     float* data_buffer_ptr = data_buffer;
+    auto set_pull_value = [&](FixedFeatureValue* ret, int pull_data_idx) {
+      _value_accessor->UpdateTimeDecay(ret->data(), true);
+#if defined(PADDLE_WITH_PSLIB) || defined(PADDLE_WITH_HETERPS)
+      _value_accessor->UpdatePassId(ret->data(), pass_id);
+#endif
+      pull_values[pull_data_idx] = reinterpret_cast<char*>(ret);
+    };
 
+    // The keys in memory are served first, so the reads of all the missed
+    // keys can be hinted to the ssd store before they are read in batches.
+    std::vector<int> missed;
     for (size_t i = 0; i < num; ++i) {
-      uint64_t key = pull_keys[i];
-      auto itr = local_shard.find(key);
+      auto itr = local_shard.find(pull_keys[i]);
       if (itr == local_shard.end()) {
-        cur_ctx->batch_index.push_back(i);
-        cur_ctx->batch_keys.emplace_back(
-            reinterpret_cast<const char*>(&(pull_keys[i])), sizeof(uint64_t));
-        if (cur_ctx->batch_keys.size() == 1024) {
-          cur_ctx->batch_values.resize(cur_ctx->batch_keys.size());
-          cur_ctx->status.resize(cur_ctx->batch_keys.size());
-          auto fut =
-              _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
-                  [this, shard_id, cur_ctx]() -> int {
-                    _db->multi_get(shard_id,
-                                   cur_ctx->batch_keys.size(),
-                                   cur_ctx->batch_keys.data(),
-                                   cur_ctx->batch_values.data(),
-                                   cur_ctx->status.data());
-                    return 0;
-                  });
-          cur_ctx = context.switch_item();
-          for (size_t x = 0; x < tasks.size(); ++x) {
-            tasks[x].wait();
-            for (size_t idx = 0; idx < cur_ctx->status.size(); idx++) {
-              uint64_t cur_key = *(reinterpret_cast<uint64_t*>(
-                  const_cast<char*>(cur_ctx->batch_keys[idx].data())));
-              if (cur_ctx->status[idx].IsNotFound()) {
-                auto& feature_value = local_shard[cur_key];
-                int init_size = value_size - mf_value_size;
-                feature_value.resize(init_size);
-                _value_accessor->Create(&data_buffer_ptr, 1);
-                memcpy(const_cast<float*>(feature_value.data()),
-                       data_buffer_ptr,
-                       init_size * sizeof(float));
-                ret = &feature_value;
-              } else {
-                int data_size =
-                    cur_ctx->batch_values[idx].size() / sizeof(float);
-                // from rocksdb to mem
-                auto& feature_value = local_shard[cur_key];
-                feature_value.resize(data_size);
-                memcpy(const_cast<float*>(feature_value.data()),
-                       ::paddle::string::str_to_float(
-                           cur_ctx->batch_values[idx].data()),
-                       data_size * sizeof(float));
-                _db->del_data(shard_id,
-                              reinterpret_cast<char*>(&cur_key),
-                              sizeof(uint64_t));
-                ret = &feature_value;
-              }
-
-              _value_accessor->UpdateTimeDecay(ret->data(), true);
-#if defined(PADDLE_WITH_PSLIB) || defined(PADDLE_WITH_HETERPS)
-              _value_accessor->UpdatePassId(ret->data(), pass_id);
-#endif
-              int pull_data_idx = cur_ctx->batch_index[idx];
-              pull_values[pull_data_idx] = reinterpret_cast<char*>(ret);
-            }
-          }
-          cur_ctx->reset();
-          tasks.clear();
-          tasks.push_back(std::move(fut));
-        }
+        missed.push_back(i);
       } else {
-        ret = itr.value_ptr();
-        // int pull_data_idx = keys[i].second;
-        _value_accessor->UpdateTimeDecay(ret->data(), true);
-#if defined(PADDLE_WITH_PSLIB) || defined(PADDLE_WITH_HETERPS)
-        _value_accessor->UpdatePassId(ret->data(), pass_id);
-#endif
-        pull_values[i] = reinterpret_cast<char*>(ret);
+        set_pull_value(itr.value_ptr(), i);
       }
     }
-    if (!cur_ctx->batch_keys.empty()) {
-      cur_ctx->batch_values.resize(cur_ctx->batch_keys.size());
-      cur_ctx->status.resize(cur_ctx->batch_keys.size());
-      auto fut =
-          _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
-              [this, shard_id, cur_ctx]() -> int {
-                _db->multi_get(shard_id,
-                               cur_ctx->batch_keys.size(),
-                               cur_ctx->batch_keys.data(),
-                               cur_ctx->batch_values.data(),
-                               cur_ctx->status.data());
-                return 0;
-              });
-      tasks.push_back(std::move(fut));
+    if (missed.empty()) {
+      return 0;
     }
-    for (size_t x = 0; x < tasks.size(); ++x) {
-      tasks[x].wait();
+    std::vector<uint64_t> missed_keys;
+    missed_keys.reserve(missed.size());
+    for (auto idx : missed) {
+      missed_keys.push_back(pull_keys[idx]);
     }
-    for (size_t x = 0; x < 2; x++) {
-      cur_ctx = context.switch_item();
-      for (size_t idx = 0; idx < cur_ctx->status.size(); idx++) {
-        uint64_t cur_key = *(reinterpret_cast<uint64_t*>(
-            const_cast<char*>(cur_ctx->batch_keys[idx].data())));
-        if (cur_ctx->status[idx].IsNotFound()) {
-          auto& feature_value = local_shard[cur_key];
+    _db->advise_will_need(shard_id, missed_keys.data(), missed_keys.size());
+
+    auto load_batch = [&](SSDValueBatch* batch) {
+      for (size_t idx = 0; idx < batch->keys.size(); idx++) {
+        uint64_t cur_key = batch->keys[idx];
+        auto& feature_value = local_shard[cur_key];
+        if (!batch->found(idx)) {
           int init_size = value_size - mf_value_size;
           feature_value.resize(init_size);
           _value_accessor->Create(&data_buffer_ptr, 1);
           memcpy(const_cast<float*>(feature_value.data()),
                  data_buffer_ptr,
                  init_size * sizeof(float));
-          ret = &feature_value;
         } else {
-          int data_size = cur_ctx->batch_values[idx].size() / sizeof(float);
-          // from rocksdb to mem
-          auto& feature_value = local_shard[cur_key];
+          int data_size = batch->sizes[idx] / sizeof(float);
+          // from ssd to mem
           feature_value.resize(data_size);
-          memcpy(
-              const_cast<float*>(feature_value.data()),
-              ::paddle::string::str_to_float(cur_ctx->batch_values[idx].data()),
-              data_size * sizeof(float));
+          memcpy(const_cast<float*>(feature_value.data()),
+                 batch->value(idx),
+                 data_size * sizeof(float));
           _db->del_data(
               shard_id, reinterpret_cast<char*>(&cur_key), sizeof(uint64_t));
-          ret = &feature_value;
         }
-        _value_accessor->UpdateTimeDecay(ret->data(), true);
-#if defined(PADDLE_WITH_PSLIB) || defined(PADDLE_WITH_HETERPS)
-        _value_accessor->UpdatePassId(ret->data(), pass_id);
-#endif
-        int pull_data_idx = cur_ctx->batch_index[idx];
-        pull_values[pull_data_idx] = reinterpret_cast<char*>(ret);
+        set_pull_value(&feature_value, batch->index[idx]);
+      }
+      batch->reset();
+    };
+
+    SSDValueCtx context;
+    std::vector<std::future<int>> tasks;
+    SSDValueBatch* cur_ctx = context.switch_item();
+    for (size_t i = 0; i < missed.size(); ++i) {
+      cur_ctx->index.push_back(missed[i]);
+      cur_ctx->keys.push_back(missed_keys[i]);
+      if (cur_ctx->keys.size() == 1024 || i + 1 == missed.size()) {
+        auto fut =
+            _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
+                [this, shard_id, cur_ctx]() -> int {
+                  _db->multi_get(shard_id, cur_ctx);
+                  return 0;
+                });
+        // Load the last batch into memory while this one is read.
+        cur_ctx = context.switch_item();
+        for (auto& task : tasks) {
+          task.wait();
+        }
+        tasks.clear();
+        load_batch(cur_ctx);
+        tasks.push_back(std::move(fut));
       }
-      cur_ctx->reset();
     }
+    for (auto& task : tasks) {
+      task.wait();
+    }
+    load_batch(context.switch_item());
   }
   return 0;
 }
 
+int32_t SSDSparseTable::PrefetchSparse(int shard_id,
+                                       const uint64_t* keys,
+                                       size_t num) {
+  // The keys in memory are not in the ssd store and are skipped by it.
+  auto prefetch_keys =
+      std::make_shared<std::vector<uint64_t>>(keys, keys + num);
+  _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
+      [this, shard_id, prefetch_keys]() -> int {
+        _db->advise_will_need(
+            shard_id, prefetch_keys->data(), prefetch_keys->size());
+        return 0;
+      });
+  return 0;
+}
+
 int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                                    const float* values,
                                    size_t num) {
@@ -2847,7 +2892,7 @@ int32_t SSDSparseTable::LoadWithBinary(const std::string& path, int param) {
         }
         auto& shard = _local_shards[shard_idx];
         rocksdb::Options options;
-        options.comparator = _db->get_comparator();
+        options.comparator = RocksDBHandler::GetInstance()->get_comparator();
         rocksdb::BlockBasedTableOptions bbto;
         bbto.format_version = 5;
         bbto.use_delta_encoding = false;
@@ -2875,8 +2920,9 @@ int32_t SSDSparseTable::LoadWithBinary(const std::string& path, int param) {
         options.compression = rocksdb::kNoCompression;
 
         rocksdb::SstFileWriter sst_writer(rocksdb::EnvOptions(), options);
+        SSDBatchWriter ssd_writer(_db.get(), shard_idx);
         int use_sst = 0;
-        if (file_split_idx != 0) {
+        if (file_split_idx != 0 && _rocksdb != nullptr) {
           std::string path =
               ::paddle::string::format_string("%s_%d/part-%03d.sst",
                                               FLAGS_rocksdb_path.c_str(),
@@ -2961,6 +3007,15 @@ int32_t SSDSparseTable::LoadWithBinary(const std::string& path, int param) {
                   if (dim > feature_value_size - mf_value_size) {
                     ssd_mf_count++;
                   }
+                } else if (file_split_idx != 0) {
+#if defined(PADDLE_WITH_PSLIB) || defined(PADDLE_WITH_HETERPS)
+                  _value_accessor->UpdatePassId(convert_value, 0);
+#endif
+                  ssd_writer.Put(k, convert_value, dim);
+                  ssd_count += 1;
+                  if (dim > feature_value_size - mf_value_size) {
+                    ssd_mf_count++;
+                  }
                 } else {
                   auto& feature_value = shard[k];
 #if defined(PADDLE_WITH_PSLIB) || defined(PADDLE_WITH_HETERPS)
@@ -2996,6 +3051,7 @@ int32_t SSDSparseTable::LoadWithBinary(const std::string& path, int param) {
             abort();
           }
         }
+        ssd_writer.Flush();
         free(buf);
         free(convert_buf);
         auto tmp_count = ssd_count + mem_count;
@@ -3026,10 +3082,14 @@ int32_t SSDSparseTable::LoadWithBinary(const std::string& path, int param) {
   }
   tasks.clear();
   for (int shard_idx = 0; shard_idx < _real_local_shard_num; shard_idx++) {
+    if (_rocksdb == nullptr) {
+      _db->flush(shard_idx);
+      continue;
+    }
     auto sst_filelist = _afs_client.list(::paddle::string::format_string(
         "%s_%d/part-*", FLAGS_rocksdb_path.c_str(), shard_idx));
     if (!sst_filelist.empty()) {
-      int ret = _db->ingest_external_file(shard_idx, sst_filelist);
+      int ret = _rocksdb->ingest_external_file(shard_idx, sst_filelist);
       if (ret) {
         VLOG(0) << "ingest file failed";
         abort();
@@ -3079,7 +3139,7 @@ int32_t SSDSparseTable::CacheTable(uint16_t pass_id) {
     auto fut = _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
         [shard_id, this, &count, show_threshold, pass_id]() -> int {
           rocksdb::Options options;
-          options.comparator = _db->get_comparator();
+          options.comparator = RocksDBHandler::GetInstance()->get_comparator();
           rocksdb::BlockBasedTableOptions bbto;
           bbto.format_version = 5;
           bbto.use_delta_encoding = false;
@@ -3132,8 +3192,17 @@ int32_t SSDSparseTable::CacheTable(uint16_t pass_id) {
                       << " ms, num: " << datas.size();
             }
 
-            // 必须做空判断，否则sst_writer.Finish会core掉
-            if (!datas.empty()) {
+            if (_rocksdb == nullptr) {
+              SSDBatchWriter ssd_writer(_db.get(), shard_id);
+              for (auto& data : datas) {
+                FixedFeatureValue& tmp_value =
+                    *((FixedFeatureValue*)(void*)(data->second));  // NOLINT
+                ssd_writer.Put(data->first, tmp_value.data(), tmp_value.size());
+              }
+              ssd_writer.Flush();
+              _db->flush(shard_id);
+            } else if (!datas.empty()) {
+              // 必须做空判断，否则sst_writer.Finish会core掉
               rocksdb::SstFileWriter sst_writer(rocksdb::EnvOptions(), options);
               std::string filename =
                   ::paddle::string::format_string("%s_%d/cache-%05d.sst",
@@ -3172,7 +3241,7 @@ int32_t SSDSparseTable::CacheTable(uint16_t pass_id) {
               }
               VLOG(0) << "write sst_file shard " << shard_id << ": "
                       << butil::gettimeofday_ms() - show_begin << " ms";
-              int ret = _db->ingest_external_file(shard_id, {filename});
+              int ret = _rocksdb->ingest_external_file(shard_id, {filename});
               if (ret) {
                 VLOG(0) << "ingest file failed"
                         << ", " << status.getState();
@@ -132,10 +132,17 @@ class SSDSparseTable : public MemorySparseTable {
 
   int32_t CacheTable(uint16_t pass_id) override;
 
+  int32_t PrefetchSparse(int shard_id,
+                         const uint64_t* keys,
+                         size_t num) override;
+
   void SetDayId(int day_id) override;
 
  private:
-  RocksDBHandler* _db;
+  // The cold tier, chosen by --pserver_ssd_value_store.
+  std::unique_ptr<SSDValueStore> _db;
+  // Set if the cold tier is rocksdb, whose sst files are ingested directly.
+  RocksDBHandler* _rocksdb = nullptr;
   int64_t _cache_tk_size;
   double _local_show_threshold{0.0};
   std::vector<paddle::framework::Channel<std::string>> _fs_channel;
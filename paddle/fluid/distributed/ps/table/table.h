@@ -158,6 +158,13 @@ class Table {
   virtual void *GetShard(size_t shard_idx) = 0;
   virtual std::pair<int64_t, int64_t> PrintTableStat() { return {0, 0}; }
   virtual int32_t CacheTable(uint16_t pass_id UNUSED) { return 0; }
+  // Hints the keys of shard_id the next pass will pull, so a table with a
+  // cold tier reads their values ahead in the background.
+  virtual int32_t PrefetchSparse(int shard_id UNUSED,
+                                 const uint64_t *keys UNUSED,
+                                 size_t num UNUSED) {
+    return 0;
+  }
 
   // for patch model
   virtual void Revert() {}
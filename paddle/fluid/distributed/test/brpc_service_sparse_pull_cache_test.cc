@@ -0,0 +1,227 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <unistd.h>
+
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/ps/service/brpc_ps_client.h"
+#include "paddle/fluid/distributed/ps/service/brpc_ps_server.h"
+#include "paddle/fluid/distributed/ps/service/env.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+#include "paddle/fluid/framework/program_desc.h"
+
+PD_DECLARE_int32(pserver_sparse_pull_cache_mb);
+PD_DECLARE_int32(pserver_sparse_pull_cache_admit_count);
+PD_DECLARE_int32(pserver_sparse_pull_cache_stale_steps);
+PD_DECLARE_int32(pserver_sparse_pull_cache_stale_ms);
+
+namespace framework = paddle::framework;
+
+namespace {
+
+void GetDownpourSparseTableProto(
+    ::paddle::distributed::TableParameter* sparse_table_proto) {
+  sparse_table_proto->set_table_id(0);
+  sparse_table_proto->set_table_class("MemorySparseTable");
+  sparse_table_proto->set_shard_num(10);
+  ::paddle::distributed::TableAccessorParameter* accessor_config =
+      sparse_table_proto->mutable_accessor();
+
+  accessor_config->set_accessor_class("SparseAccessor");
+  accessor_config->set_fea_dim(10);
+  accessor_config->set_embedx_dim(9);
+  accessor_config->set_embedx_threshold(0);
+  accessor_config->mutable_ctr_accessor_param()->set_nonclk_coeff(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_click_coeff(1);
+  accessor_config->mutable_ctr_accessor_param()->set_base_threshold(0.5);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_threshold(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_keep_days(16);
+  accessor_config->mutable_ctr_accessor_param()->set_show_click_decay_rate(
+      0.99);
+
+  accessor_config->mutable_embed_sgd_param()->set_name("SparseNaiveSGDRule");
+  auto* naive_param =
+      accessor_config->mutable_embed_sgd_param()->mutable_naive();
+  naive_param->set_learning_rate(1.0);
+  naive_param->set_initial_range(0.3);
+  naive_param->add_weight_bounds(-10.0);
+  naive_param->add_weight_bounds(10.0);
+
+  accessor_config->mutable_embedx_sgd_param()->set_name("SparseNaiveSGDRule");
+  naive_param = accessor_config->mutable_embedx_sgd_param()->mutable_naive();
+  naive_param->set_learning_rate(1.0);
+  naive_param->set_initial_range(0.3);
+  naive_param->add_weight_bounds(-10.0);
+  naive_param->add_weight_bounds(10.0);
+}
+
+void SetServiceProto(::paddle::distributed::ServerParameter* server_proto) {
+  ::paddle::distributed::DownpourServerParameter* downpour_server_proto =
+      server_proto->mutable_downpour_server_param();
+  ::paddle::distributed::ServerServiceParameter* server_service_proto =
+      downpour_server_proto->mutable_service_param();
+  server_service_proto->set_service_class("BrpcPsService");
+  server_service_proto->set_server_class("BrpcPsServer");
+  server_service_proto->set_client_class("BrpcPsClient");
+  server_service_proto->set_start_server_port(0);
+  server_service_proto->set_server_thread_num(12);
+  GetDownpourSparseTableProto(
+      downpour_server_proto->add_downpour_table_param());
+}
+
+::paddle::distributed::PSParameter GetServerProto() {
+  ::paddle::distributed::PSParameter server_fleet_desc;
+  SetServiceProto(server_fleet_desc.mutable_server_param());
+  return server_fleet_desc;
+}
+
+::paddle::distributed::PSParameter GetWorkerProto() {
+  ::paddle::distributed::PSParameter worker_fleet_desc;
+  GetDownpourSparseTableProto(worker_fleet_desc.mutable_worker_param()
+                                  ->mutable_downpour_worker_param()
+                                  ->add_downpour_table_param());
+  SetServiceProto(worker_fleet_desc.mutable_server_param());
+  return worker_fleet_desc;
+}
+
+std::string ip_ = "127.0.0.1";  // NOLINT
+uint32_t port_ = 4215;
+
+std::vector<std::string> host_sign_list_;
+
+std::shared_ptr<paddle::distributed::PSServer> pserver_ptr_;
+
+std::shared_ptr<paddle::distributed::PSClient> worker_ptr_;
+
+void RunServer() {
+  ::paddle::distributed::PSParameter server_proto = GetServerProto();
+
+  auto _ps_env = paddle::distributed::PaddlePSEnvironment();
+  _ps_env.SetPsServers(&host_sign_list_, 1);
+  pserver_ptr_ = std::shared_ptr<paddle::distributed::PSServer>(
+      paddle::distributed::PSServerFactory::Create(server_proto));
+  std::vector<framework::ProgramDesc> empty_vec;
+  framework::ProgramDesc empty_prog;
+  empty_vec.push_back(empty_prog);
+  pserver_ptr_->Configure(server_proto, _ps_env, 0, empty_vec);
+  pserver_ptr_->Start(ip_, port_);
+}
+
+void RunClient() {
+  ::paddle::distributed::PSParameter worker_proto = GetWorkerProto();
+  paddle::distributed::PaddlePSEnvironment _ps_env;
+  _ps_env.SetPsServers(&host_sign_list_, host_sign_list_.size());
+  std::map<uint64_t, std::vector<paddle::distributed::Region>> dense_regions;
+  dense_regions[0] = {};
+  worker_ptr_ = std::shared_ptr<paddle::distributed::PSClient>(
+      paddle::distributed::PSClientFactory::Create(worker_proto));
+  worker_ptr_->Configure(worker_proto, dense_regions, _ps_env, 0);
+}
+
+// Pulls the values of keys through the pull cache of the client.
+std::vector<float> Pull(const std::vector<uint64_t>& keys) {
+  std::vector<float> values(keys.size() * 10);
+  std::vector<float*> value_ptr(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    value_ptr[i] = values.data() + i * 10;
+  }
+  worker_ptr_->PullSparse(value_ptr.data(), 0, keys.data(), keys.size(), true)
+      .wait();
+  return values;
+}
+
+void ExpectStat(uint64_t hit_count, uint64_t miss_count) {
+  auto* client =
+      dynamic_cast<paddle::distributed::BrpcPsClient*>(worker_ptr_.get());
+  ASSERT_NE(client, nullptr);
+  uint64_t hit = 0, miss = 0;
+  ASSERT_TRUE(client->GetSparsePullCacheStat(0, &hit, &miss));
+  EXPECT_EQ(hit, hit_count);
+  EXPECT_EQ(miss, miss_count);
+}
+
+}  // namespace
+
+TEST(BrpcPsClient, SparsePullCache) {
+  setenv("http_proxy", "", 1);
+  setenv("https_proxy", "", 1);
+  auto ph_host = paddle::distributed::PSHost(ip_, port_, 0);
+  host_sign_list_.push_back(ph_host.SerializeToString());
+
+  std::thread server_thread(RunServer);
+  sleep(1);
+
+  // Cache a key from its first miss, and serve it for two steps.
+  FLAGS_pserver_sparse_pull_cache_mb = 1;
+  FLAGS_pserver_sparse_pull_cache_admit_count = 1;
+  FLAGS_pserver_sparse_pull_cache_stale_steps = 2;
+  FLAGS_pserver_sparse_pull_cache_stale_ms = 0;
+  RunClient();
+
+  std::vector<uint64_t> keys(10);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys[i] = i;
+  }
+  std::vector<float> values = Pull(keys);
+  ExpectStat(0, 10);
+  EXPECT_EQ(Pull(keys), values);
+  ExpectStat(10, 10);
+
+  // The gradients pushed by PushSparseRawGradient, not by PushSparse, are
+  // pulled once the cached values are two pulls old.
+  std::vector<float> grads(keys.size() * 13, 1.0);
+  std::vector<const float*> grad_ptr(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    grad_ptr[i] = grads.data() + i * 13;
+  }
+  auto* closure =
+      new paddle::distributed::DownpourBrpcClosure(1, [](void* done) {
+        auto* closure =
+            reinterpret_cast<paddle::distributed::DownpourBrpcClosure*>(done);
+        closure->set_promise_value(closure->check_response(
+            0, paddle::distributed::PS_PUSH_SPARSE_TABLE));
+      });
+  auto push_status = worker_ptr_->PushSparseRawGradient(
+      0, keys.data(), grad_ptr.data(), keys.size(), closure);
+  push_status.wait();
+  EXPECT_EQ(push_status.get(), 0);
+  EXPECT_NE(Pull(keys), values);
+  ExpectStat(10, 20);
+
+  // The values of a pull in flight across a Clear are not cached.
+  std::vector<uint64_t> new_keys(10);
+  for (size_t i = 0; i < new_keys.size(); ++i) {
+    new_keys[i] = keys.size() + i;
+  }
+  std::vector<float> new_values(new_keys.size() * 10);
+  std::vector<float*> new_value_ptr(new_keys.size());
+  for (size_t i = 0; i < new_keys.size(); ++i) {
+    new_value_ptr[i] = new_values.data() + i * 10;
+  }
+  auto pull_status = worker_ptr_->PullSparse(
+      new_value_ptr.data(), 0, new_keys.data(), new_keys.size(), true);
+  worker_ptr_->Clear(0).wait();
+  pull_status.wait();
+  Pull(new_keys);
+  ExpectStat(10, 40);
+
+  worker_ptr_->StopServer();
+  worker_ptr_->FinalizeWorker();
+  server_thread.join();
+}
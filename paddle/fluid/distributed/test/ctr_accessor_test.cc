@@ -14,11 +14,14 @@ limitations under the License. */
 
 #include "paddle/fluid/distributed/ps/table/ctr_accessor.h"
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "paddle/fluid/distributed/common/registerer.h"
+#include "paddle/fluid/distributed/ps/table/depends/sparse_value_codec.h"
 #include "paddle/fluid/distributed/ps/table/sparse_sgd_rule.h"
 #include "paddle/fluid/distributed/the_one_ps.pb.h"
 
@@ -314,4 +317,55 @@ TEST(downpour_feature_value_accessor_test, test_string_related) {
     ASSERT_FLOAT_EQ(value[i], 0);
   }
 }
+
+TEST(downpour_feature_value_accessor_test, test_compact_value) {
+  TableAccessorParameter parameter = gen_param();
+  CtrCommonAccessor* acc = new CtrCommonAccessor();
+  ASSERT_EQ(acc->Configure(parameter), 0);
+  ASSERT_EQ(acc->Initialize(), 0);
+
+  size_t dim = acc->GetAccessorInfo().dim;
+  size_t plain_size =
+      (acc->GetAccessorInfo().size - acc->GetAccessorInfo().mf_size) /
+      sizeof(float);
+  std::vector<float> value(dim);
+  for (auto i = 0u; i < dim; ++i) {
+    value[i] = 0.1f * static_cast<float>(i) - 0.5f;
+  }
+  size_t embedx_begin = acc->common_feature_value.EmbedxWIndex();
+  size_t embedx_end = embedx_begin + acc->common_feature_value.embedx_dim;
+
+  for (auto type : {SPARSE_VALUE_FP16, SPARSE_VALUE_INT8}) {
+    SparseValueCodec codec;
+    codec.Initialize(type, acc, plain_size);
+    std::vector<float> encoded(dim + SparseValueCodec::kMaxExtraSize);
+    std::vector<float> decoded(dim);
+
+    size_t encoded_size = codec.Encode(value.data(), dim, encoded.data());
+    ASSERT_LT(encoded_size, dim);
+    // fields other than embedx_w are readable from the encoded value
+    ASSERT_FLOAT_EQ(acc->common_feature_value.Show(encoded.data()),
+                    acc->common_feature_value.Show(value.data()));
+    ASSERT_EQ(codec.Decode(encoded.data(), encoded_size, decoded.data()), dim);
+    float max_abs = 0.0f;
+    for (auto i = embedx_begin; i < embedx_end; ++i) {
+      max_abs = std::max(max_abs, std::fabs(value[i]));
+    }
+    float tolerance =
+        type == SPARSE_VALUE_FP16 ? 1e-3 * max_abs : max_abs / 127.0f;
+    for (auto i = 0u; i < dim; ++i) {
+      if (i >= embedx_begin && i < embedx_end) {
+        ASSERT_NEAR(decoded[i], value[i], tolerance);
+      } else {
+        ASSERT_FLOAT_EQ(decoded[i], value[i]);
+      }
+    }
+
+    // values without embedx are stored as is
+    ASSERT_EQ(codec.Encode(value.data(), plain_size, encoded.data()),
+              plain_size);
+    ASSERT_EQ(codec.Decode(encoded.data(), plain_size, decoded.data()),
+              plain_size);
+  }
+}
 }  // namespace paddle::distributed
@@ -14,9 +14,11 @@ limitations under the License. */
 
 #include "paddle/fluid/distributed/ps/table/depends/feature_value.h"
 
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/table/depends/concurrent_table_shard.h"
 
 namespace paddle::distributed {
 
@@ -45,4 +47,77 @@ TEST(BENCHMARK, LargeScaleKV) {
   ASSERT_FLOAT_EQ(value_data[3], 0.3);
 }
 
+TEST(ConcurrentSparseTableShard, ParallelInsert) {
+  typedef ConcurrentSparseTableShard<uint64_t, FixedFeatureValue> shard_type;
+  shard_type shard;
+  const int thread_num = 8;
+  const uint64_t key_num = 100000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_num; ++t) {
+    threads.emplace_back([&shard, key_num] {
+      for (uint64_t key = 0; key < key_num; ++key) {
+        auto* value = shard.emplace(key).first.value_ptr();
+        std::lock_guard<ShardValueLock> guard(shard.ValueLock(key));
+        if (value->size() == 0) {
+          value->resize(1);
+          value->data()[0] = 0;
+        }
+        value->data()[0] += 1;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(shard.size(), key_num);
+  size_t iter_num = 0;
+  for (auto it = shard.begin(); it != shard.end(); ++it) {
+    ASSERT_FLOAT_EQ(it.value().data()[0], thread_num);
+    ++iter_num;
+  }
+  ASSERT_EQ(iter_num, key_num);
+
+  for (uint64_t key = 0; key < key_num; key += 2) {
+    ASSERT_EQ(shard.erase(key), 1UL);
+  }
+  ASSERT_EQ(shard.size(), key_num / 2);
+  ASSERT_TRUE(shard.find(0) == shard.end());
+  ASSERT_TRUE(shard.find(1) != shard.end());
+  ASSERT_FLOAT_EQ(shard.find(1).value().data()[0], thread_num);
+}
+
+TEST(FixedFeatureValue, Arena) {
+  ASSERT_EQ(sizeof(FixedFeatureValue), 16UL);
+  FixedFeatureValue value;
+  ASSERT_EQ(value.size(), 0UL);
+  ASSERT_TRUE(value.data() == nullptr);
+
+  // as std::vector, resize keeps the floats and zeroes the new ones
+  value.resize(3);
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_FLOAT_EQ(value.data()[i], 0);
+    value.data()[i] = i + 1;
+  }
+  value.resize(FeatureValueArena::kMaxPooledSize + 1);
+  ASSERT_FLOAT_EQ(value.data()[2], 3);
+  ASSERT_FLOAT_EQ(value.data()[FeatureValueArena::kMaxPooledSize], 0);
+  value.resize(2);
+  value.shrink_to_fit();
+  ASSERT_EQ(value.size(), 2UL);
+  ASSERT_FLOAT_EQ(value.data()[1], 2);
+
+  FixedFeatureValue copy = value;
+  ASSERT_TRUE(copy.data() != value.data());
+  ASSERT_EQ(copy.size(), 2UL);
+  ASSERT_FLOAT_EQ(copy.data()[1], 2);
+
+  // a freed array is reused by the next value of its size in the thread
+  float* data = copy.data();
+  copy.resize(0);
+  copy.shrink_to_fit();
+  FixedFeatureValue other;
+  other.resize(2);
+  ASSERT_TRUE(other.data() == data);
+}
+
 }  // namespace paddle::distributed
@@ -0,0 +1,280 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr_shard.h"
+
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/table/common_graph_table.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+namespace distributed = paddle::distributed;
+
+// Node 3 has 3 neighbors, node 7 none, nodes 50 and 1000 have 10 neighbors
+// id * 100 + j of weight j + 1.
+std::vector<std::unique_ptr<distributed::GraphNode>> prepare_nodes(
+    bool is_weighted) {
+  std::vector<std::unique_ptr<distributed::GraphNode>> nodes;
+  for (uint64_t id : {50, 3, 7, 1000}) {
+    auto node = std::make_unique<distributed::GraphNode>(id);
+    node->build_edges(is_weighted);
+    int degree = id == 7 ? 0 : (id == 3 ? 3 : 10);
+    for (int j = 0; j < degree; j++) {
+      node->add_edge(id * 100 + j, j + 1);
+    }
+    nodes.push_back(std::move(node));
+  }
+  return nodes;
+}
+
+void testGraphCsrShard(bool is_weighted) {
+  auto nodes = prepare_nodes(is_weighted);
+  std::vector<distributed::Node *> node_ptrs;
+  for (auto &node : nodes) node_ptrs.push_back(node.get());
+
+  distributed::GraphCsrShard shard;
+  shard.build(node_ptrs, is_weighted);
+  ASSERT_EQ(shard.node_num(), 4UL);
+  ASSERT_EQ(shard.edge_num(), 23UL);
+  ASSERT_EQ(shard.find(8), -1);
+  ASSERT_EQ(shard.get_neighbor_size(shard.find(7)), 0UL);
+
+  std::mt19937_64 rng(1);
+  uint64_t ids[16];
+  float weights[16];
+  // All the neighbors are returned in order when there are at most k.
+  ASSERT_EQ(shard.sample_k(shard.find(3), 5, &rng, ids, weights), 3);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(ids[i], 300UL + i);
+    ASSERT_EQ(weights[i], is_weighted ? i + 1 : 1);
+  }
+  ASSERT_EQ(shard.sample_k(shard.find(7), 5, &rng, ids, weights), 0);
+
+  // Weighted sampling needs the alias tables.
+  ASSERT_FALSE(shard.has_alias_tables());
+  shard.build_alias_tables();
+  ASSERT_EQ(shard.has_alias_tables(), is_weighted);
+  std::vector<int> counts(10, 0);
+  const int rounds = 20000;
+  for (int r = 0; r < rounds; r++) {
+    ASSERT_EQ(shard.sample_k(shard.find(50), 4, &rng, ids, weights), 4);
+    if (!is_weighted) {
+      ASSERT_EQ(std::set<uint64_t>(ids, ids + 4).size(), 4UL);
+    }
+    for (int i = 0; i < 4; i++) {
+      ASSERT_GE(ids[i], 5000UL);
+      ASSERT_LT(ids[i], 5010UL);
+      counts[ids[i] - 5000]++;
+    }
+  }
+  // Weighted draws are proportional to the weights 1, ..., 10.
+  for (int j = 0; j < 10; j++) {
+    double expected = is_weighted ? rounds * 4.0 * (j + 1) / 55 : rounds * 0.4;
+    ASSERT_NEAR(counts[j], expected, expected * 0.1);
+  }
+
+  std::string path = is_weighted ? "csr_shard_weighted" : "csr_shard";
+  ASSERT_EQ(shard.save(path), 0);
+  distributed::GraphCsrShard loaded;
+  ASSERT_EQ(loaded.load(path), 0);
+  ASSERT_EQ(loaded.node_num(), 4UL);
+  ASSERT_EQ(loaded.edge_num(), 23UL);
+  ASSERT_EQ(loaded.is_weighted(), is_weighted);
+  // The alias tables are not saved.
+  ASSERT_FALSE(loaded.has_alias_tables());
+  loaded.build_alias_tables();
+  ASSERT_EQ(loaded.memory_size(), shard.memory_size());
+
+  uint64_t batch_ids[3] = {3, 8, 1000};
+  uint64_t batch_out[15];
+  float batch_weights[15];
+  int actual_sizes[3];
+  loaded.sample_batch(
+      batch_ids, 3, 5, &rng, batch_out, batch_weights, actual_sizes);
+  ASSERT_EQ(actual_sizes[0], 3);
+  ASSERT_EQ(actual_sizes[1], 0);
+  ASSERT_EQ(actual_sizes[2], 5);
+  ASSERT_EQ(batch_out[0], 300UL);
+  for (int i = 10; i < 15; i++) {
+    ASSERT_GE(batch_out[i], 100000UL);
+    ASSERT_LT(batch_out[i], 100010UL);
+  }
+}
+
+TEST(GraphCsrShard, Unweighted) { testGraphCsrShard(false); }
+
+TEST(GraphCsrShard, Weighted) { testGraphCsrShard(true); }
+
+TEST(GraphCsrShard, LoadInvalidFile) {
+  std::ofstream ofs("csr_shard_invalid");
+  ofs << "not a csr shard";
+  ofs.close();
+  distributed::GraphCsrShard shard;
+  ASSERT_EQ(shard.load("csr_shard_invalid"), -1);
+  ASSERT_EQ(shard.node_num(), 0UL);
+}
+
+TEST(GraphCsrShard, Merge) {
+  auto nodes = prepare_nodes(true);
+  distributed::GraphCsrShard base;
+  base.build({nodes[0].get(), nodes[1].get()}, true);
+  base.build_alias_tables();
+  // Node 3 again and a new node 5.
+  distributed::GraphNode node3(3), node5(5);
+  node3.build_edges(true);
+  node3.add_edge(303, 4);
+  node5.build_edges(true);
+  node5.add_edge(500, 1);
+
+  distributed::GraphCsrShard shard;
+  shard.build({&node5, &node3, nodes[3].get()}, true, &base);
+  ASSERT_EQ(shard.node_num(), 4UL);
+  ASSERT_EQ(shard.edge_num(), 25UL);
+  ASSERT_TRUE(shard.has_alias_tables());
+  std::mt19937_64 rng(1);
+  uint64_t ids[16];
+  float weights[16];
+  ASSERT_EQ(shard.sample_k(shard.find(3), 5, &rng, ids, weights), 4);
+  for (int i = 0; i < 4; i++) {
+    ASSERT_EQ(ids[i], 300UL + i);
+    ASSERT_EQ(weights[i], i + 1);
+  }
+  ASSERT_EQ(shard.sample_k(shard.find(5), 5, &rng, ids, weights), 1);
+  ASSERT_EQ(ids[0], 500UL);
+  ASSERT_EQ(shard.get_neighbor_size(shard.find(50)), 10UL);
+  ASSERT_EQ(shard.get_neighbor_size(shard.find(1000)), 10UL);
+}
+
+// Node 10 has 3 neighbors in the first file and 2 in the second, node 21 has
+// 8 neighbors 2100 + j of weight j + 1.
+void prepare_edge_files() {
+  std::ofstream first("csr_edges_0");
+  for (int j = 0; j < 3; j++) {
+    first << 10 << "\t" << 1000 + j << "\t" << j + 1 << std::endl;
+  }
+  for (int j = 0; j < 8; j++) {
+    first << 21 << "\t" << 2100 + j << "\t" << j + 1 << std::endl;
+  }
+  std::ofstream second("csr_edges_1");
+  for (int j = 3; j < 5; j++) {
+    second << 10 << "\t" << 1000 + j << "\t" << j + 1 << std::endl;
+  }
+}
+
+std::unique_ptr<distributed::GraphTable> prepare_table(
+    bool freeze_edges, bool build_sampler_on_cpu, bool load_edges) {
+  ::paddle::distributed::GraphParameter table_proto;
+  table_proto.set_task_pool_size(4);
+  table_proto.set_shard_num(4);
+  table_proto.add_edge_types("u2u");
+  table_proto.add_node_types("u");
+  table_proto.add_graph_feature();
+  table_proto.set_build_sampler_on_cpu(build_sampler_on_cpu);
+  table_proto.set_freeze_edges(freeze_edges);
+  auto table = std::make_unique<distributed::GraphTable>();
+  table->Initialize(table_proto);
+  if (load_edges) {
+    table->load_edges("csr_edges_0", false, "u2u", true);
+    table->load_edges("csr_edges_1", false, "u2u", true);
+  }
+  return table;
+}
+
+std::vector<uint64_t> sample_neighbors(distributed::GraphTable *table,
+                                       uint64_t id,
+                                       int k) {
+  std::vector<std::shared_ptr<char>> buffers(1);
+  std::vector<int> actual_sizes(1, 0);
+  table->random_sample_neighbors(0, &id, k, buffers, actual_sizes, false);
+  std::vector<uint64_t> ids(actual_sizes[0] / distributed::Node::id_size);
+  if (!ids.empty()) {
+    std::memcpy(ids.data(), buffers[0].get(), actual_sizes[0]);
+  }
+  return ids;
+}
+
+// Counts the neighbors 2100 + j of node 21 in k samples per round.
+std::vector<int> count_neighbors(distributed::GraphTable *table,
+                                 int k,
+                                 int rounds) {
+  std::vector<int> counts(8, 0);
+  for (int r = 0; r < rounds; r++) {
+    auto ids = sample_neighbors(table, 21, k);
+    EXPECT_EQ(ids.size(), static_cast<size_t>(k));
+    EXPECT_EQ(std::set<uint64_t>(ids.begin(), ids.end()).size(), ids.size());
+    for (auto id : ids) {
+      EXPECT_GE(id, 2100UL);
+      EXPECT_LT(id, 2108UL);
+      counts[id - 2100]++;
+    }
+  }
+  return counts;
+}
+
+TEST(GraphCsrShard, GraphTable) {
+  prepare_edge_files();
+  auto table = prepare_table(false, true, true);
+  auto frozen_table = prepare_table(true, true, true);
+  ASSERT_NE(frozen_table->find_frozen_edge_shard(0, 21), nullptr);
+  ASSERT_EQ(frozen_table->find_node(distributed::GraphTableType::EDGE_TABLE,
+                                    0,
+                                    21),
+            nullptr);
+
+  // All the neighbors are sampled in the order they are loaded.
+  for (uint64_t id : {10, 21, 33}) {
+    ASSERT_EQ(sample_neighbors(frozen_table.get(), id, 16),
+              sample_neighbors(table.get(), id, 16));
+  }
+  ASSERT_EQ(sample_neighbors(frozen_table.get(), 10, 16).size(), 5UL);
+
+  // Both sample uniformly without replacement.
+  const int rounds = 20000;
+  for (auto *t : {table.get(), frozen_table.get()}) {
+    auto counts = count_neighbors(t, 3, rounds);
+    for (int j = 0; j < 8; j++) {
+      double expected = rounds * 3.0 / 8;
+      ASSERT_NEAR(counts[j], expected, expected * 0.1);
+    }
+  }
+
+  // The frozen shards are saved and loaded without the nodes.
+  ASSERT_EQ(frozen_table->Save("csr_graph_table", ""), 0);
+  auto loaded_table = prepare_table(false, true, false);
+  ASSERT_EQ(loaded_table->Load("csr_graph_table", "fu2u"), 0);
+  for (uint64_t id : {10, 21, 33}) {
+    ASSERT_EQ(sample_neighbors(loaded_table.get(), id, 16),
+              sample_neighbors(table.get(), id, 16));
+  }
+  ASSERT_EQ(loaded_table->Load("csr_graph_table", "fu2i"), -1);
+
+  // A weighted draw is proportional to the weights on both.
+  auto weighted_table = prepare_table(false, false, true);
+  weighted_table->build_sampler(0, "weighted");
+  loaded_table->build_sampler(0, "weighted");
+  for (auto *t : {weighted_table.get(), loaded_table.get()}) {
+    auto counts = count_neighbors(t, 1, rounds);
+    for (int j = 0; j < 8; j++) {
+      double expected = rounds * (j + 1) / 36.0;
+      ASSERT_NEAR(counts[j], expected, expected * 0.15);
+    }
+  }
+}
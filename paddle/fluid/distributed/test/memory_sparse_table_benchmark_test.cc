@@ -0,0 +1,168 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
+#include "paddle/fluid/distributed/ps/table/table.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+namespace paddle::distributed {
+
+namespace {
+
+constexpr int kEmbDim = 8;
+constexpr int kSelectDim = kEmbDim + 3;
+constexpr int kUpdateDim = kEmbDim + 4;
+
+void InitTableConfig(TableParameter *table_config) {
+  table_config->set_shard_num(10);
+  TableAccessorParameter *accessor_config = table_config->mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(kSelectDim);
+  accessor_config->set_embedx_dim(kEmbDim);
+  accessor_config->set_embedx_threshold(5);
+  auto *ctr_param = accessor_config->mutable_ctr_accessor_param();
+  ctr_param->set_nonclk_coeff(0.2);
+  ctr_param->set_click_coeff(1);
+  ctr_param->set_base_threshold(0.5);
+  ctr_param->set_delta_threshold(0.2);
+  ctr_param->set_delta_keep_days(16);
+  ctr_param->set_show_click_decay_rate(0.99);
+  for (auto *sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseNaiveSGDRule");
+    auto *naive_param = sgd_param->mutable_naive();
+    naive_param->set_learning_rate(0.1);
+    naive_param->set_initial_range(0.3);
+    naive_param->add_weight_bounds(-10.0);
+    naive_param->add_weight_bounds(10.0);
+  }
+}
+
+// Keys drawn from a zipf distribution of exponent s over key_space keys, the
+// hottest keys fall into a few shards.
+std::vector<uint64_t> ZipfKeys(size_t num, size_t key_space, double s) {
+  std::vector<double> cdf(key_space);
+  double sum = 0.0;
+  for (size_t i = 0; i < key_space; ++i) {
+    sum += 1.0 / std::pow(static_cast<double>(i + 1), s);
+    cdf[i] = sum;
+  }
+  std::mt19937_64 engine(2024);
+  std::uniform_real_distribution<double> dist(0.0, sum);
+  std::vector<uint64_t> keys(num);
+  for (auto &key : keys) {
+    size_t rank = std::lower_bound(cdf.begin(), cdf.end(), dist(engine)) -
+                  cdf.begin();
+    key = std::min(rank, key_space - 1) * 7 + 1;
+  }
+  return keys;
+}
+
+// Runs batches of pull then push from client_num threads, returns the average
+// ns per key.
+double RunPullPush(Table *table,
+                   const std::vector<std::vector<uint64_t>> &batches,
+                   int client_num) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> clients;
+  for (int client = 0; client < client_num; ++client) {
+    clients.emplace_back([table, &batches, client, client_num] {
+      std::vector<float> pull_values;
+      std::vector<float> push_values;
+      for (size_t i = client; i < batches.size(); i += client_num) {
+        auto &keys = batches[i];
+        std::vector<uint32_t> fres(keys.size(), 1);
+        pull_values.resize(keys.size() * kSelectDim);
+        TableContext pull_context;
+        pull_context.value_type = Sparse;
+        pull_context.pull_context.pull_value =
+            PullSparseValue(keys, fres, kEmbDim);
+        pull_context.pull_context.values = pull_values.data();
+        table->Pull(pull_context);
+
+        push_values.assign(keys.size() * kUpdateDim, 0.01f);
+        TableContext push_context;
+        push_context.value_type = Sparse;
+        push_context.push_context.keys = keys.data();
+        push_context.push_context.values = push_values.data();
+        push_context.num = keys.size();
+        table->Push(push_context);
+      }
+    });
+  }
+  for (auto &client : clients) {
+    client.join();
+  }
+  double ns = std::chrono::duration<double, std::nano>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+  size_t key_num = 0;
+  for (auto &batch : batches) {
+    key_num += batch.size();
+  }
+  return ns / key_num;
+}
+
+}  // namespace
+
+TEST(MemorySparseTable, ZipfPullPushBenchmark) {
+  const size_t key_space = 1 << 20;
+  const size_t batch_size = 1 << 14;
+  const int batch_num = 32;
+  const int client_num = 4;
+
+  for (double s : {0.0, 0.99, 1.2}) {
+    auto keys = ZipfKeys(batch_size * batch_num, key_space, s);
+    std::vector<std::vector<uint64_t>> batches(batch_num);
+    for (int i = 0; i < batch_num; ++i) {
+      batches[i].assign(keys.begin() + i * batch_size,
+                        keys.begin() + (i + 1) * batch_size);
+    }
+
+    std::vector<std::unique_ptr<Table>> tables;
+    tables.emplace_back(new MemorySparseTable());
+    tables.emplace_back(new ConcurrentMemorySparseTable());
+    std::vector<std::string> names = {"MemorySparseTable",
+                                      "ConcurrentMemorySparseTable"};
+    for (size_t i = 0; i < tables.size(); ++i) {
+      TableParameter table_config;
+      table_config.set_table_class(names[i]);
+      InitTableConfig(&table_config);
+      FsClientParameter fs_config;
+      tables[i]->SetShard(0, 1);
+      ASSERT_EQ(tables[i]->Initialize(table_config, fs_config), 0);
+      double ns_per_key = RunPullPush(tables[i].get(), batches, client_num);
+      LOG(INFO) << names[i] << " zipf s=" << s << ": " << ns_per_key
+                << " ns/key";
+    }
+    // both tables create the same features
+    auto *table = dynamic_cast<MemorySparseTable *>(tables[0].get());
+    auto *concurrent_table =
+        dynamic_cast<ConcurrentMemorySparseTable *>(tables[1].get());
+    ASSERT_EQ(table->LocalSize(), concurrent_table->LocalSize());
+    ASSERT_EQ(table->LocalMFSize(), concurrent_table->LocalMFSize());
+  }
+}
+
+}  // namespace paddle::distributed
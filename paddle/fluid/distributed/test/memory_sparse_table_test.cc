@@ -17,6 +17,8 @@ limitations under the License. */
 #include <ThreadPool.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <thread>  // NOLINT
 
@@ -24,6 +26,7 @@ limitations under the License. */
 #include "gtest/gtest.h"
 #include "paddle/fluid/distributed/ps/table/table.h"
 #include "paddle/fluid/distributed/the_one_ps.pb.h"
+#include "test/cpp/utils/temp_dir.h"
 
 namespace paddle::distributed {
 
@@ -151,4 +154,196 @@ TEST(MemorySparseTable, SGD) {
   }
 }
 
+TEST(MemorySparseTable, BinarySaveLoad) {
+  int emb_dim = 8;
+  TableParameter table_config;
+  table_config.set_table_class("MemorySparseTable");
+  table_config.set_shard_num(10);
+  table_config.set_save_binary_format(true);
+  FsClientParameter fs_config;
+
+  TableAccessorParameter *accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(11);
+  accessor_config->set_embedx_dim(8);
+  accessor_config->set_embedx_threshold(5);
+  accessor_config->mutable_embed_sgd_param()->set_name("SparseNaiveSGDRule");
+  auto *naive_param =
+      accessor_config->mutable_embed_sgd_param()->mutable_naive();
+  naive_param->set_learning_rate(0.1);
+  naive_param->set_initial_range(0.3);
+  accessor_config->mutable_embedx_sgd_param()->set_name("SparseNaiveSGDRule");
+  naive_param = accessor_config->mutable_embedx_sgd_param()->mutable_naive();
+  naive_param->set_learning_rate(0.1);
+  naive_param->set_initial_range(0.3);
+
+  std::unique_ptr<Table> table(new MemorySparseTable());
+  table->SetShard(0, 1);
+  ASSERT_EQ(table->Initialize(table_config, fs_config), 0);
+
+  std::vector<uint64_t> keys;
+  std::vector<uint32_t> fres;
+  for (uint64_t key = 0; key < 100; ++key) {
+    keys.push_back(key * 7);
+    fres.push_back(1);
+  }
+  auto pull_value = PullSparseValue(keys, fres, emb_dim);
+  std::vector<float> values(keys.size() * (emb_dim + 3));
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.pull_context.pull_value = pull_value;
+  table_context.pull_context.values = values.data();
+  table->Pull(table_context);
+
+  paddle::test::TempDir temp_dir("memory_sparse_table");
+  const std::string& dirname = temp_dir.path();
+  ASSERT_EQ(table->Save(dirname, "0"), 0);
+
+  std::unique_ptr<Table> loaded_table(new MemorySparseTable());
+  loaded_table->SetShard(0, 1);
+  ASSERT_EQ(loaded_table->Initialize(table_config, fs_config), 0);
+  ASSERT_EQ(loaded_table->Load(dirname, "0"), 0);
+
+  std::vector<float> loaded_values(values.size());
+  table_context.pull_context.values = loaded_values.data();
+  loaded_table->Pull(table_context);
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_FLOAT_EQ(values[i], loaded_values[i]);
+  }
+}
+
+TEST(MemorySparseTable, CompactValue) {
+  int emb_dim = 8;
+  auto make_config = [](SparseValueType value_type) {
+    TableParameter table_config;
+    table_config.set_table_class("MemorySparseTable");
+    table_config.set_shard_num(10);
+    table_config.set_sparse_value_type(value_type);
+    TableAccessorParameter *accessor_config = table_config.mutable_accessor();
+    accessor_config->set_accessor_class("CtrCommonAccessor");
+    accessor_config->set_fea_dim(11);
+    accessor_config->set_embedx_dim(8);
+    accessor_config->set_embedx_threshold(5);
+    // zero initial values, so that the tables of all the types start equal
+    accessor_config->mutable_embed_sgd_param()->set_name("SparseNaiveSGDRule");
+    auto *naive_param =
+        accessor_config->mutable_embed_sgd_param()->mutable_naive();
+    naive_param->set_learning_rate(0.1);
+    naive_param->set_initial_range(0);
+    accessor_config->mutable_embedx_sgd_param()->set_name(
+        "SparseNaiveSGDRule");
+    naive_param = accessor_config->mutable_embedx_sgd_param()->mutable_naive();
+    naive_param->set_learning_rate(0.1);
+    naive_param->set_initial_range(0);
+    return table_config;
+  };
+
+  std::vector<uint64_t> keys;
+  std::vector<uint32_t> fres;
+  for (uint64_t key = 0; key < 100; ++key) {
+    keys.push_back(key * 7);
+    fres.push_back(1);
+  }
+  // the first push extends the embedx of the values, the others update it
+  std::vector<std::vector<float>> pushes(3);
+  for (size_t p = 0; p < pushes.size(); ++p) {
+    for (size_t i = 0; i < keys.size(); ++i) {
+      pushes[p].push_back(0);   // slot
+      pushes[p].push_back(10);  // show
+      pushes[p].push_back(10);  // click
+      for (int k = 0; k <= emb_dim; ++k) {
+        pushes[p].push_back(0.01 * ((i + p * 3 + k * 5) % 17) - 0.08);
+      }
+    }
+  }
+  auto pull_value = PullSparseValue(keys, fres, emb_dim);
+  auto pull = [&](Table *table) {
+    std::vector<float> values(keys.size() * (emb_dim + 3));
+    TableContext table_context;
+    table_context.value_type = Sparse;
+    table_context.pull_context.pull_value = pull_value;
+    table_context.pull_context.values = values.data();
+    table->Pull(table_context);
+    return values;
+  };
+  auto train = [&](Table *table) {
+    pull(table);
+    for (auto &push_values : pushes) {
+      TableContext table_context;
+      table_context.value_type = Sparse;
+      table_context.push_context.keys = keys.data();
+      table_context.push_context.values = push_values.data();
+      table_context.num = keys.size();
+      table->Push(table_context);
+    }
+    return pull(table);
+  };
+
+  FsClientParameter fs_config;
+  std::unique_ptr<Table> fp32_table(new MemorySparseTable());
+  fp32_table->SetShard(0, 1);
+  ASSERT_EQ(fp32_table->Initialize(make_config(SPARSE_VALUE_FP32), fs_config),
+            0);
+  auto fp32_values = train(fp32_table.get());
+  float max_abs = 0;
+  for (float value : fp32_values) {
+    max_abs = std::max(max_abs, std::abs(value));
+  }
+  ASSERT_GT(max_abs, 0);
+
+  paddle::test::TempDir temp_dir("memory_sparse_table");
+  const std::string& dirname = temp_dir.path();
+
+  for (auto value_type : {SPARSE_VALUE_FP16, SPARSE_VALUE_INT8}) {
+    // an int8 step of the largest weight, for each update
+    float tolerance = value_type == SPARSE_VALUE_FP16 ? 1e-3 : max_abs / 40;
+    auto table_config = make_config(value_type);
+    table_config.set_save_binary_format(true);
+    std::unique_ptr<Table> table(new MemorySparseTable());
+    table->SetShard(0, 1);
+    ASSERT_EQ(table->Initialize(table_config, fs_config), 0);
+    auto values = train(table.get());
+    ASSERT_EQ(values.size(), fp32_values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+      EXPECT_NEAR(values[i], fp32_values[i], tolerance);
+    }
+
+    std::string path = dirname + "/" + std::to_string(value_type);
+    ASSERT_EQ(table->Save(path, "0"), 0);
+    std::unique_ptr<Table> loaded_table(new MemorySparseTable());
+    loaded_table->SetShard(0, 1);
+    ASSERT_EQ(loaded_table->Initialize(table_config, fs_config), 0);
+    ASSERT_EQ(loaded_table->Load(path, "0"), 0);
+    // the saved values are decoded ones, encoded again the same
+    auto loaded_values = pull(loaded_table.get());
+    for (size_t i = 0; i < values.size(); ++i) {
+      EXPECT_NEAR(loaded_values[i], values[i], 1e-6);
+    }
+
+    // The text Load parses a value into its fp32 floats, which the encoded
+    // value does not keep.
+    auto text_config = make_config(value_type);
+    std::unique_ptr<Table> text_table(new MemorySparseTable());
+    text_table->SetShard(0, 1);
+    ASSERT_EQ(text_table->Initialize(text_config, fs_config), 0);
+    train(text_table.get());
+    std::string text_path = path + "_text";
+    ASSERT_EQ(text_table->Save(text_path, "0"), 0);
+    std::unique_ptr<Table> text_loaded_table(new MemorySparseTable());
+    text_loaded_table->SetShard(0, 1);
+    ASSERT_EQ(text_loaded_table->Initialize(text_config, fs_config), 0);
+    ASSERT_EQ(text_loaded_table->Load(text_path, "0"), 0);
+    size_t value_num = 0;
+    for (size_t s = 0; s < text_config.shard_num(); ++s) {
+      auto *shard = static_cast<MemorySparseTable::shard_type *>(
+          text_loaded_table->GetShard(s));
+      for (auto it = shard->begin(); it != shard->end(); ++it) {
+        EXPECT_EQ(it.value().capacity(), it.value().size());
+        ++value_num;
+      }
+    }
+    EXPECT_EQ(value_num, keys.size());
+  }
+}
+
 }  // namespace paddle::distributed
@@ -0,0 +1,214 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/segment_value_store.h"
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/cpp/utils/temp_dir.h"
+
+namespace distributed = paddle::distributed;
+
+const int kDim = 8;
+
+std::vector<float> MakeValue(uint64_t key, int version) {
+  // Two widths, as the rows with and without the embedx.
+  std::vector<float> value(key % 2 == 0 ? kDim : kDim / 2);
+  for (size_t i = 0; i < value.size(); ++i) {
+    value[i] = static_cast<float>(key * 100 + version * 10 + i);
+  }
+  return value;
+}
+
+void Put(distributed::SSDValueStore *store,
+         uint64_t key,
+         const std::vector<float> &value) {
+  store->put(0,
+             reinterpret_cast<const char *>(&key),
+             sizeof(uint64_t),
+             reinterpret_cast<const char *>(value.data()),
+             value.size() * sizeof(float));
+}
+
+void CheckValue(const char *data, size_t size, const std::vector<float> &v) {
+  ASSERT_EQ(size, v.size() * sizeof(float));
+  const float *value = reinterpret_cast<const float *>(data);
+  for (size_t i = 0; i < v.size(); ++i) {
+    ASSERT_FLOAT_EQ(value[i], v[i]);
+  }
+}
+
+// The dir must outlive the store, which keeps the segments open.
+std::unique_ptr<distributed::SegmentValueStore> MakeStore(
+    const paddle::test::TempDir &dir) {
+  distributed::SegmentValueStore::Options options;
+  options.segment_bytes = 4096;
+  options.gc_ratio = 0.5;
+  // Compacted by the test only.
+  options.gc_interval_ms = 3600 * 1000;
+  auto store = std::make_unique<distributed::SegmentValueStore>(options);
+  store->initialize(dir.path() + "/segment", 1);
+  return store;
+}
+
+TEST(SegmentValueStore, PutGetDelete) {
+  paddle::test::TempDir dir("segment_store");
+  auto store = MakeStore(dir);
+  std::map<uint64_t, std::vector<float>> expected;
+  for (uint64_t key = 0; key < 200; ++key) {
+    expected[key] = MakeValue(key, 0);
+    Put(store.get(), key, expected[key]);
+  }
+  // Overwrite and delete some keys.
+  for (uint64_t key = 0; key < 200; key += 3) {
+    expected[key] = MakeValue(key, 1);
+    Put(store.get(), key, expected[key]);
+  }
+  for (uint64_t key = 1; key < 200; key += 5) {
+    store->del_data(0, reinterpret_cast<const char *>(&key), sizeof(key));
+    expected.erase(key);
+  }
+  ASSERT_GT(store->SegmentNum(0), 1UL);
+
+  for (uint64_t key = 0; key < 210; ++key) {
+    std::string value;
+    int ret = store->get(
+        0, reinterpret_cast<const char *>(&key), sizeof(key), value);
+    if (expected.count(key)) {
+      ASSERT_EQ(ret, 0);
+      CheckValue(value.data(), value.size(), expected[key]);
+    } else {
+      ASSERT_EQ(ret, 1);
+    }
+  }
+
+  distributed::SSDValueBatch batch;
+  for (uint64_t key = 209; key < 210; --key) {
+    batch.keys.push_back(key);
+  }
+  store->multi_get(0, &batch);
+  for (size_t i = 0; i < batch.keys.size(); ++i) {
+    uint64_t key = batch.keys[i];
+    ASSERT_EQ(batch.found(i), expected.count(key) > 0);
+    if (batch.found(i)) {
+      CheckValue(batch.value(i), batch.sizes[i], expected[key]);
+    }
+  }
+
+  uint64_t num_keys = 0;
+  store->get_estimate_key_num(num_keys);
+  ASSERT_EQ(num_keys, expected.size());
+}
+
+TEST(SegmentValueStore, IterateAndCompact) {
+  paddle::test::TempDir dir("segment_store");
+  auto store = MakeStore(dir);
+  std::map<uint64_t, std::vector<float>> expected;
+  for (int version = 0; version < 4; ++version) {
+    for (uint64_t key = 0; key < 300; ++key) {
+      expected[key] = MakeValue(key, version);
+      Put(store.get(), key, expected[key]);
+    }
+  }
+  uint64_t disk_bytes = store->DiskBytes(0);
+  ASSERT_GT(store->Compact(0), 0UL);
+  ASSERT_LT(store->DiskBytes(0), disk_bytes);
+
+  // Delete the keys while iterating, as the shrink does.
+  std::unique_ptr<distributed::SSDValueIterator> it(store->get_iterator(0));
+  size_t count = 0;
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    uint64_t key = *reinterpret_cast<const uint64_t *>(it->key().data());
+    CheckValue(it->value().data(), it->value().size(), expected[key]);
+    if (key % 2 == 1) {
+      store->del_data(0, it->key().data(), it->key().size());
+      expected.erase(key);
+    }
+    ++count;
+  }
+  ASSERT_EQ(count, 300UL);
+  store->Compact(0);
+
+  for (uint64_t key = 0; key < 300; ++key) {
+    std::string value;
+    int ret = store->get(
+        0, reinterpret_cast<const char *>(&key), sizeof(key), value);
+    ASSERT_EQ(ret, expected.count(key) ? 0 : 1);
+    if (ret == 0) {
+      CheckValue(value.data(), value.size(), expected[key]);
+    }
+  }
+}
+
+TEST(SegmentValueStore, ConcurrentPut) {
+  paddle::test::TempDir dir("segment_store");
+  auto store = MakeStore(dir);
+  // Each thread puts its own keys while the others write theirs, and the
+  // compaction moves the values of the sealed segments.
+  const int thread_num = 4;
+  const uint64_t key_num = 200;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_num; ++t) {
+    threads.emplace_back([&store, t]() {
+      for (int version = 0; version < 4; ++version) {
+        for (uint64_t key = t; key < key_num; key += thread_num) {
+          Put(store.get(), key, MakeValue(key, version));
+        }
+      }
+    });
+  }
+  for (int i = 0; i < 10; ++i) {
+    store->Compact(0);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  store->Compact(0);
+
+  distributed::SSDValueBatch batch;
+  for (uint64_t key = 0; key < key_num; ++key) {
+    batch.keys.push_back(key);
+  }
+  store->multi_get(0, &batch);
+  for (size_t i = 0; i < batch.keys.size(); ++i) {
+    ASSERT_TRUE(batch.found(i));
+    CheckValue(batch.value(i), batch.sizes[i], MakeValue(batch.keys[i], 3));
+  }
+}
+
+TEST(SegmentValueStore, TruncatedSegment) {
+  paddle::test::TempDir dir("segment_store");
+  auto store = MakeStore(dir);
+  uint64_t key = 2;
+  Put(store.get(), key, MakeValue(key, 0));
+  // Lose the end of the value, a short read is an error instead of a value
+  // with stale bytes.
+  std::string segment = dir.path() + "/segment_0/segment-000000.log";
+  std::filesystem::resize_file(segment,
+                               std::filesystem::file_size(segment) - 4);
+  std::string value;
+  ASSERT_ANY_THROW(store->get(
+      0, reinterpret_cast<const char *>(&key), sizeof(key), value));
+  distributed::SSDValueBatch batch;
+  batch.keys.push_back(key);
+  ASSERT_ANY_THROW(store->multi_get(0, &batch));
+}
@@ -0,0 +1,130 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/service/sparse_pull_cache.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace distributed = paddle::distributed;
+
+const size_t kDim = 4;
+
+distributed::SparsePullCache::Options GetOptions() {
+  distributed::SparsePullCache::Options options;
+  options.value_size = kDim * sizeof(float);
+  options.capacity_bytes = 1 << 20;
+  options.shard_num = 4;
+  options.admit_count = 2;
+  options.max_stale_steps = 3;
+  options.max_stale_ms = -1;
+  return options;
+}
+
+// Pulls the key through the cache, and fills a missed value with key.
+bool Pull(distributed::SparsePullCache *cache, uint64_t key, float *value) {
+  if (cache->Lookup(key, value)) {
+    return true;
+  }
+  std::vector<float> pulled(kDim, static_cast<float>(key));
+  cache->Insert(key, pulled.data(), cache->Generation());
+  std::copy(pulled.begin(), pulled.end(), value);
+  return false;
+}
+
+TEST(SparsePullCache, Admission) {
+  distributed::SparsePullCache cache(GetOptions());
+  float value[kDim];
+  // Admitted after the second miss.
+  ASSERT_FALSE(Pull(&cache, 7, value));
+  ASSERT_EQ(cache.Size(), 0UL);
+  ASSERT_FALSE(Pull(&cache, 7, value));
+  ASSERT_EQ(cache.Size(), 1UL);
+  ASSERT_TRUE(Pull(&cache, 7, value));
+  for (size_t i = 0; i < kDim; ++i) {
+    ASSERT_FLOAT_EQ(value[i], 7.0);
+  }
+  ASSERT_EQ(cache.HitCount(), 1UL);
+  ASSERT_EQ(cache.MissCount(), 2UL);
+
+  cache.Clear();
+  ASSERT_EQ(cache.Size(), 0UL);
+  ASSERT_FALSE(Pull(&cache, 7, value));
+}
+
+TEST(SparsePullCache, Generation) {
+  auto options = GetOptions();
+  options.admit_count = 1;
+  distributed::SparsePullCache cache(options);
+  float value[kDim];
+  std::vector<float> pulled(kDim, 3.0);
+  // A pull of key 3 is in flight when the cache is cleared.
+  ASSERT_FALSE(cache.Lookup(3, value));
+  uint64_t generation = cache.Generation();
+  cache.Clear();
+  ASSERT_FALSE(cache.Lookup(3, value));
+  cache.Insert(3, pulled.data(), generation);
+  ASSERT_EQ(cache.Size(), 0UL);
+  // The pull after the Clear is cached.
+  cache.Insert(3, pulled.data(), cache.Generation());
+  ASSERT_EQ(cache.Size(), 1UL);
+  ASSERT_TRUE(cache.Lookup(3, value));
+}
+
+TEST(SparsePullCache, Staleness) {
+  distributed::SparsePullCache cache(GetOptions());
+  float value[kDim];
+  Pull(&cache, 1, value);
+  Pull(&cache, 1, value);
+  for (int step = 0; step < 3; ++step) {
+    ASSERT_TRUE(Pull(&cache, 1, value));
+    cache.AdvanceStep();
+  }
+  // Refreshed by the pull after 3 steps, and admitted again at once.
+  ASSERT_FALSE(Pull(&cache, 1, value));
+  ASSERT_TRUE(Pull(&cache, 1, value));
+
+  auto options = GetOptions();
+  options.max_stale_steps = -1;
+  options.max_stale_ms = 10;
+  distributed::SparsePullCache timed_cache(options);
+  Pull(&timed_cache, 1, value);
+  Pull(&timed_cache, 1, value);
+  ASSERT_TRUE(Pull(&timed_cache, 1, value));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  ASSERT_FALSE(Pull(&timed_cache, 1, value));
+}
+
+TEST(SparsePullCache, Capacity) {
+  auto options = GetOptions();
+  options.capacity_bytes = 4 * 1024;
+  options.shard_num = 1;
+  options.admit_count = 1;
+  distributed::SparsePullCache cache(options);
+  float value[kDim];
+  for (uint64_t key = 0; key < 1000; ++key) {
+    Pull(&cache, key, value);
+  }
+  size_t size = cache.Size();
+  ASSERT_GT(size, 0UL);
+  ASSERT_LT(size, 1000UL);
+  // The most recent keys are kept, the oldest evicted.
+  ASSERT_TRUE(Pull(&cache, 999, value));
+  ASSERT_FLOAT_EQ(value[0], 999.0);
+  ASSERT_FALSE(Pull(&cache, 0, value));
+  ASSERT_EQ(cache.Size(), size);
+}
@@ -16,6 +16,8 @@ limitations under the License. */
 
 #include <cmath>
 #include <iostream>
+#include <random>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "paddle/fluid/distributed/the_one_ps.pb.h"
@@ -204,4 +206,96 @@ TEST(downpour_sparse_adam_test, test_init_and_update) {
     ASSERT_FLOAT_EQ(value[i], label[i]) << "i is " << i;
   }
 }
+
+// Updates the rows one by one and in a batch, and checks that they agree.
+void CheckUpdateValueBatch(SparseValueSGDRule* rule, size_t embed_dim) {
+  const size_t row_num = 5;
+  const size_t rule_dim = rule->Dim();
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> dist(-1.0, 1.0);
+  std::vector<std::vector<float>> w(row_num, std::vector<float>(embed_dim));
+  std::vector<std::vector<float>> sgd(row_num,
+                                      std::vector<float>(rule_dim + 1));
+  std::vector<std::vector<float>> grad(row_num,
+                                       std::vector<float>(embed_dim));
+  for (size_t k = 0; k < row_num; ++k) {
+    rule->InitValue(w[k].data(), sgd[k].data(), false);
+  }
+  auto batch_w = w;
+  auto batch_sgd = sgd;
+  std::vector<float> scales(row_num);
+  for (int step = 0; step < 10; ++step) {
+    std::vector<float*> w_ptrs, sgd_ptrs;
+    std::vector<const float*> grad_ptrs;
+    for (size_t k = 0; k < row_num; ++k) {
+      for (auto& g : grad[k]) {
+        g = dist(rng);
+      }
+      scales[k] = static_cast<float>(k + 1);
+      rule->UpdateValueWork(
+          w[k].data(), sgd[k].data(), grad[k].data(), scales[k]);
+      w_ptrs.push_back(batch_w[k].data());
+      sgd_ptrs.push_back(batch_sgd[k].data());
+      grad_ptrs.push_back(grad[k].data());
+    }
+    rule->UpdateValueBatch(w_ptrs.data(),
+                           sgd_ptrs.data(),
+                           grad_ptrs.data(),
+                           scales.data(),
+                           row_num);
+  }
+  for (size_t k = 0; k < row_num; ++k) {
+    for (size_t i = 0; i < embed_dim; ++i) {
+      ASSERT_NEAR(batch_w[k][i], w[k][i], 1e-4 * (1 + std::fabs(w[k][i])));
+    }
+    for (size_t i = 0; i < rule_dim; ++i) {
+      ASSERT_NEAR(
+          batch_sgd[k][i], sgd[k][i], 1e-4 * (1 + std::fabs(sgd[k][i])));
+    }
+  }
+}
+
+TEST(sparse_sgd_rule_batch_test, batch_matches_single_row) {
+  SparseCommonSGDRuleParameter param;
+  param.set_name("batch");
+  auto* naive_param = param.mutable_naive();
+  naive_param->set_learning_rate(0.1);
+  naive_param->set_initial_range(0.3);
+  naive_param->add_weight_bounds(-0.5);
+  naive_param->add_weight_bounds(0.5);
+  auto* adagrad_param = param.mutable_adagrad();
+  adagrad_param->set_learning_rate(0.1);
+  adagrad_param->set_initial_g2sum(3.0);
+  adagrad_param->set_initial_range(0.3);
+  adagrad_param->add_weight_bounds(-10.0);
+  adagrad_param->add_weight_bounds(10.0);
+  auto* adam_param = param.mutable_adam();
+  adam_param->set_learning_rate(0.01);
+  adam_param->set_initial_range(0.3);
+  adam_param->set_beta1_decay_rate(0.9);
+  adam_param->set_beta2_decay_rate(0.999);
+  adam_param->set_ada_epsilon(1e-08);
+  adam_param->add_weight_bounds(-10.0);
+  adam_param->add_weight_bounds(10.0);
+
+  // Cover the dims shorter than, equal to and not a multiple of the lanes.
+  for (size_t embed_dim : {1UL, 8UL, 13UL, 37UL}) {
+    SparseNaiveSGDRule naive_rule;
+    SparseAdaGradSGDRule adagrad_rule;
+    SparseAdaGradV2SGDRule adagrad_v2_rule;
+    StdAdaGradSGDRule std_adagrad_rule;
+    SparseAdamSGDRule adam_rule;
+    SparseSharedAdamSGDRule shared_adam_rule;
+    std::vector<SparseValueSGDRule*> rules = {&naive_rule,
+                                              &adagrad_rule,
+                                              &adagrad_v2_rule,
+                                              &std_adagrad_rule,
+                                              &adam_rule,
+                                              &shared_adam_rule};
+    for (auto* rule : rules) {
+      rule->LoadConfig(param, embed_dim);
+      CheckUpdateValueBatch(rule, embed_dim);
+    }
+  }
+}
 }  // namespace paddle::distributed
@@ -14,10 +14,20 @@
 
 #include "paddle/fluid/eager/backward.h"
 
+#include <exception>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>
+
+#include "paddle/common/flags.h"
 #include "paddle/fluid/eager/general_grad.h"
+#include "paddle/fluid/imperative/tracer.h"
 #include "paddle/phi/core/memory/stats.h"
+#include "paddle/phi/core/threadpool.h"
 #include "paddle/phi/kernels/autotune/switch_autotune.h"
 
+COMMON_DECLARE_int32(eager_backward_thread_num);
+
 namespace egr {
 
 std::unordered_map<GradNodeBase*, int> getInDegreeMap(
@@ -102,6 +112,169 @@ void DuplicateCheck(const std::vector<paddle::Tensor>& inputs, bool is_input) {
 
 GeneralGrad* GeneralGrad::general_grad_ = new GeneralGrad();
 
+namespace {
+
+using GradOutputs =
+    paddle::small_vector<std::vector<paddle::Tensor>, kSlotSmallVectorSize>;
+
+// Returns the number of threads to run the grad nodes, 1 means sequentially.
+int BackwardThreadNum(const phi::Place& place,
+                      bool create_graph,
+                      bool is_general_grad) {
+  if (FLAGS_eager_backward_thread_num <= 1) return 1;
+  // Only launching CPU kernels from several threads is safe. Building the
+  // double grad graph and collecting the results of GeneralGrad use states
+  // shared by all the nodes.
+  if (!phi::is_cpu_place(place) || create_graph || is_general_grad) return 1;
+  return FLAGS_eager_backward_thread_num;
+}
+
+// The pool of the thread number of the last parallel backward. It is replaced
+// when FLAGS_eager_backward_thread_num changes, the backwards running on the
+// old pool keep it until they finish.
+std::shared_ptr<phi::ThreadPool> BackwardThreadPool(int thread_num) {
+  static std::mutex mutex;
+  // never destroyed, joining the threads at exit may deadlock
+  static auto* pool = new std::shared_ptr<phi::ThreadPool>();
+  static int pool_thread_num = 0;
+  std::lock_guard<std::mutex> guard(mutex);
+  if (!*pool || pool_thread_num != thread_num) {
+    *pool = std::make_shared<phi::ThreadPool>(thread_num);
+    pool_thread_num = thread_num;
+  }
+  return *pool;
+}
+
+// The thread local eager states of the thread calling backward, which are set
+// on the worker threads before running grad nodes on them.
+class BackwardThreadLocalState {
+ public:
+  BackwardThreadLocalState()
+      : tracer_(egr::Controller::Instance().GetCurrentTracer()),
+        imperative_tracer_(paddle::imperative::GetCurrentTracer()),
+        has_grad_(tracer_ ? tracer_->HasGrad() : true),
+        amp_level_(paddle::imperative::GetCurrentAmpAttrs()->GetAmpLevel()),
+        amp_dtype_(paddle::imperative::GetCurrentAmpAttrs()->GetAmpDtype()),
+        use_promote_(
+            paddle::imperative::GetCurrentAmpAttrs()->GetUsePromote()) {}
+
+  void Apply() const {
+    egr::Controller::Instance().SetCurrentTracer(tracer_);
+    paddle::imperative::SetCurrentTracer(imperative_tracer_);
+    if (tracer_) tracer_->SetHasGrad(has_grad_);
+    const auto& amp_attrs = paddle::imperative::GetCurrentAmpAttrs();
+    amp_attrs->SetAmpLevel(amp_level_);
+    amp_attrs->SetAmpDtype(amp_dtype_);
+    amp_attrs->SetUsePromote(use_promote_);
+  }
+
+ private:
+  std::shared_ptr<paddle::imperative::Tracer> tracer_;
+  std::shared_ptr<paddle::imperative::Tracer> imperative_tracer_;
+  bool has_grad_;
+  paddle::imperative::AmpLevel amp_level_;
+  std::string amp_dtype_;
+  bool use_promote_;
+};
+
+// Runs the grad nodes until the queue is empty. The ready nodes in the queue
+// are run as a round: GradNodeAccumulation nodes on this thread, since their
+// hooks may launch communications whose order must be the same on all ranks,
+// and the others on the thread pool. At most one force sequential node is run
+// in a round to keep their order.
+//
+// Only the grad outputs are computed in parallel. After a round, they are
+// passed to prepare_next_nodes on this thread in the order of the round, so
+// the GradTensorHolders are only accessed by this thread and the order of
+// gradient accumulation does not depend on the thread scheduling.
+template <typename TakeBufferFn, typename RunNodeFn, typename PrepareNextFn>
+void RunNodesInParallel(
+    int thread_num,
+    std::deque<GradNodeBase*>* queue,
+    const std::unordered_map<GradNodeBase*, int>& node_in_degree_map,
+    const std::set<GradNodeBase*>& force_sequential_nodes_set,
+    const TakeBufferFn& take_node_input_buffer,
+    const RunNodeFn& run_node,
+    const PrepareNextFn& prepare_next_nodes) {
+  std::shared_ptr<phi::ThreadPool> pool = BackwardThreadPool(thread_num);
+  const BackwardThreadLocalState thread_local_state;
+  while (!queue->empty()) {
+    std::vector<GradNodeBase*> round;
+    std::deque<GradNodeBase*> deferred;
+    bool has_force_sequential_node = false;
+    while (!queue->empty()) {
+      GradNodeBase* node = queue->front();
+      queue->pop_front();
+      auto in_degree_iter = node_in_degree_map.find(node);
+      if (in_degree_iter != node_in_degree_map.end() &&
+          in_degree_iter->second != 0 &&
+          !(queue->empty() && round.empty() && deferred.empty())) {
+        continue;
+      }
+      if (force_sequential_nodes_set.count(node)) {
+        if (has_force_sequential_node) {
+          deferred.push_back(node);
+          continue;
+        }
+        has_force_sequential_node = true;
+      }
+      round.push_back(node);
+    }
+    *queue = std::move(deferred);
+
+    std::vector<std::unique_ptr<GradTensorHolder>> node_input_buffers;
+    node_input_buffers.reserve(round.size());
+    for (GradNodeBase* node : round) {
+      node_input_buffers.emplace_back(take_node_input_buffer(node));
+    }
+
+    std::vector<GradOutputs> grad_outputs(round.size());
+    auto run = [&](size_t i) {
+      phi::RecordEvent grad_node_record_event(
+          "Global_" + std::string(round[i]->name()),
+          phi::TracerEventType::Operator,
+          1);
+      grad_outputs[i] = run_node(round[i], node_input_buffers[i].get());
+    };
+    std::vector<std::future<void>> futures;
+    std::vector<size_t> local_nodes;
+    for (size_t i = 0; i < round.size(); ++i) {
+      if (round.size() > 1 &&
+          !dynamic_cast<egr::GradNodeAccumulation*>(round[i])) {
+        futures.emplace_back(pool->Run([&, i] {
+          thread_local_state.Apply();
+          run(i);
+        }));
+      } else {
+        local_nodes.push_back(i);
+      }
+    }
+    // Wait for all the nodes before rethrowing, they refer to this frame.
+    std::exception_ptr exception;
+    for (size_t i : local_nodes) {
+      try {
+        run(i);
+      } catch (...) {
+        if (!exception) exception = std::current_exception();
+      }
+    }
+    for (auto& future : futures) {
+      try {
+        future.get();
+      } catch (...) {
+        if (!exception) exception = std::current_exception();
+      }
+    }
+    if (exception) std::rethrow_exception(exception);
+
+    for (size_t i = 0; i < round.size(); ++i) {
+      prepare_next_nodes(round[i], &grad_outputs[i]);
+    }
+  }
+}
+
+}  // namespace
+
 std::vector<paddle::Tensor> RunBackward(
     const std::vector<paddle::Tensor>& tensors,  // output
     const std::vector<paddle::Tensor>& grad_tensors,
@@ -244,58 +417,18 @@ std::vector<paddle::Tensor> RunBackward(
 
   VLOG(5) << "Startup_ops's size is " << queue.size();
 
-  /* --- Topological Visit --- */
-  // 1. Pop queue
-  // 2. Run node
-  //    |- Check and capture target result
-  //    |- node(grads)
-  //    |- Prepare for next node
-  // 3. Update queue
-  while (!queue.empty()) {
-    GradNodeBase* node = queue.front();
-    VLOG(3) << "Preparing GradNode:" << node->name() << " addr:" << node;
-
-    if (queue.size() > 1 && node_in_degree_map[node] != 0) {
-      queue.pop_front();
-      continue;
-    }
-    queue.pop_front();
-
-    // Run node: This is where Hook happens
-    auto node_input_buffer_iter = node_input_buffers_dict.find(node);
-    PADDLE_ENFORCE_NE(
-        node_input_buffer_iter,
-        node_input_buffers_dict.end(),
-        common::errors::Fatal(
-            "Unable to find next node in the GradTensorHolder \n"
-            "Trying to run Node without configuring its GradTensorHolder."));
-
-    std::unique_ptr<GradTensorHolder> node_input_buffer =
-        std::move(node_input_buffer_iter->second);
-
+  // Runs the node, this is where Hook happens. It is called on the worker
+  // threads in the parallel backward, so it must only touch the node itself.
+  auto run_node = [&](GradNodeBase* node,
+                      GradTensorHolder* node_input_buffer) -> GradOutputs {
     // Check input
     EnforceGradNodeHasInput(node);
 
     VLOG(7) << "Run Backward Kernel with GradTensorHolder.";
 
-    // This 'Global_XXXGradNode' record event is different with
-    // 'Local_XXXGradNode' event.
-    // * 'Global_XXXGradNode' will not only cover execution time of this
-    // function, but also include gradient
-    //    accumulation when the output(s) of corresponding forward OP are shared
-    //    by other OP(s), which may have extra overhead of accumulation than
-    //    'Local_XXXGradNode'.
-    // * 'Local_XXXGradNode' will only cover execution time of GradNode
-    // function.
-    phi::RecordEvent grad_node_record_event(
-        "Global_" + std::string((*node).name()),
-        phi::TracerEventType::Operator,
-        1);
-
     // Run Pre Backward Node and get outputs
-    paddle::small_vector<std::vector<paddle::Tensor>, kSlotSmallVectorSize>
-        grad_output_tensors = (*node)(
-            node_input_buffer->Buffers(), create_graph, is_general_grad);
+    GradOutputs grad_output_tensors =
+        (*node)(node_input_buffer->Buffers(), create_graph, is_general_grad);
 
     if (!inputs.empty() && is_general_grad) {
       GeneralGrad::Instance().SetResultForEndingNodes(grad_output_tensors,
@@ -308,11 +441,29 @@ std::vector<paddle::Tensor> RunBackward(
           << "retain_graph is false, need to clear the TensorWrapper of nodes.";
       node->ClearTensorWrappers();
     }
+    return grad_output_tensors;
+  };
 
+  auto take_node_input_buffer = [&](GradNodeBase* node) {
+    auto node_input_buffer_iter = node_input_buffers_dict.find(node);
+    PADDLE_ENFORCE_NE(
+        node_input_buffer_iter,
+        node_input_buffers_dict.end(),
+        common::errors::Fatal(
+            "Unable to find next node in the GradTensorHolder \n"
+            "Trying to run Node without configuring its GradTensorHolder."));
+
+    std::unique_ptr<GradTensorHolder> node_input_buffer =
+        std::move(node_input_buffer_iter->second);
     // TODO(jiabin): Should we erase it or find a more efficient way.
     node_input_buffers_dict.erase(node_input_buffer_iter);
+    return node_input_buffer;
+  };
 
-    // Prepare GradTensorHolder for next node
+  // Prepare GradTensorHolder for next node, and update queue
+  auto prepare_next_nodes = [&](GradNodeBase* node,
+                                GradOutputs* grad_output_tensors_ptr) {
+    GradOutputs& grad_output_tensors = *grad_output_tensors_ptr;
     const paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>&
         metas = node->OutputMeta();
     PADDLE_ENFORCE(metas.size() == grad_output_tensors.size() || metas.empty(),
@@ -424,6 +575,62 @@ std::vector<paddle::Tensor> RunBackward(
         }
       }
     }
+  };
+
+  const int thread_num =
+      BackwardThreadNum(place, create_graph, is_general_grad);
+  if (thread_num > 1) {
+    VLOG(3) << "Run backward with " << thread_num << " threads";
+    RunNodesInParallel(thread_num,
+                       &queue,
+                       node_in_degree_map,
+                       force_sequential_nodes_set,
+                       take_node_input_buffer,
+                       run_node,
+                       [&](GradNodeBase* node, GradOutputs* grad_outputs) {
+                         prepare_next_nodes(node, grad_outputs);
+                         paddle::memory::LogDeviceMemoryStats(
+                             place, std::string((*node).name()));
+                       });
+    // The queue is drained, so the sequential visit below does nothing.
+  }
+
+  /* --- Topological Visit --- */
+  // 1. Pop queue
+  // 2. Run node
+  //    |- Check and capture target result
+  //    |- node(grads)
+  //    |- Prepare for next node
+  // 3. Update queue
+  while (!queue.empty()) {
+    GradNodeBase* node = queue.front();
+    VLOG(3) << "Preparing GradNode:" << node->name() << " addr:" << node;
+
+    if (queue.size() > 1 && node_in_degree_map[node] != 0) {
+      queue.pop_front();
+      continue;
+    }
+    queue.pop_front();
+
+    std::unique_ptr<GradTensorHolder> node_input_buffer =
+        take_node_input_buffer(node);
+
+    // This 'Global_XXXGradNode' record event is different with
+    // 'Local_XXXGradNode' event.
+    // * 'Global_XXXGradNode' will not only cover execution time of this
+    // function, but also include gradient
+    //    accumulation when the output(s) of corresponding forward OP are shared
+    //    by other OP(s), which may have extra overhead of accumulation than
+    //    'Local_XXXGradNode'.
+    // * 'Local_XXXGradNode' will only cover execution time of GradNode
+    // function.
+    phi::RecordEvent grad_node_record_event(
+        "Global_" + std::string((*node).name()),
+        phi::TracerEventType::Operator,
+        1);
+
+    GradOutputs grad_output_tensors = run_node(node, node_input_buffer.get());
+    prepare_next_nodes(node, &grad_output_tensors);
     paddle::memory::LogDeviceMemoryStats(place, std::string((*node).name()));
   }
 
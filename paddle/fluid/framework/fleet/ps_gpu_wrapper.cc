@@ -947,6 +947,19 @@ void PSGPUWrapper::BuildPull(std::shared_ptr<HeterContext> gpu_task) {
 
   threads.resize(thread_keys_shard_num_ * multi_mf_dim_);
 
+#ifdef PADDLE_WITH_PSCORE
+  // The pulls of a shard wait for its pull thread, meanwhile the cpu table
+  // reads the values of all the keys of the pass from ssd ahead.
+  for (int i = 0; i < thread_keys_shard_num_; i++) {
+    for (int j = 0; j < multi_mf_dim_; j++) {
+      fleet_ptr_->worker_ptr_->PrefetchSparse(i,
+                                              this->table_id_,
+                                              local_dim_keys[i][j].data(),
+                                              local_dim_keys[i][j].size());
+    }
+  }
+#endif
+
   uint64_t total_key = 0;
   std::vector<std::future<void>> task_futures;
   for (int i = 0; i < thread_keys_shard_num_; i++) {
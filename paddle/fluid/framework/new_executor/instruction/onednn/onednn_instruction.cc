@@ -408,8 +408,15 @@ void OneDNNPhiKernelInstruction::Run() {
   auto tmp_kernel_context = kernel_context_;
   auto tmp_infer_meta_context_ = infer_meta_context_;
   // Step1. TransLayout
-  auto inputs = tmp_kernel_context.InputsBetween<phi::DenseTensor>(
-      size_t(0), tmp_kernel_context.InputsSize());
+  // The inputs that are not DenseTensor, e.g. a TensorArray, are nullptr.
+  std::vector<const phi::DenseTensor*> inputs;
+  inputs.reserve(tmp_kernel_context.InputsSize());
+  for (size_t i = 0; i < tmp_kernel_context.InputsSize(); ++i) {
+    const phi::TensorBase* input = tmp_kernel_context.MutableIutputAt(i);
+    inputs.push_back(input != nullptr && phi::DenseTensor::classof(input)
+                         ? static_cast<const phi::DenseTensor*>(input)
+                         : nullptr);
+  }
   for (size_t i = 0; i < inputs.size(); ++i) {
     auto input = inputs[i];
     if (input == nullptr) {
@@ -502,6 +509,10 @@ void OneDNNPhiKernelInstruction::Run() {
   one_dnn_ctx->SetOutputsName(outputs_);
 
   // Step3. InferMeta
+  // The handlers of the kernel find their blobs in blob_cache_ in the steady
+  // state, without the lookups of the BlobMap.
+  phi::OneDNNInstructionCacheGuard cache_guard(
+      &blob_cache_, phi::funcs::CreateInputShapeKey(inputs));
   if (infer_meta_interface_) {
     infer_meta_interface_->infer_meta_(&(tmp_infer_meta_context_));
   }
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
+#include "paddle/phi/backends/onednn/onednn_context.h"
 
 namespace pir {
 class Operation;
@@ -77,6 +78,8 @@ class OneDNNPhiKernelInstruction : public InstructionBase {
   std::map<std::string, std::vector<std::string>> outputs_{};
   std::string kernel_name_;
   phi::KernelKey kernel_key_;
+  // The primitives and memories of the kernel for its input shapes
+  phi::OneDNNInstructionCache blob_cache_;
 };
 }  // namespace framework
 }  // namespace paddle
@@ -303,6 +303,18 @@ void OneDNNLegacyKernelInstruction::Run() {
   }
 
   // Step2. InferMeta
+  // The handlers of the kernel find their blobs in blob_cache_ in the steady
+  // state, without the lookups of the BlobMap.
+  std::vector<const phi::DenseTensor*> input_tensors;
+  for (auto& input_name : inputs) {
+    for (auto& var : kernel_context_->MultiInputVar(*input_name)) {
+      input_tensors.push_back(var != nullptr && var->IsType<phi::DenseTensor>()
+                                  ? &var->Get<phi::DenseTensor>()
+                                  : nullptr);
+    }
+  }
+  phi::OneDNNInstructionCacheGuard cache_guard(
+      &blob_cache_, phi::funcs::CreateInputShapeKey(input_tensors));
   VLOG(6) << "Run op " << legacy_op_name_ << " infer meta.";
   if (infer_meta_interface_) {
     infer_meta_interface_->infer_meta_(&(infer_meta_context_));
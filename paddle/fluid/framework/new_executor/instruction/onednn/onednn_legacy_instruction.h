@@ -15,6 +15,7 @@
 #pragma once
 
 #include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
+#include "paddle/phi/backends/onednn/onednn_context.h"
 
 namespace pir {
 class Operation;
@@ -70,6 +71,8 @@ class OneDNNLegacyKernelInstruction : public InstructionBase {
   std::set<std::string> data_format_tensors_{};
   std::set<std::string> skip_format_tensors_{};
   phi::DataLayout input_layout_{phi::DataLayout::kAnyLayout};
+  // The primitives and memories of the kernel for its input shapes
+  phi::OneDNNInstructionCache blob_cache_;
 };
 
 }  // namespace framework
@@ -27,6 +27,7 @@
 #include "paddle/phi/core/platform/collective_helper.h"
 #include "paddle/phi/core/platform/device_context.h"
 #include "paddle/phi/core/platform/profiler/event_tracing.h"
+#include "paddle/phi/core/tensor_utils.h"
 #include "paddle/phi/core/type_defs.h"
 #include "paddle/pir/include/core/builtin_attribute.h"
 #include "paddle/pir/include/core/operation.h"
@@ -37,6 +38,12 @@
 PHI_DEFINE_EXPORTED_bool(print_kernel_run_info,
                          false,
                          "Whether print kernel run info.");
+PHI_DEFINE_EXPORTED_bool(
+    enable_infer_meta_cache,
+    false,
+    "Whether to skip InferMeta of phi kernel instructions when the meta of "
+    "all inputs is the same as a previous run, and replay the output meta "
+    "computed by that run instead.");
 
 namespace paddle::framework {
 
@@ -129,6 +136,9 @@ PhiKernelInstruction::PhiKernelInstruction(
         paddle::small_vector<phi::MetaTensor, phi::kInputSmallVectorSize>,
         paddle::small_vector<phi::MetaTensor, phi::kInputSmallVectorSize>,
         false>(op, *value_exec_info_, yaml_info_parser, &infer_meta_context_);
+    if (FLAGS_enable_infer_meta_cache) {
+      InitInferMetaCache(yaml_info_parser);
+    }
   }
   VLOG(6) << "finish process infer meta context";
 
@@ -183,6 +193,147 @@ PhiKernelInstruction::PhiKernelInstruction(
 
 PhiKernelInstruction::~PhiKernelInstruction() { delete phi_kernel_; }
 
+void PhiKernelInstruction::InitInferMetaCache(
+    const paddle::dialect::OpYamlInfoParser& yaml_info_parser) {
+  // InferMeta reads the value of tensor attributes (e.g. the shape of
+  // reshape), which is not part of the cache key.
+  const auto& name2id = yaml_info_parser.InputName2Id();
+  for (const auto& attr_name : yaml_info_parser.AttrParams(false)) {
+    if (name2id.count(attr_name)) {
+      VLOG(6) << "Disable infer meta cache for " << phi_op_name_
+              << " since it has tensor attribute " << attr_name;
+      return;
+    }
+  }
+
+  Scope* inner_scope = value_exec_info_->GetScope();
+  // Collect DenseTensors held by var, return false for other types.
+  auto CollectDenseTensors =
+      [](const Variable* var, std::vector<phi::DenseTensor*>* tensors) {
+        if (var->IsType<phi::DenseTensor>()) {
+          tensors->push_back(
+              const_cast<phi::DenseTensor*>(&(var->Get<phi::DenseTensor>())));
+          return true;
+        }
+        if (var->IsType<VariableRefArray>()) {
+          for (auto* item : var->Get<VariableRefArray>()) {
+            if (!item->IsType<phi::DenseTensor>()) {
+              return false;
+            }
+            tensors->push_back(const_cast<phi::DenseTensor*>(
+                &(item->Get<phi::DenseTensor>())));
+          }
+          return true;
+        }
+        return false;
+      };
+
+  std::vector<phi::DenseTensor*> inputs;
+  for (size_t i = 0; i < op_->num_operands(); ++i) {
+    pir::Value value = op_->operand_source(i);
+    if (!IsInvalid(value)) {
+      continue;
+    }
+    Variable* var = inner_scope->FindVar(value_exec_info_->GetVarName(value));
+    if (var == nullptr || !CollectDenseTensors(var, &inputs)) {
+      VLOG(6) << "Disable infer meta cache for " << phi_op_name_
+              << " since its " << i << "-th input is not DenseTensor";
+      return;
+    }
+  }
+  std::vector<phi::DenseTensor*> outputs;
+  for (size_t i = 0; i < op_->num_results(); ++i) {
+    pir::Value value = op_->result(i);
+    if (!IsInvalid(value)) {
+      continue;
+    }
+    Variable* var = inner_scope->FindVar(value_exec_info_->GetVarName(value));
+    if (var == nullptr || !CollectDenseTensors(var, &outputs)) {
+      VLOG(6) << "Disable infer meta cache for " << phi_op_name_
+              << " since its " << i << "-th output is not DenseTensor";
+      return;
+    }
+  }
+
+  infer_meta_cache_inputs_.assign(inputs.begin(), inputs.end());
+  infer_meta_cache_outputs_ = std::move(outputs);
+  use_infer_meta_cache_ = true;
+}
+
+void PhiKernelInstruction::BuildInferMetaCacheKey(
+    std::vector<int64_t>* key) const {
+  key->clear();
+  for (const phi::DenseTensor* tensor : infer_meta_cache_inputs_) {
+    const phi::DenseTensorMeta& meta = tensor->meta();
+    key->push_back(static_cast<int64_t>(meta.dtype));
+    key->push_back(static_cast<int64_t>(meta.layout));
+    key->push_back(static_cast<int64_t>(meta.is_scalar));
+    key->push_back(meta.dims.size());
+    for (int i = 0; i < meta.dims.size(); ++i) {
+      key->push_back(meta.dims[i]);
+    }
+    key->push_back(meta.strides.size());
+    for (int i = 0; i < meta.strides.size(); ++i) {
+      key->push_back(meta.strides[i]);
+    }
+    key->push_back(static_cast<int64_t>(meta.legacy_lod.size()));
+    for (const auto& level : meta.legacy_lod) {
+      key->push_back(static_cast<int64_t>(level.size()));
+      for (size_t offset : level) {
+        key->push_back(static_cast<int64_t>(offset));
+      }
+    }
+  }
+}
+
+void PhiKernelInstruction::RunInferMeta() {
+  if (!use_infer_meta_cache_) {
+    infer_meta_interface_->infer_meta_(&(infer_meta_context_));
+    return;
+  }
+
+  BuildInferMetaCacheKey(&infer_meta_cache_key_);
+  for (const auto& entry : infer_meta_cache_) {
+    if (entry.key != infer_meta_cache_key_) {
+      continue;
+    }
+    VLOG(6) << "Hit infer meta cache for " << phi_op_name_;
+    for (size_t i = 0; i < infer_meta_cache_outputs_.size(); ++i) {
+      phi::DenseTensorMeta* meta =
+          phi::DenseTensorUtils::GetMutableMeta(infer_meta_cache_outputs_[i]);
+      const phi::DenseTensorMeta& cached = entry.output_metas[i];
+      // offset is owned by the allocation rather than InferMeta, keep it.
+      meta->is_scalar = cached.is_scalar;
+      meta->dims = cached.dims;
+      meta->dtype = cached.dtype;
+      meta->layout = cached.layout;
+      meta->legacy_lod = cached.legacy_lod;
+      meta->strides = cached.strides;
+      meta->use_gpudnn = cached.use_gpudnn;
+    }
+    return;
+  }
+
+  infer_meta_interface_->infer_meta_(&(infer_meta_context_));
+
+  // Inputs may also be outputs for inplace ops, record the key before
+  // InferMeta and the output meta after it.
+  InferMetaCacheEntry entry;
+  entry.key = infer_meta_cache_key_;
+  entry.output_metas.reserve(infer_meta_cache_outputs_.size());
+  for (const phi::DenseTensor* tensor : infer_meta_cache_outputs_) {
+    entry.output_metas.push_back(tensor->meta());
+  }
+  constexpr size_t kInferMetaCacheCapacity = 4;
+  if (infer_meta_cache_.size() < kInferMetaCacheCapacity) {
+    infer_meta_cache_.push_back(std::move(entry));
+  } else {
+    infer_meta_cache_[infer_meta_cache_next_slot_] = std::move(entry);
+    infer_meta_cache_next_slot_ =
+        (infer_meta_cache_next_slot_ + 1) % kInferMetaCacheCapacity;
+  }
+}
+
 void PhiKernelInstruction::Run() {
   if (FLAGS_print_kernel_run_info) {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
@@ -215,7 +366,7 @@ void PhiKernelInstruction::Run() {
     phi::RecordEvent record_event("PhiKernelInstruction::infermeta",
                                   phi::TracerEventType::UserDefined,
                                   1);
-    infer_meta_interface_->infer_meta_(&(infer_meta_context_));
+    RunInferMeta();
   }
   VLOG(6) << "End run op " << phi_op_name_ << " infer meta.";
   for (auto& pair : this->InplaceInfo()) {
@@ -15,11 +15,18 @@
 #pragma once
 
 #include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
+#include "paddle/phi/core/dense_tensor.h"
 
 namespace pir {
 class Operation;
 }  // namespace pir
 
+namespace paddle {
+namespace dialect {
+class OpYamlInfoParser;
+}  // namespace dialect
+}  // namespace paddle
+
 namespace paddle {
 namespace framework {
 class Scope;
@@ -53,9 +60,38 @@ class PhiKernelInstruction : public InstructionBase {
   const std::string& Name() const override { return phi_op_name_; }
 
  private:
+  // Decide whether the result of InferMeta only depends on the meta of the
+  // input tensors, and collect the tensors used by the InferMeta cache.
+  void InitInferMetaCache(
+      const paddle::dialect::OpYamlInfoParser& yaml_info_parser);
+
+  void RunInferMeta();
+
+  void BuildInferMetaCacheKey(std::vector<int64_t>* key) const;
+
   paddle::dialect::InferMetaInterface::Concept* infer_meta_interface_{
       nullptr};  // not owned
 
+  // InferMeta cache, only used when FLAGS_enable_infer_meta_cache is set. Each
+  // entry maps the meta of all input tensors to the output meta computed by
+  // InferMeta for them.
+  struct InferMetaCacheEntry {
+    std::vector<int64_t> key;
+    std::vector<phi::DenseTensorMeta> output_metas;
+  };
+
+  bool use_infer_meta_cache_{false};
+
+  std::vector<const phi::DenseTensor*> infer_meta_cache_inputs_;  // not owned
+
+  std::vector<phi::DenseTensor*> infer_meta_cache_outputs_;  // not owned
+
+  std::vector<InferMetaCacheEntry> infer_meta_cache_;
+
+  size_t infer_meta_cache_next_slot_{0};
+
+  std::vector<int64_t> infer_meta_cache_key_;
+
   phi::InferMetaContext infer_meta_context_;
 
   phi::KernelContext kernel_context_;
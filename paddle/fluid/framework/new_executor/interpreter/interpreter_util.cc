@@ -129,6 +129,11 @@ void AsyncWorkQueue::AddTask(const OpFuncType& op_func_type,
   queue_group_->AddTask(op_func_type == OpFuncType::kGpuAsync, std::move(fn));
 }
 
+void AsyncWorkQueue::AddTasks(const OpFuncType& op_func_type,
+                              std::vector<std::function<void()>>* fns) {
+  queue_group_->AddTasks(op_func_type == OpFuncType::kGpuAsync, fns);
+}
+
 bool IsCommunicationOp(const OperatorBase* op) {
   const std::string& op_name = op->Type();
   const std::set<std::string> special_comm_op_set = {
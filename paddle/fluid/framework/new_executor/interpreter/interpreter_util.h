@@ -55,6 +55,11 @@ class AsyncWorkQueue {
 
   void AddTask(const OpFuncType& op_func_type, std::function<void()> fn);
 
+  // Dispatch a group of tasks with the same OpFuncType at once, see
+  // WorkQueueGroup::AddTasks for details.
+  void AddTasks(const OpFuncType& op_func_type,
+                std::vector<std::function<void()>>* fns);
+
   void Cancel() { queue_group_->Cancel(); }
 
   size_t QueueNumThreads(size_t idx) {
@@ -23,6 +23,12 @@ PHI_DEFINE_EXPORTED_bool(
     new_executor_serial_run,
     false,
     "Enable serial execution for standalone executor, used for debug.");
+PHI_DEFINE_EXPORTED_bool(
+    new_executor_use_work_stealing,
+    false,
+    "Keep ready successors of an instruction on the worker thread that "
+    "finished it and let idle workers steal them, instead of dispatching each "
+    "of them through the shared work queue. Only affects host instructions.");
 PHI_DEFINE_EXPORTED_bool(
     new_executor_static_build,
     false,
@@ -15,6 +15,7 @@
 #include "paddle/fluid/framework/new_executor/pir_interpreter.h"
 
 #include <chrono>
+#include <numeric>
 #include <unordered_set>
 
 #include "paddle/common/flags.h"
@@ -74,6 +75,8 @@
 #include "paddle/fluid/pir/dialect/operator/ir/manual_pylayer_op.h"
 #include "paddle/fluid/pir/dialect/operator/ir/tensorrt_op.h"
 #include "paddle/fluid/pir/dialect/operator/utils/utils.h"
+#include "paddle/fluid/pir/transforms/general/memory_plan_pass.h"
+#include "paddle/phi/core/memory/malloc.h"
 #include "paddle/pir/include/core/builtin_attribute.h"
 #include "paddle/pir/include/dialect/control_flow/ir/cf_op.h"
 
@@ -1664,6 +1667,7 @@ void PirInterpreter::TraceRunImpl() {
   }
 
   interpreter::ResetAtomicGuard guard(&deps_, &refs_);
+  BindMemoryPlan();
   VLOG(4) << "Tracing Instruction List";
 
   TraceRunInstructionList(vec_instruction_base_);
@@ -1775,18 +1779,25 @@ void PirInterpreter::MultiThreadRunInstructionList(
     }
   }
 
+  std::vector<std::function<void()>> host_root_tasks;
   for (size_t i = 0; i < dependency_count_->size(); ++i) {
     if ((*dependency_count_)[i] == 0) {
       // NOTE(zhiqiu): hot fix for jit input var
       RecordMemcpyD2H(vec_instr.at(i).get());
       if (FLAGS_new_executor_serial_run) {
         RunInstructionBaseAsync(i);
+      } else if (FLAGS_new_executor_use_work_stealing &&
+                 vec_instr.at(i)->KernelType() != OpFuncType::kGpuAsync) {
+        host_root_tasks.emplace_back([this, i] { RunInstructionBaseAsync(i); });
       } else {
         async_work_queue_->AddTask(vec_instr.at(i)->KernelType(),
                                    [this, i] { RunInstructionBaseAsync(i); });
       }
     }
   }
+  if (!host_root_tasks.empty()) {
+    async_work_queue_->AddTasks(OpFuncType::kCpuSync, &host_root_tasks);
+  }
 
   // For debug hang in main_thread_blocker_.WaitEvent(),
   // launch async task to log deps every
@@ -1882,6 +1893,11 @@ void PirInterpreter::RunInstructionBaseAsync(size_t instr_id) {
 
 void PirInterpreter::RunNextInstructions(InstructionBase* instr,
                                          SchedulingQueue* reserved_next_ops) {
+  if (FLAGS_new_executor_use_work_stealing) {
+    RunNextInstructionsWithWorkStealing(instr, reserved_next_ops);
+    return;
+  }
+
   phi::RecordEvent record(
       "RunNextInstructions", phi::TracerEventType::UserDefined, 10);
 
@@ -1906,6 +1922,57 @@ void PirInterpreter::RunNextInstructions(InstructionBase* instr,
   }
 }
 
+// NOTE: In work stealing mode, the worker that finishes an instruction keeps
+// one ready host successor for itself even if it was assigned to a different
+// thread by BuildInstructionDependences, and pushes the remaining ones into its
+// own local queue in one batch, from which idle workers steal. This avoids one
+// shared queue push and one wakeup per successor, which dominates when the
+// kernels are tiny.
+void PirInterpreter::RunNextInstructionsWithWorkStealing(
+    InstructionBase* instr, SchedulingQueue* reserved_next_ops) {
+  phi::RecordEvent record("RunNextInstructionsWithWorkStealing",
+                          phi::TracerEventType::UserDefined,
+                          10);
+
+  auto IsReady = [this](size_t next_id) {
+    VLOG(4) << "op_id: " << next_id
+            << ", remain deps: " << deps_[next_id]->DynamicDep();
+    return deps_[next_id]->CheckAndDecrease();
+  };
+
+  for (size_t next_instr_id : instr->NextInstrsInSameThread()) {
+    if (IsReady(next_instr_id)) {
+      reserved_next_ops->push(next_instr_id);
+    }
+  }
+
+  // Instructions of kGpuAsync run on the device queue, so a host thread can
+  // only keep host successors of a host instruction.
+  bool can_keep_local = instr->KernelType() != OpFuncType::kGpuAsync;
+  std::vector<std::function<void()>> host_tasks;
+  for (size_t next_instr_id : instr->NextInstrsInDifferenceThread()) {
+    if (!IsReady(next_instr_id)) {
+      continue;
+    }
+    const OpFuncType next_type =
+        vec_instruction_base_[next_instr_id]->KernelType();
+    if (next_type == OpFuncType::kGpuAsync) {
+      async_work_queue_->AddTask(
+          next_type,
+          [this, next_instr_id]() { RunInstructionBaseAsync(next_instr_id); });
+    } else if (can_keep_local && reserved_next_ops->empty()) {
+      reserved_next_ops->push(next_instr_id);
+    } else {
+      host_tasks.emplace_back(
+          [this, next_instr_id]() { RunInstructionBaseAsync(next_instr_id); });
+    }
+  }
+
+  if (!host_tasks.empty()) {
+    async_work_queue_->AddTasks(OpFuncType::kCpuSync, &host_tasks);
+  }
+}
+
 void PirInterpreter::RunInstructionBase(InstructionBase* instr_node) {
   phi::RecordEvent instruction_event(
       instr_node->Name(), phi::TracerEventType::Operator, 1);
@@ -2072,6 +2139,75 @@ void PirInterpreter::PreAnalysis() {
 
   UpdateOneDNNOpNum();
   VLOG(4) << "Done UpdateOneDNNOpNum";
+
+  BuildMemoryPlan();
+  VLOG(4) << "Done BuildMemoryPlan";
+}
+
+void PirInterpreter::BuildMemoryPlan() {
+  memory_plan_slices_.clear();
+  memory_arena_.reset();
+  auto* module_op = ir_block_->GetParentOp();
+  if (module_op == nullptr ||
+      !module_op->HasAttribute(::pir::kAttrMemoryArenaSize) ||
+      !phi::is_cpu_place(place_)) {
+    return;
+  }
+  // The offsets are planned for the op order of the program, which only the
+  // trace mode keeps.
+  if (!UseTraceRun(execution_config_, onednn_op_num_, sync_op_num_)) {
+    VLOG(4) << "Skip the memory plan of the program in multi-thread mode.";
+    return;
+  }
+
+  int64_t arena_size =
+      module_op->attribute<::pir::Int64Attribute>(::pir::kAttrMemoryArenaSize)
+          .data();
+  memory_arena_ = memory::AllocShared(place_, arena_size);
+  auto* arena_ptr = reinterpret_cast<uint8_t*>(memory_arena_->ptr());
+  for (auto& op : *ir_block_) {
+    for (auto result : op.results()) {
+      auto offset_attr =
+          result.attribute<::pir::Int64Attribute>(::pir::kAttrMemoryOffset);
+      if (!offset_attr || !value_exe_info_->HasValue(result)) {
+        continue;
+      }
+      auto type =
+          result.type().dyn_cast<paddle::dialect::AllocatedDenseTensorType>();
+      size_t size =
+          common::product(type.dims()) *
+          phi::SizeOf(paddle::dialect::TransToPhiDataType(type.dtype()));
+      PADDLE_ENFORCE_LE(
+          offset_attr.data() + static_cast<int64_t>(size),
+          arena_size,
+          common::errors::PreconditionNotMet(
+              "The value %s of %d bytes at offset %d exceeds the memory "
+              "arena of %d bytes.",
+              value_exe_info_->GetVarName(result),
+              size,
+              offset_attr.data(),
+              arena_size));
+      auto* tensor = value_exe_info_->GetVarByValue(result)
+                         ->GetMutable<phi::DenseTensor>();
+      memory_plan_slices_.emplace_back(
+          tensor,
+          std::make_shared<phi::Allocation>(
+              arena_ptr + offset_attr.data(), size, place_));
+    }
+  }
+
+  std::iota(trace_execute_order_.begin(), trace_execute_order_.end(), 0);
+  VLOG(4) << "Bind " << memory_plan_slices_.size()
+          << " values to a memory arena of " << arena_size << " bytes.";
+}
+
+void PirInterpreter::BindMemoryPlan() {
+  // The holders are released by the gc after the last use of the values, and
+  // the kernels allocate the outputs from the bound slices.
+  for (auto& item : memory_plan_slices_) {
+    item.first->clear();
+    item.first->ResetHolder(item.second);
+  }
 }
 
 ::pir::Value PirInterpreter::GetValueByName(const std::string& var_name) {
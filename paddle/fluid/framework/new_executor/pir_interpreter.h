@@ -206,6 +206,12 @@ class PirInterpreter : public InterpreterBaseImpl {
   int64_t onednn_op_num_{-1};
   std::vector<size_t> trace_execute_order_;
 
+  // The arena of the values planned by memory_plan_pass, and the slices of
+  // it bound to the tensors of the values before each run.
+  std::shared_ptr<phi::Allocation> memory_arena_;
+  std::vector<std::pair<phi::DenseTensor*, std::shared_ptr<phi::Allocation>>>
+      memory_plan_slices_;
+
   std::vector<PirHookFunc> pir_output_hookfuncs_;
   std::vector<PirHookFunc> pir_input_hookfuncs_;
 
@@ -222,6 +228,10 @@ class PirInterpreter : public InterpreterBaseImpl {
 
   void PreAnalysis();
 
+  void BuildMemoryPlan();
+
+  void BindMemoryPlan();
+
   void BuildInstruction();
 
   void BuildInstructionDependences();
@@ -241,6 +251,9 @@ class PirInterpreter : public InterpreterBaseImpl {
   void RunNextInstructions(InstructionBase* instr,
                            SchedulingQueue* reserved_next_ops);
 
+  void RunNextInstructionsWithWorkStealing(InstructionBase* instr,
+                                           SchedulingQueue* reserved_next_ops);
+
   void RunInstructionBase(InstructionBase* instr_node);
 
   void RecordMemcpyD2H(InstructionBase* instr_node);
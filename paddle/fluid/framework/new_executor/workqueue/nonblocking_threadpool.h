@@ -9,8 +9,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cstdlib>
+#include <functional>
 #include <vector>
 
 #include "glog/logging.h"
@@ -140,6 +142,43 @@ class ThreadPoolTempl {
     }
   }
 
+  // Push a group of tasks with a single round of notifications. When called
+  // from a worker thread of this pool, all tasks go to the front of the
+  // caller's own queue so that they stay cache-local and are only taken by
+  // other workers through stealing. Idle workers are woken at most once per
+  // pushed task and never more than num_threads_ - 1 times, since the caller
+  // itself will drain its own queue.
+  void AddTasks(std::vector<std::function<void()>>* fns) {
+    if (fns->empty()) {
+      return;
+    }
+    PerThread* pt = GetPerThread();
+    bool is_worker = pt->pool == this;
+    int rnd = is_worker ? 0 : static_cast<int>(Rand(&pt->rand) % num_threads_);
+    int num_pushed = 0;
+    for (size_t i = 0; i < fns->size(); ++i) {
+      Task t = env_.CreateTask(std::move((*fns)[i]));
+      if (is_worker) {
+        t = thread_data_[pt->thread_id].queue.PushFront(std::move(t));
+      } else {
+        int idx = static_cast<int>((rnd + i) % num_threads_);
+        t = thread_data_[idx].queue.PushBack(std::move(t));
+      }
+      if (!t.f) {
+        ++num_pushed;
+      } else {
+        env_.ExecuteTask(t);  // Push failed, execute directly.
+      }
+    }
+    fns->clear();
+
+    int num_notify = is_worker ? std::min(num_pushed, num_threads_ - 1)
+                               : std::min(num_pushed, num_threads_);
+    for (int i = 0; i < num_notify; ++i) {
+      ec_.Notify(false);
+    }
+  }
+
   void Cancel() {
     cancelled_ = true;
     done_ = true;
@@ -96,6 +96,9 @@ class WorkQueueGroupImpl : public WorkQueueGroup {
 
   void AddTask(size_t queue_idx, std::function<void()> fn) override;
 
+  void AddTasks(size_t queue_idx,
+                std::vector<std::function<void()>>* fns) override;
+
   size_t QueueNumThreads(size_t queue_idx) const override;
 
   size_t QueueGroupNumThreads() const override;
@@ -176,6 +179,24 @@ void WorkQueueGroupImpl::AddTask(size_t queue_idx, std::function<void()> fn) {
   queues_[queue_idx]->AddTask(std::move(fn));
 }
 
+void WorkQueueGroupImpl::AddTasks(size_t queue_idx,
+                                  std::vector<std::function<void()>>* fns) {
+  phi::RecordEvent record(
+      "WorkQueue::AddTasks", phi::TracerEventType::UserDefined, 10 /*level*/);
+  assert(queue_idx < queues_.size());
+  PADDLE_ENFORCE_NOT_NULL(
+      queues_.at(queue_idx),
+      common::errors::NotFound("Workqueue of index %d is not initialized.",
+                               queue_idx));
+  if (queues_options_.at(queue_idx).track_task) {
+    for (auto& fn : *fns) {
+      fn = [task = std::move(fn),
+            raii = CounterGuard<TaskTracker>(tracker_)]() mutable { task(); };
+    }
+  }
+  queues_[queue_idx]->AddTasks(fns);
+}
+
 size_t WorkQueueGroupImpl::QueueNumThreads(size_t queue_idx) const {
   assert(queue_idx < queues_.size());
   if (!queues_.at(queue_idx)) {
@@ -155,6 +155,12 @@ class WorkQueueGroup {
 
   virtual void AddTask(size_t queue_idx, std::function<void()> fn) = 0;
 
+  // Lower cost than calling AddTask for each fn. When called from a worker
+  // thread of the target queue, the tasks are pushed into the caller's local
+  // queue and other workers can only get them by stealing.
+  virtual void AddTasks(size_t queue_idx,
+                        std::vector<std::function<void()>>* fns) = 0;
+
   // Higher cost than AddTask
   template <typename F, typename... Args>
   std::future<typename std::result_of<F(Args...)>::type> AddAwaitableTask(
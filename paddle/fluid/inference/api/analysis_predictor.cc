@@ -119,6 +119,7 @@
 #include "paddle/fluid/pir/transforms/general/dead_code_elimination_pass.h"
 #include "paddle/fluid/pir/transforms/general/delete_assert_op_pass.h"
 #include "paddle/fluid/pir/transforms/general/inplace_pass.h"
+#include "paddle/fluid/pir/transforms/general/memory_plan_pass.h"
 #include "paddle/fluid/pir/transforms/general/params_sync_among_devices_pass.h"
 #include "paddle/fluid/pir/transforms/general/remove_shadow_feed_pass.h"
 #include "paddle/fluid/pir/transforms/general/replace_fetch_with_shadow_output_pass.h"
@@ -134,6 +135,7 @@
 #include "paddle/pir/include/pass/pass_registry.h"
 
 COMMON_DECLARE_bool(pir_apply_inplace_pass);
+COMMON_DECLARE_bool(pir_apply_memory_plan_pass);
 COMMON_DECLARE_bool(enable_auto_layout_pass);
 namespace paddle {
 namespace {
@@ -211,6 +213,39 @@ bool IsPersistable(const framework::VarDesc *var) {
   return false;
 }
 
+// Makes the pool of the thread use the device contexts of a predictor, and
+// puts back the previous ones on Restore or on any return or exception.
+class DeviceContextsGuard {
+ public:
+  explicit DeviceContextsGuard(
+      const std::map<phi::Place,
+                     std::shared_future<std::unique_ptr<phi::DeviceContext>>>
+          *device_contexts)
+      : enabled_(device_contexts != nullptr),
+        prev_(phi::DeviceContextPool::GetExternalDeviceContexts()) {
+    if (enabled_) {
+      phi::DeviceContextPool::SetDeviceContexts(device_contexts);
+    }
+  }
+
+  ~DeviceContextsGuard() { Restore(); }
+
+  void Restore() {
+    if (enabled_) {
+      phi::DeviceContextPool::SetDeviceContexts(prev_);
+      enabled_ = false;
+    }
+  }
+
+ private:
+  bool enabled_;
+  const std::map<phi::Place,
+                 std::shared_future<std::unique_ptr<phi::DeviceContext>>>
+      *prev_;
+
+  DISABLE_COPY_AND_ASSIGN(DeviceContextsGuard);
+};
+
 phi::DataType ConvertPrecision(AnalysisConfig::Precision precision) {
   switch (precision) {
     case AnalysisConfig::Precision::kFloat32:
@@ -553,6 +588,7 @@ bool AnalysisPredictor::Init(
     InitDeviceContexts();
   }
 #endif
+  InitCPUContext();
 
   TryShrinkMemory();
 
@@ -748,6 +784,25 @@ void AnalysisPredictor::InitDeviceContexts() {
 #endif
 }
 
+void AnalysisPredictor::InitCPUContext() {
+  // The CPU kernels run on a CPUContext of the predictor during Run, which
+  // bounds the threads of their ParallelFor by cpu_math_library_num_threads
+  // also when the predictors of a process are configured differently. With
+  // OneDNN the context of the pool is kept, its blob cache is shared by the
+  // predictors, and the OpenMP threads set in Run bound the kernels.
+  if (config_.mkldnn_enabled() || device_contexts_.count(phi::CPUPlace())) {
+    return;
+  }
+  paddle::platform::EmplaceDeviceContexts(&device_contexts_,
+                                          {phi::CPUPlace()},
+                                          false,
+                                          /*unused*/ 0);
+  auto *cpu_context = static_cast<phi::CPUContext *>(
+      device_contexts_.at(phi::CPUPlace()).get().get());
+  cpu_context->SetNumThreads(config_.cpu_math_library_num_threads());
+  private_cpu_context_ = true;
+}
+
 void *AnalysisPredictor::GetExecStream() const {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   if (place_.GetType() == phi::AllocationType::GPU) {
@@ -1143,6 +1198,15 @@ void AnalysisPredictor::OptimizeInferencePirProgram() {
       lowered_pm.AddPass(std::move(inplace_pass));
     }
   }
+  if (FLAGS_pir_apply_memory_plan_pass) {
+    auto memory_plan_pass = ::pir::CreateMemoryPlanPass();
+    if (std::find(config_.deleted_passes_.begin(),
+                  config_.deleted_passes_.end(),
+                  memory_plan_pass->name()) == config_.deleted_passes_.end()) {
+      memory_plan_pass->SetNotOwned(pir::Pass::kPlaceAttr, &place_);
+      lowered_pm.AddPass(std::move(memory_plan_pass));
+    }
+  }
   if (!config_.glog_info_disabled()) {
     lowered_pm.EnablePrintStatistics();
   }
@@ -1572,6 +1636,8 @@ void AnalysisPredictor::MkldnnPostReset() {
 bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
                             std::vector<PaddleTensor> *output_data,
                             int batch_size) {
+  DeviceContextsGuard device_contexts_guard(
+      private_cpu_context_ ? &device_contexts_ : nullptr);
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
 #ifdef PADDLE_WITH_DNNL
   if (config_.use_mkldnn_) MkldnnPreSet(inputs);
@@ -1629,6 +1695,7 @@ bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
   // recover the cpu_math_library_num_threads to 1, in order to avoid thread
   // conflict when integrating it into deployment service.
   paddle::platform::SetNumThreads(1);
+  device_contexts_guard.Restore();
 #ifdef PADDLE_WITH_DNNL
   if (config_.use_mkldnn_) MkldnnPostReset();
 #endif
@@ -1644,8 +1711,9 @@ bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
 bool AnalysisPredictor::Run(const std::vector<paddle::Tensor> &inputs,
                             std::vector<paddle::Tensor> *outputs) {
   inference::DisplayMemoryInfo(place_, "before run");
+  DeviceContextsGuard device_contexts_guard(
+      private_context_ || private_cpu_context_ ? &device_contexts_ : nullptr);
   if (private_context_) {
-    phi::DeviceContextPool::SetDeviceContexts(&device_contexts_);
     auto &pool = paddle::experimental::DeviceContextPool::Instance();
     pool.SyncDeviceContext(place_);
   }
@@ -1732,9 +1800,7 @@ bool AnalysisPredictor::Run(const std::vector<paddle::Tensor> &inputs,
   // recover the cpu_math_library_num_threads to 1, in order to avoid thread
   // conflict when integrating it into deployment service.
   paddle::platform::SetNumThreads(1);
-  if (private_context_) {
-    phi::DeviceContextPool::SetDeviceContexts(nullptr);
-  }
+  device_contexts_guard.Restore();
 #ifdef PADDLE_WITH_DNNL
   if (config_.use_mkldnn_) MkldnnPostReset();
 #endif
@@ -2574,8 +2640,9 @@ std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetOutputTensor(
 
 bool AnalysisPredictor::ZeroCopyRun(bool switch_stream) {
   inference::DisplayMemoryInfo(place_, "before run");
+  DeviceContextsGuard device_contexts_guard(
+      private_context_ || private_cpu_context_ ? &device_contexts_ : nullptr);
   if (private_context_) {
-    phi::DeviceContextPool::SetDeviceContexts(&device_contexts_);
     auto &pool = paddle::experimental::DeviceContextPool::Instance();
     pool.SyncDeviceContext(place_);
   }
@@ -2668,9 +2735,7 @@ bool AnalysisPredictor::ZeroCopyRun(bool switch_stream) {
   // recover the cpu_math_library_num_threads to 1, in order to avoid thread
   // conflict when integrating it into deployment service.
   paddle::platform::SetNumThreads(1);
-  if (private_context_) {
-    phi::DeviceContextPool::SetDeviceContexts(nullptr);
-  }
+  device_contexts_guard.Restore();
 #ifdef PADDLE_WITH_DNNL
   if (config_.use_mkldnn_) MkldnnPostReset();
 #endif
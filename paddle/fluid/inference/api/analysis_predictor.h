@@ -505,6 +505,7 @@ class AnalysisPredictor : public PaddlePredictor {
   void HookCollectShapeRangeInfo();
   void InitPlace();
   void InitDeviceContexts();
+  void InitCPUContext();
   void InitResourceManager(void *stream);
   std::string GetOptimizedModelPath();
   void ClearExtraParams();
@@ -556,6 +557,8 @@ class AnalysisPredictor : public PaddlePredictor {
   std::map<std::string, std::vector<std::vector<int32_t>>> shape_tensor_value_;
 
   bool private_context_{false};
+  // The kernels run on a CPUContext of the predictor, see InitCPUContext.
+  bool private_cpu_context_{false};
   void *predictor_stream_{nullptr};
   std::map<phi::Place, std::shared_future<std::unique_ptr<phi::DeviceContext>>>
       device_contexts_;
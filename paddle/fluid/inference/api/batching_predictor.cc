@@ -0,0 +1,481 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#include "paddle/common/enforce.h"
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+
+namespace paddle_infer {
+namespace services {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int64_t Numel(const std::vector<int>& shape, size_t begin = 0) {
+  int64_t numel = 1;
+  for (size_t i = begin; i < shape.size(); ++i) {
+    numel *= shape[i];
+  }
+  return numel;
+}
+
+void CopyFromHost(Tensor* tensor, DataType dtype, const char* data) {
+  switch (dtype) {
+    case DataType::FLOAT32:
+      tensor->CopyFromCpu(reinterpret_cast<const float*>(data));
+      break;
+    case DataType::INT64:
+      tensor->CopyFromCpu(reinterpret_cast<const int64_t*>(data));
+      break;
+    case DataType::INT32:
+      tensor->CopyFromCpu(reinterpret_cast<const int32_t*>(data));
+      break;
+    case DataType::UINT8:
+      tensor->CopyFromCpu(reinterpret_cast<const uint8_t*>(data));
+      break;
+    case DataType::INT8:
+      tensor->CopyFromCpu(reinterpret_cast<const int8_t*>(data));
+      break;
+    case DataType::FLOAT16:
+      tensor->CopyFromCpu(reinterpret_cast<const phi::dtype::float16*>(data));
+      break;
+    case DataType::BOOL:
+      tensor->CopyFromCpu(reinterpret_cast<const bool*>(data));
+      break;
+    case DataType::FLOAT64:
+      tensor->CopyFromCpu(reinterpret_cast<const double*>(data));
+      break;
+    case DataType::BFLOAT16:
+      tensor->CopyFromCpu(reinterpret_cast<const phi::dtype::bfloat16*>(data));
+      break;
+    default:
+      PADDLE_THROW(common::errors::Unimplemented(
+          "Unsupported data type %d of the batched input.",
+          static_cast<int>(dtype)));
+  }
+}
+
+void CopyToHost(const Tensor& tensor, char* data) {
+  switch (tensor.type()) {
+    case DataType::FLOAT32:
+      tensor.CopyToCpu(reinterpret_cast<float*>(data));
+      break;
+    case DataType::INT64:
+      tensor.CopyToCpu(reinterpret_cast<int64_t*>(data));
+      break;
+    case DataType::INT32:
+      tensor.CopyToCpu(reinterpret_cast<int32_t*>(data));
+      break;
+    case DataType::UINT8:
+      tensor.CopyToCpu(reinterpret_cast<uint8_t*>(data));
+      break;
+    case DataType::INT8:
+      tensor.CopyToCpu(reinterpret_cast<int8_t*>(data));
+      break;
+    case DataType::FLOAT16:
+      tensor.CopyToCpu(reinterpret_cast<phi::dtype::float16*>(data));
+      break;
+    case DataType::BOOL:
+      tensor.CopyToCpu(reinterpret_cast<bool*>(data));
+      break;
+    case DataType::FLOAT64:
+      tensor.CopyToCpu(reinterpret_cast<double*>(data));
+      break;
+    case DataType::BFLOAT16:
+      tensor.CopyToCpu(reinterpret_cast<phi::dtype::bfloat16*>(data));
+      break;
+    default:
+      PADDLE_THROW(common::errors::Unimplemented(
+          "Unsupported data type %d of the batched output.",
+          static_cast<int>(tensor.type())));
+  }
+}
+
+struct BatchingRequest {
+  HostTensorMap inputs;
+  // The requests of the same key can be batched together.
+  std::string key;
+  int rows{0};
+  // The dim 1 of the padded inputs, or -1 if they may differ.
+  int seq_len{-1};
+  Clock::time_point enqueue_time;
+  std::promise<HostTensorMap> promise;
+};
+
+using RequestList = std::vector<std::unique_ptr<BatchingRequest>>;
+
+}  // namespace
+
+class BatchingPredictor::Impl {
+ public:
+  Impl(const Config& config, const BatchingOptions& options)
+      : options_(options),
+        pool_(config, std::max<size_t>(options.num_workers, 1)),
+        padded_inputs_(options.padded_inputs.begin(),
+                       options.padded_inputs.end()),
+        unpadded_outputs_(options.unpadded_outputs.begin(),
+                          options.unpadded_outputs.end()) {
+    PADDLE_ENFORCE_GE(
+        options_.max_batch_size,
+        1UL,
+        common::errors::InvalidArgument(
+            "The max batch size should be at least 1, but got %d.",
+            options_.max_batch_size));
+    PADDLE_ENFORCE_EQ(
+        std::is_sorted(options_.seq_len_buckets.begin(),
+                       options_.seq_len_buckets.end()),
+        true,
+        common::errors::InvalidArgument(
+            "The sequence length buckets should be in ascending order."));
+    for (size_t i = 0; i < std::max<size_t>(options_.num_workers, 1); ++i) {
+      workers_.emplace_back(&Impl::WorkerLoop, this, pool_.Retrieve(i));
+    }
+  }
+
+  ~Impl() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  std::future<HostTensorMap> Submit(HostTensorMap inputs) {
+    auto request = std::make_unique<BatchingRequest>();
+    request->rows = CheckInputs(inputs, &request->seq_len);
+    request->key = BatchKey(inputs);
+    request->inputs = std::move(inputs);
+    auto future = request->promise.get_future();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      PADDLE_ENFORCE_EQ(stop_,
+                        false,
+                        common::errors::PreconditionNotMet(
+                            "The batching predictor has been stopped."));
+      request->enqueue_time = Clock::now();
+      queue_.push_back(std::move(request));
+    }
+    cv_.notify_all();
+    return future;
+  }
+
+ private:
+  // Returns the rows of the request, and sets seq_len to the dim 1 of its
+  // padded inputs if the outputs are unpadded.
+  int CheckInputs(const HostTensorMap& inputs, int* seq_len) const {
+    PADDLE_ENFORCE_EQ(inputs.empty(),
+                      false,
+                      common::errors::InvalidArgument(
+                          "The request should have at least one input."));
+    int rows = -1;
+    for (auto& item : inputs) {
+      const HostTensor& tensor = item.second;
+      PADDLE_ENFORCE_EQ(
+          tensor.shape.empty(),
+          false,
+          common::errors::InvalidArgument(
+              "The input %s should have the batch dim.", item.first));
+      PADDLE_ENFORCE_EQ(
+          tensor.data.size(),
+          static_cast<size_t>(Numel(tensor.shape) *
+                              GetNumBytesOfDataType(tensor.dtype)),
+          common::errors::InvalidArgument(
+              "The data of the input %s has %d bytes, which does not match "
+              "its shape.",
+              item.first,
+              tensor.data.size()));
+      if (padded_inputs_.count(item.first)) {
+        PADDLE_ENFORCE_GE(tensor.shape.size(),
+                          2UL,
+                          common::errors::InvalidArgument(
+                              "The padded input %s should have the sequence "
+                              "dim 1.",
+                              item.first));
+        if (!unpadded_outputs_.empty()) {
+          if (*seq_len < 0) {
+            *seq_len = tensor.shape[1];
+          }
+          PADDLE_ENFORCE_EQ(
+              tensor.shape[1],
+              *seq_len,
+              common::errors::InvalidArgument(
+                  "The padded inputs of a request should have the same "
+                  "sequence length to unpad the outputs, but the input %s "
+                  "has %d and the others %d.",
+                  item.first,
+                  tensor.shape[1],
+                  *seq_len));
+        }
+      }
+      if (rows < 0) {
+        rows = tensor.shape[0];
+      }
+      PADDLE_ENFORCE_EQ(tensor.shape[0],
+                        rows,
+                        common::errors::InvalidArgument(
+                            "The inputs of a request should have the same "
+                            "batch size, but the input %s has %d rows and "
+                            "the others %d.",
+                            item.first,
+                            tensor.shape[0],
+                            rows));
+    }
+    return rows;
+  }
+
+  // Returns the bucket the length is padded to, or -1 to pad it to the
+  // longest length of the batch.
+  int BucketLength(int length) const {
+    auto iter = std::lower_bound(options_.seq_len_buckets.begin(),
+                                 options_.seq_len_buckets.end(),
+                                 length);
+    return iter == options_.seq_len_buckets.end() ? -1 : *iter;
+  }
+
+  std::string BatchKey(const HostTensorMap& inputs) const {
+    std::string key;
+    for (auto& item : inputs) {
+      const HostTensor& tensor = item.second;
+      key += item.first + ":" + std::to_string(tensor.dtype);
+      for (size_t i = 1; i < tensor.shape.size(); ++i) {
+        int dim = tensor.shape[i];
+        if (i == 1 && padded_inputs_.count(item.first)) {
+          dim = BucketLength(dim);
+        }
+        key += "," + std::to_string(dim);
+      }
+      key += ";";
+    }
+    return key;
+  }
+
+  int QueuedRows(const std::string& key) const {
+    int rows = 0;
+    for (auto& request : queue_) {
+      if (request->key == key) {
+        rows += request->rows;
+      }
+    }
+    return rows;
+  }
+
+  // Takes the oldest request, and the following ones of the same key that
+  // fit in the batch.
+  RequestList TakeBatch() {
+    RequestList batch;
+    const std::string key = queue_.front()->key;
+    size_t rows = 0;
+    for (auto iter = queue_.begin(); iter != queue_.end();) {
+      if ((*iter)->key == key &&
+          (batch.empty() ||
+           rows + (*iter)->rows <= options_.max_batch_size)) {
+        rows += (*iter)->rows;
+        batch.push_back(std::move(*iter));
+        iter = queue_.erase(iter);
+      } else {
+        ++iter;
+      }
+      if (rows >= options_.max_batch_size) {
+        break;
+      }
+    }
+    return batch;
+  }
+
+  void WorkerLoop(Predictor* predictor) {
+    const auto delay = std::chrono::microseconds(options_.max_queue_delay_us);
+    while (true) {
+      RequestList batch;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        if (queue_.empty()) {
+          return;
+        }
+        // Wait for the batch of the oldest request to fill up, unless the
+        // predictor is stopping.
+        while (!stop_ && !queue_.empty()) {
+          auto deadline = queue_.front()->enqueue_time + delay;
+          if (Clock::now() >= deadline ||
+              QueuedRows(queue_.front()->key) >=
+                  static_cast<int>(options_.max_batch_size)) {
+            break;
+          }
+          cv_.wait_until(lock, deadline);
+        }
+        if (queue_.empty()) {
+          continue;
+        }
+        batch = TakeBatch();
+      }
+      RunBatch(predictor, &batch);
+    }
+  }
+
+  void RunBatch(Predictor* predictor, RequestList* batch) {
+    try {
+      int total_rows = 0;
+      for (auto& request : *batch) {
+        total_rows += request->rows;
+      }
+
+      for (auto& item : batch->front()->inputs) {
+        const std::string& name = item.first;
+        const int elem_bytes = GetNumBytesOfDataType(item.second.dtype);
+        std::vector<int> shape = item.second.shape;
+        shape[0] = total_rows;
+        const bool padded = padded_inputs_.count(name) > 0;
+        if (padded) {
+          int length = BucketLength(shape[1]);
+          if (length < 0) {
+            for (auto& request : *batch) {
+              length = std::max(length, request->inputs.at(name).shape[1]);
+            }
+          }
+          shape[1] = length;
+        }
+
+        const int64_t row_bytes = Numel(shape, 1) * elem_bytes;
+        std::vector<char> buffer(total_rows * row_bytes, 0);
+        char* dst = buffer.data();
+        for (auto& request : *batch) {
+          const HostTensor& tensor = request->inputs.at(name);
+          if (!padded) {
+            std::memcpy(dst, tensor.data.data(), tensor.data.size());
+          } else {
+            // Each row is copied to the front of its padded row.
+            const int64_t src_row_bytes = Numel(tensor.shape, 1) * elem_bytes;
+            for (int r = 0; r < request->rows; ++r) {
+              std::memcpy(dst + r * row_bytes,
+                          tensor.data.data() + r * src_row_bytes,
+                          src_row_bytes);
+            }
+          }
+          dst += request->rows * row_bytes;
+        }
+
+        auto handle = predictor->GetInputHandle(name);
+        handle->Reshape(shape);
+        CopyFromHost(handle.get(), item.second.dtype, buffer.data());
+      }
+
+      PADDLE_ENFORCE_EQ(
+          predictor->Run(),
+          true,
+          common::errors::Fatal("Failed to run the batch of %d requests.",
+                                batch->size()));
+
+      std::vector<HostTensorMap> outputs(batch->size());
+      for (auto& name : predictor->GetOutputNames()) {
+        auto handle = predictor->GetOutputHandle(name);
+        HostTensor output;
+        output.shape = handle->shape();
+        output.dtype = handle->type();
+        output.data.resize(Numel(output.shape) *
+                           GetNumBytesOfDataType(output.dtype));
+        CopyToHost(*handle, output.data.data());
+
+        if (output.shape.empty() || output.shape[0] != total_rows) {
+          for (auto& request_outputs : outputs) {
+            request_outputs[name] = output;
+          }
+          continue;
+        }
+        const int64_t row_bytes = output.data.size() / total_rows;
+        const bool unpadded = unpadded_outputs_.count(name) > 0;
+        const char* src = output.data.data();
+        for (size_t i = 0; i < batch->size(); ++i) {
+          const BatchingRequest& request = *(*batch)[i];
+          HostTensor& split = outputs[i][name];
+          split.shape = output.shape;
+          split.shape[0] = request.rows;
+          split.dtype = output.dtype;
+          if (!unpadded || request.seq_len < 0) {
+            split.data.assign(src, src + request.rows * row_bytes);
+          } else {
+            PADDLE_ENFORCE_EQ(
+                output.shape.size() >= 2 && output.shape[1] >= request.seq_len,
+                true,
+                common::errors::InvalidArgument(
+                    "The unpadded output %s should have the padded sequence "
+                    "dim 1 of at least %d.",
+                    name,
+                    request.seq_len));
+            // The front of each padded row.
+            split.shape[1] = request.seq_len;
+            const int64_t split_row_bytes =
+                Numel(split.shape, 1) * GetNumBytesOfDataType(output.dtype);
+            split.data.resize(request.rows * split_row_bytes);
+            for (int r = 0; r < request.rows; ++r) {
+              std::memcpy(split.data.data() + r * split_row_bytes,
+                          src + r * row_bytes,
+                          split_row_bytes);
+            }
+          }
+          src += request.rows * row_bytes;
+        }
+      }
+
+      for (size_t i = 0; i < batch->size(); ++i) {
+        (*batch)[i]->promise.set_value(std::move(outputs[i]));
+      }
+    } catch (...) {
+      for (auto& request : *batch) {
+        request->promise.set_exception(std::current_exception());
+      }
+    }
+  }
+
+  BatchingOptions options_;
+  PredictorPool pool_;
+  std::unordered_set<std::string> padded_inputs_;
+  std::unordered_set<std::string> unpadded_outputs_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::unique_ptr<BatchingRequest>> queue_;
+  bool stop_{false};
+  std::vector<std::thread> workers_;
+};
+
+BatchingPredictor::BatchingPredictor(const Config& config,
+                                     const BatchingOptions& options)
+    : impl_(new Impl(config, options)) {}
+
+BatchingPredictor::~BatchingPredictor() = default;
+
+std::future<HostTensorMap> BatchingPredictor::Submit(HostTensorMap inputs) {
+  return impl_->Submit(std::move(inputs));
+}
+
+HostTensorMap BatchingPredictor::Run(HostTensorMap inputs) {
+  return Submit(std::move(inputs)).get();
+}
+
+}  // namespace services
+}  // namespace paddle_infer
@@ -22,6 +22,8 @@ limitations under the License. */
 #pragma once
 
 #include <cassert>
+#include <cstdint>
+#include <future>
 #include <map>
 #include <memory>
 #include <string>
@@ -272,6 +274,85 @@ class PD_INFER_DECL PredictorPool {
   std::shared_ptr<Predictor> main_pred_;
   std::vector<std::unique_ptr<Predictor>> preds_;
 };
+
+///
+/// \brief A tensor in host memory, whose dim 0 is the batch dim.
+///
+struct PD_INFER_DECL HostTensor {
+  std::vector<int> shape;
+  DataType dtype{DataType::FLOAT32};
+  std::vector<char> data;
+};
+
+using HostTensorMap = std::map<std::string, HostTensor>;
+
+///
+/// \brief The options of BatchingPredictor.
+///
+struct PD_INFER_DECL BatchingOptions {
+  /// The most rows of the requests coalesced into one run. A request with
+  /// more rows than it is run alone.
+  size_t max_batch_size{8};
+  /// How long the oldest queued request waits for others to fill its batch.
+  int64_t max_queue_delay_us{1000};
+  /// The number of predictors running batches concurrently.
+  size_t num_workers{1};
+  /// The inputs whose dim 1 is a variable sequence length. They are padded
+  /// with zeros along dim 1, so the requests of different lengths can be
+  /// batched together.
+  std::vector<std::string> padded_inputs;
+  /// The ascending lengths the padded inputs are padded to. The requests are
+  /// only batched with those of the same bucket. If empty, or the length is
+  /// longer than the last bucket, the inputs are padded to the longest one
+  /// in the batch.
+  std::vector<int> seq_len_buckets;
+  /// The outputs whose dim 1 is the padded sequence length. They are cut
+  /// back to the sequence length of the padded inputs of each request, which
+  /// must then have the same dim 1.
+  std::vector<std::string> unpadded_outputs;
+};
+
+///
+/// \class BatchingPredictor
+///
+/// \brief BatchingPredictor queues the requests of concurrent callers and
+/// coalesces them along the batch dim, so that a predictor of the pool runs
+/// them with one ZeroCopyRun. The outputs are split back along dim 0 by the
+/// rows of each request. The outputs of the padded requests keep the padded
+/// length unless they are in unpadded_outputs, and an output whose dim 0 is
+/// not the batch dim is given whole to each request of the batch.
+///
+/// Usage:
+///
+/// \code{.cpp}
+/// BatchingOptions options;
+/// options.max_batch_size = 16;
+/// BatchingPredictor predictor(config, options);
+/// // From any thread.
+/// HostTensorMap outputs = predictor.Run(inputs);
+/// \endcode
+///
+class PD_INFER_DECL BatchingPredictor {
+ public:
+  BatchingPredictor(const Config& config, const BatchingOptions& options);
+  BatchingPredictor(const BatchingPredictor&) = delete;
+  BatchingPredictor& operator=(const BatchingPredictor&) = delete;
+
+  /// \brief Waits for the queued requests to finish and stops the workers.
+  ~BatchingPredictor();
+
+  /// \brief Queues a request of the named inputs. thread safe.
+  ///
+  /// \return the future of the named outputs of the request.
+  std::future<HostTensorMap> Submit(HostTensorMap inputs);
+
+  /// \brief Submits a request and waits for its outputs.
+  HostTensorMap Run(HostTensorMap inputs);
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
 }  // namespace services
 
 }  // namespace paddle_infer
@@ -0,0 +1,170 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/capi_exp/pd_batching_predictor.h"
+
+#include <cstring>
+
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/inference/capi_exp/pd_types.h"
+#include "paddle/fluid/inference/capi_exp/pd_utils.h"
+#include "paddle/fluid/inference/capi_exp/types_internal.h"
+#include "paddle/fluid/inference/capi_exp/utils_internal.h"
+#include "paddle/fluid/platform/enforce.h"
+
+#define CHECK_AND_CONVERT_PD_BATCHING_PREDICTOR                     \
+  PADDLE_ENFORCE_NOT_NULL(                                          \
+      pd_batching_predictor,                                        \
+      common::errors::InvalidArgument(                              \
+          "The pointer of paddle batching predictor shouldn't be "  \
+          "nullptr"));                                              \
+  auto& batching_predictor = pd_batching_predictor->predictor
+
+#define CHECK_AND_CONVERT_PD_BATCHING_REQUEST                       \
+  PADDLE_ENFORCE_NOT_NULL(                                          \
+      pd_request,                                                   \
+      common::errors::InvalidArgument(                              \
+          "The pointer of paddle batching request shouldn't be "    \
+          "nullptr"));                                              \
+  auto& request = *pd_request
+
+namespace {
+
+const paddle_infer::services::HostTensor& GetOutput(
+    const PD_BatchingRequest& request, const char* name) {
+  auto iter = request.outputs.find(name);
+  PADDLE_ENFORCE_NE(
+      iter,
+      request.outputs.end(),
+      common::errors::NotFound("The request has no output %s.", name));
+  return iter->second;
+}
+
+}  // namespace
+
+extern "C" {
+
+__pd_give PD_BatchingPredictor* PD_BatchingPredictorCreate(
+    __pd_take PD_Config* pd_config,
+    size_t max_batch_size,
+    int64_t max_queue_delay_us,
+    size_t num_workers,
+    __pd_keep PD_OneDimArrayCstr* padded_inputs,
+    __pd_keep PD_OneDimArrayInt32* seq_len_buckets,
+    __pd_keep PD_OneDimArrayCstr* unpadded_outputs) {
+  PADDLE_ENFORCE_NOT_NULL(
+      pd_config,
+      common::errors::InvalidArgument(
+          "The pointer of paddle predictor shouldn't be nullptr"));
+  paddle_infer::Config* config =
+      reinterpret_cast<paddle_infer::Config*>(pd_config);
+  paddle_infer::services::BatchingOptions options;
+  options.max_batch_size = max_batch_size;
+  options.max_queue_delay_us = max_queue_delay_us;
+  options.num_workers = num_workers;
+  if (padded_inputs != nullptr) {
+    options.padded_inputs =
+        paddle_infer::CvtOneDimArrayToVecCstr(padded_inputs);
+  }
+  if (seq_len_buckets != nullptr) {
+    options.seq_len_buckets =
+        paddle_infer::CvtOneDimArrayToVecInt32(seq_len_buckets);
+  }
+  if (unpadded_outputs != nullptr) {
+    options.unpadded_outputs =
+        paddle_infer::CvtOneDimArrayToVecCstr(unpadded_outputs);
+  }
+  PD_BatchingPredictor* pd_batching_predictor = new PD_BatchingPredictor();
+  pd_batching_predictor->predictor.reset(
+      new paddle_infer::services::BatchingPredictor(*config, options));
+  return pd_batching_predictor;
+}
+
+PD_Bool PD_BatchingPredictorRun(
+    __pd_keep PD_BatchingPredictor* pd_batching_predictor,
+    __pd_keep PD_BatchingRequest* pd_request) {
+  CHECK_AND_CONVERT_PD_BATCHING_PREDICTOR;
+  CHECK_AND_CONVERT_PD_BATCHING_REQUEST;
+  try {
+    request.outputs = batching_predictor->Run(request.inputs);
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Failed to run the batching request: " << e.what();
+    return FALSE;
+  }
+  return TRUE;
+}
+
+void PD_BatchingPredictorDestroy(
+    __pd_take PD_BatchingPredictor* pd_batching_predictor) {
+  delete pd_batching_predictor;
+}
+
+__pd_give PD_BatchingRequest* PD_BatchingRequestCreate() {
+  return new PD_BatchingRequest();
+}
+
+void PD_BatchingRequestSetInput(__pd_keep PD_BatchingRequest* pd_request,
+                                const char* name,
+                                PD_DataType data_type,
+                                size_t shape_size,
+                                int32_t* shape,
+                                const void* data) {
+  CHECK_AND_CONVERT_PD_BATCHING_REQUEST;
+  paddle_infer::services::HostTensor& input = request.inputs[name];
+  input.shape.assign(shape, shape + shape_size);
+  input.dtype = paddle_infer::CvtToCxxDatatype(data_type);
+  int64_t numel = 1;
+  for (size_t i = 0; i < shape_size; ++i) {
+    numel *= shape[i];
+  }
+  const char* bytes = static_cast<const char*>(data);
+  input.data.assign(
+      bytes,
+      bytes + numel * paddle_infer::GetNumBytesOfDataType(input.dtype));
+}
+
+__pd_give PD_OneDimArrayCstr* PD_BatchingRequestGetOutputNames(
+    __pd_keep PD_BatchingRequest* pd_request) {
+  CHECK_AND_CONVERT_PD_BATCHING_REQUEST;
+  std::vector<std::string> names;
+  for (auto& item : request.outputs) {
+    names.push_back(item.first);
+  }
+  return paddle_infer::CvtVecToOneDimArrayCstr(names);
+}
+
+__pd_give PD_OneDimArrayInt32* PD_BatchingRequestGetOutputShape(
+    __pd_keep PD_BatchingRequest* pd_request, const char* name) {
+  CHECK_AND_CONVERT_PD_BATCHING_REQUEST;
+  return paddle_infer::CvtVecToOneDimArrayInt32(GetOutput(request, name).shape);
+}
+
+PD_DataType PD_BatchingRequestGetOutputType(
+    __pd_keep PD_BatchingRequest* pd_request, const char* name) {
+  CHECK_AND_CONVERT_PD_BATCHING_REQUEST;
+  return paddle_infer::CvtFromCxxDatatype(GetOutput(request, name).dtype);
+}
+
+void PD_BatchingRequestCopyOutputToCpu(
+    __pd_keep PD_BatchingRequest* pd_request, const char* name, void* data) {
+  CHECK_AND_CONVERT_PD_BATCHING_REQUEST;
+  const auto& output = GetOutput(request, name);
+  std::memcpy(data, output.data.data(), output.data.size());
+}
+
+void PD_BatchingRequestDestroy(__pd_take PD_BatchingRequest* pd_request) {
+  delete pd_request;
+}
+
+}  // extern "C"
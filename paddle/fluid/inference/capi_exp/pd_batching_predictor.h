@@ -0,0 +1,152 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+///
+/// \file pd_batching_predictor.h
+///
+/// \brief interface for the predictor batching the concurrent requests
+///
+/// \author paddle-infer@baidu.com
+/// \date 2024-10-16
+/// \since 3.0
+///
+
+#pragma once
+
+#include "pd_common.h"  // NOLINT
+
+typedef struct PD_BatchingPredictor PD_BatchingPredictor;
+typedef struct PD_BatchingRequest PD_BatchingRequest;
+typedef struct PD_Config PD_Config;
+typedef struct PD_OneDimArrayCstr PD_OneDimArrayCstr;
+typedef struct PD_OneDimArrayInt32 PD_OneDimArrayInt32;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+///
+/// \brief Create a new BatchingPredictor, which coalesces the requests run
+/// from concurrent threads along the batch dim.
+///
+/// \param[in] pd_config config
+/// \param[in] max_batch_size The most rows of the requests in one run.
+/// \param[in] max_queue_delay_us How long the oldest queued request waits
+/// for others to fill its batch.
+/// \param[in] num_workers The number of predictors running batches.
+/// \param[in] padded_inputs The inputs whose dim 1 is a variable sequence
+/// length, padded with zeros to batch the requests. Can be NULL.
+/// \param[in] seq_len_buckets The ascending lengths the padded inputs are
+/// padded to. Can be NULL to pad them to the longest one in the batch.
+/// \param[in] unpadded_outputs The outputs cut back to the sequence length
+/// of each request. Can be NULL.
+/// \return new batching predictor.
+///
+PADDLE_CAPI_EXPORT extern __pd_give PD_BatchingPredictor*
+PD_BatchingPredictorCreate(__pd_take PD_Config* pd_config,
+                           size_t max_batch_size,
+                           int64_t max_queue_delay_us,
+                           size_t num_workers,
+                           __pd_keep PD_OneDimArrayCstr* padded_inputs,
+                           __pd_keep PD_OneDimArrayInt32* seq_len_buckets,
+                           __pd_keep PD_OneDimArrayCstr* unpadded_outputs);
+///
+/// \brief Run the request, blocking until its batch is run. thread safe.
+///
+/// \param[in] pd_batching_predictor batching predictor
+/// \param[in] pd_request The request, whose outputs are set by the run.
+/// \return Whether the request is run successfully
+///
+PADDLE_CAPI_EXPORT extern PD_Bool PD_BatchingPredictorRun(
+    __pd_keep PD_BatchingPredictor* pd_batching_predictor,
+    __pd_keep PD_BatchingRequest* pd_request);
+///
+/// \brief Destroy the batching predictor, after the queued requests finish.
+///
+/// \param[in] pd_batching_predictor batching predictor
+///
+PADDLE_CAPI_EXPORT extern void PD_BatchingPredictorDestroy(
+    __pd_take PD_BatchingPredictor* pd_batching_predictor);
+
+///
+/// \brief Create a new request with no inputs.
+///
+/// \return new request.
+///
+PADDLE_CAPI_EXPORT extern __pd_give PD_BatchingRequest*
+PD_BatchingRequestCreate();
+///
+/// \brief Set an input of the request, copying its data.
+///
+/// \param[in] pd_request request
+/// \param[in] name The input name.
+/// \param[in] data_type The data type of the input.
+/// \param[in] shape_size The size of shape.
+/// \param[in] shape The shape of the input, whose dim 0 is the batch dim.
+/// \param[in] data The pointer of the data.
+///
+PADDLE_CAPI_EXPORT extern void PD_BatchingRequestSetInput(
+    __pd_keep PD_BatchingRequest* pd_request,
+    const char* name,
+    PD_DataType data_type,
+    size_t shape_size,
+    int32_t* shape,
+    const void* data);
+///
+/// \brief Get the output names of the request after it is run.
+///
+/// \param[in] pd_request request
+/// \return output names
+///
+PADDLE_CAPI_EXPORT extern __pd_give PD_OneDimArrayCstr*
+PD_BatchingRequestGetOutputNames(__pd_keep PD_BatchingRequest* pd_request);
+///
+/// \brief Get the shape of an output of the request.
+///
+/// \param[in] pd_request request
+/// \param[in] name The output name.
+/// \return The shape of the output.
+///
+PADDLE_CAPI_EXPORT extern __pd_give PD_OneDimArrayInt32*
+PD_BatchingRequestGetOutputShape(__pd_keep PD_BatchingRequest* pd_request,
+                                 const char* name);
+///
+/// \brief Get the data type of an output of the request.
+///
+/// \param[in] pd_request request
+/// \param[in] name The output name.
+/// \return The data type of the output.
+///
+PADDLE_CAPI_EXPORT extern PD_DataType PD_BatchingRequestGetOutputType(
+    __pd_keep PD_BatchingRequest* pd_request, const char* name);
+///
+/// \brief Copy an output of the request to the host memory.
+///
+/// \param[in] pd_request request
+/// \param[in] name The output name.
+/// \param[out] data The pointer of the host memory to copy to.
+///
+PADDLE_CAPI_EXPORT extern void PD_BatchingRequestCopyOutputToCpu(
+    __pd_keep PD_BatchingRequest* pd_request, const char* name, void* data);
+///
+/// \brief Destroy the request.
+///
+/// \param[in] pd_request request
+///
+PADDLE_CAPI_EXPORT extern void PD_BatchingRequestDestroy(
+    __pd_take PD_BatchingRequest* pd_request);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
@@ -27,3 +27,12 @@ typedef struct PD_Tensor {
 typedef struct PD_Predictor {
   std::shared_ptr<paddle_infer::Predictor> predictor;
 } PD_Predictor;
+
+typedef struct PD_BatchingPredictor {
+  std::unique_ptr<paddle_infer::services::BatchingPredictor> predictor;
+} PD_BatchingPredictor;
+
+typedef struct PD_BatchingRequest {
+  paddle_infer::services::HostTensorMap inputs;
+  paddle_infer::services::HostTensorMap outputs;
+} PD_BatchingRequest;
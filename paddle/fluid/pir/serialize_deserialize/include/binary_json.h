@@ -0,0 +1,49 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "paddle/fluid/pir/serialize_deserialize/include/third_party.h"
+#include "paddle/pir/include/core/dll_decl.h"
+
+namespace pir {
+/**
+ * Binary encoding of the json documents written by WriteModule. It keeps the
+ * schema of the json file, so that ProgramReader and the version compatible
+ * patches work on the decoded json as is, but:
+ *   - all keys and string values (op, attribute and type names) are interned
+ *     in a string table at the head of the file and referred by index;
+ *   - integers, ids and lengths are varint encoded, floats are raw doubles.
+ *
+ * layout: magic "PIRB" | varint format version | varint string number |
+ *         (varint length, bytes) * string number | root value
+ */
+constexpr char kBinaryJsonMagic[] = "PIRB";
+constexpr uint64_t kBinaryJsonVersion = 1;
+
+IR_API std::string EncodeBinaryJson(const Json& json);
+
+IR_API Json DecodeBinaryJson(const char* data, size_t size);
+
+IR_API bool IsBinaryJson(const char* data, size_t size);
+
+/** Reads a module file written by WriteModule in either json or binary
+ * encoding. */
+IR_API Json ReadModuleJson(const std::string& file_path);
+
+}  // namespace pir
@@ -0,0 +1,294 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/pir/serialize_deserialize/include/binary_json.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "paddle/common/enforce.h"
+
+namespace pir {
+
+namespace {
+
+enum BinaryJsonTag : uint8_t {
+  kNull = 0,
+  kFalse = 1,
+  kTrue = 2,
+  kInteger = 3,   // zigzag varint
+  kUnsigned = 4,  // varint
+  kFloat = 5,     // 8 bytes double
+  kString = 6,    // varint index of the string table
+  kArray = 7,     // varint size, values
+  kObject = 8,    // varint size, (varint key index, value) pairs
+};
+
+constexpr size_t kMagicSize = sizeof(kBinaryJsonMagic) - 1;
+
+class BinaryJsonWriter {
+ public:
+  std::string Encode(const Json& json) {
+    WriteValue(json);
+    std::string out(kBinaryJsonMagic, kMagicSize);
+    WriteVarint(kBinaryJsonVersion, &out);
+    WriteVarint(strings_.size(), &out);
+    for (auto* str : strings_) {
+      WriteVarint(str->size(), &out);
+      out.append(*str);
+    }
+    out.append(body_);
+    return out;
+  }
+
+ private:
+  static void WriteVarint(uint64_t value, std::string* out) {
+    while (value >= 0x80) {
+      out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+      value >>= 7;
+    }
+    out->push_back(static_cast<char>(value));
+  }
+
+  void WriteString(const std::string& str) {
+    auto it = string_ids_.find(str);
+    if (it == string_ids_.end()) {
+      it = string_ids_.emplace(str, strings_.size()).first;
+      strings_.push_back(&it->first);
+    }
+    WriteVarint(it->second, &body_);
+  }
+
+  void WriteValue(const Json& json) {
+    switch (json.type()) {
+      case Json::value_t::null:
+        body_.push_back(kNull);
+        break;
+      case Json::value_t::boolean:
+        body_.push_back(json.get<bool>() ? kTrue : kFalse);
+        break;
+      case Json::value_t::number_integer: {
+        int64_t value = json.get<int64_t>();
+        body_.push_back(kInteger);
+        WriteVarint((static_cast<uint64_t>(value) << 1) ^
+                        static_cast<uint64_t>(value >> 63),
+                    &body_);
+        break;
+      }
+      case Json::value_t::number_unsigned:
+        body_.push_back(kUnsigned);
+        WriteVarint(json.get<uint64_t>(), &body_);
+        break;
+      case Json::value_t::number_float: {
+        double value = json.get<double>();
+        body_.push_back(kFloat);
+        body_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        break;
+      }
+      case Json::value_t::string:
+        body_.push_back(kString);
+        WriteString(json.get_ref<const std::string&>());
+        break;
+      case Json::value_t::array:
+        body_.push_back(kArray);
+        WriteVarint(json.size(), &body_);
+        for (auto& item : json) {
+          WriteValue(item);
+        }
+        break;
+      case Json::value_t::object:
+        body_.push_back(kObject);
+        WriteVarint(json.size(), &body_);
+        for (auto& item : json.items()) {
+          WriteString(item.key());
+          WriteValue(item.value());
+        }
+        break;
+      default:
+        PADDLE_THROW(common::errors::Unimplemented(
+            "Json type %s is not supported in binary encoding.",
+            json.type_name()));
+    }
+  }
+
+  std::string body_;
+  std::unordered_map<std::string, uint64_t> string_ids_;
+  // strings in the order of their ids, pointing to the keys of string_ids_
+  std::vector<const std::string*> strings_;
+};
+
+class BinaryJsonReader {
+ public:
+  BinaryJsonReader(const char* data, size_t size)
+      : cur_(data), end_(data + size) {}
+
+  Json Decode() {
+    PADDLE_ENFORCE_EQ(
+        IsBinaryJson(cur_, end_ - cur_),
+        true,
+        common::errors::InvalidArgument("Invalid binary model file."));
+    cur_ += kMagicSize;
+    uint64_t version = ReadVarint();
+    PADDLE_ENFORCE_LE(version,
+                      kBinaryJsonVersion,
+                      common::errors::InvalidArgument(
+                          "The binary model file is of format version %d, "
+                          "which is newer than the supported version %d.",
+                          version,
+                          kBinaryJsonVersion));
+    uint64_t string_num = ReadVarint();
+    strings_.reserve(string_num);
+    for (uint64_t i = 0; i < string_num; ++i) {
+      uint64_t length = ReadVarint();
+      CheckRemain(length);
+      strings_.emplace_back(cur_, length);
+      cur_ += length;
+    }
+    Json json = ReadValue();
+    PADDLE_ENFORCE_EQ(
+        cur_,
+        end_,
+        common::errors::InvalidArgument(
+            "Invalid binary model file, %d bytes remain after the program.",
+            end_ - cur_));
+    return json;
+  }
+
+ private:
+  void CheckRemain(uint64_t size) const {
+    PADDLE_ENFORCE_LE(size,
+                      static_cast<uint64_t>(end_ - cur_),
+                      common::errors::InvalidArgument(
+                          "Invalid binary model file, the file is truncated."));
+  }
+
+  uint64_t ReadVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      CheckRemain(1);
+      uint8_t byte = static_cast<uint8_t>(*cur_++);
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return value;
+      }
+    }
+    PADDLE_THROW(common::errors::InvalidArgument(
+        "Invalid binary model file, varint is too long."));
+  }
+
+  const std::string& ReadString() {
+    uint64_t id = ReadVarint();
+    PADDLE_ENFORCE_LT(id,
+                      strings_.size(),
+                      common::errors::InvalidArgument(
+                          "Invalid binary model file, string id %d is out of "
+                          "the string table of size %d.",
+                          id,
+                          strings_.size()));
+    return strings_[id];
+  }
+
+  Json ReadValue() {
+    CheckRemain(1);
+    auto tag = static_cast<uint8_t>(*cur_++);
+    switch (tag) {
+      case kNull:
+        return Json(nullptr);
+      case kFalse:
+        return Json(false);
+      case kTrue:
+        return Json(true);
+      case kInteger: {
+        uint64_t value = ReadVarint();
+        return Json(static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1)));
+      }
+      case kUnsigned:
+        return Json(ReadVarint());
+      case kFloat: {
+        double value = 0;
+        CheckRemain(sizeof(value));
+        std::memcpy(&value, cur_, sizeof(value));
+        cur_ += sizeof(value);
+        return Json(value);
+      }
+      case kString:
+        return Json(ReadString());
+      case kArray: {
+        uint64_t size = ReadVarint();
+        // every value takes at least one byte
+        CheckRemain(size);
+        Json json = Json::array();
+        auto& array = json.get_ref<Json::array_t&>();
+        array.reserve(size);
+        for (uint64_t i = 0; i < size; ++i) {
+          array.emplace_back(ReadValue());
+        }
+        return json;
+      }
+      case kObject: {
+        uint64_t size = ReadVarint();
+        CheckRemain(size);
+        Json json = Json::object();
+        auto& object = json.get_ref<Json::object_t&>();
+        for (uint64_t i = 0; i < size; ++i) {
+          const std::string& key = ReadString();
+          object.emplace_hint(object.end(), key, ReadValue());
+        }
+        return json;
+      }
+      default:
+        PADDLE_THROW(common::errors::InvalidArgument(
+            "Invalid binary model file, unknown value tag %d.", tag));
+    }
+  }
+
+  const char* cur_;
+  const char* end_;
+  std::vector<std::string> strings_;
+};
+
+}  // namespace
+
+std::string EncodeBinaryJson(const Json& json) {
+  return BinaryJsonWriter().Encode(json);
+}
+
+Json DecodeBinaryJson(const char* data, size_t size) {
+  return BinaryJsonReader(data, size).Decode();
+}
+
+bool IsBinaryJson(const char* data, size_t size) {
+  return size >= kMagicSize &&
+         std::memcmp(data, kBinaryJsonMagic, kMagicSize) == 0;
+}
+
+Json ReadModuleJson(const std::string& file_path) {
+  std::ifstream f(file_path, std::ios::binary);
+  PADDLE_ENFORCE_EQ(static_cast<bool>(f),
+                    true,
+                    common::errors::Unavailable(
+                        "Cannot open %s to load the program.", file_path));
+  std::string buffer((std::istreambuf_iterator<char>(f)),
+                     std::istreambuf_iterator<char>());
+  if (IsBinaryJson(buffer.data(), buffer.size())) {
+    return DecodeBinaryJson(buffer.data(), buffer.size());
+  }
+  return Json::parse(buffer);
+}
+
+}  // namespace pir
@@ -15,6 +15,7 @@
 #include "paddle/fluid/pir/serialize_deserialize/include/interface.h"
 #include <stdio.h>
 #include "paddle/common/enforce.h"
+#include "paddle/fluid/pir/serialize_deserialize/include/binary_json.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/ir_deserialize.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/ir_serialize.h"
 #include "paddle/phi/common/port.h"
@@ -31,7 +32,8 @@ void WriteModule(const pir::Program& program,
                  uint64_t pir_version,
                  bool overwrite,
                  bool readable,
-                 bool trainable) {
+                 bool trainable,
+                 bool binary) {
   PADDLE_ENFORCE_EQ(
       FileExists(file_path) && !overwrite,
       false,
@@ -50,7 +52,9 @@ void WriteModule(const pir::Program& program,
   // write program
   total[PROGRAM] = writer.GetProgramJson(&program);
   std::string total_str;
-  if (readable) {
+  if (binary) {
+    total_str = EncodeBinaryJson(total);
+  } else if (readable) {
     total_str = total.dump(4);
   } else {
     total_str = total.dump();
@@ -69,8 +73,7 @@ void WriteModule(const pir::Program& program,
 bool ReadModule(const std::string& file_path,
                 pir::Program* program,
                 int64_t pir_version) {
-  std::ifstream f(file_path);
-  Json data = Json::parse(f);
+  Json data = ReadModuleJson(file_path);
   if (pir_version < 0) {
     pir_version = DEVELOP_VERSION;
     VLOG(6) << "pir_version is null, get pir_version: " << pir_version;
@@ -14,11 +14,15 @@ limitations under the License. */
 #include <numeric>
 
 #include "glog/logging.h"
+#include "paddle/common/flags.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/interface.h"
 #include "paddle/phi/common/port.h"
+#include "paddle/phi/core/framework/dense_tensor_serialize.h"
 #include "paddle/phi/kernels/funcs/data_type_transform.h"
 
+COMMON_DECLARE_bool(load_params_with_mmap);
+
 namespace pir {
 
 const phi::DeviceContext* GetDeviceContext(
@@ -165,7 +169,18 @@ void LoadFunction(const std::string& file_path,
                               "The variable to be loaded cannot be found."));
   const phi::DeviceContext* dev_ctx = GetDeviceContext(*out, place);
 
+#ifndef _WIN32
+  if (FLAGS_load_params_with_mmap && seek == -1 &&
+      phi::is_cpu_place(dev_ctx->GetPlace())) {
+    fin.close();
+    auto file =
+        paddle::memory::allocation::AllocateMappedFileAllocation(file_path);
+    size_t offset = 0;
+    phi::DeserializeFromMappedFile(file, &offset, out);
+  } else if (seek != -1) {
+#else
   if (seek != -1) {
+#endif
     PADDLE_ENFORCE_GE(seek,
                       0,
                       common::errors::InvalidArgument(
@@ -203,6 +218,31 @@ void LoadCombineFunction(const std::string& file_path,
                         "it to be greater than 0.",
                         out->size()));
   const phi::DeviceContext* dev_ctx = GetDeviceContext(*(out->at(0)), place);
+#ifndef _WIN32
+  if (FLAGS_load_params_with_mmap && phi::is_cpu_place(dev_ctx->GetPlace())) {
+    fin.close();
+    auto file =
+        paddle::memory::allocation::AllocateMappedFileAllocation(file_path);
+    size_t offset = 0;
+    for (size_t i = 0; i < names.size(); i++) {
+      auto tensor = out->at(i);
+      phi::DeserializeFromMappedFile(file, &offset, tensor);
+
+      auto in_dtype = tensor->dtype();
+      auto out_dtype = load_as_fp16 ? phi::DataType::FLOAT16 : in_dtype;
+      if (in_dtype != out_dtype) {
+        auto cast_in = *tensor;
+        *tensor = CastTensorType(dev_ctx, cast_in, out_dtype);
+      }
+    }
+    PADDLE_ENFORCE_EQ(offset,
+                      file->size(),
+                      common::errors::Unavailable(
+                          "Not allowed to load partial data via "
+                          "load_combine_op, please use load_op instead."));
+    return;
+  }
+#endif
   for (size_t i = 0; i < names.size(); i++) {
     auto tensor = out->at(i);
     phi::DeserializeFromStream(fin, tensor, *dev_ctx);
@@ -0,0 +1,300 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/pir/transforms/general/memory_plan_pass.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_op.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_type.h"
+#include "paddle/fluid/pir/dialect/operator/utils/utils.h"
+#include "paddle/phi/common/place.h"
+#include "paddle/pir/include/core/builtin_attribute.h"
+#include "paddle/pir/include/core/builtin_op.h"
+#include "paddle/pir/include/core/operation.h"
+#include "paddle/pir/include/pass/pass.h"
+#include "paddle/pir/include/pass/pass_registry.h"
+
+namespace {
+
+using TensorType = paddle::dialect::AllocatedDenseTensorType;
+
+constexpr int64_t kMemoryPlanAlignment = 64;
+
+// The ops whose outputs may share the memory of their inputs.
+const std::unordered_set<std::string> kViewOps = {
+    "pd_op.as_complex",
+    "pd_op.as_real",
+    "pd_op.as_strided",
+    "pd_op.diagonal",
+    "pd_op.flatten",
+    "pd_op.reshape",
+    "pd_op.slice",
+    "pd_op.split",
+    "pd_op.split_with_num",
+    "pd_op.squeeze",
+    "pd_op.strided_slice",
+    "pd_op.tensor_unfold",
+    "pd_op.transpose",
+    "pd_op.unbind",
+    "pd_op.unsqueeze",
+    "pd_op.view_dtype",
+    "pd_op.view_shape",
+    "pd_op.transfer_layout"};
+
+// The ops that hand their inputs out of the program, or keep them alive
+// across runs.
+const std::unordered_set<std::string> kEscapeOps = {"builtin.shadow_output",
+                                                    "builtin.set_parameter",
+                                                    "pd_op.fetch",
+                                                    "pd_op.share_data",
+                                                    "pd_op.share_data_",
+                                                    "pd_op.select_input",
+                                                    "pd_op.select_output",
+                                                    "cf.yield",
+                                                    "cf.tuple_push"};
+
+// The ops whose outputs are not allocated by their kernels.
+const std::unordered_set<std::string> kNoPlanOps = {"pd_op.feed",
+                                                    "pd_op.data",
+                                                    "pd_op.fetch"};
+
+std::string OpName(pir::Operation* op) {
+  if (op->HasAttribute("op_name")) {
+    return op->attribute<pir::StrAttribute>("op_name").AsString();
+  }
+  return op->name();
+}
+
+bool IsInplaceOp(pir::Operation* op, const std::string& op_name) {
+  if (op->HasAttribute("is_inplace") &&
+      op->attribute<pir::BoolAttribute>("is_inplace").data()) {
+    return true;
+  }
+  return !op_name.empty() && op_name.back() == '_';
+}
+
+// Whether the results of op alias the memory of its inputs.
+bool IsAliasOp(pir::Operation* op) {
+  if (op->isa<pir::CombineOp>() || op->isa<pir::SplitOp>() ||
+      op->isa<pir::SliceOp>()) {
+    return true;
+  }
+  const std::string op_name = OpName(op);
+  return kViewOps.count(op_name) || IsInplaceOp(op, op_name);
+}
+
+struct LiveRange {
+  pir::Value value;
+  int64_t size;
+  int64_t begin;
+  int64_t end;
+  int64_t offset;
+};
+
+class LivenessAnalyzer {
+ public:
+  explicit LivenessAnalyzer(pir::Block* block) : block_(block) {
+    int64_t index = 0;
+    for (auto& op : *block) {
+      op_index_[&op] = index++;
+    }
+  }
+
+  int64_t Index(pir::Operation* op) const { return op_index_.at(op); }
+
+  // Returns the index of the last op that reads the value or one of its
+  // aliases, or -1 if the memory may be read outside of the block.
+  int64_t LastUse(pir::Value value) {
+    auto iter = last_use_.find(value);
+    if (iter != last_use_.end()) {
+      return iter->second;
+    }
+    int64_t last = 0;
+    for (auto it = value.use_begin(); it != value.use_end() && last >= 0;
+         ++it) {
+      pir::Operation* user = it->owner();
+      if (user->GetParent() != block_ || user->num_regions() > 0 ||
+          kEscapeOps.count(OpName(user))) {
+        last = -1;
+        break;
+      }
+      last = std::max(last, Index(user));
+      if (IsAliasOp(user)) {
+        for (auto result : user->results()) {
+          int64_t alias_last = LastUse(result);
+          if (alias_last < 0) {
+            last = -1;
+            break;
+          }
+          last = std::max(last, alias_last);
+        }
+      }
+    }
+    last_use_[value] = last;
+    return last;
+  }
+
+ private:
+  pir::Block* block_;
+  std::unordered_map<pir::Operation*, int64_t> op_index_;
+  std::unordered_map<pir::Value, int64_t> last_use_;
+};
+
+// Returns the aligned bytes of a static shape CPU tensor that can be planned,
+// or 0.
+int64_t PlannedBytes(pir::Value value) {
+  if (!value || !value.type() || !value.type().isa<TensorType>()) {
+    return 0;
+  }
+  auto persist_attr = value.attribute<pir::BoolAttribute>(kAttrIsPersistable);
+  if (persist_attr && persist_attr.data()) {
+    return 0;
+  }
+  auto type = value.type().dyn_cast<TensorType>();
+  if (!phi::is_cpu_place(type.place())) {
+    return 0;
+  }
+  int64_t numel = 1;
+  for (int i = 0; i < type.dims().size(); ++i) {
+    if (type.dims()[i] < 0) {
+      return 0;
+    }
+    numel *= type.dims()[i];
+  }
+  int64_t bytes =
+      numel * static_cast<int64_t>(phi::SizeOf(
+                  paddle::dialect::TransToPhiDataType(type.dtype())));
+  return (bytes + kMemoryPlanAlignment - 1) / kMemoryPlanAlignment *
+         kMemoryPlanAlignment;
+}
+
+// Greedy by size: the largest values are placed first, each in the smallest
+// gap left by the placed values it overlaps in time, or on top of them.
+int64_t AssignOffsets(std::vector<LiveRange>* ranges) {
+  std::vector<LiveRange*> order;
+  for (auto& range : *ranges) {
+    order.push_back(&range);
+  }
+  std::stable_sort(
+      order.begin(), order.end(), [](const LiveRange* a, const LiveRange* b) {
+        return a->size > b->size;
+      });
+
+  int64_t arena_size = 0;
+  std::vector<LiveRange*> placed;
+  for (LiveRange* range : order) {
+    std::vector<LiveRange*> overlapped;
+    for (LiveRange* other : placed) {
+      if (other->begin <= range->end && range->begin <= other->end) {
+        overlapped.push_back(other);
+      }
+    }
+    std::sort(overlapped.begin(),
+              overlapped.end(),
+              [](const LiveRange* a, const LiveRange* b) {
+                return a->offset < b->offset;
+              });
+    int64_t best_offset = -1;
+    int64_t best_gap = 0;
+    int64_t prev_end = 0;
+    for (LiveRange* other : overlapped) {
+      int64_t gap = other->offset - prev_end;
+      if (gap >= range->size && (best_offset < 0 || gap < best_gap)) {
+        best_offset = prev_end;
+        best_gap = gap;
+      }
+      prev_end = std::max(prev_end, other->offset + other->size);
+    }
+    range->offset = best_offset < 0 ? prev_end : best_offset;
+    arena_size = std::max(arena_size, range->offset + range->size);
+    placed.push_back(range);
+  }
+  return arena_size;
+}
+
+class MemoryPlanPass : public pir::Pass {
+ public:
+  MemoryPlanPass() : pir::Pass("memory_plan_pass", 3) {}
+
+  void Run(pir::Operation* op) override {
+    if (Has(pir::Pass::kPlaceAttr) &&
+        !phi::is_cpu_place(Get<phi::Place>(pir::Pass::kPlaceAttr))) {
+      return;
+    }
+    auto* block = &op->dyn_cast<pir::ModuleOp>().block();
+    LivenessAnalyzer analyzer(block);
+
+    std::vector<LiveRange> ranges;
+    for (auto& kernel_op : *block) {
+      if (!kernel_op.isa<paddle::dialect::PhiKernelOp>() &&
+          !kernel_op.isa<paddle::dialect::LegacyKernelOp>()) {
+        continue;
+      }
+      if (kNoPlanOps.count(OpName(&kernel_op)) || IsAliasOp(&kernel_op)) {
+        continue;
+      }
+      int64_t begin = analyzer.Index(&kernel_op);
+      for (auto result : kernel_op.results()) {
+        int64_t size = PlannedBytes(result);
+        if (size == 0) {
+          continue;
+        }
+        int64_t end = analyzer.LastUse(result);
+        if (end < 0) {
+          continue;
+        }
+        ranges.push_back({result, size, begin, std::max(begin, end), 0});
+      }
+    }
+    if (ranges.empty()) {
+      return;
+    }
+
+    int64_t arena_size = AssignOffsets(&ranges);
+    auto* ctx = pir::IrContext::Instance();
+    int64_t total_size = 0;
+    for (auto& range : ranges) {
+      range.value.set_attribute(
+          pir::kAttrMemoryOffset,
+          pir::Int64Attribute::get(ctx, range.offset));
+      total_size += range.size;
+    }
+    op->set_attribute(pir::kAttrMemoryArenaSize,
+                      pir::Int64Attribute::get(ctx, arena_size));
+    VLOG(4) << "Planned " << ranges.size() << " values of " << total_size
+            << " bytes into an arena of " << arena_size << " bytes.";
+    AddStatistics(static_cast<int64_t>(ranges.size()));
+  }
+
+  bool CanApplyOn(pir::Operation* op) const override {
+    return op->isa<pir::ModuleOp>() && op->num_regions() > 0;
+  }
+};
+
+}  // namespace
+
+namespace pir {
+
+std::unique_ptr<pir::Pass> CreateMemoryPlanPass() {
+  return std::make_unique<MemoryPlanPass>();
+}
+
+}  // namespace pir
+
+REGISTER_IR_PASS(memory_plan_pass, MemoryPlanPass);
@@ -0,0 +1,36 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include "paddle/pir/include/core/dll_decl.h"
+
+namespace pir {
+
+class Pass;
+
+// The byte offset of a value in the arena of the program.
+constexpr char kAttrMemoryOffset[] = "memory_offset";
+// The byte size of the arena, set on the module op.
+constexpr char kAttrMemoryArenaSize[] = "memory_arena_size";
+
+// Plans the memory of the static shape CPU tensors of a lowered program.
+// The live ranges of the values are computed from the op order of the top
+// block, and each value is given an offset into one arena such that values
+// live at the same time do not overlap. The interpreter binds the values to
+// slices of the arena, and runs the ops in program order.
+IR_API std::unique_ptr<Pass> CreateMemoryPlanPass();
+
+}  // namespace pir
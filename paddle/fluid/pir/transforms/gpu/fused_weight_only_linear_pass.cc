@@ -76,7 +76,7 @@ class FusedWeightOnlyLinearWithBiasPattern
     //
     // Constraints.
     //
-    src.AddConstraint([](const paddle::drr::MatchContext &match_ctx) -> bool {
+    src.AddConstraint([this](const paddle::drr::MatchContext &match_ctx) {
       if (!pir::ValueIsPersistable(match_ctx.Tensor("w"))) {
         return false;
       }
@@ -86,7 +86,8 @@ class FusedWeightOnlyLinearWithBiasPattern
 
       auto w_dtype = pir::GetDataTypeFromValue(match_ctx.Tensor("w"));
       if (!w_dtype.isa<pir::Float16Type>() &&
-          !w_dtype.isa<pir::BFloat16Type>()) {
+          !w_dtype.isa<pir::BFloat16Type>() &&
+          !(sm_version_ == 0 && w_dtype.isa<pir::Float32Type>())) {
         return false;
       }
 
@@ -108,7 +109,7 @@ class FusedWeightOnlyLinearWithBiasPattern
     //
     paddle::drr::ResultPattern res = src.ResultPattern();
 
-    if (algo_ == "weight_only_int4") {
+    if (algo_ == "weight_only_int4" && sm_version_ != 0) {
       // TODO(liuyuanle): When the operator weight_quantize supports
       // weight_only_int4 on gpu version, delete the memory copy.
       const auto &memcpy_d2h =
@@ -190,7 +191,7 @@ class FusedWeightOnlyLinearNoBiasPattern : public paddle::drr::DrrPatternBase {
     //
     // Constraints.
     //
-    src.AddConstraint([](const paddle::drr::MatchContext &match_ctx) -> bool {
+    src.AddConstraint([this](const paddle::drr::MatchContext &match_ctx) {
       if (!pir::ValueIsPersistable(match_ctx.Tensor("w"))) {
         return false;
       }
@@ -207,7 +208,9 @@ class FusedWeightOnlyLinearNoBiasPattern : public paddle::drr::DrrPatternBase {
       if (w_dims.at(0) % 64 != 0 || w_dims.at(1) % 16 != 0) return false;
 
       auto w_dtype = pir::GetDataTypeFromValue(match_ctx.Tensor("w"));
-      if (!w_dtype.isa<pir::Float16Type>() && !w_dtype.isa<pir::BFloat16Type>())
+      if (!w_dtype.isa<pir::Float16Type>() &&
+          !w_dtype.isa<pir::BFloat16Type>() &&
+          !(sm_version_ == 0 && w_dtype.isa<pir::Float32Type>()))
         return false;
 
       if (x_dims.at(x_dims.size() - 1) != w_dims.at(0)) return false;
@@ -219,7 +222,7 @@ class FusedWeightOnlyLinearNoBiasPattern : public paddle::drr::DrrPatternBase {
     //
     paddle::drr::ResultPattern res = src.ResultPattern();
 
-    if (algo_ == "weight_only_int4") {
+    if (algo_ == "weight_only_int4" && sm_version_ != 0) {
       // TODO(liuyuanle): When the operator weight_quantize supports
       // weight_only_int4 on gpu version, delete the memory copy.
       const auto &memcpy_d2h =
@@ -288,6 +291,13 @@ class FusedWeightOnlyLinearPass : public pir::PatternRewritePass {
                           "weight_only_int8 or weight_only_int4, but get %s.",
                           algo));
 
+    // Quantize the weights to the layout of the CPU kernel for CPU programs.
+    if (Has(pir::Pass::kPlaceAttr) &&
+        Get<phi::Place>(pir::Pass::kPlaceAttr).GetType() ==
+            phi::AllocationType::CPU) {
+      sm_version_ = 0;
+    }
+
     pir::RewritePatternSet ps(context);
     ps.Add(paddle::drr::Create<FusedWeightOnlyLinearWithBiasPattern>(
         context, true, algo, sm_version_));
@@ -310,8 +320,9 @@ class FusedWeightOnlyLinearPass : public pir::PatternRewritePass {
   }
 
   bool CanApplyOn(pir::Operation *op) const override {
-    if (sm_version_ != 70 && sm_version_ != 75 && sm_version_ != 80 &&
-        sm_version_ != 86 && sm_version_ != 89 && sm_version_ != 90) {
+    if (sm_version_ != 0 && sm_version_ != 70 && sm_version_ != 75 &&
+        sm_version_ != 80 && sm_version_ != 86 && sm_version_ != 89 &&
+        sm_version_ != 90) {
       return false;
     }
     return op->num_regions() > 0;
@@ -286,6 +286,11 @@ void BindDistributed(py::module *m) {
 
                 auto task = self.AllGather(out_dense, in_dense, sync_op);
                 auto *dev_ctx = self.GetDeviceContext(in_tensor.place());
+                if (dev_ctx->GetPlace() == phi::CPUPlace()) {
+                  // cpu collectives may run on a comm thread, the output
+                  // must be ready before it is split on the host
+                  task->Wait();
+                }
                 SplitTensor(*dev_ctx, *out_dense, &out_tensor_list);
                 task->UpdateWaitChain(*dev_ctx);
                 return task;
@@ -575,6 +580,11 @@ void BindDistributed(py::module *m) {
                     out_dense, in_dense, gather_opts, sync_op, use_calc_stream);
                 auto *dev_ctx =
                     self.GetDeviceContext(in_tensor.place(), use_calc_stream);
+                if (dev_ctx->GetPlace() == phi::CPUPlace()) {
+                  // cpu collectives may run on a comm thread, the output
+                  // must be ready before it is split on the host
+                  task->Wait();
+                }
                 SplitTensor(*dev_ctx, *out_dense, &out_tensor_list);
                 if (!use_calc_stream &&
                     dev_ctx->GetPlace() != phi::CPUPlace()) {
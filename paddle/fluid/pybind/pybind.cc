@@ -1528,8 +1528,10 @@ PYBIND11_MODULE(libpaddle, m) {
   // plugins are loaded for custom kernels, but de-initialized AFTER they are
   // unloaded. We need manually clear symbols(may contain plugins' symbols)
   // stored in this static instance to avoid illegal memory access.
-  m.def("clear_kernel_factory",
-        []() { phi::KernelFactory::Instance().kernels().clear(); });
+  m.def("clear_kernel_factory", []() {
+    phi::KernelFactory::Instance().kernels().clear();
+    phi::KernelFactory::Instance().IncreaseVersion();
+  });
   m.def("clear_device_manager", []() {
 #ifdef PADDLE_WITH_CUSTOM_DEVICE
     platform::XCCLCommContext::Release();
@@ -103,6 +103,12 @@ TEST_API void DeviceContextPool::SetDeviceContexts(
   external_device_contexts_ = dev_ctxs;
 }
 
+TEST_API const
+    std::map<Place, std::shared_future<std::unique_ptr<DeviceContext>>>*
+    DeviceContextPool::GetExternalDeviceContexts() {
+  return external_device_contexts_;
+}
+
 DeviceContextPool::DeviceContextPool(const std::vector<phi::Place>& places) {
   phi::memory_utils::EmplaceDeviceContexts(
       &device_contexts_,
@@ -106,6 +106,12 @@ class DeviceContextPool {
       const std::map<Place,
                      std::shared_future<std::unique_ptr<DeviceContext>>>*);
 
+  // The device contexts set by SetDeviceContexts on the thread, or nullptr.
+  TEST_API static const std::map<
+      Place,
+      std::shared_future<std::unique_ptr<DeviceContext>>>*
+  GetExternalDeviceContexts();
+
  private:
   explicit DeviceContextPool(const std::vector<phi::Place>& places);
 
@@ -51,6 +51,7 @@ struct CPUContext::Impl {
   bool owned_{false};
   Eigen::DefaultDevice* eigen_device_{nullptr};
   Place place_;
+  int num_threads_{0};
 };
 
 CPUContext::CPUContext()
@@ -75,6 +76,19 @@ Eigen::DefaultDevice* CPUContext::eigen_device() const {
 
 const Place& CPUContext::GetPlace() const { return impl_->place_; }
 
+void CPUContext::SetNumThreads(int num_threads) {
+  PADDLE_ENFORCE_GE(
+      num_threads,
+      0,
+      common::errors::InvalidArgument(
+          "The number of threads of CPUContext should be non-negative, but "
+          "received %d.",
+          num_threads));
+  impl_->num_threads_ = num_threads;
+}
+
+int CPUContext::GetNumThreads() const { return impl_->num_threads_; }
+
 void CPUContext::SetEigenDevice(Eigen::DefaultDevice* device) {
   impl_->eigen_device_ = device;
 }
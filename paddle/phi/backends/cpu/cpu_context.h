@@ -35,6 +35,12 @@ class PADDLE_API CPUContext : public DeviceContext,
   Eigen::DefaultDevice* eigen_device() const;
   const Place& GetPlace() const override;
 
+  // Upper bound of the threads used by ParallelFor/ParallelReduce of the
+  // kernels running on this context, 0 (the default) means no bound other
+  // than the OpenMP threads of the calling thread.
+  void SetNumThreads(int num_threads);
+  int GetNumThreads() const;
+
   static const char* name() { return "CPUContext"; }
 
  protected:
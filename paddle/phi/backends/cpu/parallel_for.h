@@ -0,0 +1,152 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#ifdef PADDLE_WITH_MKLML
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+
+namespace phi {
+
+// Loops with fewer iterations than the grain size are not split, it is about
+// the amount of elementwise work which pays for waking up a thread.
+constexpr int64_t kParallelGrainSize = 32768;
+
+// Returns the number of threads ParallelFor uses for `range` iterations: at
+// most the thread budget of dev_ctx and the OpenMP threads of the calling
+// thread (i.e. cpu_math_library_num_threads of a predictor), and 1 when
+// called from a parallel region.
+inline int GetParallelNumThreads(const CPUContext& dev_ctx,
+                                 int64_t range,
+                                 int64_t grain_size) {
+#ifdef PADDLE_WITH_MKLML
+  if (range <= 0 || omp_in_parallel()) {
+    return 1;
+  }
+  int64_t num_threads = omp_get_max_threads();
+  if (dev_ctx.GetNumThreads() > 0) {
+    num_threads = std::min<int64_t>(num_threads, dev_ctx.GetNumThreads());
+  }
+  grain_size = std::max<int64_t>(grain_size, 1);
+  num_threads = std::min(num_threads, (range + grain_size - 1) / grain_size);
+  return static_cast<int>(std::max<int64_t>(num_threads, 1));
+#else
+  return 1;
+#endif
+}
+
+namespace detail {
+
+// Calls f(thread_id) from num_threads threads and rethrows the first
+// exception thrown by f, e.g. by PADDLE_ENFORCE, in the calling thread.
+template <typename F>
+void ParallelRun(int num_threads, const F& f) {
+  if (num_threads <= 1) {
+    f(0);
+    return;
+  }
+#ifdef PADDLE_WITH_MKLML
+  std::exception_ptr eptr = nullptr;
+#pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+  for (int tid = 0; tid < num_threads; ++tid) {
+    try {
+      f(tid);
+    } catch (...) {
+#pragma omp critical(phi_parallel_run)
+      if (!eptr) {
+        eptr = std::current_exception();
+      }
+    }
+  }
+  if (eptr) {
+    std::rethrow_exception(eptr);
+  }
+#else
+  for (int tid = 0; tid < num_threads; ++tid) {
+    f(tid);
+  }
+#endif
+}
+
+}  // namespace detail
+
+// Calls f(chunk_begin, chunk_end) on disjoint chunks covering [begin, end),
+// each of at least grain_size iterations unless the whole range is smaller.
+template <typename F>
+void ParallelFor(const CPUContext& dev_ctx,
+                 int64_t begin,
+                 int64_t end,
+                 int64_t grain_size,
+                 const F& f) {
+  if (begin >= end) {
+    return;
+  }
+  int64_t range = end - begin;
+  int num_threads = GetParallelNumThreads(dev_ctx, range, grain_size);
+  if (num_threads == 1) {
+    f(begin, end);
+    return;
+  }
+  detail::ParallelRun(num_threads, [&](int tid) {
+    int64_t chunk_begin = begin + range * tid / num_threads;
+    int64_t chunk_end = begin + range * (tid + 1) / num_threads;
+    if (chunk_begin < chunk_end) {
+      f(chunk_begin, chunk_end);
+    }
+  });
+}
+
+// Computes f(chunk_begin, chunk_end, ident) on chunks of [begin, end) like
+// ParallelFor and combines the partial results with reduce in chunk order, so
+// the result only depends on the number of threads.
+template <typename T, typename F, typename R>
+T ParallelReduce(const CPUContext& dev_ctx,
+                 int64_t begin,
+                 int64_t end,
+                 int64_t grain_size,
+                 const T& ident,
+                 const F& f,
+                 const R& reduce) {
+  if (begin >= end) {
+    return ident;
+  }
+  int64_t range = end - begin;
+  int num_threads = GetParallelNumThreads(dev_ctx, range, grain_size);
+  if (num_threads == 1) {
+    return f(begin, end, ident);
+  }
+  std::vector<T> partials(num_threads, ident);
+  detail::ParallelRun(num_threads, [&](int tid) {
+    int64_t chunk_begin = begin + range * tid / num_threads;
+    int64_t chunk_end = begin + range * (tid + 1) / num_threads;
+    if (chunk_begin < chunk_end) {
+      partials[tid] = f(chunk_begin, chunk_end, ident);
+    }
+  });
+  T result = ident;
+  for (auto& partial : partials) {
+    result = reduce(result, partial);
+  }
+  return result;
+}
+
+}  // namespace phi
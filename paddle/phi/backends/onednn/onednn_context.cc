@@ -83,6 +83,41 @@ void OneDNNContextThreadLocals::Body::log_lib_version() {
   }
 }
 
+void OneDNNInstructionCache::Bind(uint64_t shape_key) {
+  auto it = entries_.begin();
+  while (it != entries_.end() && it->first != shape_key) {
+    ++it;
+  }
+  if (it == entries_.end()) {
+    if (entries_.size() >= capacity_) {
+      VLOG(3) << "OneDNNInstructionCache drops the blobs of shape key "
+              << entries_.back().first;
+      entries_.pop_back();
+    }
+    entries_.emplace_front(shape_key, Blobs());
+  } else if (it != entries_.begin()) {
+    entries_.splice(entries_.begin(), entries_, it);
+  }
+  blobs_ = &entries_.front().second;
+}
+
+OneDNNInstructionCacheGuard::OneDNNInstructionCacheGuard(
+    OneDNNInstructionCache* cache, uint64_t shape_key)
+    : prev_cache_(OneDNNContext::tls().get_instruction_cache()) {
+  if (OneDNNContext::tls().get_cur_mkldnn_session_id() ==
+      OneDNNContextThreadLocals::kMKLDNNSessionID_CacheClearing) {
+    cache = nullptr;
+  }
+  if (cache != nullptr) {
+    cache->Bind(shape_key);
+  }
+  OneDNNContext::tls().set_instruction_cache(cache);
+}
+
+OneDNNInstructionCacheGuard::~OneDNNInstructionCacheGuard() {
+  OneDNNContext::tls().set_instruction_cache(prev_cache_);
+}
+
 OneDNNContextThreadLocals::Body& OneDNNContextThreadLocals::fetch() {
   thread_local Body b;
   return b;
@@ -422,6 +457,31 @@ OneDNNContext::BlobPtr_t<void> OneDNNContext::GetBlob(
   return impl_->GetBlob(name);
 }
 
+void OneDNNContext::SetBlob(const OneDNNBlobKey& key,
+                            BlobPtr_t<void> data) const {
+  OneDNNInstructionCache* cache = tls().get_instruction_cache();
+  if (cache != nullptr) {
+    cache->SetBlob(key.hash(), data);
+  }
+  impl_->SetBlob(key.name(), data);
+}
+
+OneDNNContext::BlobPtr_t<void> OneDNNContext::GetBlob(
+    const OneDNNBlobKey& key) const {
+  OneDNNInstructionCache* cache = tls().get_instruction_cache();
+  if (cache != nullptr) {
+    auto data = cache->GetBlob(key.hash());
+    if (likely(data != nullptr)) {
+      return data;
+    }
+  }
+  auto data = impl_->GetBlob(key.name());
+  if (cache != nullptr && data != nullptr) {
+    cache->SetBlob(key.hash(), data);
+  }
+  return data;
+}
+
 bool OneDNNContext::HasDnnAttr(const std::string& attr_name) const {
   return impl_->HasDnnAttr(attr_name);
 }
@@ -14,19 +14,119 @@ limitations under the License. */
 
 #pragma once
 #ifdef PADDLE_WITH_DNNL
+#include <array>
+#include <cstdint>
+#include <list>
 #include <memory>
-#include <mutex>     // NOLINT
+#include <mutex>  // NOLINT
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
 #include "dnnl.hpp"  // NOLINT
 #include "paddle/common/layout.h"
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/core/attribute.h"
+#include "paddle/phi/core/enforce.h"
 #include "paddle/utils/test_macros.h"
 
 namespace phi {
 
 using TensorNameMap = std::map<std::string, std::vector<std::string>>;
 
+// The key of a blob cached by a oneDNN handler: the base key of the handler
+// followed by up to kMaxSuffixes suffixes, e.g. "@fwd_pd". Its 64-bit hash
+// is the FNV-1a hash of the whole name, extended suffix by suffix, so the
+// handler hashes its base key once and a lookup of an instruction cache
+// builds no string. The name is only built for the BlobMap. The base key
+// and the suffixes are referenced and must outlive the key.
+class OneDNNBlobKey {
+ public:
+  static constexpr size_t kMaxSuffixes = 3;
+  static constexpr uint64_t kHashSeed = 14695981039346656037ULL;
+
+  explicit OneDNNBlobKey(const std::string& base)
+      : OneDNNBlobKey(base, HashBytes(kHashSeed, base.data(), base.size())) {}
+
+  // base_hash must be the hash of base, as a handler keeps it.
+  OneDNNBlobKey(const std::string& base, uint64_t base_hash)
+      : base_(&base), hash_(base_hash) {}
+
+  OneDNNBlobKey With(std::string_view suffix) const {
+    PADDLE_ENFORCE_LT(num_suffixes_,
+                      kMaxSuffixes,
+                      common::errors::OutOfRange(
+                          "OneDNNBlobKey %s has %d suffixes already.",
+                          name(),
+                          kMaxSuffixes));
+    OneDNNBlobKey key(*this);
+    key.suffixes_[key.num_suffixes_++] = suffix;
+    key.hash_ = HashBytes(hash_, suffix.data(), suffix.size());
+    return key;
+  }
+
+  uint64_t hash() const { return hash_; }
+
+  // The name of the blob in the BlobMap
+  std::string name() const {
+    std::string name = *base_;
+    for (size_t i = 0; i < num_suffixes_; ++i) {
+      name.append(suffixes_[i].data(), suffixes_[i].size());
+    }
+    return name;
+  }
+
+  static uint64_t HashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+      hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+  }
+
+ private:
+  const std::string* base_;
+  std::array<std::string_view, kMaxSuffixes> suffixes_{};
+  size_t num_suffixes_ = 0;
+  uint64_t hash_;
+};
+
+// The blobs cached on an instruction of the new executor, in one entry for
+// each input shapes the instruction has run with. While the instruction runs,
+// the cache is set in the thread locals, and OneDNNContext looks up the blobs
+// of a OneDNNBlobKey in it first, without the lock and the BlobMap. The
+// blobs are still set to the BlobMap too, since some are shared between
+// instructions, e.g. the forward primitive descriptor of a grad kernel.
+// An instruction runs on one thread at a time, so the cache is not locked.
+class OneDNNInstructionCache {
+ public:
+  using Blobs = std::unordered_map<uint64_t, std::shared_ptr<void>>;
+
+  explicit OneDNNInstructionCache(size_t capacity = 8) : capacity_(capacity) {}
+
+  // Selects the entry of shape_key, and drops the least recently used entry
+  // if the cache is full.
+  TEST_API void Bind(uint64_t shape_key);
+
+  std::shared_ptr<void> GetBlob(uint64_t key) const {
+    auto it = blobs_->find(key);
+    return it == blobs_->end() ? nullptr : it->second;
+  }
+
+  void SetBlob(uint64_t key, std::shared_ptr<void> data) {
+    (*blobs_)[key] = std::move(data);
+  }
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  size_t capacity_;
+  // The most recently used entry first
+  std::list<std::pair<uint64_t, Blobs>> entries_;
+  Blobs* blobs_ = nullptr;
+};
+
 class OneDNNContextThreadLocals {
   // default onednn session id
 
@@ -50,6 +150,8 @@ class OneDNNContextThreadLocals {
     std::string key_suffix;  // Key identifying current Executor
     bool key_attach_thread_id = true;
     void* exec_ptr_ = nullptr;
+    // Cache of the running instruction, nullptr out of the new executor
+    OneDNNInstructionCache* instruction_cache_ = nullptr;
 
     Body();
     ~Body();
@@ -68,6 +170,12 @@ class OneDNNContextThreadLocals {
     bool is_tid_used_in_key(void) const { return key_attach_thread_id; }
     void set_curr_exec(void* exec_ptr) { exec_ptr_ = exec_ptr; }
     void* get_curr_exec(void) const { return exec_ptr_; }
+    void set_instruction_cache(OneDNNInstructionCache* cache) {
+      instruction_cache_ = cache;
+    }
+    OneDNNInstructionCache* get_instruction_cache(void) const {
+      return instruction_cache_;
+    }
   };
   OneDNNContextThreadLocals() = default;
   OneDNNContextThreadLocals(const OneDNNContextThreadLocals& c) = delete;
@@ -131,6 +239,12 @@ class OneDNNContext : public CPUContext {
   // Find a saved blob. Return nullptr if not found
   std::shared_ptr<void> GetBlob(const std::string& name) const;
 
+  // Same as above, but looks up the cache of the running instruction first,
+  // and fills it from the BlobMap on a miss.
+  TEST_API void SetBlob(const OneDNNBlobKey& key,
+                        std::shared_ptr<void> data) const;
+  TEST_API std::shared_ptr<void> GetBlob(const OneDNNBlobKey& key) const;
+
   static auto tls() -> decltype(OneDNNContextThreadLocals::fetch()) {
     return OneDNNContextThreadLocals::fetch();
   }
@@ -162,5 +276,18 @@ class OneDNNContext : public CPUContext {
   std::unique_ptr<Impl> impl_;
 };
 
+// Sets the cache of an instruction in the thread locals, bound to the entry
+// of shape_key, for the lifetime of the guard. In the cache clearing mode
+// the BlobMap bounds the cached shapes, so no instruction cache is set.
+class OneDNNInstructionCacheGuard {
+ public:
+  TEST_API OneDNNInstructionCacheGuard(OneDNNInstructionCache* cache,
+                                       uint64_t shape_key);
+  TEST_API ~OneDNNInstructionCacheGuard();
+
+ private:
+  OneDNNInstructionCache* prev_cache_;
+};
+
 }  // namespace phi
 #endif
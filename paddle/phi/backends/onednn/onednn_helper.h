@@ -227,6 +227,31 @@ inline std::string CreateKey(const OneDNNContext& dev_ctx UNUSED,
   return key;
 }
 
+// The key of the input shapes of an instruction, which selects the entry of
+// its OneDNNInstructionCache. The input shape string of the thread locals is
+// hashed too, as it partitions the BlobMap.
+inline uint64_t CreateInputShapeKey(
+    const std::vector<const DenseTensor*>& inputs) {
+  const std::string& shape_str = OneDNNContext::tls().cur_input_shape_str;
+  uint64_t key = OneDNNBlobKey::HashBytes(
+      OneDNNBlobKey::kHashSeed, shape_str.data(), shape_str.size());
+  for (const DenseTensor* input : inputs) {
+    int64_t meta[3] = {-1, -1, -1};
+    if (input != nullptr) {
+      const DDim& dims = input->dims();
+      meta[0] = dims.size();
+      meta[1] = static_cast<int64_t>(input->layout());
+      meta[2] = static_cast<int64_t>(input->dtype());
+      if (dims.size() > 0) {
+        key = OneDNNBlobKey::HashBytes(
+            key, dims.Get(), dims.size() * sizeof(int64_t));
+      }
+    }
+    key = OneDNNBlobKey::HashBytes(key, meta, sizeof(meta));
+  }
+  return key;
+}
+
 // The function adjusts the vector of weight dimensions for group convolutions
 inline void GetGroupConvWeightsTz(std::vector<int64_t>& weights_tz,  // NOLINT
                                   const int groups) {
@@ -18,6 +18,7 @@ limitations under the License. */
 #include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -151,13 +152,14 @@ class OneDNNHandlerT {
         place_(cpu_place),
         key_common_(base_key),
         key_(ExtendKeyWithThreadInfoIfNeeded(dev_ctx, base_key)),
+        key_hash_(OneDNNBlobKey(key_).hash()),
         fwd_pd_(nullptr),
         bwd_pd_(nullptr) {
     OneDNNContext::tls().log_lib_version();
   }
 
   std::shared_ptr<TForward> AcquireForwardPrimitive() {
-    const std::string key_p = key_ + "@fwd_p";
+    const auto key_p = BlobKey("@fwd_p");
     auto forward_p =
         std::static_pointer_cast<TForward>(dev_ctx_.GetBlob(key_p));
     if (forward_p == nullptr) {
@@ -168,7 +170,7 @@ class OneDNNHandlerT {
   }
 
   std::shared_ptr<TBackward> AcquireBackwardPrimitive() {
-    const std::string key_p = key_ + "@bwd_p";
+    const auto key_p = BlobKey("@bwd_p");
     auto backward_p =
         std::static_pointer_cast<TBackward>(dev_ctx_.GetBlob(key_p));
     if (backward_p == nullptr) {
@@ -179,7 +181,7 @@ class OneDNNHandlerT {
   }
 
   std::shared_ptr<TBackward_params> AcquireBackwardWeightsPrimitive() {
-    const std::string key_p = key_ + "@bwd_w_p";
+    const auto key_p = BlobKey("@bwd_w_p");
     auto backward_p =
         std::static_pointer_cast<TBackward_params>(dev_ctx_.GetBlob(key_p));
     if (backward_p == nullptr) {
@@ -187,7 +189,7 @@ class OneDNNHandlerT {
           bwd_w_pd_,
           errors::Unavailable("BWD_PD should be set when "
                               "getting BWD prim witk key: %s .",
-                              key_p));
+                              key_p.name()));
       backward_p = std::make_shared<TBackward_params>(*bwd_w_pd_);
       dev_ctx_.SetBlob(key_p, backward_p);
     }
@@ -259,8 +261,12 @@ class OneDNNHandlerT {
   }
 
  protected:
+  OneDNNBlobKey BlobKey(std::string_view suffix) const {
+    return OneDNNBlobKey(key_, key_hash_).With(suffix);
+  }
+
   bool isCached() {
-    const std::string key_pd = key_ + "@fwd_pd";
+    const auto key_pd = BlobKey("@fwd_pd");
     fwd_pd_ = std::static_pointer_cast<typename TForward::primitive_desc>(
         dev_ctx_.GetBlob(key_pd));
 
@@ -268,7 +274,7 @@ class OneDNNHandlerT {
   }
 
   bool isBwdCached() {
-    const std::string key_pd = key_ + "@bwd_pd";
+    const auto key_pd = BlobKey("@bwd_pd");
     bwd_pd_ = std::static_pointer_cast<typename TBackward::primitive_desc>(
         dev_ctx_.GetBlob(key_pd));
 
@@ -277,14 +283,14 @@ class OneDNNHandlerT {
     } else {
       if (std::is_same<TBackward_params, onednn_dummy_primitive>::value ==
           false) {
-        const std::string key_bw_w_pd = key_ + "@bwd_w_pd";
+        const auto key_bw_w_pd = BlobKey("@bwd_w_pd");
         bwd_w_pd_ =
             std::static_pointer_cast<typename TBackward_params::primitive_desc>(
                 dev_ctx_.GetBlob(key_bw_w_pd));
       }
 
       // When BWD is cached then still we need to Get FWD PD
-      const std::string key_fpd = key_ + "@fwd_pd";
+      const auto key_fpd = BlobKey("@fwd_pd");
       fwd_pd_ = std::static_pointer_cast<typename TForward::primitive_desc>(
           dev_ctx_.GetBlob(key_fpd));
       PADDLE_ENFORCE_NOT_NULL(
@@ -303,7 +309,7 @@ class OneDNNHandlerT {
   void AcquireForwardPrimitiveDescriptor(Arg&& first_arg, Args&&... args) {
     // This is used when we can recreate FWD PD in BWD so
     // we do not need to pass FWD to BWD
-    const std::string key_pd = key_ + "@fwd_pd";
+    const auto key_pd = BlobKey("@fwd_pd");
     fwd_pd_ = std::static_pointer_cast<typename TForward::primitive_desc>(
         dev_ctx_.GetBlob(key_pd));
     if (fwd_pd_ == nullptr) {
@@ -338,7 +344,7 @@ class OneDNNHandlerT {
         fwd_pd_,
         errors::Unavailable("Get OneDNN Forward primitive %s failed.",
                             key_ + "@fwd_pd"));
-    const std::string key_pd = key_ + "@bwd_pd";
+    const auto key_pd = BlobKey("@bwd_pd");
     bwd_pd_ = std::static_pointer_cast<typename TBackward::primitive_desc>(
         dev_ctx_.GetBlob(key_pd));
     if (bwd_pd_ == nullptr) {
@@ -356,7 +362,7 @@ class OneDNNHandlerT {
         fwd_pd_,
         errors::Unavailable("Get OneDNN Forward primitive %s failed.",
                             key_ + "@fwd_pd"));
-    const std::string key_pd = key_ + "@bwd_w_pd";
+    const auto key_pd = BlobKey("@bwd_w_pd");
     bwd_w_pd_ =
         std::static_pointer_cast<typename TBackward_params::primitive_desc>(
             dev_ctx_.GetBlob(key_pd));
@@ -370,12 +376,12 @@ class OneDNNHandlerT {
   std::shared_ptr<dnnl::memory> AcquireMemoryFromPrimitive(
       const std::string& suffix) {
     return std::static_pointer_cast<dnnl::memory>(
-        dev_ctx_.GetBlob(key_ + suffix));
+        dev_ctx_.GetBlob(BlobKey(suffix)));
   }
 
   std::shared_ptr<dnnl::memory> AcquireMemoryFromPrimitive(
       dnnl::memory::desc md, void* ptr, const std::string& suffix) {
-    const auto local_key = key_ + suffix;
+    const auto local_key = BlobKey(suffix);
     auto mem_p =
         std::static_pointer_cast<dnnl::memory>(dev_ctx_.GetBlob(local_key));
     if (mem_p == nullptr) {
@@ -389,7 +395,7 @@ class OneDNNHandlerT {
 
   std::shared_ptr<dnnl::memory> AcquireMemoryFromPrimitive(
       dnnl::memory::desc md, const std::string& suffix) {
-    const auto local_key = key_ + suffix;
+    const auto local_key = BlobKey(suffix);
     auto mem_p =
         std::static_pointer_cast<dnnl::memory>(dev_ctx_.GetBlob(local_key));
     if (mem_p == nullptr) {
@@ -422,9 +428,9 @@ class OneDNNHandlerT {
       std::function<std::shared_ptr<F>(const F*)> custom_reorder_func = {},
       const std::vector<float>& scale_data = {1.0f},
       int mask = 0) {
-    const auto target_key = key_ + suffix + "_target";
-    const auto key_reorder_p = key_ + suffix + "reorder_p";
-    const auto user_key = key_ + suffix + "_user";
+    const auto target_key = BlobKey(suffix).With("_target");
+    const auto key_reorder_p = BlobKey(suffix).With("reorder_p");
+    const auto user_key = BlobKey(suffix).With("_user");
 
     auto target_memory_p =
         std::static_pointer_cast<dnnl::memory>(dev_ctx_.GetBlob(target_key));
@@ -433,7 +439,8 @@ class OneDNNHandlerT {
       if (custom_reorder_func) {
         auto reordered_data =
             custom_reorder_func(reinterpret_cast<const F*>(ptr));
-        dev_ctx_.SetBlob(key_reorder_p + "-custom_reorder", reordered_data);
+        dev_ctx_.SetBlob(key_reorder_p.With("-custom_reorder"),
+                         reordered_data);
         ptr = reinterpret_cast<void*>(reordered_data.get());
       }
       auto user_memory_p =
@@ -498,13 +505,13 @@ class OneDNNHandlerT {
   }
 
   std::shared_ptr<dnnl::memory> AcquireMemory(const std::string& suffix) {
-    const auto local_key = key_ + suffix;
+    const auto local_key = BlobKey(suffix);
     return std::static_pointer_cast<dnnl::memory>(dev_ctx_.GetBlob(local_key));
   }
 
   void CacheMemory(const std::string& suffix,
                    const std::shared_ptr<dnnl::memory>& mem_p) {
-    const auto local_key = key_ + suffix;
+    const auto local_key = BlobKey(suffix);
     dev_ctx_.SetBlob(local_key, mem_p);
     return;
   }
@@ -514,6 +521,8 @@ class OneDNNHandlerT {
   Place place_;
   std::string key_common_;
   std::string key_;
+  // The hash of key_, which the blob keys of the handler extend
+  uint64_t key_hash_;
   std::shared_ptr<typename TForward::primitive_desc> fwd_pd_;
   std::shared_ptr<typename TBackward::primitive_desc> bwd_pd_;
   std::shared_ptr<typename TBackward_params::primitive_desc> bwd_w_pd_;
@@ -15,6 +15,7 @@
 #include "paddle/phi/core/custom_kernel.h"
 
 #include "glog/logging.h"
+#include "paddle/phi/core/scope_guard.h"
 
 namespace phi {
 
@@ -40,6 +41,10 @@ void CustomKernelMap::RegisterCustomKernels() {
     return;
   }
   auto& kernels = KernelFactory::Instance().kernels();
+  // The cached kernel selections are dropped even if a kernel fails to be
+  // registered after the others are added.
+  DEFINE_PADDLE_SCOPE_GUARD(
+      [] { KernelFactory::Instance().IncreaseVersion(); });
   for (auto& pair : kernels_) {
     for (auto& info_pair : pair.second) {
       PADDLE_ENFORCE_EQ(
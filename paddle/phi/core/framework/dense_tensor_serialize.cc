@@ -14,6 +14,7 @@
 
 #include "paddle/phi/core/framework/dense_tensor_serialize.h"
 #include <cstdint>
+#include <cstring>
 #include "paddle/phi/core/framework/convert_utils.h"
 
 namespace phi {
@@ -127,4 +128,118 @@ void DeserializeFromStream(std::istream &is,
   TensorFromStream(is, static_cast<phi::DenseTensor *>(tensor), dev_ctx);
 }
 
+#ifndef _WIN32
+namespace {
+
+using paddle::memory::allocation::MappedFileAllocation;
+
+void CheckMappedRange(const MappedFileAllocation &file,
+                      size_t offset,
+                      size_t size) {
+  PADDLE_ENFORCE_EQ(
+      offset <= file.size() && size <= file.size() - offset,
+      true,
+      common::errors::Unavailable(
+          "Deserialize from file %s failed, %d bytes at offset %d are out of "
+          "the file of %d bytes, please check whether the model file is "
+          "complete or damaged.",
+          file.file_name(),
+          size,
+          offset,
+          file.size()));
+}
+
+template <typename T>
+T ReadMappedValue(const MappedFileAllocation &file, size_t *offset) {
+  CheckMappedRange(file, *offset, sizeof(T));
+  T value;
+  std::memcpy(
+      &value, static_cast<const char *>(file.ptr()) + *offset, sizeof(T));
+  *offset += sizeof(T);
+  return value;
+}
+
+}  // namespace
+
+void DeserializeFromMappedFile(
+    const std::shared_ptr<MappedFileAllocation> &file,
+    size_t *offset,
+    phi::DenseTensor *tensor) {
+  const char *base = static_cast<const char *>(file->ptr());
+  {
+    // the 1st field, unit32_t version for DenseTensor
+    uint32_t version = ReadMappedValue<uint32_t>(*file, offset);
+    PADDLE_ENFORCE_EQ(
+        version,
+        0U,
+        common::errors::InvalidArgument(
+            "Deserialize to tensor failed, maybe the loaded file is "
+            "not a paddle model(expected file format: 0, but %u found).",
+            version));
+  }
+  phi::LegacyLoD lod;
+  {
+    // the 2st field, LoD information
+    uint64_t lod_level = ReadMappedValue<uint64_t>(*file, offset);
+    lod.resize(lod_level);
+    for (uint64_t i = 0; i < lod_level; ++i) {
+      uint64_t size = ReadMappedValue<uint64_t>(*file, offset);
+      CheckMappedRange(*file, *offset, size);
+      lod[i].resize(size / sizeof(size_t));
+      std::memcpy(lod[i].data(), base + *offset, size);
+      *offset += size;
+    }
+  }
+  // the 3st field, Tensor
+  uint32_t version = ReadMappedValue<uint32_t>(*file, offset);
+  PADDLE_ENFORCE_EQ(
+      version,
+      0U,
+      common::errors::InvalidArgument(
+          "tensor version %u is not supported, Only version 0 is supported",
+          version));
+  proto::VarType::TensorDesc desc;
+  {
+    int32_t size = ReadMappedValue<int32_t>(*file, offset);
+    PADDLE_ENFORCE_GE(size,
+                      0,
+                      common::errors::InvalidArgument(
+                          "phi::DenseTensor desc size should >= 0"));
+    CheckMappedRange(*file, *offset, size);
+    PADDLE_ENFORCE_EQ(
+        desc.ParseFromArray(base + *offset, size),
+        true,
+        common::errors::InvalidArgument("Cannot parse tensor desc"));
+    *offset += size;
+  }
+  std::vector<int64_t> dims(desc.dims().begin(), desc.dims().end());
+  phi::DataType dtype = phi::TransToPhiDataType(desc.data_type());
+  PADDLE_ENFORCE_EQ(
+      dtype != phi::DataType::UNDEFINED && dtype != phi::DataType::PSTRING,
+      true,
+      common::errors::Unimplemented(
+          "Data type %d is not supported when deserializing from a mapped "
+          "file.",
+          static_cast<int>(desc.data_type())));
+  phi::DenseTensorMeta meta(dtype, common::make_ddim(dims));
+  size_t size = meta.dims.numel() * phi::SizeOf(dtype);
+  CheckMappedRange(*file, *offset, size);
+  if (size > 0 &&
+      reinterpret_cast<uintptr_t>(base + *offset) % phi::SizeOf(dtype) == 0) {
+    auto holder =
+        std::make_shared<paddle::memory::allocation::MappedFileSliceAllocation>(
+            file, *offset, size);
+    *tensor = phi::DenseTensor(holder, meta);
+  } else {
+    tensor->Resize(meta.dims);
+    void *buf = tensor->mutable_data(phi::CPUPlace(), dtype);
+    if (size > 0) {
+      std::memcpy(buf, base + *offset, size);
+    }
+  }
+  tensor->set_lod(lod);
+  *offset += size;
+}
+#endif
+
 }  // namespace phi
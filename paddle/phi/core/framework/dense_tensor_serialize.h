@@ -24,6 +24,7 @@
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/enforce.h"
 #include "paddle/phi/core/framework/dense_tensor_tostream.h"
+#include "paddle/phi/core/memory/allocation/mmap_allocator.h"
 #include "paddle/phi/core/mixed_vector.h"
 #include "paddle/utils/test_macros.h"
 
@@ -50,4 +51,18 @@ void SerializeToStream(std::ostream& os, const phi::DenseTensor& tensor);
 
 void DeserializeFromStream(std::istream& os, phi::DenseTensor* tensor);
 
+#ifndef _WIN32
+/*
+ * Deserialize the phi::DenseTensor written by SerializeToStream at *offset of
+ * a mapped file and advance *offset past it. The CPU tensor aliases the
+ * mapped pages when its data is aligned to the element size in the file,
+ * otherwise the data is copied.
+ */
+void DeserializeFromMappedFile(
+    const std::shared_ptr<paddle::memory::allocation::MappedFileAllocation>&
+        file,
+    size_t* offset,
+    phi::DenseTensor* tensor);
+#endif
+
 }  // namespace phi
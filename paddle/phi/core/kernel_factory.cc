@@ -14,6 +14,8 @@
 
 #include "paddle/phi/core/kernel_factory.h"
 
+#include <algorithm>
+
 #include "glog/logging.h"
 #include "paddle/common/flags.h"
 #include "paddle/phi/core/enforce.h"
@@ -408,6 +410,46 @@ KernelResult KernelFactory::SelectKernelOrThrowError(
   return {kernel_iter->second, false, false};
 }
 
+KernelResult KernelSelectionCache::Select(const KernelKey& kernel_key,
+                                          bool use_strided_kernel) {
+#if defined(PADDLE_WITH_XPU)
+  // The selection of XPU kernels also depends on the op lists of XPU.
+  return KernelFactory::Instance().SelectKernelOrThrowError(
+      kernel_name_, kernel_key, use_strided_kernel);
+#else
+  auto& kernel_factory = KernelFactory::Instance();
+  const uint64_t version = kernel_factory.version();
+  if (version != version_) {
+    version_ = version;
+    size_ = 0;
+    next_ = 0;
+  }
+  const bool strided = use_strided_kernel && FLAGS_use_stride_kernel;
+  const bool enable_fallback = FLAGS_enable_api_kernel_fallback;
+  for (size_t i = 0; i < size_; ++i) {
+    const Entry& entry = entries_[i];
+    if (entry.kernel_key == kernel_key &&
+        entry.use_strided_kernel == strided &&
+        entry.enable_fallback == enable_fallback) {
+      return {*entry.kernel, entry.has_fallback_cpu, entry.is_stride_kernel};
+    }
+  }
+
+  KernelResult result = kernel_factory.SelectKernelOrThrowError(
+      kernel_name_, kernel_key, use_strided_kernel);
+  Entry& entry = entries_[next_];
+  entry.kernel_key = kernel_key;
+  entry.use_strided_kernel = strided;
+  entry.enable_fallback = enable_fallback;
+  entry.kernel = &result.kernel;
+  entry.has_fallback_cpu = result.has_fallback_cpu;
+  entry.is_stride_kernel = result.is_stride_kernel;
+  next_ = (next_ + 1) % kCapacity;
+  size_ = std::min(size_ + 1, kCapacity);
+  return result;
+#endif
+}
+
 const KernelArgsDef& KernelFactory::GetFirstKernelArgsDef(
     const std::string& kernel_name) const {
   auto iter = kernels_.find(kernel_name);
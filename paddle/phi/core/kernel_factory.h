@@ -14,8 +14,11 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <map>
 #include <ostream>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include "paddle/common/layout.h"
@@ -348,15 +351,65 @@ class KernelFactory {
 
   void ClearLowPrecisionKernelList() { low_precision_kernels_.clear(); }
 
+  // The version of kernels(), which must be increased after kernels are added
+  // to or removed from it, so that KernelSelectionCache drops the Kernel
+  // references it holds.
+  uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+  void IncreaseVersion() { version_.fetch_add(1, std::memory_order_acq_rel); }
+
  private:
   KernelFactory() = default;
 
   KernelNameMap kernels_;
 
+  std::atomic<uint64_t> version_{0};
+
   // Get the low precision kernel list of current module.
   std::map<const std::string, OpCount> low_precision_kernels_;
 };
 
+/**
+ * Inline cache of KernelFactory::SelectKernelOrThrowError for a call site,
+ * such as a generated API, which keeps a thread local instance:
+ *
+ *   static thread_local phi::KernelSelectionCache cache("scale");
+ *   auto kernel_result = cache.Select(kernel_key, true);
+ *
+ * It keeps the results of the last few kernel keys, so that the common call
+ * skips the lookups of the kernel name and the kernel key. The results are
+ * dropped when KernelFactory::version() changes, e.g. after custom kernels
+ * are registered.
+ */
+class KernelSelectionCache {
+ public:
+  explicit KernelSelectionCache(const char* kernel_name)
+      : kernel_name_(kernel_name) {}
+
+  KernelResult Select(const KernelKey& kernel_key,
+                      bool use_strided_kernel = false);
+
+ private:
+  struct Entry {
+    KernelKey kernel_key;
+    // The selection also depends on these flags.
+    bool use_strided_kernel = false;
+    bool enable_fallback = false;
+    const Kernel* kernel = nullptr;
+    bool has_fallback_cpu = false;
+    bool is_stride_kernel = false;
+  };
+
+  static constexpr size_t kCapacity = 4;
+
+  const std::string kernel_name_;
+  uint64_t version_ = 0;
+  std::array<Entry, kCapacity> entries_;
+  size_t size_ = 0;
+  // The entry to be replaced by the next miss when the cache is full.
+  size_t next_ = 0;
+};
+
 inline std::ostream& operator<<(std::ostream& os, const KernelKey& kernel_key) {
   os << "(" << kernel_key.backend() << ", " << kernel_key.layout() << ", "
      << kernel_key.dtype() << ")";
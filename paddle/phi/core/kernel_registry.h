@@ -146,6 +146,7 @@ struct KernelRegistrar {
     args_def_fn(kernel_key, &kernel);
     if (reg_type == RegType::INNER) {
       KernelFactory::Instance().kernels()[kernel_name][kernel_key] = kernel;
+      KernelFactory::Instance().IncreaseVersion();
     } else {
       CustomKernelMap::Instance().RegisterCustomKernel(
           kernel_name, kernel_key, kernel);
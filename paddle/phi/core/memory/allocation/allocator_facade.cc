@@ -25,6 +25,7 @@
 #include "paddle/phi/core/memory/allocation/auto_growth_best_fit_allocator_v2.h"
 #include "paddle/phi/core/memory/allocation/cpu_allocator.h"
 #include "paddle/phi/core/memory/allocation/naive_best_fit_allocator.h"
+#include "paddle/phi/core/memory/allocation/pooled_cpu_allocator.h"
 #include "paddle/phi/core/memory/allocation/retry_allocator.h"
 #include "paddle/phi/core/memory/allocation/stat_allocator.h"
 #include "paddle/phi/core/platform/device_context.h"
@@ -111,6 +112,35 @@ PHI_DEFINE_EXPORTED_bool(
     "Whether to use AutoGrowthBestFitAllocatorV2 for auto_growth "
     "strategy");
 
+// NOTE: The pooled CPU allocator is a bool instead of a value of
+// FLAGS_allocator_strategy. The strategy selects the allocators of all the
+// places, and most of the device code requires auto_growth, while the pooled
+// allocator only replaces the one of CPUPlace. As a flag of its own it works
+// with any strategy, e.g. auto_growth on GPU with the pooled CPU allocator.
+PHI_DEFINE_EXPORTED_bool(
+    use_pooled_cpu_allocator,
+    false,
+    "Whether to use PooledCPUAllocator for CPUPlace, which caches freed "
+    "memory in size-class bins with per-thread caches instead of returning "
+    "it to the system. It works with any FLAGS_allocator_strategy. Not "
+    "available on Windows.");
+
+PHI_DEFINE_EXPORTED_bool(pooled_cpu_allocator_numa_aware,
+                         true,
+                         "Whether PooledCPUAllocator keeps one pool per NUMA "
+                         "node and binds the memory of a pool to its node.");
+
+PHI_DEFINE_EXPORTED_bool(pooled_cpu_allocator_use_huge_page,
+                         false,
+                         "Whether PooledCPUAllocator advises its memory to be "
+                         "backed by transparent huge pages.");
+
+PHI_DEFINE_EXPORTED_uint64(
+    pooled_cpu_allocator_max_idle_mb,
+    1024,
+    "The free memory in MB PooledCPUAllocator keeps before it returns the "
+    "free slabs and large blocks to the system. 0 means no limit.");
+
 COMMON_DECLARE_string(allocator_strategy);
 COMMON_DECLARE_uint64(auto_growth_chunk_size_in_mb);
 COMMON_DECLARE_bool(use_auto_growth_pinned_allocator);
@@ -830,6 +860,15 @@ class AllocatorFacadePrivate {
     allocators_[phi::CPUPlace()] =
         std::make_shared<NaiveBestFitAllocator>(phi::CPUPlace());
 #else
+#ifndef _WIN32
+    if (FLAGS_use_pooled_cpu_allocator) {
+      allocators_[phi::CPUPlace()] = std::make_shared<PooledCPUAllocator>(
+          FLAGS_pooled_cpu_allocator_numa_aware,
+          FLAGS_pooled_cpu_allocator_use_huge_page,
+          FLAGS_pooled_cpu_allocator_max_idle_mb << 20);
+      return;
+    }
+#endif
     allocators_[phi::CPUPlace()] = std::make_shared<CPUAllocator>();
 #endif
   }
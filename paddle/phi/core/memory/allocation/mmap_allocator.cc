@@ -18,6 +18,8 @@
 
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <cstdlib>
 
 #include <atomic>
@@ -323,6 +325,46 @@ std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
   return std::make_shared<MemoryMapReaderAllocation>(ptr, size, ipc_name);
 }
 
+MappedFileAllocation::~MappedFileAllocation() {
+  if (munmap(this->ptr(), this->size()) == -1) {
+    LOG(WARNING) << "Could not unmap the file " << file_name_;
+  }
+  VLOG(3) << "~MappedFileAllocation: " << file_name_;
+}
+
+std::shared_ptr<MappedFileAllocation> AllocateMappedFileAllocation(
+    const std::string &file_name) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  PADDLE_ENFORCE_NE(
+      fd,
+      -1,
+      common::errors::Unavailable("Failed to open file %s to map it, please "
+                                  "check whether the file exists.",
+                                  file_name));
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == -1) {
+    close(fd);
+    PADDLE_THROW(common::errors::Unavailable(
+        "Failed to get the size of file %s.", file_name));
+  }
+  size_t size = static_cast<size_t>(file_stat.st_size);
+  if (size == 0) {
+    close(fd);
+    PADDLE_THROW(common::errors::Unavailable(
+        "Failed to map file %s, the file is empty.", file_name));
+  }
+  // Written pages are copied on write, so that the tensors aliasing the file
+  // can still be modified in place, e.g. by the fuse passes of inference.
+  void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  PADDLE_ENFORCE_NE(
+      ptr,
+      MAP_FAILED,
+      common::errors::Unavailable("Memory map failed for file %s.", file_name));
+  VLOG(4) << "Map file " << file_name << " of " << size << " bytes";
+  return std::make_shared<MappedFileAllocation>(ptr, size, file_name);
+}
+
 MemoryMapFdSet &MemoryMapFdSet::Instance() {  // NOLINT
   static MemoryMapFdSet set;
   return set;
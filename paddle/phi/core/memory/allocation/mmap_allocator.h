@@ -154,6 +154,41 @@ std::shared_ptr<MemoryMapWriterAllocation> AllocateMemoryMapWriterAllocation(
 std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
     const std::string &ipc_name, size_t size);
 
+// MappedFileAllocation maps a whole regular file, e.g. a params file, with
+// MAP_PRIVATE. Its pages are shared with the page cache, and so with the other
+// processes mapping the same file, until they are written.
+class MappedFileAllocation : public Allocation {
+ public:
+  explicit MappedFileAllocation(void *ptr, size_t size, std::string file_name)
+      : Allocation(ptr, size, phi::CPUPlace()),
+        file_name_(std::move(file_name)) {}
+
+  inline const std::string &file_name() const { return file_name_; }
+
+  ~MappedFileAllocation() override;
+
+ private:
+  std::string file_name_;
+};
+
+// A range of a MappedFileAllocation, which keeps the whole mapping alive.
+class MappedFileSliceAllocation : public Allocation {
+ public:
+  explicit MappedFileSliceAllocation(std::shared_ptr<MappedFileAllocation> file,
+                                     size_t offset,
+                                     size_t size)
+      : Allocation(static_cast<char *>(file->ptr()) + offset,
+                   size,
+                   phi::CPUPlace()),
+        file_(std::move(file)) {}
+
+ private:
+  std::shared_ptr<MappedFileAllocation> file_;
+};
+
+std::shared_ptr<MappedFileAllocation> AllocateMappedFileAllocation(
+    const std::string &file_name);
+
 class MemoryMapFdSet {
  public:
   static MemoryMapFdSet &Instance();  // NOLINT
@@ -0,0 +1,573 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _WIN32
+
+#include "paddle/phi/core/memory/allocation/pooled_cpu_allocator.h"
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <fstream>
+#include <mutex>  // NOLINT
+#include <string>
+
+#include "glog/logging.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/memory/stats.h"
+
+namespace paddle::memory::allocation {
+
+namespace {
+
+// Size classes:
+//  - (0, 1KB]: multiples of 64B, 16 classes.
+//  - (2^(n-1), 2^n] for n in [11, kMaxPooledLog2]: 4 classes each, spaced by
+//    2^(n-3), so the internal fragmentation is at most 25%.
+// Requests larger than 2^kMaxPooledLog2 are mapped and unmapped directly.
+constexpr size_t kSmallClassLimit = 1024;
+constexpr size_t kNumSmallClasses = kSmallClassLimit / 64;
+constexpr int kMinGeometricLog2 = 11;
+constexpr int kMaxPooledLog2 = 32;
+constexpr size_t kNumClasses =
+    kNumSmallClasses + (kMaxPooledLog2 - kMinGeometricLog2 + 1) * 4;
+
+constexpr size_t kPageSize = 4096;
+// Blocks not larger than kMaxSlabBlockSize are carved from kSlabSize slabs and
+// can be kept in thread caches.
+constexpr size_t kSlabSize = 2UL << 20;
+constexpr size_t kMaxSlabBlockSize = 256UL << 10;
+constexpr size_t kThreadCacheBytesPerClass = 512UL << 10;
+constexpr size_t kMaxThreadCacheBlocks = 64;
+
+inline int Log2Ceil(size_t value) {
+  return 64 - __builtin_clzll(static_cast<uint64_t>(value - 1));
+}
+
+inline size_t AlignUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+inline size_t ThreadCacheCapacity(size_t class_size) {
+  return std::min(kMaxThreadCacheBlocks,
+                  std::max<size_t>(1, kThreadCacheBytesPerClass / class_size));
+}
+
+// Return the number of NUMA nodes, and fill cpu_to_node with the node of each
+// cpu. Fall back to a single node if sysfs is not available.
+int ReadCpuToNode(std::vector<int>* cpu_to_node) {
+  cpu_to_node->clear();
+  int num_nodes = 0;
+#ifdef __linux__
+  for (int node = 0;; ++node) {
+    std::ifstream fin("/sys/devices/system/node/node" + std::to_string(node) +
+                      "/cpulist");
+    if (!fin.is_open()) {
+      break;
+    }
+    ++num_nodes;
+    std::string cpulist;
+    std::getline(fin, cpulist);
+    // cpulist looks like "0-3,8-11"
+    size_t pos = 0;
+    while (pos < cpulist.size()) {
+      size_t end = cpulist.find(',', pos);
+      if (end == std::string::npos) {
+        end = cpulist.size();
+      }
+      std::string range = cpulist.substr(pos, end - pos);
+      pos = end + 1;
+      if (range.empty()) {
+        continue;
+      }
+      size_t dash = range.find('-');
+      int first = std::stoi(range.substr(0, dash));
+      int last =
+          dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      if (static_cast<int>(cpu_to_node->size()) <= last) {
+        cpu_to_node->resize(last + 1, 0);
+      }
+      for (int cpu = first; cpu <= last; ++cpu) {
+        (*cpu_to_node)[cpu] = node;
+      }
+    }
+  }
+#endif
+  return std::max(num_nodes, 1);
+}
+
+}  // namespace
+
+class PooledCPUAllocation : public Allocation {
+ public:
+  PooledCPUAllocation(void* ptr, size_t size, size_t class_index, int node)
+      : Allocation(ptr, size, phi::CPUPlace()),
+        class_index_(class_index),
+        node_(node) {}
+
+  size_t ClassIndex() const { return class_index_; }
+  int Node() const { return node_; }
+
+ private:
+  size_t class_index_;
+  int node_;
+};
+
+struct PooledCPUAllocator::Pool
+    : public std::enable_shared_from_this<PooledCPUAllocator::Pool> {
+  struct FreeList {
+    SpinLock lock;
+    std::vector<void*> blocks;
+  };
+
+  struct Slab {
+    size_t class_index;
+    size_t num_blocks;
+  };
+
+  // Cache of free small blocks of the current thread. A thread only caches
+  // blocks for one pool, which is the CPU pool of AllocatorFacade in practice.
+  struct ThreadCache {
+    std::shared_ptr<Pool> pool;
+    int node{0};
+    std::vector<void*> blocks[kNumClasses];
+
+    ~ThreadCache() { Reset(); }
+
+    void Reset() {
+      if (pool) {
+        pool->Flush(this);
+        pool.reset();
+      }
+    }
+  };
+
+  Pool(bool numa_aware, bool use_huge_page, size_t max_idle_bytes)
+      : numa_aware_(numa_aware),
+        use_huge_page_(use_huge_page),
+        max_idle_bytes_(max_idle_bytes),
+        trim_at_(max_idle_bytes) {
+    num_nodes_ = numa_aware_ ? ReadCpuToNode(&cpu_to_node_) : 1;
+    free_lists_.resize(num_nodes_);
+    for (auto& lists : free_lists_) {
+      lists.reset(new FreeList[kNumClasses]);
+    }
+    VLOG(1) << "PooledCPUAllocator: numa_aware " << numa_aware_
+            << ", num_nodes " << num_nodes_ << ", use_huge_page "
+            << use_huge_page_ << ", max_idle_bytes " << max_idle_bytes_;
+  }
+
+  ~Pool() {
+    for (int node = 0; node < num_nodes_; ++node) {
+      for (size_t idx = 0; idx < kNumClasses; ++idx) {
+        size_t class_size = SizeClassSize(idx);
+        if (class_size <= kMaxSlabBlockSize) {
+          continue;
+        }
+        for (void* ptr : free_lists_[node][idx].blocks) {
+          UnmapMemory(ptr, AlignUp(class_size, kPageSize));
+        }
+      }
+    }
+    for (auto& pair : slabs_) {
+      UnmapMemory(reinterpret_cast<void*>(pair.first), kSlabSize);
+    }
+  }
+
+  int CurrentNode() const {
+    if (num_nodes_ == 1) {
+      return 0;
+    }
+#ifdef __linux__
+    int cpu = sched_getcpu();
+    if (cpu >= 0 && cpu < static_cast<int>(cpu_to_node_.size())) {
+      return cpu_to_node_[cpu];
+    }
+#endif
+    return 0;
+  }
+
+  ThreadCache* GetThreadCache() {
+    static thread_local ThreadCache cache;
+    if (cache.pool.get() == this) {
+      return &cache;
+    }
+    // The allocator owning the cache has been destroyed, take the cache over.
+    if (cache.pool && cache.pool.use_count() == 1) {
+      cache.Reset();
+    }
+    if (!cache.pool) {
+      cache.pool = shared_from_this();
+      cache.node = CurrentNode();
+      return &cache;
+    }
+    return nullptr;
+  }
+
+  void* MapMemory(size_t size, size_t alignment, int node) {
+    size_t map_size = alignment > kPageSize ? size + alignment : size;
+    void* ptr = mmap(nullptr,
+                     map_size,
+                     PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS,
+                     -1,
+                     0);
+    PADDLE_ENFORCE_NE(ptr,
+                      MAP_FAILED,
+                      common::errors::ResourceExhausted(
+                          "Fail to map memory of %ld size, error code is %d.",
+                          map_size,
+                          errno));
+    if (map_size != size) {
+      uintptr_t begin = reinterpret_cast<uintptr_t>(ptr);
+      uintptr_t aligned = AlignUp(begin, alignment);
+      if (aligned != begin) {
+        munmap(ptr, aligned - begin);
+      }
+      size_t tail = begin + map_size - (aligned + size);
+      if (tail != 0) {
+        munmap(reinterpret_cast<void*>(aligned + size), tail);
+      }
+      ptr = reinterpret_cast<void*>(aligned);
+    }
+#ifdef MADV_HUGEPAGE
+    if (use_huge_page_ && size >= kSlabSize) {
+      madvise(ptr, size, MADV_HUGEPAGE);
+    }
+#endif
+#if defined(__linux__) && defined(SYS_mbind)
+    if (num_nodes_ > 1 && node < 64) {
+      // MPOL_PREFERRED, so that memory can still come from other nodes when
+      // the node is exhausted.
+      constexpr int kMpolPreferred = 1;
+      uint64_t node_mask = 1UL << node;
+      if (syscall(SYS_mbind,
+                  ptr,
+                  size,
+                  kMpolPreferred,
+                  &node_mask,
+                  sizeof(node_mask) * 8 + 1,
+                  0) != 0) {
+        VLOG(3) << "mbind to node " << node << " failed, errno " << errno;
+      }
+    }
+#endif
+    HOST_MEMORY_STAT_UPDATE(Reserved, 0, size);
+    return ptr;
+  }
+
+  void UnmapMemory(void* ptr, size_t size) {
+    munmap(ptr, size);
+    HOST_MEMORY_STAT_UPDATE(Reserved, 0, -size);
+  }
+
+  // Map a new slab for the class, and return its blocks.
+  void NewSlab(size_t class_index, int node, std::vector<void*>* blocks) {
+    size_t class_size = SizeClassSize(class_index);
+    size_t num_blocks = kSlabSize / class_size;
+    char* base = static_cast<char*>(MapMemory(kSlabSize, kSlabSize, node));
+    {
+      std::lock_guard<std::mutex> guard(slab_mutex_);
+      slabs_[reinterpret_cast<uintptr_t>(base)] = Slab{class_index, num_blocks};
+    }
+    // Reversed, so that blocks are handed out in address order.
+    for (size_t i = num_blocks; i > 0; --i) {
+      blocks->push_back(base + (i - 1) * class_size);
+    }
+  }
+
+  void* Allocate(size_t class_index, int* node) {
+    size_t class_size = SizeClassSize(class_index);
+    if (class_size <= kMaxSlabBlockSize) {
+      ThreadCache* cache = GetThreadCache();
+      if (cache != nullptr) {
+        *node = cache->node;
+        auto& cached = cache->blocks[class_index];
+        if (cached.empty()) {
+          Refill(class_index, cache->node, &cached);
+        }
+        void* ptr = cached.back();
+        cached.pop_back();
+        return ptr;
+      }
+    }
+
+    *node = CurrentNode();
+    FreeList& list = free_lists_[*node][class_index];
+    {
+      std::lock_guard<SpinLock> guard(list.lock);
+      if (!list.blocks.empty()) {
+        void* ptr = list.blocks.back();
+        list.blocks.pop_back();
+        idle_bytes_ -= class_size;
+        return ptr;
+      }
+    }
+    if (class_size > kMaxSlabBlockSize) {
+      return MapMemory(AlignUp(class_size, kPageSize), kPageSize, *node);
+    }
+    std::vector<void*> blocks;
+    NewSlab(class_index, *node, &blocks);
+    void* ptr = blocks.back();
+    blocks.pop_back();
+    std::lock_guard<SpinLock> guard(list.lock);
+    list.blocks.insert(list.blocks.end(), blocks.begin(), blocks.end());
+    idle_bytes_ += blocks.size() * class_size;
+    return ptr;
+  }
+
+  // Move half of the thread cache capacity from the free list (or a new slab)
+  // to the thread cache.
+  void Refill(size_t class_index, int node, std::vector<void*>* cached) {
+    size_t class_size = SizeClassSize(class_index);
+    size_t batch = (ThreadCacheCapacity(class_size) + 1) / 2;
+    FreeList& list = free_lists_[node][class_index];
+    {
+      std::lock_guard<SpinLock> guard(list.lock);
+      size_t n = std::min(batch, list.blocks.size());
+      cached->insert(cached->end(), list.blocks.end() - n, list.blocks.end());
+      list.blocks.resize(list.blocks.size() - n);
+      idle_bytes_ -= n * class_size;
+    }
+    if (!cached->empty()) {
+      return;
+    }
+    std::vector<void*> blocks;
+    NewSlab(class_index, node, &blocks);
+    size_t n = std::min(batch, blocks.size());
+    cached->insert(cached->end(), blocks.end() - n, blocks.end());
+    blocks.resize(blocks.size() - n);
+    if (!blocks.empty()) {
+      std::lock_guard<SpinLock> guard(list.lock);
+      list.blocks.insert(list.blocks.end(), blocks.begin(), blocks.end());
+      idle_bytes_ += blocks.size() * class_size;
+    }
+  }
+
+  void Free(void* ptr, size_t class_index, int node) {
+    size_t class_size = SizeClassSize(class_index);
+    if (class_size <= kMaxSlabBlockSize) {
+      ThreadCache* cache = GetThreadCache();
+      if (cache != nullptr && cache->node == node) {
+        auto& cached = cache->blocks[class_index];
+        cached.push_back(ptr);
+        size_t capacity = ThreadCacheCapacity(class_size);
+        if (cached.size() > capacity) {
+          size_t n = cached.size() - capacity / 2;
+          FreeList& list = free_lists_[node][class_index];
+          {
+            std::lock_guard<SpinLock> guard(list.lock);
+            list.blocks.insert(
+                list.blocks.end(), cached.begin(), cached.begin() + n);
+            idle_bytes_ += n * class_size;
+          }
+          cached.erase(cached.begin(), cached.begin() + n);
+          MaybeTrim();
+        }
+        return;
+      }
+    } else if (max_idle_bytes_ != 0 &&
+               idle_bytes_ + class_size > max_idle_bytes_) {
+      // The pool is full, so the large block is not kept.
+      UnmapMemory(ptr, AlignUp(class_size, kPageSize));
+      return;
+    }
+    FreeList& list = free_lists_[node][class_index];
+    {
+      std::lock_guard<SpinLock> guard(list.lock);
+      list.blocks.push_back(ptr);
+      idle_bytes_ += class_size;
+    }
+    MaybeTrim();
+  }
+
+  // Releases the free memory once the free lists have grown by
+  // max_idle_bytes since the last trimming. What is still idle after the
+  // release is held by partly used slabs, and is not trimmed again until
+  // the free lists grow by max_idle_bytes more.
+  void MaybeTrim() {
+    if (max_idle_bytes_ == 0 || idle_bytes_ <= trim_at_) {
+      return;
+    }
+    std::unique_lock<std::mutex> lock(trim_mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      return;
+    }
+    Release();
+    trim_at_ = idle_bytes_ + max_idle_bytes_;
+  }
+
+  // Return all blocks of the thread cache to the free lists.
+  void Flush(ThreadCache* cache) {
+    for (size_t idx = 0; idx < kNumClasses; ++idx) {
+      auto& cached = cache->blocks[idx];
+      if (cached.empty()) {
+        continue;
+      }
+      FreeList& list = free_lists_[cache->node][idx];
+      std::lock_guard<SpinLock> guard(list.lock);
+      list.blocks.insert(list.blocks.end(), cached.begin(), cached.end());
+      idle_bytes_ += cached.size() * SizeClassSize(idx);
+      cached.clear();
+    }
+  }
+
+  uint64_t Release() {
+    ThreadCache* cache = GetThreadCache();
+    if (cache != nullptr) {
+      Flush(cache);
+    }
+
+    uint64_t released = 0;
+    std::vector<std::pair<void*, size_t>> to_unmap;
+    for (int node = 0; node < num_nodes_; ++node) {
+      for (size_t idx = 0; idx < kNumClasses; ++idx) {
+        size_t class_size = SizeClassSize(idx);
+        FreeList& list = free_lists_[node][idx];
+        std::lock_guard<SpinLock> guard(list.lock);
+        if (list.blocks.empty()) {
+          continue;
+        }
+        if (class_size > kMaxSlabBlockSize) {
+          for (void* ptr : list.blocks) {
+            to_unmap.emplace_back(ptr, AlignUp(class_size, kPageSize));
+          }
+          idle_bytes_ -= list.blocks.size() * class_size;
+          list.blocks.clear();
+          continue;
+        }
+        // A slab can be unmapped once all of its blocks are free here.
+        std::unordered_map<uintptr_t, size_t> free_count;
+        for (void* ptr : list.blocks) {
+          ++free_count[reinterpret_cast<uintptr_t>(ptr) & ~(kSlabSize - 1)];
+        }
+        std::lock_guard<std::mutex> slab_guard(slab_mutex_);
+        size_t num_released_slabs = 0;
+        for (auto& pair : free_count) {
+          auto it = slabs_.find(pair.first);
+          if (it != slabs_.end() && it->second.num_blocks == pair.second) {
+            to_unmap.emplace_back(reinterpret_cast<void*>(pair.first),
+                                  kSlabSize);
+            slabs_.erase(it);
+            pair.second = 0;  // mark as released
+            ++num_released_slabs;
+          }
+        }
+        if (num_released_slabs == 0) {
+          continue;
+        }
+        auto end = std::remove_if(
+            list.blocks.begin(), list.blocks.end(), [&free_count](void* ptr) {
+              return free_count[reinterpret_cast<uintptr_t>(ptr) &
+                                ~(kSlabSize - 1)] == 0;
+            });
+        idle_bytes_ -= (list.blocks.end() - end) * class_size;
+        list.blocks.erase(end, list.blocks.end());
+      }
+    }
+
+    for (auto& pair : to_unmap) {
+      UnmapMemory(pair.first, pair.second);
+      released += pair.second;
+    }
+    VLOG(4) << "PooledCPUAllocator released " << released << " bytes";
+    return released;
+  }
+
+  bool numa_aware_;
+  bool use_huge_page_;
+  size_t max_idle_bytes_;
+  std::atomic<size_t> idle_bytes_{0};
+  std::atomic<size_t> trim_at_;
+  std::mutex trim_mutex_;
+  int num_nodes_{1};
+  std::vector<int> cpu_to_node_;
+  // free_lists_[node][class_index]
+  std::vector<std::unique_ptr<FreeList[]>> free_lists_;
+  // slab base address -> slab, slabs are aligned to kSlabSize.
+  std::unordered_map<uintptr_t, Slab> slabs_;
+  std::mutex slab_mutex_;
+};
+
+size_t PooledCPUAllocator::SizeClassIndex(size_t size) {
+  if (size <= kSmallClassLimit) {
+    return size == 0 ? 0 : (size + 63) / 64 - 1;
+  }
+  int lg = Log2Ceil(size);
+  if (lg > kMaxPooledLog2) {
+    return kNumClasses;
+  }
+  size_t step = 1UL << (lg - 3);
+  size_t sub = (size - (1UL << (lg - 1)) + step - 1) / step;
+  return kNumSmallClasses + (lg - kMinGeometricLog2) * 4 + sub - 1;
+}
+
+size_t PooledCPUAllocator::SizeClassSize(size_t index) {
+  if (index < kNumSmallClasses) {
+    return (index + 1) * 64;
+  }
+  int lg = kMinGeometricLog2 + static_cast<int>((index - kNumSmallClasses) / 4);
+  size_t sub = (index - kNumSmallClasses) % 4 + 1;
+  return (1UL << (lg - 1)) + sub * (1UL << (lg - 3));
+}
+
+PooledCPUAllocator::PooledCPUAllocator(bool numa_aware,
+                                       bool use_huge_page,
+                                       size_t max_idle_bytes)
+    : pool_(std::make_shared<Pool>(
+          numa_aware, use_huge_page, max_idle_bytes)) {}
+
+size_t PooledCPUAllocator::IdleBytes() const { return pool_->idle_bytes_; }
+
+PooledCPUAllocator::~PooledCPUAllocator() = default;
+
+phi::Allocation* PooledCPUAllocator::AllocateImpl(size_t size) {
+  size_t class_index = SizeClassIndex(size);
+  if (class_index == kNumClasses) {
+    size_t map_size = AlignUp(size, kPageSize);
+    void* ptr = pool_->MapMemory(map_size, kPageSize, pool_->CurrentNode());
+    return new PooledCPUAllocation(ptr, map_size, class_index, -1);
+  }
+  int node = 0;
+  void* ptr = pool_->Allocate(class_index, &node);
+  return new PooledCPUAllocation(
+      ptr, SizeClassSize(class_index), class_index, node);
+}
+
+void PooledCPUAllocator::FreeImpl(phi::Allocation* allocation) {
+  auto* pooled_allocation = static_cast<PooledCPUAllocation*>(allocation);
+  if (pooled_allocation->ClassIndex() == kNumClasses) {
+    pool_->UnmapMemory(pooled_allocation->ptr(), pooled_allocation->size());
+  } else {
+    pool_->Free(pooled_allocation->ptr(),
+                pooled_allocation->ClassIndex(),
+                pooled_allocation->Node());
+  }
+  delete allocation;
+}
+
+uint64_t PooledCPUAllocator::ReleaseImpl(const phi::Place& place) {
+  return pool_->Release();
+}
+
+}  // namespace paddle::memory::allocation
+
+#endif
@@ -0,0 +1,84 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#ifndef _WIN32
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/phi/core/memory/allocation/allocator.h"
+#include "paddle/phi/core/memory/allocation/spin_lock.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// PooledCPUAllocator is an auto growth pool for CPUPlace. Requests are rounded
+// up to a size class, and freed blocks are kept in per-class free lists
+// instead of being returned to the system, so that the steady state does not
+// go through malloc or touch fresh pages.
+//
+// - Blocks of small classes are carved from 2MB slabs, larger blocks are
+//   mapped individually.
+// - Each thread keeps a small cache of free small blocks, so that most
+//   allocations do not take any lock.
+// - When numa_aware is set, there is one pool per NUMA node, and memory of a
+//   pool is bound to its node. A thread allocates from the pool of the node
+//   it is running on.
+// - When use_huge_page is set, slabs and large blocks are advised to be
+//   backed by transparent huge pages.
+//
+// Release() returns to the system the large blocks and the fully free slabs
+// which are not held by any thread cache. When max_idle_bytes is not 0, the
+// free lists are trimmed the same way once they hold more than
+// max_idle_bytes of releasable memory, and a freed large block is unmapped
+// directly if keeping it would exceed max_idle_bytes, so that the memory of
+// the size classes no longer used does not stay reserved.
+class PooledCPUAllocator : public Allocator {
+ public:
+  static constexpr size_t kAlignment = 64;
+
+  PooledCPUAllocator(bool numa_aware,
+                     bool use_huge_page,
+                     size_t max_idle_bytes = 0);
+
+  ~PooledCPUAllocator() override;
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // Exposed for unittests.
+  static size_t SizeClassIndex(size_t size);
+  static size_t SizeClassSize(size_t index);
+  // The bytes of the blocks in the free lists, not counting thread caches.
+  size_t IdleBytes() const;
+
+  struct Pool;
+
+ protected:
+  phi::Allocation* AllocateImpl(size_t size) override;
+  void FreeImpl(phi::Allocation* allocation) override;
+  uint64_t ReleaseImpl(const phi::Place& place) override;
+
+ private:
+  std::shared_ptr<Pool> pool_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
+
+#endif
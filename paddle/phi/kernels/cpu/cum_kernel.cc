@@ -15,6 +15,7 @@
 #include "paddle/phi/kernels/cum_kernel.h"
 
 #include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/backends/cpu/parallel_for.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/funcs/eigen/common.h"
 #include "paddle/phi/kernels/funcs/eigen/eigen_function.h"
@@ -116,25 +117,41 @@ void ScanKernel(const Context& dev_ctx,
                  reducer);
     }
   } else {
-    if (post == 1) {
-      ComputeImp(place,
-                 Eigen::DSizes<IndexT, 2>(pre, mid),
-                 x0,
-                 out0,
-                 /* axis= */ 1,
-                 reverse,
-                 exclusive,
-                 reducer);
-    } else {
-      ComputeImp(place,
-                 Eigen::DSizes<IndexT, 3>(pre, mid, post),
-                 x0,
-                 out0,
-                 /* axis= */ 1,
-                 reverse,
-                 exclusive,
-                 reducer);
-    }
+    // the pre rows are scanned independently, split them over the threads
+    const T* x_data = x.data<T>();
+    T* out_data = out->data<T>();
+    const int64_t row_size = static_cast<int64_t>(mid) * post;
+    ParallelFor(
+        dev_ctx,
+        0,
+        pre,
+        kParallelGrainSize / std::max<int64_t>(row_size, 1) + 1,
+        [&](int64_t begin, int64_t end) {
+          IndexT rows = end - begin;
+          typename EigenVector<T>::ConstType x_rows(x_data + begin * row_size,
+                                                    rows * row_size);
+          typename EigenVector<T>::Type out_rows(out_data + begin * row_size,
+                                                 rows * row_size);
+          if (post == 1) {
+            ComputeImp(place,
+                       Eigen::DSizes<IndexT, 2>(rows, mid),
+                       x_rows,
+                       out_rows,
+                       /* axis= */ 1,
+                       reverse,
+                       exclusive,
+                       reducer);
+          } else {
+            ComputeImp(place,
+                       Eigen::DSizes<IndexT, 3>(rows, mid, post),
+                       x_rows,
+                       out_rows,
+                       /* axis= */ 1,
+                       reverse,
+                       exclusive,
+                       reducer);
+          }
+        });
   }
 }
 
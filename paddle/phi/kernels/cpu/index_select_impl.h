@@ -16,6 +16,7 @@
 
 #include "glog/logging.h"
 
+#include "paddle/phi/backends/cpu/parallel_for.h"
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/tensor_utils.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
@@ -108,6 +109,35 @@ void IndexSelectInner(const Context& ctx,
   VLOG(3) << "Index_Select_Debug; outer_nums: " << outer_nums
           << "; slice_size: " << slice_size << "; index_size: " << index_size;
 
+  if constexpr (std::is_same<Context, CPUContext>::value) {
+    // copy the selected slices of all outer rows in parallel
+    if (output->numel() == 0) {
+      return;
+    }
+    const T* input_data = input->data<T>();
+    T* output_data = output->data<T>();
+    const int64_t dim_size = input_dim[dim];
+    const int64_t row_num = static_cast<int64_t>(outer_nums) * index_size;
+    ParallelFor(ctx,
+                0,
+                row_num,
+                kParallelGrainSize / std::max(slice_size, 1) + 1,
+                [&](int64_t begin, int64_t end) {
+                  for (int64_t row = begin; row < end; ++row) {
+                    int64_t i = row / index_size;
+                    IndexT index_value = index_data[row % index_size];
+                    if (index_value < 0) {
+                      index_value += dim_size;
+                    }
+                    memcpy(output_data + row * slice_size,
+                           input_data + (i * dim_size + index_value) *
+                                            slice_size,
+                           slice_size * sizeof(T));
+                  }
+                });
+    return;
+  }
+
   input->Resize(common::make_ddim({outer_nums, input_dim[dim], slice_size}));
   output->Resize(common::make_ddim({outer_nums, index_size, slice_size}));
 
@@ -0,0 +1,185 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/kernels/weight_only_linear_kernel.h"
+
+#include <algorithm>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/backends/cpu/parallel_for.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/cast_kernel.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/weight_only_gemm_cpu.h"
+
+namespace phi {
+
+namespace {
+
+// Up to this number of rows of x the weights are dequantized in registers,
+// above it they are dequantized by tiles that are multiplied by GEMM.
+constexpr int64_t kWeightOnlyGemvMaxRows = 16;
+constexpr int64_t kWeightOnlyGemmTile = 64;
+
+template <typename T, typename Context>
+const float* GetFloatData(const Context& dev_ctx,
+                          const DenseTensor& x,
+                          DenseTensor* buffer) {
+  if (x.dtype() == DataType::FLOAT32) {
+    return x.data<float>();
+  }
+  *buffer = phi::Cast<T>(dev_ctx, x, DataType::FLOAT32);
+  return buffer->data<float>();
+}
+
+}  // namespace
+
+template <typename T, typename Context>
+void WeightOnlyLinearKernel(const Context& dev_ctx,
+                            const DenseTensor& x,
+                            const DenseTensor& weight,
+                            const paddle::optional<DenseTensor>& bias,
+                            const DenseTensor& weight_scale,
+                            const std::string& weight_dtype,
+                            const int32_t arch,
+                            const int32_t group_size,
+                            DenseTensor* out) {
+  PADDLE_ENFORCE_EQ(
+      arch,
+      0,
+      common::errors::InvalidArgument(
+          "The CPU kernel of weight_only_linear only supports the weights "
+          "quantized by weight_quantize with arch 0, but got arch %d.",
+          arch));
+  const int bits = weight_dtype == "int4" ? 4 : 8;
+  const int64_t n =
+      group_size > 0 ? weight_scale.dims()[1] : weight_scale.dims()[0];
+  const int64_t k = weight.dims()[1];
+  const int64_t m = x.numel() / k;
+  PADDLE_ENFORCE_EQ(
+      weight.numel() * 8,
+      n * k * bits,
+      common::errors::InvalidArgument(
+          "The weight of weight_only_linear should have %d elements for %d "
+          "output channels of %s, but got %d.",
+          n * k * bits / 8,
+          n,
+          weight_dtype,
+          weight.numel()));
+
+  dev_ctx.template Alloc<T>(out);
+  if (m == 0) {
+    return;
+  }
+
+  DenseTensor x_buffer, scale_buffer, out_buffer;
+  const float* x_data = GetFloatData<T>(dev_ctx, x, &x_buffer);
+  const float* scale_data =
+      GetFloatData<T>(dev_ctx, weight_scale, &scale_buffer);
+  const int8_t* weight_data = weight.data<int8_t>();
+  float* out_data = nullptr;
+  if (out->dtype() == DataType::FLOAT32) {
+    out_data = reinterpret_cast<float*>(out->data<T>());
+  } else {
+    out_buffer.Resize(out->dims());
+    out_data = dev_ctx.template Alloc<float>(&out_buffer);
+  }
+
+  if (m <= kWeightOnlyGemvMaxRows) {
+    // Memory bound, so each quantized weight is read once for all the rows.
+    auto dot = funcs::GetWeightOnlyDotFunc(bits, k, group_size);
+    const int64_t row_bytes = k * bits / 8;
+    const int64_t grain_size =
+        std::max<int64_t>(kParallelGrainSize / std::max<int64_t>(m * k, 1), 1);
+    ParallelFor(dev_ctx, 0, n, grain_size, [&](int64_t c_begin, int64_t c_end) {
+      for (int64_t c = c_begin; c < c_end; ++c) {
+        for (int64_t i = 0; i < m; i += funcs::kWeightOnlyDotMaxRows) {
+          int rows = static_cast<int>(
+              std::min<int64_t>(funcs::kWeightOnlyDotMaxRows, m - i));
+          dot(x_data + i * k,
+              k,
+              rows,
+              weight_data + c * row_bytes,
+              scale_data + c,
+              n,
+              k,
+              group_size,
+              out_data + i * n + c,
+              n);
+        }
+      }
+    });
+  } else {
+    DenseTensor tile;
+    tile.Resize({kWeightOnlyGemmTile, k});
+    float* tile_data = dev_ctx.template Alloc<float>(&tile);
+    auto blas = funcs::GetBlas<Context, float>(dev_ctx);
+    const int64_t grain_size =
+        std::max<int64_t>(kParallelGrainSize / std::max<int64_t>(k, 1), 1);
+    for (int64_t begin = 0; begin < n; begin += kWeightOnlyGemmTile) {
+      const int64_t end = std::min(begin + kWeightOnlyGemmTile, n);
+      ParallelFor(
+          dev_ctx, begin, end, grain_size, [&](int64_t c_begin, int64_t c_end) {
+            funcs::WeightOnlyDequantRows(weight_data,
+                                         scale_data,
+                                         n,
+                                         k,
+                                         bits,
+                                         group_size,
+                                         c_begin,
+                                         c_end,
+                                         tile_data + (c_begin - begin) * k);
+          });
+      blas.GEMM(false,
+                true,
+                static_cast<int>(m),
+                static_cast<int>(end - begin),
+                static_cast<int>(k),
+                1.0f,
+                x_data,
+                static_cast<int>(k),
+                tile_data,
+                static_cast<int>(k),
+                0.0f,
+                out_data + begin,
+                static_cast<int>(n));
+    }
+  }
+
+  if (bias) {
+    DenseTensor bias_buffer;
+    const float* bias_data = GetFloatData<T>(dev_ctx, bias.get(), &bias_buffer);
+    for (int64_t i = 0; i < m; ++i) {
+      for (int64_t c = 0; c < n; ++c) {
+        out_data[i * n + c] += bias_data[c];
+      }
+    }
+  }
+  if (out->dtype() != DataType::FLOAT32) {
+    T* out_ptr = out->data<T>();
+    for (int64_t i = 0; i < m * n; ++i) {
+      out_ptr[i] = static_cast<T>(out_data[i]);
+    }
+  }
+}
+
+}  // namespace phi
+
+PD_REGISTER_KERNEL(weight_only_linear,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::WeightOnlyLinearKernel,
+                   float,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16) {}
@@ -22,6 +22,28 @@ limitations under the License. */
 
 namespace phi {
 
+// The layout of the CPU weight_only_linear kernel: the m quantized weights of
+// each of the n output channels are contiguous, two per byte for int4.
+template <int bits>
+void cpu_weight_layout(int8_t* out, const int8_t* x_int, size_t m, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    int8_t* row = out + i * m * bits / 8;
+    for (size_t j = 0; j < m; ++j) {
+      int8_t value = x_int[j * n + i];
+      if (bits == 8) {
+        row[j] = value;
+      } else {
+        value = std::max<int8_t>(-7, std::min<int8_t>(7, value));
+        if (j % 2 == 0) {
+          row[j / 2] = value & 0x0F;
+        } else {
+          row[j / 2] |= (value & 0x0F) << 4;
+        }
+      }
+    }
+  }
+}
+
 template <typename DeviceContext,
           typename T,
           typename D,
@@ -36,11 +58,11 @@ void quant_compute(const DeviceContext& dev_ctx,
                    const int32_t group_size) {
 #ifndef PADDLE_WITH_HIP
   PADDLE_ENFORCE_EQ(
-      ((arch == 70) || (arch == 75) || (arch == 80) || (arch == 86) ||
-       (arch == 89) || (arch == 90)),
+      ((arch == 0) || (arch == 70) || (arch == 75) || (arch == 80) ||
+       (arch == 86) || (arch == 89) || (arch == 90)),
       true,
       common::errors::InvalidArgument(
-          "Currently, arch only support 70, 75, 80, 86, 89, 90."));
+          "Currently, arch only support 0 (CPU), 70, 75, 80, 86, 89, 90."));
 
 #endif
   const auto x_dims = x.dims();
@@ -57,6 +79,27 @@ void quant_compute(const DeviceContext& dev_ctx,
   D* out_data = out->data<D>();
   ScaleT* scale_data = scale->data<ScaleT>();
 
+  if (arch == 0 && algo != "llm.int8") {
+    // The int4 weights are quantized to int8 in [-7, 7] and packed after.
+    DenseTensor x_int(out->type());
+    x_int.Resize({static_cast<int64_t>(m), static_cast<int64_t>(n)});
+    D* x_int_data = dev_ctx.template Alloc<D>(&x_int);
+    if (group_size == -1) {
+      per_channel_scale(scale_data, x_data, m, n, bits == 8 ? 127.0f : 7.0f);
+      per_channel_quant<T, 8>(x_int_data, x_data, scale_data, m, n);
+    } else {
+      group_wise_scale(scale_data,
+                       x_data,
+                       m,
+                       n,
+                       bits == 8 ? 127.0f : 7.0f,
+                       static_cast<size_t>(group_size));
+      group_wise_quant<T, 8>(x_int_data, x_data, scale_data, m, n, group_size);
+    }
+    cpu_weight_layout<bits>(out_data, x_int_data, m, n);
+    return;
+  }
+
   DenseTensor x_int(out->type());
 
 #ifdef PADDLE_WITH_HIP
@@ -182,5 +225,6 @@ PD_REGISTER_KERNEL(weight_quantize,
                    CPU,
                    ALL_LAYOUT,
                    phi::WeightQuantizeKernel,
+                   float,
                    phi::dtype::float16,
                    phi::dtype::bfloat16) {}
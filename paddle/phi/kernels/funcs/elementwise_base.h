@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 
 #include "paddle/phi/backends/all_context.h"
+#include "paddle/phi/backends/cpu/parallel_for.h"
 #include "paddle/phi/common/transform.h"
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/kernels/empty_kernel.h"
@@ -218,11 +219,29 @@ class TransformFunctor {
   }
 
   inline void Run() const {
+    if constexpr (std::is_same<DeviceContext, CPUContext>::value) {
+      ParallelFor(ctx_,
+                  0,
+                  nx_,
+                  kParallelGrainSize,
+                  [this](int64_t begin, int64_t end) {
+                    std::transform(x_ + begin,
+                                   x_ + end,
+                                   y_ + begin,
+                                   z_ + begin,
+                                   Functor(func_));
+                  });
+      return;
+    }
     phi::Transform<DeviceContext> trans;
     trans(ctx_, x_, x_ + nx_, y_, z_, func_);
   }
 
   inline void RunRowWise(int n) const {
+    if constexpr (std::is_same<DeviceContext, CPUContext>::value) {
+      RunBroadcastCPU([n](int64_t i) { return i % n; });
+      return;
+    }
     phi::Transform<DeviceContext> trans;
     if (is_xsize_larger_) {
       trans(ctx_,
@@ -242,6 +261,10 @@ class TransformFunctor {
   }
 
   inline void RunMidWise(int n, int post) const {
+    if constexpr (std::is_same<DeviceContext, CPUContext>::value) {
+      RunBroadcastCPU([n, post](int64_t i) { return i / post % n; });
+      return;
+    }
     phi::Transform<DeviceContext> trans;
     if (is_xsize_larger_) {
       trans(ctx_,
@@ -261,6 +284,23 @@ class TransformFunctor {
   }
 
  private:
+  // z[i] = func(x[i], y[y_index(i)]), or with x and y swapped if y is larger.
+  template <typename IndexFunctor>
+  void RunBroadcastCPU(IndexFunctor y_index) const {
+    const T *large = is_xsize_larger_ ? x_ : y_;
+    const T *small = is_xsize_larger_ ? y_ : x_;
+    ParallelFor(ctx_,
+                0,
+                nx_,
+                kParallelGrainSize,
+                [&](int64_t begin, int64_t end) {
+                  Functor func = func_;
+                  for (int64_t i = begin; i < end; ++i) {
+                    z_[i] = func(large[i], small[y_index(i)]);
+                  }
+                });
+  }
+
   const T *x_;
   const T *y_;
   OutType *z_;
@@ -281,7 +321,6 @@ void CommonForwardBroadcastCPU(const DenseTensor &x,
                                const CPUContext &ctx,
                                Functor func,
                                const bool is_xsize_larger = true) {
-  std::vector<int> index_array(max_dim, 0);
   const T *x_data = x.data<T>();
   const T *y_data = y.data<T>();
   PADDLE_ENFORCE_NOT_NULL(
@@ -292,18 +331,32 @@ void CommonForwardBroadcastCPU(const DenseTensor &x,
 
   const int out_size = std::accumulate(
       out_dims_array, out_dims_array + max_dim, 1, std::multiplies<int>());
-  int x_index, y_index;
-  for (int out_index = 0; out_index < out_size; ++out_index) {
-    x_index = GetElementwiseIndex(x_dims_array, max_dim, index_array.data());
-    y_index = GetElementwiseIndex(y_dims_array, max_dim, index_array.data());
-    if (is_xsize_larger) {
-      out_data[out_index] = func(x_data[x_index], y_data[y_index]);
-    } else {
-      out_data[out_index] = func(y_data[y_index], x_data[x_index]);
-    }
-
-    UpdateElementwiseIndexArray(out_dims_array, max_dim, index_array.data());
-  }
+  ParallelFor(
+      ctx, 0, out_size, kParallelGrainSize, [&](int64_t begin, int64_t end) {
+        // the index of `begin` in out_dims_array
+        std::vector<int> index_array(max_dim, 0);
+        int64_t offset = begin;
+        for (int i = max_dim - 1; i >= 0 && offset > 0; --i) {
+          index_array[i] = offset % out_dims_array[i];
+          offset /= out_dims_array[i];
+        }
+        Functor chunk_func = func;
+        int x_index, y_index;
+        for (int64_t out_index = begin; out_index < end; ++out_index) {
+          x_index =
+              GetElementwiseIndex(x_dims_array, max_dim, index_array.data());
+          y_index =
+              GetElementwiseIndex(y_dims_array, max_dim, index_array.data());
+          if (is_xsize_larger) {
+            out_data[out_index] = chunk_func(x_data[x_index], y_data[y_index]);
+          } else {
+            out_data[out_index] = chunk_func(y_data[y_index], x_data[x_index]);
+          }
+
+          UpdateElementwiseIndexArray(
+              out_dims_array, max_dim, index_array.data());
+        }
+      });
 }
 
 template <typename Functor, typename T, typename OutType = T>
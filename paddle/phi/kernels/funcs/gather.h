@@ -15,11 +15,13 @@ limitations under the License. */
 #pragma once
 #include <memory.h>
 
+#include <algorithm>
 #include <cstring>
 #include <vector>
 
 #include "paddle/common/ddim.h"
 #include "paddle/common/macros.h"
+#include "paddle/phi/backends/cpu/parallel_for.h"
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
@@ -34,7 +36,7 @@ namespace funcs {
  * return: output tensor
  */
 template <typename T, typename IndexT = int>
-void CPUGather(const phi::CPUContext& ctx UNUSED,
+void CPUGather(const phi::CPUContext& ctx,
                const DenseTensor& src,
                const DenseTensor& index,
                DenseTensor* output) {
@@ -71,30 +73,38 @@ void CPUGather(const phi::CPUContext& ctx UNUSED,
   int64_t index_dim_size = src_dims[0];
 
   const size_t slice_bytes = slice_size * sizeof(T);
+  const int64_t grain_size =
+      std::max<int64_t>(kParallelGrainSize / std::max<int64_t>(slice_size, 1),
+                        1);
 
-  for (int64_t i = 0; i < index_size; ++i) {
-    PADDLE_ENFORCE_LT(p_index[i],
-                      index_dim_size,
-                      common::errors::OutOfRange(
-                          "The element of Index must be less than the size of "
-                          "input dim size of axis which is %d, but received "
-                          "index element which is %d in the %d index.",
-                          index_dim_size,
-                          p_index[i],
-                          i));
-    PADDLE_ENFORCE_GE(
-        p_index[i],
-        -index_dim_size,
-        common::errors::OutOfRange(
-            "The element of Index must be greater than or equal "
-            "to %d, but received index element which is %d in the "
-            "%d index.",
-            -index_dim_size,
-            p_index[i],
-            i));
-    IndexT index_ = (p_index[i] < 0 ? p_index[i] + index_dim_size : p_index[i]);
-    memcpy(p_output + i * slice_size, p_src + index_ * slice_size, slice_bytes);
-  }
+  ParallelFor(ctx, 0, index_size, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      PADDLE_ENFORCE_LT(
+          p_index[i],
+          index_dim_size,
+          common::errors::OutOfRange(
+              "The element of Index must be less than the size of "
+              "input dim size of axis which is %d, but received "
+              "index element which is %d in the %d index.",
+              index_dim_size,
+              p_index[i],
+              i));
+      PADDLE_ENFORCE_GE(
+          p_index[i],
+          -index_dim_size,
+          common::errors::OutOfRange(
+              "The element of Index must be greater than or equal "
+              "to %d, but received index element which is %d in the "
+              "%d index.",
+              -index_dim_size,
+              p_index[i],
+              i));
+      IndexT index_ =
+          (p_index[i] < 0 ? p_index[i] + index_dim_size : p_index[i]);
+      memcpy(
+          p_output + i * slice_size, p_src + index_ * slice_size, slice_bytes);
+    }
+  });
 }
 
 template <typename T, typename IndexT = int>
@@ -209,20 +219,29 @@ void GatherV2Function(const phi::CPUContext& ctx,
   out->Resize(out_dim);
   auto* out_data = ctx.Alloc<T>(out);
 
-  int out_index = 0;
-  for (int64_t i = 0; i < inner_dim_size; i++) {
-    for (int64_t j = 0; j < index_size; j++) {
-      const int64_t index_data_j =
-          (index_data[j] < 0 ? index_data[j] + input_index_dim_size
+  const int64_t row_size = index_size * outer_dim_size;
+  ParallelFor(ctx,
+              0,
+              inner_dim_size,
+              std::max<int64_t>(
+                  kParallelGrainSize / std::max<int64_t>(row_size, 1), 1),
+              [&](int64_t begin, int64_t end) {
+                int64_t out_index = begin * row_size;
+                for (int64_t i = begin; i < end; i++) {
+                  for (int64_t j = 0; j < index_size; j++) {
+                    const int64_t index_data_j =
+                        (index_data[j] < 0
+                             ? index_data[j] + input_index_dim_size
                              : index_data[j]);
-      for (int64_t k = 0; k < outer_dim_size; k++) {
-        int64_t index = k + index_data_j * outer_dim_size +
-                        (i * input_size / inner_dim_size);
-        out_data[out_index] = input_data[index];
-        out_index++;
-      }
-    }
-  }
+                    for (int64_t k = 0; k < outer_dim_size; k++) {
+                      int64_t index = k + index_data_j * outer_dim_size +
+                                      (i * input_size / inner_dim_size);
+                      out_data[out_index] = input_data[index];
+                      out_index++;
+                    }
+                  }
+                }
+              });
 }
 
 template <typename T, typename U>
@@ -58,6 +58,7 @@ using dim3 = phi::kps::dim3;
 #endif
 
 #include "paddle/common/array.h"
+#include "paddle/phi/backends/cpu/parallel_for.h"
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/enforce.h"
 #include "paddle/phi/core/kernel_utils.h"
@@ -1348,6 +1349,60 @@ void HandleLargeDim(const Context& dev_ctx,
   output->ResizeAndAllocate(output_dim);
 }
 
+////////////// ReduceTrailingDimsCPU
+
+// Reduces the trailing dims of input, viewed as a [pre, post] matrix, with
+// the rows split over the threads of dev_ctx. Returns false if dims are not
+// the trailing dims of input.
+template <typename OutT, typename Functor>
+bool ReduceTrailingDimsCPU(const phi::CPUContext& dev_ctx,
+                           const phi::DenseTensor& input,
+                           phi::DenseTensor* output,
+                           const std::vector<int64_t>& dims) {
+  const auto& input_dims = input.dims();
+  int ndim = input_dims.size();
+  std::vector<bool> reduced(ndim, false);
+  for (auto dim : dims) {
+    reduced[dim < 0 ? dim + ndim : dim] = true;
+  }
+  int split = ndim;
+  while (split > 0 && reduced[split - 1]) {
+    --split;
+  }
+  for (int i = 0; i < split; ++i) {
+    if (reduced[i]) {
+      return false;
+    }
+  }
+  int64_t pre = 1;
+  int64_t post = 1;
+  for (int i = 0; i < ndim; ++i) {
+    (i < split ? pre : post) *= input_dims[i];
+  }
+  if (split == ndim || pre == 1) {
+    return false;
+  }
+  const OutT* x_data = input.data<OutT>();
+  OutT* out_data = output->data<OutT>();
+  auto& place = *dev_ctx.eigen_device();
+  ParallelFor(dev_ctx,
+              0,
+              pre,
+              kParallelGrainSize / post + 1,
+              [&](int64_t begin, int64_t end) {
+                using Index = Eigen::DenseIndex;
+                typename EigenMatrix<OutT>::ConstType x(
+                    x_data + begin * post,
+                    Eigen::DSizes<Index, 2>(end - begin, post));
+                typename EigenVector<OutT>::Type out(
+                    out_data + begin, Eigen::DSizes<Index, 1>(end - begin));
+                auto reduce_dim = Eigen::array<int, 1>({{1}});
+                Functor functor;
+                functor(place, &x, &out, reduce_dim);
+              });
+  return true;
+}
+
 ////////////// ReduceKernel
 
 template <typename Context, typename T, typename OutT, typename Functor>
@@ -1374,6 +1429,11 @@ void ReduceKernelImpl(const Context& dev_ctx,
     Functor functor;
     functor(dev, &x, &out, reduce_dim);
   } else {
+    if constexpr (std::is_same<Context, phi::CPUContext>::value) {
+      if (ReduceTrailingDimsCPU<OutT, Functor>(dev_ctx, input, output, dims)) {
+        return;
+      }
+    }
     int ndim = input.dims().size();
     int rdim = dims.size();
     if (ndim > 6) {
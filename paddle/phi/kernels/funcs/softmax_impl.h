@@ -17,6 +17,7 @@ limitations under the License. */
 
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/backends/cpu/cpu_info.h"
+#include "paddle/phi/backends/cpu/parallel_for.h"
 #include "paddle/phi/backends/gpu/gpu_context.h"
 #include "paddle/phi/common/bfloat16.h"
 #include "paddle/phi/common/float16.h"
@@ -247,26 +248,35 @@ class SoftmaxFunctor<DeviceContext, T, enable_if_CPU<DeviceContext>> {
 
     if (num_remain == 1 &&
         phi::backends::cpu::MayIUse(phi::backends::cpu::avx)) {
-      const T* in_data = X->data<T>();
-      T* out_data = Y->data<T>();
-      for (int bs = 0; bs < batch_size; ++bs) {
-        T max_val = *std::max_element(in_data, in_data + num_classes);
-        max_val *= static_cast<T>(-1);
-        vec_add_bias<T, phi::backends::cpu::avx>(
-            num_classes, max_val, in_data, out_data);
-        vec_clip<T, phi::backends::cpu::avx>(
-            num_classes, static_cast<T>(-64), out_data, out_data);
-        vec_exp<T>(num_classes, out_data, out_data);
-
-        T sum = 0;
-        vec_sum<T, phi::backends::cpu::avx>(num_classes, out_data, &sum);
-        sum = static_cast<T>(1) / sum;
-        vec_scal<T, phi::backends::cpu::avx>(
-            num_classes, sum, out_data, out_data);
-
-        in_data += num_classes;
-        out_data += num_classes;
-      }
+      const T* in_base = X->data<T>();
+      T* out_base = Y->data<T>();
+      ParallelFor(
+          context,
+          0,
+          batch_size,
+          kParallelGrainSize / std::max(num_classes, 1) + 1,
+          [&](int64_t begin, int64_t end) {
+            const T* in_data = in_base + begin * num_classes;
+            T* out_data = out_base + begin * num_classes;
+            for (int64_t bs = begin; bs < end; ++bs) {
+              T max_val = *std::max_element(in_data, in_data + num_classes);
+              max_val *= static_cast<T>(-1);
+              vec_add_bias<T, phi::backends::cpu::avx>(
+                  num_classes, max_val, in_data, out_data);
+              vec_clip<T, phi::backends::cpu::avx>(
+                  num_classes, static_cast<T>(-64), out_data, out_data);
+              vec_exp<T>(num_classes, out_data, out_data);
+
+              T sum = 0;
+              vec_sum<T, phi::backends::cpu::avx>(num_classes, out_data, &sum);
+              sum = static_cast<T>(1) / sum;
+              vec_scal<T, phi::backends::cpu::avx>(
+                  num_classes, sum, out_data, out_data);
+
+              in_data += num_classes;
+              out_data += num_classes;
+            }
+          });
     } else {
       SoftmaxEigen<DeviceContext, T>()(context, axis_dim, X, Y);
     }
@@ -0,0 +1,580 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "paddle/common/ddim.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/backends/cpu/parallel_for.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/sparse_coo_tensor.h"
+#include "paddle/phi/core/sparse_csr_tensor.h"
+#include "paddle/phi/core/visit_type.h"
+#include "paddle/phi/kernels/cast_kernel.h"
+#include "paddle/phi/kernels/empty_kernel.h"
+#include "paddle/phi/kernels/sparse/sparse_utils_kernel.h"
+
+namespace phi {
+namespace funcs {
+namespace sparse {
+
+// One matrix of a batched SparseCsrTensor, whose crows restart from 0 in
+// every batch.
+template <typename T, typename IntT>
+struct CpuCsrMatrix {
+  int64_t rows;
+  int64_t cols;
+  const IntT* crows;
+  const IntT* cols_data;
+  const T* values;
+};
+
+// Holds the arrays of a CpuCsrMatrix computed on the fly.
+template <typename T, typename IntT>
+struct CpuCsrBuffer {
+  std::vector<IntT> crows;
+  std::vector<IntT> cols;
+  std::vector<T> values;
+
+  CpuCsrMatrix<T, IntT> matrix(int64_t rows, int64_t cols_num) const {
+    return {rows, cols_num, crows.data(), cols.data(), values.data()};
+  }
+};
+
+inline void GetCsrShape(const DDim& dims,
+                        int64_t* batch_size,
+                        int64_t* rows,
+                        int64_t* cols) {
+  int ndims = dims.size();
+  PADDLE_ENFORCE_GE(
+      ndims,
+      2,
+      common::errors::InvalidArgument("the dim size of SparseCsrTensor must be "
+                                      "greater than or equal to 2."));
+  *batch_size = 1;
+  for (int i = 0; i < ndims - 2; ++i) {
+    *batch_size *= dims[i];
+  }
+  *rows = dims[ndims - 2];
+  *cols = dims[ndims - 1];
+}
+
+// Returns the matrices of all batches of x.
+template <typename T, typename IntT>
+std::vector<CpuCsrMatrix<T, IntT>> GetCpuCsrMatrices(
+    const SparseCsrTensor& x) {
+  int64_t batch_size = 0, rows = 0, cols = 0;
+  GetCsrShape(x.dims(), &batch_size, &rows, &cols);
+  PADDLE_ENFORCE_EQ(x.crows().numel(),
+                    batch_size * (rows + 1),
+                    common::errors::PreconditionNotMet(
+                        "the length of SparseCsrTensor crows is not right."));
+  const IntT* crows = x.crows().data<IntT>();
+  const IntT* cols_data = x.cols().data<IntT>();
+  const T* values = x.values().data<T>();
+  std::vector<CpuCsrMatrix<T, IntT>> matrices;
+  int64_t offset = 0;
+  for (int64_t b = 0; b < batch_size; ++b) {
+    const IntT* batch_crows = crows + b * (rows + 1);
+    matrices.push_back(
+        {rows, cols, batch_crows, cols_data + offset, values + offset});
+    offset += batch_crows[rows];
+  }
+  return matrices;
+}
+
+// CSR of the transpose of x by counting sort, the cols of every row stay
+// sorted.
+template <typename T, typename IntT>
+CpuCsrMatrix<T, IntT> TransposeCpuCsr(const CpuCsrMatrix<T, IntT>& x,
+                                      CpuCsrBuffer<T, IntT>* buffer) {
+  const int64_t nnz = x.crows[x.rows];
+  buffer->crows.assign(x.cols + 1, 0);
+  buffer->cols.resize(nnz);
+  buffer->values.resize(nnz);
+  for (int64_t p = 0; p < nnz; ++p) {
+    buffer->crows[x.cols_data[p] + 1]++;
+  }
+  for (int64_t j = 0; j < x.cols; ++j) {
+    buffer->crows[j + 1] += buffer->crows[j];
+  }
+  std::vector<IntT> next(buffer->crows.begin(), buffer->crows.end() - 1);
+  for (int64_t i = 0; i < x.rows; ++i) {
+    for (IntT p = x.crows[i]; p < x.crows[i + 1]; ++p) {
+      IntT q = next[x.cols_data[p]]++;
+      buffer->cols[q] = static_cast<IntT>(i);
+      buffer->values[q] = x.values[p];
+    }
+  }
+  return buffer->matrix(x.cols, x.rows);
+}
+
+// Transposes the dense matrix x of rows * cols into out.
+template <typename T>
+void TransposeCpuDense(const T* x, int64_t rows, int64_t cols, T* out) {
+  for (int64_t i = 0; i < rows; ++i) {
+    for (int64_t j = 0; j < cols; ++j) {
+      out[j * rows + i] = x[i * cols + j];
+    }
+  }
+}
+
+// Splits the rows of a CSR matrix into ranges of about the same number of
+// non zero elements plus rows, so that a few long rows do not keep one
+// thread busy while the others wait. Returns the part_num + 1 bounds.
+template <typename IntT>
+std::vector<int64_t> PartitionCsrRows(const IntT* crows,
+                                      int64_t rows,
+                                      int part_num) {
+  const int64_t total = static_cast<int64_t>(crows[rows]) + rows;
+  std::vector<int64_t> bounds(part_num + 1, rows);
+  bounds[0] = 0;
+  for (int p = 1; p < part_num; ++p) {
+    const int64_t target = total * p / part_num;
+    int64_t lo = bounds[p - 1], hi = rows;
+    while (lo < hi) {
+      int64_t mid = lo + (hi - lo) / 2;
+      if (static_cast<int64_t>(crows[mid]) + mid < target) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    bounds[p] = lo;
+  }
+  return bounds;
+}
+
+// Calls func(row_begin, row_end) for the row ranges of x, one range on each
+// of the threads ParallelFor runs for dev_ctx.
+template <typename T, typename IntT, typename Func>
+void ParallelForCsrRows(const phi::CPUContext& dev_ctx,
+                        const CpuCsrMatrix<T, IntT>& x,
+                        const Func& func) {
+  const int part_num = GetParallelNumThreads(dev_ctx, x.rows, 1);
+  if (part_num == 1) {
+    func(0, x.rows);
+    return;
+  }
+  std::vector<int64_t> bounds = PartitionCsrRows(x.crows, x.rows, part_num);
+  ParallelFor(dev_ctx, 0, part_num, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t p = begin; p < end; ++p) {
+      func(bounds[p], bounds[p + 1]);
+    }
+  });
+}
+
+// out = alpha * a * b + beta * out, where b is a.cols * n and out is
+// a.rows * n, both row major.
+template <typename T, typename IntT>
+void CpuCsrDenseMatmul(const phi::CPUContext& dev_ctx,
+                       const CpuCsrMatrix<T, IntT>& a,
+                       const T* b,
+                       int64_t n,
+                       T alpha,
+                       T beta,
+                       T* out) {
+  ParallelForCsrRows(dev_ctx, a, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      T* out_row = out + i * n;
+      if (beta == static_cast<T>(0)) {
+        std::fill(out_row, out_row + n, static_cast<T>(0));
+      } else if (beta != static_cast<T>(1)) {
+        for (int64_t j = 0; j < n; ++j) {
+          out_row[j] *= beta;
+        }
+      }
+      for (IntT p = a.crows[i]; p < a.crows[i + 1]; ++p) {
+        const T scale = alpha * a.values[p];
+        const T* b_row = b + static_cast<int64_t>(a.cols_data[p]) * n;
+        for (int64_t j = 0; j < n; ++j) {
+          out_row[j] += scale * b_row[j];
+        }
+      }
+    }
+  });
+}
+
+// out.values = alpha * (a * b)[out] + beta * out.values, where a is
+// out.rows * k and b_trans is out.cols * k, both row major, so that every
+// element is the dot product of two contiguous rows.
+template <typename T, typename IntT>
+void CpuSampledDenseMatmul(const phi::CPUContext& dev_ctx,
+                           const T* a,
+                           const T* b_trans,
+                           int64_t k,
+                           T alpha,
+                           T beta,
+                           const CpuCsrMatrix<T, IntT>& out,
+                           T* out_values) {
+  ParallelForCsrRows(dev_ctx, out, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      const T* a_row = a + i * k;
+      for (IntT p = out.crows[i]; p < out.crows[i + 1]; ++p) {
+        const T* b_row = b_trans + static_cast<int64_t>(out.cols_data[p]) * k;
+        T sum = static_cast<T>(0);
+        for (int64_t j = 0; j < k; ++j) {
+          sum += a_row[j] * b_row[j];
+        }
+        out_values[p] = beta == static_cast<T>(0)
+                            ? alpha * sum
+                            : alpha * sum + beta * out_values[p];
+      }
+    }
+  });
+}
+
+// Gustavson's algorithm: a symbolic pass counts the non zero elements of
+// every row of out = alpha * a * b, a numeric pass fills them. Every thread
+// accumulates a row in a dense array of b.cols elements.
+template <typename T, typename IntT>
+void CpuCsrCsrMatmul(const phi::CPUContext& dev_ctx,
+                     const CpuCsrMatrix<T, IntT>& a,
+                     const CpuCsrMatrix<T, IntT>& b,
+                     T alpha,
+                     CpuCsrBuffer<T, IntT>* out) {
+  out->crows.assign(a.rows + 1, 0);
+  ParallelForCsrRows(dev_ctx, a, [&](int64_t begin, int64_t end) {
+    std::vector<int64_t> marker(b.cols, -1);
+    for (int64_t i = begin; i < end; ++i) {
+      IntT row_nnz = 0;
+      for (IntT p = a.crows[i]; p < a.crows[i + 1]; ++p) {
+        const IntT k = a.cols_data[p];
+        for (IntT q = b.crows[k]; q < b.crows[k + 1]; ++q) {
+          if (marker[b.cols_data[q]] != i) {
+            marker[b.cols_data[q]] = i;
+            ++row_nnz;
+          }
+        }
+      }
+      out->crows[i + 1] = row_nnz;
+    }
+  });
+  for (int64_t i = 0; i < a.rows; ++i) {
+    out->crows[i + 1] += out->crows[i];
+  }
+  out->cols.resize(out->crows[a.rows]);
+  out->values.resize(out->crows[a.rows]);
+
+  ParallelForCsrRows(dev_ctx, a, [&](int64_t begin, int64_t end) {
+    std::vector<int64_t> marker(b.cols, -1);
+    std::vector<T> accumulator(b.cols, static_cast<T>(0));
+    for (int64_t i = begin; i < end; ++i) {
+      IntT* row_cols = out->cols.data() + out->crows[i];
+      IntT row_nnz = 0;
+      for (IntT p = a.crows[i]; p < a.crows[i + 1]; ++p) {
+        const IntT k = a.cols_data[p];
+        const T scale = alpha * a.values[p];
+        for (IntT q = b.crows[k]; q < b.crows[k + 1]; ++q) {
+          const IntT j = b.cols_data[q];
+          if (marker[j] != i) {
+            marker[j] = i;
+            row_cols[row_nnz++] = j;
+            accumulator[j] = scale * b.values[q];
+          } else {
+            accumulator[j] += scale * b.values[q];
+          }
+        }
+      }
+      std::sort(row_cols, row_cols + row_nnz);
+      T* row_values = out->values.data() + out->crows[i];
+      for (IntT x = 0; x < row_nnz; ++x) {
+        row_values[x] = accumulator[row_cols[x]];
+      }
+    }
+  });
+}
+
+template <typename T>
+const SparseCsrTensor& GetCpuCsrTensor(const phi::CPUContext& dev_ctx UNUSED,
+                                       const SparseCsrTensor& x,
+                                       SparseCsrTensor* holder UNUSED) {
+  return x;
+}
+
+// The COO tensor is converted, whose indices must be coalesced.
+template <typename T>
+const SparseCsrTensor& GetCpuCsrTensor(const phi::CPUContext& dev_ctx,
+                                       const SparseCooTensor& x,
+                                       SparseCsrTensor* holder) {
+  *holder = phi::sparse::CooToCsr<T, phi::CPUContext>(dev_ctx, x);
+  return *holder;
+}
+
+// out = alpha * op(a) * op(b) + beta * out for every batch, where b and out
+// are dense matrices of b_rows * b_cols and out_rows * out_cols.
+template <typename T, typename IntT>
+void CpuSpmm(const phi::CPUContext& dev_ctx,
+             bool transa,
+             bool transb,
+             T alpha,
+             const SparseCsrTensor& mat_a,
+             const T* b,
+             int64_t b_rows,
+             int64_t b_cols,
+             T beta,
+             T* out,
+             int64_t out_rows,
+             int64_t out_cols) {
+  auto matrices = GetCpuCsrMatrices<T, IntT>(mat_a);
+  const int64_t a_rows = transa ? matrices[0].cols : matrices[0].rows;
+  const int64_t a_cols = transa ? matrices[0].rows : matrices[0].cols;
+  const int64_t op_b_rows = transb ? b_cols : b_rows;
+  PADDLE_ENFORCE_EQ(a_cols,
+                    op_b_rows,
+                    common::errors::PreconditionNotMet(
+                        "The shape of sparse and dense matrix is not "
+                        "suitable for matmul, got %d and %d.",
+                        a_cols,
+                        op_b_rows));
+  PADDLE_ENFORCE_EQ(
+      a_rows == out_rows && (transb ? b_rows : b_cols) == out_cols,
+      true,
+      common::errors::PreconditionNotMet(
+          "The shape of output matrix is not suitable for matmul."));
+
+  CpuCsrBuffer<T, IntT> trans_a;
+  std::vector<T> trans_b;
+  if (transb) {
+    trans_b.resize(b_rows * b_cols);
+  }
+  for (size_t batch = 0; batch < matrices.size(); ++batch) {
+    const T* batch_b = b + batch * b_rows * b_cols;
+    if (transb) {
+      TransposeCpuDense(batch_b, b_rows, b_cols, trans_b.data());
+      batch_b = trans_b.data();
+    }
+    CpuCsrMatrix<T, IntT> a = transa
+                                  ? TransposeCpuCsr(matrices[batch], &trans_a)
+                                  : matrices[batch];
+    CpuCsrDenseMatmul(dev_ctx,
+                      a,
+                      batch_b,
+                      out_cols,
+                      alpha,
+                      beta,
+                      out + batch * out_rows * out_cols);
+  }
+}
+
+/************* SPARSE*DENSE->DENSE MATMUL ************/
+template <>
+template <typename T, typename TensorType>
+void SparseBlas<phi::CPUContext>::SPMM(bool transa,
+                                       bool transb,
+                                       T alpha,
+                                       const TensorType& mat_a,
+                                       const phi::DenseTensor& mat_b,
+                                       T beta,
+                                       phi::DenseTensor* mat_out) const {
+  SparseCsrTensor holder;
+  const SparseCsrTensor& csr_a = GetCpuCsrTensor<T>(dev_ctx_, mat_a, &holder);
+  const auto& b_dims = mat_b.dims();
+  const auto& out_dims = mat_out->dims();
+  PD_VISIT_BASE_INTEGRAL_TYPES(csr_a.crows().dtype(), "CpuSpmm", ([&] {
+                                 CpuSpmm<T, data_t>(
+                                     dev_ctx_,
+                                     transa,
+                                     transb,
+                                     alpha,
+                                     csr_a,
+                                     mat_b.data<T>(),
+                                     b_dims[b_dims.size() - 2],
+                                     b_dims[b_dims.size() - 1],
+                                     beta,
+                                     mat_out->data<T>(),
+                                     out_dims[out_dims.size() - 2],
+                                     out_dims[out_dims.size() - 1]);
+                               }));
+}
+
+/************* SPARSE*DENSE->DENSE MV ************/
+template <>
+template <typename T, typename TensorType>
+void SparseBlas<phi::CPUContext>::SPMV(bool transa,
+                                       T alpha,
+                                       const TensorType& mat_a,
+                                       const phi::DenseTensor& vec_x,
+                                       T beta,
+                                       phi::DenseTensor* vec_out) const {
+  SparseCsrTensor holder;
+  const SparseCsrTensor& csr_a = GetCpuCsrTensor<T>(dev_ctx_, mat_a, &holder);
+  PD_VISIT_BASE_INTEGRAL_TYPES(csr_a.crows().dtype(), "CpuSpmv", ([&] {
+                                 CpuSpmm<T, data_t>(dev_ctx_,
+                                                    transa,
+                                                    false,
+                                                    alpha,
+                                                    csr_a,
+                                                    vec_x.data<T>(),
+                                                    vec_x.numel(),
+                                                    1,
+                                                    beta,
+                                                    vec_out->data<T>(),
+                                                    vec_out->numel(),
+                                                    1);
+                               }));
+}
+
+/************* DENSE*DENSE->SPARSE MATMUL ************/
+template <>
+template <typename T, typename TensorType>
+void SparseBlas<phi::CPUContext>::SDDMM(bool transa,
+                                        bool transb,
+                                        T alpha,
+                                        const phi::DenseTensor& mat_a,
+                                        const phi::DenseTensor& mat_b,
+                                        T beta,
+                                        TensorType* mat_out) const {
+  const auto& a_dims = mat_a.dims();
+  const auto& b_dims = mat_b.dims();
+  const int64_t a_rows = a_dims[a_dims.size() - 2];
+  const int64_t a_cols = a_dims[a_dims.size() - 1];
+  const int64_t b_rows = b_dims[b_dims.size() - 2];
+  const int64_t b_cols = b_dims[b_dims.size() - 1];
+  const int64_t k = transa ? a_rows : a_cols;
+  PADDLE_ENFORCE_EQ(k,
+                    transb ? b_cols : b_rows,
+                    common::errors::PreconditionNotMet(
+                        "The shape of dense matrices is not suitable for "
+                        "matmul, got %d and %d.",
+                        k,
+                        transb ? b_cols : b_rows));
+
+  // Both operands are made rows of length k: op(a) and op(b)'.
+  std::vector<T> trans_a, trans_b;
+  if (transa) {
+    trans_a.resize(a_rows * a_cols);
+  }
+  if (!transb) {
+    trans_b.resize(b_rows * b_cols);
+  }
+  PD_VISIT_BASE_INTEGRAL_TYPES(
+      mat_out->crows().dtype(), "CpuSddmm", ([&] {
+        auto matrices = GetCpuCsrMatrices<T, data_t>(*mat_out);
+        T* out_values = mat_out->mutable_values()->template data<T>();
+        for (size_t batch = 0; batch < matrices.size(); ++batch) {
+          const T* a = mat_a.data<T>() + batch * a_rows * a_cols;
+          const T* b = mat_b.data<T>() + batch * b_rows * b_cols;
+          if (transa) {
+            TransposeCpuDense(a, a_rows, a_cols, trans_a.data());
+            a = trans_a.data();
+          }
+          if (!transb) {
+            TransposeCpuDense(b, b_rows, b_cols, trans_b.data());
+            b = trans_b.data();
+          }
+          const auto& out = matrices[batch];
+          CpuSampledDenseMatmul(dev_ctx_,
+                                a,
+                                b,
+                                k,
+                                alpha,
+                                beta,
+                                out,
+                                out_values + (out.values - matrices[0].values));
+        }
+      }));
+}
+
+/************* SPARSE*SPARSE->SPARSE MATMUL ************/
+template <>
+template <typename T>
+void SparseBlas<phi::CPUContext>::SPGEMM(bool transa,
+                                         bool transb,
+                                         T alpha,
+                                         const SparseCsrTensor& mat_a,
+                                         const SparseCsrTensor& mat_b,
+                                         T beta UNUSED,
+                                         SparseCsrTensor* mat_out) const {
+  // Both operands use int64 indices if either does.
+  SparseCsrTensor a_int64, b_int64;
+  const SparseCsrTensor* a = &mat_a;
+  const SparseCsrTensor* b = &mat_b;
+  const auto CastToInt64 = [&](const SparseCsrTensor& x, SparseCsrTensor* out) {
+    out->SetMember(phi::Cast<int32_t>(dev_ctx_, x.crows(), DataType::INT64),
+                   phi::Cast<int32_t>(dev_ctx_, x.cols(), DataType::INT64),
+                   x.values(),
+                   x.dims());
+  };
+  if (mat_a.crows().dtype() != mat_b.crows().dtype()) {
+    if (mat_a.crows().dtype() == DataType::INT32) {
+      CastToInt64(mat_a, &a_int64);
+      a = &a_int64;
+    } else {
+      CastToInt64(mat_b, &b_int64);
+      b = &b_int64;
+    }
+  }
+
+  PD_VISIT_BASE_INTEGRAL_TYPES(
+      a->crows().dtype(), "CpuSpgemm", ([&] {
+        auto a_matrices = GetCpuCsrMatrices<T, data_t>(*a);
+        auto b_matrices = GetCpuCsrMatrices<T, data_t>(*b);
+        PADDLE_ENFORCE_EQ(a_matrices.size(),
+                          b_matrices.size(),
+                          common::errors::PreconditionNotMet(
+                              "The batch size of Input(x) and Input(y) "
+                              "should be equal."));
+        const size_t batch_size = a_matrices.size();
+        std::vector<CpuCsrBuffer<T, data_t>> out_batches(batch_size);
+        CpuCsrBuffer<T, data_t> trans_a, trans_b;
+        int64_t out_rows = 0, out_cols = 0, out_nnz = 0;
+        for (size_t batch = 0; batch < batch_size; ++batch) {
+          auto a_matrix = transa ? TransposeCpuCsr(a_matrices[batch], &trans_a)
+                                 : a_matrices[batch];
+          auto b_matrix = transb ? TransposeCpuCsr(b_matrices[batch], &trans_b)
+                                 : b_matrices[batch];
+          PADDLE_ENFORCE_EQ(
+              a_matrix.cols,
+              b_matrix.rows,
+              common::errors::PreconditionNotMet(
+                  "The shape of Input(x) and Input(y) is not suitable for "
+                  "matmul opetation, x_dim[-1] must be equal to y_dim[-2]."));
+          CpuCsrCsrMatmul(
+              dev_ctx_, a_matrix, b_matrix, alpha, &out_batches[batch]);
+          out_rows = a_matrix.rows;
+          out_cols = b_matrix.cols;
+          out_nnz += out_batches[batch].cols.size();
+        }
+
+        DenseTensor crows = phi::Empty<data_t>(
+            dev_ctx_, {static_cast<int64_t>(batch_size) * (out_rows + 1)});
+        DenseTensor cols = phi::Empty<data_t>(dev_ctx_, {out_nnz});
+        DenseTensor values = phi::Empty<T>(dev_ctx_, {out_nnz});
+        data_t* crows_data = crows.data<data_t>();
+        data_t* cols_data = cols.data<data_t>();
+        T* values_data = values.data<T>();
+        for (auto& out_batch : out_batches) {
+          crows_data = std::copy(
+              out_batch.crows.begin(), out_batch.crows.end(), crows_data);
+          cols_data = std::copy(
+              out_batch.cols.begin(), out_batch.cols.end(), cols_data);
+          values_data = std::copy(
+              out_batch.values.begin(), out_batch.values.end(), values_data);
+        }
+
+        std::vector<int64_t> out_dims = common::vectorize(a->dims());
+        out_dims[out_dims.size() - 2] = out_rows;
+        out_dims[out_dims.size() - 1] = out_cols;
+        mat_out->SetMember(crows, cols, values, common::make_ddim(out_dims));
+      }));
+}
+
+}  // namespace sparse
+}  // namespace funcs
+}  // namespace phi
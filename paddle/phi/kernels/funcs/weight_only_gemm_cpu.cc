@@ -0,0 +1,121 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/kernels/funcs/weight_only_gemm_cpu.h"
+
+#include "paddle/phi/backends/cpu/cpu_info.h"
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+template <int bits>
+inline float LoadWeight(const int8_t* weight, int64_t j) {
+  if (bits == 8) {
+    return weight[j];
+  }
+  // Shift the nibble to the top and back to sign extend it.
+  int8_t packed = weight[j / 2];
+  return static_cast<int8_t>(j % 2 == 0 ? packed << 4 : packed) >> 4;
+}
+
+}  // namespace
+
+template <int bits>
+void WeightOnlyDotRef(const float* x,
+                      int64_t ldx,
+                      int m,
+                      const int8_t* weight,
+                      const float* scale,
+                      int64_t scale_stride,
+                      int64_t k,
+                      int group_size,
+                      float* out,
+                      int64_t ldo) {
+  const int64_t group = group_size > 0 ? group_size : k;
+  float acc[kWeightOnlyDotMaxRows] = {0};
+  for (int64_t begin = 0; begin < k; begin += group) {
+    const int64_t end = begin + group < k ? begin + group : k;
+    const float s = scale[(begin / group) * scale_stride];
+    float group_acc[kWeightOnlyDotMaxRows] = {0};
+    for (int64_t j = begin; j < end; ++j) {
+      const float w = LoadWeight<bits>(weight, j);
+      for (int i = 0; i < m; ++i) {
+        group_acc[i] += x[i * ldx + j] * w;
+      }
+    }
+    for (int i = 0; i < m; ++i) {
+      acc[i] += group_acc[i] * s;
+    }
+  }
+  for (int i = 0; i < m; ++i) {
+    out[i * ldo] = acc[i];
+  }
+}
+
+template void WeightOnlyDotRef<8>(const float*,
+                                  int64_t,
+                                  int,
+                                  const int8_t*,
+                                  const float*,
+                                  int64_t,
+                                  int64_t,
+                                  int,
+                                  float*,
+                                  int64_t);
+template void WeightOnlyDotRef<4>(const float*,
+                                  int64_t,
+                                  int,
+                                  const int8_t*,
+                                  const float*,
+                                  int64_t,
+                                  int64_t,
+                                  int,
+                                  float*,
+                                  int64_t);
+
+WeightOnlyDotFunc GetWeightOnlyDotFunc(int bits, int64_t k, int group_size) {
+#if defined(PADDLE_WITH_AVX) && defined(PADDLE_WITH_AVX512F)
+  if (phi::backends::cpu::MayIUse(phi::backends::cpu::avx512f) &&
+      k % 16 == 0 && (group_size <= 0 || group_size % 16 == 0)) {
+    return bits == 8 ? WeightOnlyDotAVX512<8> : WeightOnlyDotAVX512<4>;
+  }
+#endif
+  return bits == 8 ? WeightOnlyDotRef<8> : WeightOnlyDotRef<4>;
+}
+
+void WeightOnlyDequantRows(const int8_t* weight,
+                           const float* scale,
+                           int64_t n,
+                           int64_t k,
+                           int bits,
+                           int group_size,
+                           int64_t begin,
+                           int64_t end,
+                           float* out) {
+  const int64_t group = group_size > 0 ? group_size : k;
+  const int64_t row_bytes = k * bits / 8;
+  for (int64_t c = begin; c < end; ++c) {
+    const int8_t* w = weight + c * row_bytes;
+    float* o = out + (c - begin) * k;
+    for (int64_t j = 0; j < k; ++j) {
+      const float q = bits == 8 ? LoadWeight<8>(w, j) : LoadWeight<4>(w, j);
+      o[j] = q * scale[(j / group) * n + c];
+    }
+  }
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,92 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+
+namespace phi {
+namespace funcs {
+
+/*
+ * The CPU weight-only kernels take the weights quantized by weight_quantize
+ * with arch 0. The k weights of each of the n output channels are stored
+ * contiguously, as k int8 values, or as k / 2 bytes of int4 values with the
+ * even ones in the low nibbles. The scales are of shape [n] for per-channel
+ * quantization and [k / group_size, n] for group-wise quantization.
+ */
+
+// The rows of x handled by one call of a WeightOnlyDotFunc.
+constexpr int kWeightOnlyDotMaxRows = 4;
+
+// Computes out[i * ldo] = sum_j x[i * ldx + j] * w[j] * s(j) for i < m, where
+// w is the quantized weights of one channel and s(j) its scale, read from
+// scale[(j / group_size) * scale_stride], or scale[0] if group_size <= 0.
+// The weights are dequantized in registers and m is at most
+// kWeightOnlyDotMaxRows, so each weight is loaded once for the m rows.
+using WeightOnlyDotFunc = void (*)(const float* x,
+                                   int64_t ldx,
+                                   int m,
+                                   const int8_t* weight,
+                                   const float* scale,
+                                   int64_t scale_stride,
+                                   int64_t k,
+                                   int group_size,
+                                   float* out,
+                                   int64_t ldo);
+
+template <int bits>
+void WeightOnlyDotRef(const float* x,
+                      int64_t ldx,
+                      int m,
+                      const int8_t* weight,
+                      const float* scale,
+                      int64_t scale_stride,
+                      int64_t k,
+                      int group_size,
+                      float* out,
+                      int64_t ldo);
+
+#if defined(PADDLE_WITH_AVX) && defined(PADDLE_WITH_AVX512F)
+// Needs k and group_size to be multiples of 16.
+template <int bits>
+void WeightOnlyDotAVX512(const float* x,
+                         int64_t ldx,
+                         int m,
+                         const int8_t* weight,
+                         const float* scale,
+                         int64_t scale_stride,
+                         int64_t k,
+                         int group_size,
+                         float* out,
+                         int64_t ldo);
+#endif
+
+// Returns the fastest dot function the CPU supports for the shape.
+WeightOnlyDotFunc GetWeightOnlyDotFunc(int bits, int64_t k, int group_size);
+
+// Dequantizes the channels [begin, end) of the weights into the rows of out,
+// which is of shape [end - begin, k].
+void WeightOnlyDequantRows(const int8_t* weight,
+                           const float* scale,
+                           int64_t n,
+                           int64_t k,
+                           int bits,
+                           int group_size,
+                           int64_t begin,
+                           int64_t end,
+                           float* out);
+
+}  // namespace funcs
+}  // namespace phi
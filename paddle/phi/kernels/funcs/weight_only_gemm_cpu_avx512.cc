@@ -0,0 +1,108 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <immintrin.h>
+
+#include "paddle/phi/kernels/funcs/weight_only_gemm_cpu.h"
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+// Loads the 16 weights from j on as floats.
+template <int bits>
+inline __m512 LoadWeights(const int8_t* weight, int64_t j) {
+  __m512i w;
+  if (bits == 8) {
+    w = _mm512_cvtepi8_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(weight + j)));
+  } else {
+    // Interleave the low and high nibbles of the 8 bytes, then shift each
+    // nibble to the top of its lane and back to sign extend it.
+    const __m128i packed =
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(weight + j / 2));
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i lo = _mm_and_si128(packed, mask);
+    const __m128i hi = _mm_and_si128(_mm_srli_epi16(packed, 4), mask);
+    w = _mm512_cvtepu8_epi32(_mm_unpacklo_epi8(lo, hi));
+    w = _mm512_srai_epi32(_mm512_slli_epi32(w, 28), 28);
+  }
+  return _mm512_cvtepi32_ps(w);
+}
+
+}  // namespace
+
+template <int bits>
+void WeightOnlyDotAVX512(const float* x,
+                         int64_t ldx,
+                         int m,
+                         const int8_t* weight,
+                         const float* scale,
+                         int64_t scale_stride,
+                         int64_t k,
+                         int group_size,
+                         float* out,
+                         int64_t ldo) {
+  const int64_t group = group_size > 0 ? group_size : k;
+  __m512 acc[kWeightOnlyDotMaxRows];
+  for (int i = 0; i < m; ++i) {
+    acc[i] = _mm512_setzero_ps();
+  }
+  for (int64_t begin = 0; begin < k; begin += group) {
+    const int64_t end = begin + group < k ? begin + group : k;
+    __m512 group_acc[kWeightOnlyDotMaxRows];
+    for (int i = 0; i < m; ++i) {
+      group_acc[i] = _mm512_setzero_ps();
+    }
+    for (int64_t j = begin; j < end; j += 16) {
+      const __m512 w = LoadWeights<bits>(weight, j);
+      for (int i = 0; i < m; ++i) {
+        group_acc[i] =
+            _mm512_fmadd_ps(_mm512_loadu_ps(x + i * ldx + j), w, group_acc[i]);
+      }
+    }
+    const __m512 s = _mm512_set1_ps(scale[(begin / group) * scale_stride]);
+    for (int i = 0; i < m; ++i) {
+      acc[i] = _mm512_fmadd_ps(group_acc[i], s, acc[i]);
+    }
+  }
+  for (int i = 0; i < m; ++i) {
+    out[i * ldo] = _mm512_reduce_add_ps(acc[i]);
+  }
+}
+
+template void WeightOnlyDotAVX512<8>(const float*,
+                                     int64_t,
+                                     int,
+                                     const int8_t*,
+                                     const float*,
+                                     int64_t,
+                                     int64_t,
+                                     int,
+                                     float*,
+                                     int64_t);
+template void WeightOnlyDotAVX512<4>(const float*,
+                                     int64_t,
+                                     int,
+                                     const int8_t*,
+                                     const float*,
+                                     int64_t,
+                                     int64_t,
+                                     int,
+                                     float*,
+                                     int64_t);
+
+}  // namespace funcs
+}  // namespace phi
@@ -18,6 +18,7 @@
 #include <string>
 #include <vector>
 
+#include "paddle/common/flags.h"
 #include "paddle/phi/core/extended_tensor.h"
 #include "paddle/phi/core/framework/convert_utils.h"
 #include "paddle/phi/core/framework/data_type_transform.h"
@@ -29,6 +30,8 @@
 #include "paddle/phi/core/tensor_utils.h"
 #include "paddle/phi/core/vocab/string_array.h"
 
+COMMON_DECLARE_bool(load_params_with_mmap);
+
 namespace phi {
 
 template <typename T, typename Context>
@@ -81,6 +84,50 @@ void LoadParamsFromBuffer(const Context& dev_ctx,
                         "load_combine_op, please use load_op instead."));
 }
 
+#ifndef _WIN32
+// The CPU tensors alias the copy-on-write mapping of the params file instead
+// of holding a copy, see DeserializeFromMappedFile.
+inline void LoadParamsFromMappedFile(
+    const phi::Place& place,
+    const std::string& file_path,
+    bool load_as_fp16,
+    const std::vector<phi::DenseTensor*>& out) {
+  auto file =
+      paddle::memory::allocation::AllocateMappedFileAllocation(file_path);
+  size_t offset = 0;
+  for (size_t i = 0; i < out.size(); i++) {
+    PADDLE_ENFORCE_NOT_NULL(
+        out[i],
+        common::errors::InvalidArgument(
+            "The variable index %d to be loaded cannot be found.", i));
+    phi::DenseTensor* tensor = out[i];
+    DeserializeFromMappedFile(file, &offset, tensor);
+    auto in_dtype = tensor->dtype();
+    auto out_dtype = load_as_fp16 ? phi::DataType::FLOAT16 : in_dtype;
+    if (in_dtype != out_dtype) {
+      // convert to float16 tensor
+      auto in_kernel_type =
+          phi::KernelKey(place, phi::DataLayout::ALL_LAYOUT, in_dtype);
+      auto out_kernel_type =
+          phi::KernelKey(place, phi::DataLayout::ALL_LAYOUT, out_dtype);
+      phi::DenseTensor fp16_tensor;
+      // copy LoD info to the new tensor
+      fp16_tensor.set_lod(tensor->lod());
+      TransDataType(in_kernel_type, out_kernel_type, *tensor, &fp16_tensor);
+
+      // reset output tensor
+      tensor->set_lod(fp16_tensor.lod());
+      tensor->ShareDataWith(fp16_tensor);
+    }
+  }
+  PADDLE_ENFORCE_EQ(offset,
+                    file->size(),
+                    common::errors::Unavailable(
+                        "Not allowed to load partial data via "
+                        "load_combine_op, please use load_op instead."));
+}
+#endif
+
 template <typename T, typename Context>
 void LoadParamsFromBuffer(const Context& dev_ctx,
                           const phi::Place& place,
@@ -213,6 +260,13 @@ void LoadCombineKernel(const Context& dev_ctx,
   auto filename = file_path;
   auto out_var_names = out;
 
+#ifndef _WIN32
+  if (!model_from_memory && FLAGS_load_params_with_mmap &&
+      phi::is_cpu_place(place)) {
+    LoadParamsFromMappedFile(place, filename, load_as_fp16, out);
+    return;
+  }
+#endif
   if (!model_from_memory) {
     std::ifstream fin(filename, std::ios::binary);
     PADDLE_ENFORCE_EQ(
@@ -16,37 +16,61 @@ limitations under the License. */
 
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/empty_kernel.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/sparse/matmul_grad_kernel.h"
 
 namespace phi::sparse {
 
 template <typename T, typename Context>
-void AddmmCooDenseGradKernel(const Context& dev_ctx UNUSED,
-                             const DenseTensor& input UNUSED,
-                             const SparseCooTensor& x UNUSED,
-                             const DenseTensor& y UNUSED,
-                             const DenseTensor& dout UNUSED,
-                             float alpha UNUSED,
-                             float beta UNUSED,
-                             DenseTensor* dinput UNUSED,
-                             SparseCooTensor* dx UNUSED,
-                             DenseTensor* dy UNUSED) {
-  PADDLE_THROW(common::errors::Unimplemented(
-      "Not support CPU backward kernel of 'sparse.addmm' now."));
+void AddmmCooDenseGradKernel(const Context& dev_ctx,
+                             const DenseTensor& input,
+                             const SparseCooTensor& x,
+                             const DenseTensor& y,
+                             const DenseTensor& dout,
+                             float alpha,
+                             float beta,
+                             DenseTensor* dinput,
+                             SparseCooTensor* dx,
+                             DenseTensor* dy) {
+  auto blas = funcs::GetBlas<Context, T>(dev_ctx);
+  if (dinput) {
+    dinput->Resize(input.dims());
+    dev_ctx.template Alloc<T>(dinput);
+
+    blas.VCOPY(input.numel(), dout.data<T>(), dinput->data<T>());
+    blas.SCAL(input.numel(), beta, dinput->data<T>());
+  }
+  DenseTensor dout_scale = phi::EmptyLike<T, Context>(dev_ctx, dout);
+  blas.VCOPY(dout.numel(), dout.data<T>(), dout_scale.data<T>());
+  blas.SCAL(dout.numel(), alpha, dout_scale.data<T>());
+  MatmulCooDenseGradKernel<T, Context>(dev_ctx, x, y, dout_scale, dx, dy);
 }
 
+// Backward of "DENSE + CSR @ DENSE -> DENSE"
 template <typename T, typename Context>
-void AddmmCsrDenseGradKernel(const Context& dev_ctx UNUSED,
-                             const DenseTensor& input UNUSED,
-                             const SparseCsrTensor& x UNUSED,
-                             const DenseTensor& y UNUSED,
-                             const DenseTensor& dout UNUSED,
-                             float alpha UNUSED,
-                             float beta UNUSED,
-                             DenseTensor* dinput UNUSED,
-                             SparseCsrTensor* dx UNUSED,
-                             DenseTensor* dy UNUSED) {
-  PADDLE_THROW(common::errors::Unimplemented(
-      "Not support CPU backward kernel of 'sparse.addmm' now."));
+void AddmmCsrDenseGradKernel(const Context& dev_ctx,
+                             const DenseTensor& input,
+                             const SparseCsrTensor& x,
+                             const DenseTensor& y,
+                             const DenseTensor& dout,
+                             float alpha,
+                             float beta,
+                             DenseTensor* dinput,
+                             SparseCsrTensor* dx,
+                             DenseTensor* dy) {
+  auto blas = funcs::GetBlas<Context, T>(dev_ctx);
+  if (dinput) {
+    dinput->Resize(input.dims());
+    dev_ctx.template Alloc<T>(dinput);
+
+    blas.VCOPY(input.numel(), dout.data<T>(), dinput->data<T>());
+    blas.SCAL(input.numel(), beta, dinput->data<T>());
+  }
+  DenseTensor dout_scale = phi::EmptyLike<T, Context>(dev_ctx, dout);
+  blas.VCOPY(dout.numel(), dout.data<T>(), dout_scale.data<T>());
+  blas.SCAL(dout.numel(), alpha, dout_scale.data<T>());
+  MatmulCsrDenseGradKernel<T, Context>(dev_ctx, x, y, dout_scale, dx, dy);
 }
 
 }  // namespace phi::sparse
@@ -14,30 +14,211 @@ limitations under the License. */
 
 #include "paddle/phi/kernels/sparse/matmul_kernel.h"
 
+#include <vector>
+
+#include "paddle/common/ddim.h"
 #include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/enforce.h"
 #include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/core/meta_tensor.h"
+#include "paddle/phi/kernels/funcs/sparse/sparse_blas.h"
+#include "paddle/phi/kernels/sparse/empty_kernel.h"
+#include "paddle/phi/kernels/sparse/sparse_utils_kernel.h"
 
 namespace phi::sparse {
 
-// TODO(zhouwei25): implement CPU kernel of " CSR @ DENSE -> DENSE"
+template <typename T, typename Context, typename TensorType>
+void MatmulKernelImpl(const Context& dev_ctx,
+                      const TensorType& x,
+                      const DenseTensor& y,
+                      DenseTensor* out) {
+  std::vector<int64_t> xdim_vec = common::vectorize(x.dims());
+  std::vector<int64_t> ydim_vec = common::vectorize(y.dims());
+  auto x_ndims = xdim_vec.size();
+  auto y_ndims = ydim_vec.size();
+  PADDLE_ENFORCE_EQ(x_ndims,
+                    y_ndims,
+                    common::errors::PreconditionNotMet(
+                        "The dims size of Input(x) and Input(y) "
+                        "should be equal, But received X's "
+                        "dimensions=%d, Y's dimensions=%d.",
+                        x_ndims,
+                        y_ndims));
+  PADDLE_ENFORCE_GE(
+      x_ndims,
+      2,
+      common::errors::InvalidArgument("the dims size of Input(x) and "
+                                      "Input(y) must be greater than "
+                                      "or equal to 2."));
+
+  for (size_t i = 0; i < x_ndims - 2; ++i) {
+    PADDLE_ENFORCE_EQ(xdim_vec[i],
+                      ydim_vec[i],
+                      common::errors::InvalidArgument(
+                          "x.dim[%d] and x.dim[%d] must be eaqul.", i, i));
+  }
+
+  PADDLE_ENFORCE_EQ(
+      xdim_vec[x_ndims - 1],
+      ydim_vec[y_ndims - 2],
+      common::errors::PreconditionNotMet(
+          "The shape of Input(x) and Input(y) is not suitable for matmul "
+          "opetation, x_dim[-1] must be equal to y_dim[-2]."));
+
+  // InferMeta of DenseTensor 'out'
+  std::vector<int64_t> out_dim_vec(ydim_vec);
+  out_dim_vec[y_ndims - 2] = xdim_vec[x_ndims - 2];
+  out_dim_vec[y_ndims - 1] = ydim_vec[y_ndims - 1];
+  MetaTensor meta_out(out);
+  meta_out.set_dims(common::make_ddim(out_dim_vec));
+  meta_out.set_dtype(y.dtype());
+
+  dev_ctx.template Alloc<T>(out);
+
+  auto sparse_blas = phi::funcs::sparse::GetSparseBlas<Context, T>(dev_ctx);
+  sparse_blas.SPMM(
+      false, false, static_cast<T>(1), x, y, static_cast<T>(0), out);
+}
+
+template <typename T, typename Context>
+void MatmulCooDenseKernel(const Context& dev_ctx,
+                          const SparseCooTensor& x,
+                          const DenseTensor& y,
+                          DenseTensor* out) {
+  MatmulKernelImpl<T>(dev_ctx, x, y, out);
+}
+
 template <typename T, typename Context>
-void MatmulCsrDenseKernel(const Context& dev_ctx UNUSED,
-                          const SparseCsrTensor& x UNUSED,
-                          const DenseTensor& y UNUSED,
-                          DenseTensor* out UNUSED) {
-  PADDLE_THROW(common::errors::Unimplemented(
-      "Not support CPU kernel of 'sparse.matmul' now."));
+void MatmulCsrDenseKernel(const Context& dev_ctx,
+                          const SparseCsrTensor& x,
+                          const DenseTensor& y,
+                          DenseTensor* out) {
+  MatmulKernelImpl<T>(dev_ctx, x, y, out);
 }
 
-// TODO(zhouwei25): implement CPU kernel of " DENSE @ DENSE * CSR_MASK -> CSR"
 template <typename T, typename Context>
-void MaskedMatmulCsrKernel(const Context& dev_ctx UNUSED,
-                           const DenseTensor& x UNUSED,
-                           const DenseTensor& y UNUSED,
-                           const SparseCsrTensor& mask UNUSED,
-                           SparseCsrTensor* out UNUSED) {
-  PADDLE_THROW(common::errors::Unimplemented(
-      "Not support CPU kernel of 'sparse.masked_matmul' now."));
+void MatmulCsrCsrKernel(const Context& dev_ctx,
+                        const SparseCsrTensor& x,
+                        const SparseCsrTensor& y,
+                        SparseCsrTensor* out) {
+  std::vector<int64_t> xdim_vec = common::vectorize(x.dims());
+  std::vector<int64_t> ydim_vec = common::vectorize(y.dims());
+  auto x_ndims = xdim_vec.size();
+  auto y_ndims = ydim_vec.size();
+  PADDLE_ENFORCE_EQ(x_ndims,
+                    y_ndims,
+                    common::errors::PreconditionNotMet(
+                        "The dims size of Input(x) and Input(y) "
+                        "should be equal, But received X's "
+                        "dimensions=%d, Y's dimensions=%d.",
+                        x_ndims,
+                        y_ndims));
+  PADDLE_ENFORCE_GE(
+      x_ndims,
+      2,
+      common::errors::InvalidArgument("the dims size of Input(x) and "
+                                      "Input(y) must be greater than "
+                                      "or equal to 2."));
+
+  for (size_t i = 0; i < x_ndims - 2; ++i) {
+    PADDLE_ENFORCE_EQ(xdim_vec[i],
+                      ydim_vec[i],
+                      common::errors::InvalidArgument(
+                          "x.dim[%d] and x.dim[%d] must be eaqul.", i, i));
+  }
+
+  auto sparse_blas = phi::funcs::sparse::GetSparseBlas<Context, T>(dev_ctx);
+  sparse_blas.SPGEMM(
+      false, false, static_cast<T>(1), x, y, static_cast<T>(0), out);
+}
+
+template <typename T, typename Context>
+void MatmulCooCooKernel(const Context& dev_ctx,
+                        const SparseCooTensor& x,
+                        const SparseCooTensor& y,
+                        SparseCooTensor* out) {
+  SparseCsrTensor x_csr = CooToCsr<T, Context>(dev_ctx, x);
+  SparseCsrTensor y_csr = CooToCsr<T, Context>(dev_ctx, y);
+  SparseCsrTensor out_csr;
+  MatmulCsrCsrKernel<T>(dev_ctx, x_csr, y_csr, &out_csr);
+  CsrToCooKernel<T>(dev_ctx, out_csr, out);
+}
+
+template <typename T, typename Context>
+void MaskedMatmulCsrKernel(const Context& dev_ctx,
+                           const DenseTensor& x,
+                           const DenseTensor& y,
+                           const SparseCsrTensor& mask,
+                           SparseCsrTensor* out) {
+  std::vector<int64_t> xdim_vec = common::vectorize(x.dims());
+  std::vector<int64_t> ydim_vec = common::vectorize(y.dims());
+  std::vector<int64_t> maskdim_vec = common::vectorize(mask.dims());
+
+  auto x_ndims = xdim_vec.size();
+  auto y_ndims = ydim_vec.size();
+  auto mask_ndims = maskdim_vec.size();
+
+  PADDLE_ENFORCE_EQ(x_ndims,
+                    y_ndims,
+                    common::errors::PreconditionNotMet(
+                        "The dims size of Input(x) and Input(y) "
+                        "should be equal, But received X's "
+                        "dimensions=%d, Y's dimensions=%d.",
+                        x_ndims,
+                        y_ndims));
+  PADDLE_ENFORCE_EQ(x_ndims,
+                    mask_ndims,
+                    common::errors::PreconditionNotMet(
+                        "The dims size of Input(x) and Input(mask) "
+                        "should be equal, But received X's "
+                        "dimensions=%d, mask's dimensions=%d.",
+                        x_ndims,
+                        mask_ndims));
+  PADDLE_ENFORCE_GE(
+      x_ndims,
+      2,
+      common::errors::InvalidArgument("the dims size of Input(x) and "
+                                      "Input(y) must be greater than "
+                                      "or equal to 2."));
+
+  for (size_t i = 0; i < x_ndims - 2; ++i) {
+    PADDLE_ENFORCE_EQ(xdim_vec[i],
+                      ydim_vec[i],
+                      common::errors::InvalidArgument(
+                          "x.dim[%d] and x.dim[%d] must match.", i, i));
+    PADDLE_ENFORCE_EQ(xdim_vec[i],
+                      maskdim_vec[i],
+                      common::errors::InvalidArgument(
+                          "x.dim[%d] and mask.dim[%d] must match.", i, i));
+  }
+
+  PADDLE_ENFORCE_EQ(
+      xdim_vec[x_ndims - 1],
+      ydim_vec[y_ndims - 2],
+      common::errors::PreconditionNotMet(
+          "The shape of Input(x) and Input(y) is not suitable for matmul "
+          "opetation, x_dim[-1] must be equal to y_dim[-2]."));
+
+  PADDLE_ENFORCE_EQ(
+      maskdim_vec[mask_ndims - 2],
+      xdim_vec[x_ndims - 2],
+      common::errors::PreconditionNotMet(
+          "The shape of Input(x) and Input(y) is not suitable for matmul "
+          "opetation, mask_dim[-2] must be equal to x_dim[-2]."));
+
+  PADDLE_ENFORCE_EQ(
+      maskdim_vec[mask_ndims - 1],
+      ydim_vec[y_ndims - 1],
+      common::errors::PreconditionNotMet(
+          "The shape of Input(x) and Input(y) is not suitable for matmul "
+          "opetation, mask_dim[-1] must be equal to y_dim[-1]."));
+
+  // InferMeta of SparseCsrTensor 'out', CreateLikeInferMeta
+  EmptyLikeCsrKernel<T, Context>(dev_ctx, mask, out);
+
+  auto sparse_blas = phi::funcs::sparse::GetSparseBlas<Context, T>(dev_ctx);
+  sparse_blas.SDDMM(
+      false, false, static_cast<T>(1), x, y, static_cast<T>(0), out);
 }
 
 }  // namespace phi::sparse
@@ -51,6 +232,35 @@ PD_REGISTER_KERNEL(matmul_csr_dense,
   kernel->InputAt(0).SetDataLayout(phi::DataLayout::SPARSE_CSR);
 }
 
+PD_REGISTER_KERNEL(matmul_coo_dense,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::sparse::MatmulCooDenseKernel,
+                   float,
+                   double) {
+  kernel->InputAt(0).SetDataLayout(phi::DataLayout::SPARSE_COO);
+}
+
+PD_REGISTER_KERNEL(matmul_coo_coo,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::sparse::MatmulCooCooKernel,
+                   float,
+                   double) {
+  kernel->InputAt(0).SetDataLayout(phi::DataLayout::SPARSE_COO);
+  kernel->InputAt(1).SetDataLayout(phi::DataLayout::SPARSE_COO);
+}
+
+PD_REGISTER_KERNEL(matmul_csr_csr,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::sparse::MatmulCsrCsrKernel,
+                   float,
+                   double) {
+  kernel->InputAt(0).SetDataLayout(phi::DataLayout::SPARSE_CSR);
+  kernel->InputAt(1).SetDataLayout(phi::DataLayout::SPARSE_CSR);
+}
+
 PD_REGISTER_KERNEL(masked_matmul_csr,
                    CPU,
                    ALL_LAYOUT,
@@ -95,9 +95,11 @@ class TestProcessGroupFp32(unittest.TestCase):
         broadcast_result = paddle.assign(tensor_x)
         if rank == 0:
             task = pg.broadcast(tensor_x, 0)
+            task.wait()
             np.testing.assert_array_equal(broadcast_result, tensor_x)
         else:
             task = pg.broadcast(tensor_y, 0)
+            task.wait()
             np.testing.assert_array_equal(broadcast_result, tensor_y)
         print("test broadcast api ok")
 
@@ -0,0 +1,116 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+from paddle.base import core
+
+
+class TestProcessGroupGlooShm(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        paddle.device.set_device('cpu')
+        nranks = paddle.distributed.ParallelEnv().nranks
+        cls.rank = paddle.distributed.ParallelEnv().local_rank
+        cls.store = core.TCPStore("127.0.0.1", 6273, cls.rank == 0, nranks, 30)
+        # The ranks are on one host, so the first group maps a shared memory
+        # segment, smaller than the tensors to reduce them in several rounds.
+        # The second one keeps the gloo transport.
+        paddle.set_flags({'FLAGS_gloo_shm_buffer_size': 4096})
+        cls.shm_pg = core.ProcessGroupGloo.create(
+            cls.store, cls.rank, nranks, 1
+        )
+        paddle.set_flags({'FLAGS_gloo_shm_buffer_size': 0})
+        cls.gloo_pg = core.ProcessGroupGloo.create(
+            cls.store, cls.rank, nranks, 2
+        )
+        paddle.set_flags({'FLAGS_gloo_shm_buffer_size': 4 << 20})
+
+    def allreduce(self, pg, x, dtype, op):
+        tensor = paddle.to_tensor(x).cast(dtype)
+        pg.allreduce(tensor, op).wait()
+        if dtype in ('float16', 'bfloat16'):
+            tensor = tensor.cast('float32')
+        return tensor.numpy()
+
+    def check(self, dtypes, ops):
+        # Both ranks draw the same numbers, each takes its own row.
+        rng = np.random.RandomState(2024)
+        for dtype in dtypes:
+            for op in ops:
+                if dtype in ('int8', 'uint8', 'int32', 'int64'):
+                    inputs = rng.randint(1, 4, (2, 3001))
+                else:
+                    inputs = rng.uniform(0.5, 1.5, (2, 3001))
+                x = inputs[self.rank]
+                shm_result = self.allreduce(self.shm_pg, x, dtype, op)
+                gloo_result = self.allreduce(self.gloo_pg, x, dtype, op)
+                if dtype in ('float16', 'bfloat16'):
+                    # one rounding of the half types may differ
+                    np.testing.assert_allclose(
+                        shm_result, gloo_result, rtol=1e-2
+                    )
+                else:
+                    np.testing.assert_array_equal(shm_result, gloo_result)
+
+    def test_allreduce(self):
+        self.check(
+            ['float32', 'float64', 'float16', 'bfloat16', 'int32', 'int64'],
+            [
+                core.ReduceOp.SUM,
+                core.ReduceOp.MAX,
+                core.ReduceOp.MIN,
+                core.ReduceOp.PRODUCT,
+            ],
+        )
+
+    def inputs(self, dtype):
+        # Both ranks draw the same numbers, each takes its own row.
+        rng = np.random.RandomState(2024)
+        return rng.uniform(0, 100, (2, 3001)).astype(dtype)
+
+    def test_broadcast(self):
+        for dtype in ['float32', 'float64', 'int32', 'int64', 'uint8']:
+            inputs = self.inputs(dtype)
+            for root in [0, 1]:
+                results = []
+                for pg in [self.shm_pg, self.gloo_pg]:
+                    tensor = paddle.to_tensor(inputs[self.rank])
+                    pg.broadcast(tensor, root).wait()
+                    results.append(tensor.numpy())
+                np.testing.assert_array_equal(results[0], inputs[root])
+                np.testing.assert_array_equal(results[0], results[1])
+
+    def test_all_gather(self):
+        for dtype in ['float32', 'float64', 'int32', 'int64', 'uint8']:
+            inputs = self.inputs(dtype)
+            results = []
+            for pg in [self.shm_pg, self.gloo_pg]:
+                tensor = paddle.to_tensor(inputs[self.rank])
+                out = paddle.zeros([2 * 3001], dtype=dtype)
+                pg.all_gather(tensor, out).wait()
+                results.append(out.numpy())
+            np.testing.assert_array_equal(results[0], inputs.reshape([-1]))
+            np.testing.assert_array_equal(results[0], results[1])
+
+    def test_allreduce_fallback(self):
+        # ShmComm::CanAllReduce is false, the shm group falls back to gloo
+        self.check(['int8', 'uint8'], [core.ReduceOp.SUM, core.ReduceOp.MAX])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -26,6 +26,14 @@ class TestProcessGroup(TestMultipleAccelerators):
     def test_process_group_gloo(self):
         self.run_mnist_2accelerators('process_group_gloo.py')
 
+    def test_process_group_gloo_async_comm(self):
+        self.run_mnist_2accelerators(
+            'process_group_gloo.py', need_envs={"FLAGS_gloo_async_comm": "1"}
+        )
+
+    def test_process_group_gloo_shm(self):
+        self.run_mnist_2accelerators('process_group_gloo_shm.py')
+
     def test_init_process_group(self):
         self.run_mnist_2accelerators('init_process_group.py')
 
@@ -33,6 +33,8 @@
 
 #include "paddle/phi/core/kernel_registry.h"
 
+COMMON_DECLARE_int32(eager_backward_thread_num);
+
 using namespace egr;            // NOLINT
 using namespace egr_utils_api;  // NOLINT
 
@@ -240,3 +242,58 @@ TEST(Benchmark, EagerIntermediateMLPCPU) {
     }
   }
 }
+
+TEST(Benchmark, EagerBranchyMLPCPU) {
+  // Prepare Device Contexts
+  eager_test::InitEnv(phi::CPUPlace());
+
+  auto tracer = std::make_shared<paddle::imperative::Tracer>();
+  paddle::imperative::SetCurrentTracer(tracer);
+
+  // 2 after 4 replaces the thread pool of the backward
+  for (int thread_num : {0, 4, 2}) {
+    FLAGS_eager_backward_thread_num = thread_num;
+    for (const std::string mode : {"Accuracy", "Performance"}) {
+      phi::DDim ddimX = common::make_ddim({BRANCHY_MLP_M, BRANCHY_MLP_N});
+      paddle::Tensor X =
+          eager_test::CreateTensorWithValue(ddimX,
+                                            phi::CPUPlace(),
+                                            phi::DataType::FLOAT32,
+                                            phi::DataLayout::NCHW,
+                                            BRANCHY_MLP_X_VAL,
+                                            true);
+      RetainGradForTensor(X);
+
+      std::vector<paddle::Tensor> Ws;
+      for (size_t i = 0; i < BRANCHY_MLP_NUM_TOWER * BRANCHY_MLP_DEPTH; i++) {
+        phi::DDim ddimW = common::make_ddim({BRANCHY_MLP_N, BRANCHY_MLP_N});
+        paddle::Tensor W =
+            eager_test::CreateTensorWithValue(ddimW,
+                                              phi::CPUPlace(),
+                                              phi::DataType::FLOAT32,
+                                              phi::DataLayout::NCHW,
+                                              BRANCHY_MLP_W_VAL,
+                                              true);
+        RetainGradForTensor(W);
+        Ws.emplace_back(std::move(W));
+      }
+
+      if (mode == "Accuracy") {
+        benchmark_eager_branchy_mlp(X, Ws, true /* accuracy_check */);
+
+      } else if (mode == "Performance") {
+        auto t_start = std::chrono::high_resolution_clock::now();
+        benchmark_eager_branchy_mlp(X, Ws);
+        auto t_end = std::chrono::high_resolution_clock::now();
+        double elapsed_time_ms =
+            std::chrono::duration<double, std::milli>(t_end - t_start).count();
+        std::cout << "Backward threads: " << thread_num
+                  << ", Duration: " << elapsed_time_ms << " ms" << std::endl;
+
+      } else {
+        PADDLE_THROW(common::errors::Fatal("Unknown benchmark mode"));
+      }
+    }
+  }
+  FLAGS_eager_backward_thread_num = 0;
+}
@@ -152,6 +152,35 @@ void benchmark_eager_intermediate_mlp(const paddle::Tensor& X,
   }
 }
 
+/* ------------------------------ */
+/* ---- Eager Branchy MLP ---- */
+/* ------------------------------ */
+void benchmark_eager_branchy_mlp(const paddle::Tensor& X,
+                                 const std::vector<paddle::Tensor>& Ws,
+                                 bool accuracy_check) {
+  paddle::Tensor Out;
+  for (size_t b = 0; b < BRANCHY_MLP_NUM_TOWER; b++) {
+    paddle::Tensor tower = X;
+    for (size_t i = 0; i < BRANCHY_MLP_DEPTH; i++) {
+      tower =
+          matmul_ad_func(tower, Ws[b * BRANCHY_MLP_DEPTH + i], false, false);
+    }
+    Out = b == 0 ? tower : add_ad_func(Out, tower);
+  }
+
+  std::vector<paddle::Tensor> target_tensors = {Out};
+  Backward(target_tensors, {});
+
+  if (accuracy_check) {
+    // The grad of every tower input and output is 1.0
+    eager_test::CompareTensorWithValue<float>(Out, BRANCHY_MLP_NUM_TOWER);
+    eager_test::CompareGradTensorWithValue<float>(X, BRANCHY_MLP_NUM_TOWER);
+    for (const auto& W : Ws) {
+      eager_test::CompareGradTensorWithValue<float>(W, BRANCHY_MLP_M);
+    }
+  }
+}
+
 }  // namespace egr
 
 namespace paddle {
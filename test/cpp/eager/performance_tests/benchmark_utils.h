@@ -32,6 +32,17 @@
 #define MLP_B_VAL 3.0
 #define MLP_NUM_LINEAR 1000
 
+/* Branchy MLP Configurations */
+// Tower_b = X[M, N] x W_b0[N, N] x ... x W_b(DEPTH-1)[N, N]
+// Out     = Tower_0 + ... + Tower_(NUM_TOWER-1)
+// W_VAL is 1 / N, so that every tower outputs X exactly.
+#define BRANCHY_MLP_M 64
+#define BRANCHY_MLP_N 64
+#define BRANCHY_MLP_X_VAL 1.0
+#define BRANCHY_MLP_W_VAL (1.0 / BRANCHY_MLP_N)
+#define BRANCHY_MLP_NUM_TOWER 8
+#define BRANCHY_MLP_DEPTH 50
+
 namespace egr {
 
 inline std::unordered_map<std::string, float> compute_mlp_expected_results() {
@@ -65,6 +76,12 @@ void benchmark_eager_intermediate_mlp(const paddle::Tensor& X,
                                       const std::vector<paddle::Tensor>& Bs,
                                       bool accuracy_check = false);
 
+/* ---- Eager Branchy MLP ---- */
+// Ws holds the weights of tower b at [b * DEPTH, (b + 1) * DEPTH).
+void benchmark_eager_branchy_mlp(const paddle::Tensor& X,
+                                 const std::vector<paddle::Tensor>& Ws,
+                                 bool accuracy_check = false);
+
 }  // namespace egr
 
 namespace paddle {
@@ -203,3 +203,45 @@ TEST(WorkQueue, TestWorkQueueGroup) {
   queue_group.reset();
   waiter_thread.join();
 }
+
+TEST(WorkQueue, TestWorkQueueGroupAddTasks) {
+  using paddle::framework::CreateWorkQueueGroup;
+  using paddle::framework::EventsWaiter;
+  using paddle::framework::WorkQueueOptions;
+  std::atomic<unsigned> counter{0};
+  constexpr unsigned kTaskNum = 1000;
+  EventsWaiter events_waiter;
+  WorkQueueOptions host_options(/*name*/ "HostTasks",
+                                /*num_threads*/ 4,
+                                /*allow_spinning*/ true,
+                                /*always_spinning*/ false,
+                                /*track_task*/ true,
+                                /*detached*/ true,
+                                &events_waiter);
+  WorkQueueOptions device_options(/*name*/ "DeviceKernelLaunch",
+                                  /*num_threads*/ 0,
+                                  /*allow_spinning*/ true,
+                                  /*always_spinning*/ false,
+                                  /*track_task*/ false,
+                                  /*detached*/ true,
+                                  &events_waiter);
+  auto queue_group = CreateWorkQueueGroup({host_options, device_options});
+  // AddTasks from an external thread, then from a worker thread
+  std::vector<std::function<void()>> fns;
+  for (unsigned i = 0; i < kTaskNum; ++i) {
+    fns.emplace_back([&counter]() { ++counter; });
+  }
+  fns.emplace_back([&counter, &queue_group]() {
+    std::vector<std::function<void()>> inner_fns;
+    for (unsigned i = 0; i < kTaskNum; ++i) {
+      inner_fns.emplace_back([&counter]() { ++counter; });
+    }
+    queue_group->AddTasks(0, &inner_fns);
+    EXPECT_TRUE(inner_fns.empty());
+  });
+  queue_group->AddTasks(0, &fns);
+  EXPECT_TRUE(fns.empty());
+  // WaitQueueGroupEmpty
+  EXPECT_EQ(events_waiter.WaitEvent(), paddle::framework::kQueueEmptyEvent);
+  EXPECT_EQ(counter.load(), 2 * kTaskNum);
+}
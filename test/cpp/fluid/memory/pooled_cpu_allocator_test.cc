@@ -0,0 +1,138 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _WIN32
+
+#include "paddle/phi/core/memory/allocation/pooled_cpu_allocator.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+TEST(PooledCPUAllocator, size_class) {
+  for (size_t size : {1UL, 63UL, 64UL, 65UL, 1000UL, 1024UL, 1025UL, 2048UL,
+                      2049UL, 300000UL, 1UL << 30}) {
+    size_t index = PooledCPUAllocator::SizeClassIndex(size);
+    size_t class_size = PooledCPUAllocator::SizeClassSize(index);
+    EXPECT_GE(class_size, size);
+    EXPECT_EQ(class_size % PooledCPUAllocator::kAlignment, 0UL);
+    // The size class wastes at most a quarter of the request above 1KB.
+    if (size > 1024) {
+      EXPECT_LE(class_size, size + size / 4);
+    }
+    if (index > 0) {
+      EXPECT_LT(PooledCPUAllocator::SizeClassSize(index - 1), size);
+    }
+  }
+}
+
+TEST(PooledCPUAllocator, reuse) {
+  PooledCPUAllocator allocator(/*numa_aware=*/false, /*use_huge_page=*/false);
+  for (size_t size : {100UL, 4096UL, 1UL << 20, (1UL << 33) / 1024}) {
+    void* first = nullptr;
+    {
+      auto allocation = allocator.Allocate(size);
+      ASSERT_NE(allocation->ptr(), nullptr);
+      EXPECT_GE(allocation->size(), size);
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(allocation->ptr()) %
+                    PooledCPUAllocator::kAlignment,
+                0UL);
+      std::memset(allocation->ptr(), 1, size);
+      first = allocation->ptr();
+    }
+    auto allocation = allocator.Allocate(size);
+    EXPECT_EQ(allocation->ptr(), first);
+  }
+}
+
+TEST(PooledCPUAllocator, multi_thread) {
+  PooledCPUAllocator allocator(/*numa_aware=*/true, /*use_huge_page=*/true);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&allocator, t] {
+      std::vector<AllocationPtr> allocations;
+      for (int i = 0; i < 1000; ++i) {
+        size_t size = 64 * (1 + (i * (t + 1)) % 300);
+        allocations.emplace_back(allocator.Allocate(size));
+        std::memset(allocations.back()->ptr(), t, size);
+        if (i % 3 == 0) {
+          allocations.erase(allocations.begin());
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  allocator.Release(phi::CPUPlace());
+}
+
+TEST(PooledCPUAllocator, release) {
+  PooledCPUAllocator allocator(/*numa_aware=*/false, /*use_huge_page=*/false);
+  {
+    auto large = allocator.Allocate(4UL << 20);
+    std::vector<AllocationPtr> small;
+    for (int i = 0; i < 100; ++i) {
+      small.emplace_back(allocator.Allocate(1024));
+    }
+  }
+  EXPECT_GT(allocator.Release(phi::CPUPlace()), 0UL);
+  EXPECT_EQ(allocator.Release(phi::CPUPlace()), 0UL);
+}
+
+TEST(PooledCPUAllocator, max_idle_bytes) {
+  constexpr size_t kMaxIdleBytes = 8UL << 20;
+  PooledCPUAllocator allocator(
+      /*numa_aware=*/false, /*use_huge_page=*/false, kMaxIdleBytes);
+  // Large blocks beyond the limit are unmapped when they are freed.
+  {
+    std::vector<AllocationPtr> large;
+    for (int i = 0; i < 16; ++i) {
+      large.emplace_back(allocator.Allocate(1UL << 20));
+    }
+  }
+  EXPECT_LE(allocator.IdleBytes(), kMaxIdleBytes);
+
+  // The slabs of a size class no longer used are trimmed, and do not stay
+  // reserved until Release.
+  for (size_t size : {2048UL, 4096UL, 8192UL, 16384UL}) {
+    std::vector<AllocationPtr> small;
+    for (int i = 0; i < 2048; ++i) {
+      small.emplace_back(allocator.Allocate(size));
+    }
+  }
+  EXPECT_LE(allocator.IdleBytes(), 2 * kMaxIdleBytes);
+
+  // Without a limit the free memory is kept.
+  PooledCPUAllocator unlimited(/*numa_aware=*/false, /*use_huge_page=*/false);
+  {
+    std::vector<AllocationPtr> large;
+    for (int i = 0; i < 16; ++i) {
+      large.emplace_back(unlimited.Allocate(1UL << 20));
+    }
+  }
+  EXPECT_GT(unlimited.IdleBytes(), kMaxIdleBytes);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
+
+#endif
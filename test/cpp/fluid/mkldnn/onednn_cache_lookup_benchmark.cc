@@ -0,0 +1,220 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmark of the lookups of the oneDNN blob cache, as a handler does
+// them for each kernel call: the string keys of the BlobMap, the hashed keys
+// falling back to the BlobMap, and the hashed keys found in the cache of an
+// instruction. The results are written as one JSON object per line. ctest
+// does not run it, it is run by hand, e.g.
+//
+//   onednn_cache_lookup_benchmark --bench_num_handlers=256 \
+//       --bench_threads=1,4,8 --bench_output=/tmp/bench.jsonl
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "paddle/common/flags.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/backends/onednn/onednn_context.h"
+#include "paddle/phi/backends/onednn/onednn_helper.h"
+#include "paddle/phi/common/place.h"
+
+PD_DEFINE_int32(bench_num_handlers,
+                64,
+                "The number of the handlers, i.e. the base keys, cached.");
+PD_DEFINE_int32(bench_repeat,
+                2000,
+                "The kernel calls of each handler per thread.");
+PD_DEFINE_string(bench_threads,
+                 "1,4",
+                 "The comma separated numbers of the looking up threads.");
+PD_DEFINE_string(bench_output,
+                 "",
+                 "The file the results are appended to, or stdout if empty.");
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+// The blobs a forward handler gets in a kernel call
+const std::vector<std::string> kSuffixes = {
+    "@fwd_pd", "@src_mem_p", "@dst_mem_p", "@fwd_p"};
+
+void Report(const std::string& line) {
+  if (FLAGS_bench_output.empty()) {
+    std::cout << line << std::endl;
+  } else {
+    std::ofstream out(FLAGS_bench_output, std::ios::app);
+    out << line << std::endl;
+  }
+}
+
+std::vector<int> ParseThreads() {
+  std::vector<int> threads;
+  std::stringstream ss(FLAGS_bench_threads);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (!item.empty()) threads.push_back(std::stoi(item));
+  }
+  return threads;
+}
+
+OneDNNContext* GetContext() {
+  auto& pool = DeviceContextPool::Instance();
+  return static_cast<OneDNNContext*>(pool.Get(CPUPlace()));
+}
+
+// A base key like the one of a conv2d handler
+std::string BaseKey(const OneDNNContext& dev_ctx, int handler) {
+  std::vector<int64_t> src_tz = {8, 64, 56, 56};
+  std::vector<int64_t> weights_tz = {64, 64, 3, 3};
+  return ExtendKeyWithThreadInfoIfNeeded(
+      dev_ctx,
+      CreateKey(dev_ctx,
+                src_tz,
+                weights_tz,
+                "conv2d_input_" + std::to_string(handler),
+                OneDNNGetDataType<float>()));
+}
+
+// Runs the kernel calls of all the handlers, and returns the number of the
+// blobs found.
+int64_t LookupStrings(const OneDNNContext& dev_ctx,
+                      const std::vector<std::string>& base_keys) {
+  int64_t found = 0;
+  for (int r = 0; r < FLAGS_bench_repeat; ++r) {
+    for (auto& base_key : base_keys) {
+      for (auto& suffix : kSuffixes) {
+        found += dev_ctx.GetBlob(base_key + suffix) != nullptr;
+      }
+    }
+  }
+  return found;
+}
+
+int64_t LookupHashed(const OneDNNContext& dev_ctx,
+                     const std::vector<std::string>& base_keys) {
+  int64_t found = 0;
+  for (int r = 0; r < FLAGS_bench_repeat; ++r) {
+    for (auto& base_key : base_keys) {
+      // A handler hashes its base key once in the constructor.
+      OneDNNBlobKey key(base_key);
+      for (auto& suffix : kSuffixes) {
+        found += dev_ctx.GetBlob(key.With(suffix)) != nullptr;
+      }
+    }
+  }
+  return found;
+}
+
+int64_t LookupInstruction(const OneDNNContext& dev_ctx,
+                          const std::vector<std::string>& base_keys) {
+  // An instruction of each handler, bound as the executor runs it
+  std::vector<OneDNNInstructionCache> caches(base_keys.size());
+  int64_t found = 0;
+  for (int r = 0; r < FLAGS_bench_repeat; ++r) {
+    for (size_t i = 0; i < base_keys.size(); ++i) {
+      OneDNNInstructionCacheGuard guard(&caches[i], 0);
+      OneDNNBlobKey key(base_keys[i]);
+      for (auto& suffix : kSuffixes) {
+        found += dev_ctx.GetBlob(key.With(suffix)) != nullptr;
+      }
+    }
+  }
+  return found;
+}
+
+using LookupFn = int64_t (*)(const OneDNNContext&,
+                             const std::vector<std::string>&);
+
+void RunBenchmark(const std::string& mode, LookupFn lookup) {
+  OneDNNContext* dev_ctx = GetContext();
+  for (int num_threads : ParseThreads()) {
+    dev_ctx->ResetBlobMap(nullptr);
+    // The keys of the threads differ if the thread id is in the keys, so
+    // each thread sets its own blobs.
+    std::vector<int64_t> found(num_threads, 0);
+    std::vector<double> seconds(num_threads, 0);
+    std::vector<std::thread> threads;
+    std::atomic<int> num_done(0);
+    for (int t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&, t] {
+        std::vector<std::string> base_keys;
+        for (int h = 0; h < FLAGS_bench_num_handlers; ++h) {
+          base_keys.push_back(BaseKey(*dev_ctx, h));
+          for (auto& suffix : kSuffixes) {
+            dev_ctx->SetBlob(base_keys.back() + suffix,
+                             std::make_shared<int>(h));
+          }
+        }
+        auto start = std::chrono::steady_clock::now();
+        found[t] = lookup(*dev_ctx, base_keys);
+        seconds[t] = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+        // The thread locals of a thread clear the BlobMap when it exits.
+        ++num_done;
+        while (num_done < num_threads) {
+          std::this_thread::yield();
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    int64_t lookups = static_cast<int64_t>(FLAGS_bench_repeat) *
+                      FLAGS_bench_num_handlers * kSuffixes.size();
+    double max_seconds = 0;
+    for (int t = 0; t < num_threads; ++t) {
+      EXPECT_EQ(found[t], lookups);
+      max_seconds = std::max(max_seconds, seconds[t]);
+    }
+    std::stringstream line;
+    line << "{\"mode\": \"" << mode
+         << "\", \"handlers\": " << FLAGS_bench_num_handlers
+         << ", \"threads\": " << num_threads << ", \"lookups\": " << lookups
+         << ", \"ns_per_lookup\": " << max_seconds * 1e9 / lookups << "}";
+    Report(line.str());
+  }
+  dev_ctx->ResetBlobMap(nullptr);
+}
+
+}  // namespace
+
+TEST(OneDNNCacheLookupBenchmark, string_key) {
+  RunBenchmark("string_key", LookupStrings);
+}
+
+TEST(OneDNNCacheLookupBenchmark, hashed_key) {
+  RunBenchmark("hashed_key", LookupHashed);
+}
+
+TEST(OneDNNCacheLookupBenchmark, instruction_cache) {
+  RunBenchmark("instruction_cache", LookupInstruction);
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,248 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle/common/flags.h"
+#include "paddle/fluid/framework/new_executor/interpretercore.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_type.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/transforms/pd_op_to_kernel_pass.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/backends/onednn/onednn_context.h"
+#include "paddle/phi/backends/onednn/onednn_helper.h"
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/pir/include/core/builder.h"
+#include "paddle/pir/include/core/builtin_op.h"
+#include "paddle/pir/include/core/ir_context.h"
+#include "paddle/pir/include/core/program.h"
+
+COMMON_DECLARE_bool(use_mkldnn);
+
+PD_DECLARE_KERNEL(full, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(full_like, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(conv2d, OneDNN, ONEDNN);
+PD_DECLARE_KERNEL(conv2d_grad, OneDNN, ONEDNN);
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+OneDNNContext* GetContext() {
+  auto& pool = DeviceContextPool::Instance();
+  return static_cast<OneDNNContext*>(pool.Get(CPUPlace()));
+}
+
+DenseTensor MakeTensor(const std::vector<int64_t>& dims, float value) {
+  DenseTensor tensor;
+  tensor.Resize(common::make_ddim(dims));
+  float* data = GetContext()->Alloc<float>(&tensor);
+  for (int64_t i = 0; i < tensor.numel(); ++i) {
+    data[i] = value;
+  }
+  return tensor;
+}
+
+}  // namespace
+
+TEST(OneDNNBlobKey, hash) {
+  std::string base = "conv2d_input_0";
+  OneDNNBlobKey key(base);
+  // Extending the key suffix by suffix hashes the same as the whole name.
+  auto target = key.With("@weights").With("_target");
+  std::string name = base + "@weights_target";
+  EXPECT_EQ(target.name(), name);
+  EXPECT_EQ(target.hash(), OneDNNBlobKey(name).hash());
+  EXPECT_NE(target.hash(), key.With("@weights").With("_user").hash());
+}
+
+TEST(OneDNNInstructionCache, input_shape_key) {
+  DenseTensor x = MakeTensor({2, 3}, 1.0f);
+  DenseTensor y = MakeTensor({3, 2}, 1.0f);
+  DenseTensor z = MakeTensor({2, 3}, 2.0f);
+  // The key depends on the metas of the inputs, not on their data.
+  EXPECT_EQ(CreateInputShapeKey({&x}), CreateInputShapeKey({&z}));
+  EXPECT_NE(CreateInputShapeKey({&x}), CreateInputShapeKey({&y}));
+  EXPECT_NE(CreateInputShapeKey({&x, nullptr}), CreateInputShapeKey({&x}));
+  EXPECT_NE(CreateInputShapeKey({&x, nullptr}),
+            CreateInputShapeKey({nullptr, &x}));
+}
+
+TEST(OneDNNInstructionCache, eviction) {
+  OneDNNContext* dev_ctx = GetContext();
+  dev_ctx->ResetBlobMap(nullptr);
+  OneDNNBlobKey key("conv2d_input_0@fwd_pd");
+  // An instruction keeps the blobs of each input shapes.
+  OneDNNInstructionCache cache(2);
+  {
+    OneDNNInstructionCacheGuard guard(&cache, 1);
+    dev_ctx->SetBlob(key, std::make_shared<int>(1));
+  }
+  EXPECT_EQ(OneDNNContext::tls().get_instruction_cache(), nullptr);
+  {
+    OneDNNInstructionCacheGuard guard(&cache, 2);
+    EXPECT_NE(dev_ctx->GetBlob(key), nullptr);
+  }
+  EXPECT_EQ(cache.size(), 2UL);
+
+  // The blob is found in the instruction cache without the BlobMap.
+  dev_ctx->ResetBlobMap(nullptr);
+  {
+    OneDNNInstructionCacheGuard guard(&cache, 1);
+    EXPECT_EQ(*std::static_pointer_cast<int>(dev_ctx->GetBlob(key)), 1);
+  }
+  EXPECT_EQ(dev_ctx->GetBlob(key.name()), nullptr);
+
+  // A new shape drops the least recently used one, 2, and keeps 1.
+  {
+    OneDNNInstructionCacheGuard guard(&cache, 3);
+    EXPECT_EQ(dev_ctx->GetBlob(key), nullptr);
+  }
+  EXPECT_EQ(cache.size(), 2UL);
+  {
+    OneDNNInstructionCacheGuard guard(&cache, 1);
+    EXPECT_NE(dev_ctx->GetBlob(key), nullptr);
+  }
+  {
+    OneDNNInstructionCacheGuard guard(&cache, 2);
+    EXPECT_EQ(dev_ctx->GetBlob(key), nullptr);
+  }
+  EXPECT_EQ(cache.size(), 2UL);
+  dev_ctx->ResetBlobMap(nullptr);
+}
+
+TEST(OneDNNInstructionCache, shared_blob_map) {
+  OneDNNContext* dev_ctx = GetContext();
+  dev_ctx->ResetBlobMap(nullptr);
+  OneDNNBlobKey key("conv2d_input_0@fwd_pd");
+  OneDNNInstructionCache forward_cache;
+  OneDNNInstructionCache grad_cache;
+  {
+    OneDNNInstructionCacheGuard guard(&forward_cache, 1);
+    dev_ctx->SetBlob(key, std::make_shared<int>(1));
+  }
+  // The grad instruction finds the blob of the forward one in the BlobMap.
+  {
+    OneDNNInstructionCacheGuard guard(&grad_cache, 1);
+    EXPECT_EQ(*std::static_pointer_cast<int>(dev_ctx->GetBlob(key)), 1);
+  }
+  EXPECT_NE(dev_ctx->GetBlob(key.name()), nullptr);
+  dev_ctx->ResetBlobMap(nullptr);
+}
+
+}  // namespace funcs
+}  // namespace phi
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+const phi::DenseTensor& GetOutput(const InterpreterCore& core,
+                                  const Scope& scope,
+                                  const std::string& name) {
+  const Scope* local_scope = core.local_scope();
+  return (local_scope == nullptr ? scope : *local_scope)
+      .FindVar(name)
+      ->Get<phi::DenseTensor>();
+}
+
+void ExpectFilled(const phi::DenseTensor& tensor,
+                  const std::vector<int64_t>& dims,
+                  float value) {
+  ASSERT_EQ(tensor.dims(), common::make_ddim(dims));
+  for (int64_t i = 0; i < tensor.numel(); ++i) {
+    EXPECT_FLOAT_EQ(tensor.data<float>()[i], value);
+  }
+}
+
+}  // namespace
+
+// conv2d and conv2d_grad run as oneDNN instructions on inputs whose shape
+// changes between the runs.
+TEST(OneDNNPhiKernelInstruction, input_shape_change) {
+  FLAGS_use_mkldnn = true;
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  pir::Program program(ctx);
+  pir::Builder builder = pir::Builder(ctx, program.block());
+
+  pir::Type x_type = paddle::dialect::DenseTensorType::get(
+      ctx,
+      pir::Float32Type::get(ctx),
+      common::make_ddim({1, 2, -1, -1}),
+      phi::DataLayout::NCHW,
+      phi::LegacyLoD(),
+      0);
+  pir::AttributeMap feed_attrs;
+  feed_attrs["name"] = pir::StrAttribute::get(ctx, "x");
+  feed_attrs["col"] = pir::Int32Attribute::get(ctx, 0);
+  pir::Operation* feed_op = pir::Operation::Create(
+      {},
+      feed_attrs,
+      {x_type},
+      ctx->GetRegisteredOpInfo(paddle::dialect::FeedOp::name()));
+  program.block()->push_back(feed_op);
+
+  auto filter = builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{2, 2, 3, 3},
+      1.0,
+      phi::DataType::FLOAT32,
+      phi::CPUPlace());
+  auto conv = builder.Build<paddle::dialect::Conv2dOp>(feed_op->result(0),
+                                                       filter->result(0));
+  auto out_grad = builder.Build<paddle::dialect::FullLikeOp>(
+      conv->result(0), 1.0, phi::DataType::FLOAT32, phi::CPUPlace());
+  auto conv_grad = builder.Build<paddle::dialect::Conv2dGradOp>(
+      feed_op->result(0),
+      filter->result(0),
+      out_grad->result(0),
+      std::vector<int>{1, 1},
+      std::vector<int>{0, 0},
+      "EXPLICIT",
+      std::vector<int>{1, 1},
+      1,
+      "NCHW");
+  builder.Build<pir::ShadowOutputOp>(conv->result(0), "out");
+  builder.Build<pir::ShadowOutputOp>(conv_grad->result(1), "filter_grad");
+
+  auto kernel_program = paddle::dialect::PdOpLowerToKernelPass(&program);
+  Scope scope;
+  InterpreterCore core(phi::CPUPlace(), {}, kernel_program->block(), &scope);
+  core.SetSkipGcVars({"out", "filter_grad"});
+
+  // Each shape selects its own entry of the instruction caches, so a stale
+  // primitive of the other shape is never run. conv2d_grad looks up the
+  // forward primitive descriptor of conv2d under the same key, and has to
+  // get the one of the current shape.
+  for (int64_t size : {4, 6, 4}) {
+    core.Run({"x"}, {phi::funcs::MakeTensor({1, 2, size, size}, 1.0f)});
+    int64_t out_size = size - 2;
+    ExpectFilled(GetOutput(core, scope, "out"), {1, 2, out_size, out_size}, 18);
+    ExpectFilled(GetOutput(core, scope, "filter_grad"),
+                 {2, 2, 3, 3},
+                 static_cast<float>(out_size * out_size));
+  }
+  FLAGS_use_mkldnn = false;
+}
+
+}  // namespace framework
+}  // namespace paddle
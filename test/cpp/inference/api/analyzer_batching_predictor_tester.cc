@@ -0,0 +1,265 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/serialize_deserialize/include/interface.h"
+#include "paddle/pir/include/core/builder.h"
+#include "paddle/pir/include/core/builtin_dialect.h"
+#include "paddle/pir/include/core/program.h"
+#include "test/cpp/inference/api/tester_helper.h"
+
+namespace paddle_infer {
+namespace services {
+
+namespace {
+
+Config GetConfig() {
+  Config config;
+  config.SetModel(FLAGS_infer_model + "/__model__",
+                  FLAGS_infer_model + "/__params__");
+  config.DisableGpu();
+  config.SetCpuMathLibraryNumThreads(FLAGS_cpu_num_threads);
+  return config;
+}
+
+HostTensor MakeImage(int rows, float value) {
+  HostTensor tensor;
+  tensor.shape = {rows, 3, 224, 224};
+  tensor.dtype = DataType::FLOAT32;
+  std::vector<float> data(rows * 3 * 224 * 224, value);
+  tensor.data.resize(data.size() * sizeof(float));
+  std::memcpy(tensor.data.data(), data.data(), tensor.data.size());
+  return tensor;
+}
+
+// Writes a model of out = 2 * x + 1 and padded_out = x to dir, where x is a
+// sequence of shape [batch, seq_len, 4], and returns its config.
+Config GetSequenceConfig(const std::string& dir) {
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::BuiltinDialect>();
+  pir::Program program(ctx);
+  pir::Builder builder(ctx, program.block());
+  pir::Value x = builder
+                     .Build<paddle::dialect::DataOp>(
+                         "x",
+                         std::vector<int64_t>({-1, -1, 4}),
+                         phi::DataType::FLOAT32,
+                         phi::CPUPlace())
+                     .result(0);
+  auto out = builder.Build<paddle::dialect::ScaleOp>(x, 2.0, 1.0, true);
+  auto padded_out = builder.Build<paddle::dialect::ScaleOp>(x, 1.0, 0.0, true);
+  builder.Build<paddle::dialect::FetchOp>(out.out(), "out", 0);
+  builder.Build<paddle::dialect::FetchOp>(padded_out.out(), "padded_out", 1);
+
+  const std::string model_file = dir + "/batching_sequence_model.json";
+  const std::string params_file = dir + "/batching_sequence_model.pdiparams";
+  pir::WriteModule(program, model_file, 1, true, false, false);
+  // The model has no parameters.
+  std::ofstream(params_file, std::ios::binary).close();
+
+  Config config;
+  config.SetModel(model_file, params_file);
+  config.DisableGpu();
+  config.SetCpuMathLibraryNumThreads(1);
+  return config;
+}
+
+// The request i has rows sequences of seq_len steps of 4 values each.
+HostTensor MakeSequence(int i, int rows, int seq_len) {
+  HostTensor tensor;
+  tensor.shape = {rows, seq_len, 4};
+  tensor.dtype = DataType::FLOAT32;
+  std::vector<float> data;
+  for (int r = 0; r < rows; ++r) {
+    for (int t = 0; t < seq_len; ++t) {
+      for (int c = 0; c < 4; ++c) {
+        data.push_back(i * 100 + r * 10 + t + c * 0.25f);
+      }
+    }
+  }
+  tensor.data.resize(data.size() * sizeof(float));
+  std::memcpy(tensor.data.data(), data.data(), tensor.data.size());
+  return tensor;
+}
+
+std::vector<float> ToFloats(const HostTensor& tensor) {
+  std::vector<float> data(tensor.data.size() / sizeof(float));
+  std::memcpy(data.data(), tensor.data.data(), tensor.data.size());
+  return data;
+}
+
+// Runs num_clients closed-loop clients of repeat requests each, and reports
+// the latency percentiles and the throughput of the requests.
+void RunLoad(const BatchingOptions& options, int num_clients, int repeat) {
+  BatchingPredictor predictor(GetConfig(), options);
+  auto input_name = CreatePredictor(GetConfig())->GetInputNames()[0];
+  predictor.Run({{input_name, MakeImage(1, 0.5f)}});
+
+  std::vector<std::vector<double>> latencies(num_clients);
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> clients;
+  for (int i = 0; i < num_clients; ++i) {
+    clients.emplace_back([&, i] {
+      HostTensor image = MakeImage(1, 0.1f * i);
+      for (int j = 0; j < repeat; ++j) {
+        auto begin = std::chrono::steady_clock::now();
+        predictor.Run({{input_name, image}});
+        latencies[i].push_back(std::chrono::duration<double, std::milli>(
+                                   std::chrono::steady_clock::now() - begin)
+                                   .count());
+      }
+    });
+  }
+  for (auto& client : clients) {
+    client.join();
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  std::vector<double> all;
+  for (auto& client_latencies : latencies) {
+    all.insert(all.end(), client_latencies.begin(), client_latencies.end());
+  }
+  std::sort(all.begin(), all.end());
+  LOG(INFO) << "max_batch_size " << options.max_batch_size << ", clients "
+            << num_clients << ": p50 " << all[all.size() / 2] << " ms, p99 "
+            << all[std::min(all.size() - 1, all.size() * 99 / 100)]
+            << " ms, throughput " << all.size() / seconds << " requests/s";
+}
+
+}  // namespace
+
+TEST(BatchingPredictor, compare_with_predictor) {
+  auto predictor = CreatePredictor(GetConfig());
+  auto input_name = predictor->GetInputNames()[0];
+  auto output_name = predictor->GetOutputNames()[0];
+
+  BatchingOptions options;
+  options.max_batch_size = 4;
+  options.max_queue_delay_us = 10000;
+  BatchingPredictor batching_predictor(GetConfig(), options);
+
+  const int num_requests = 6;
+  std::vector<std::future<HostTensorMap>> futures;
+  for (int i = 0; i < num_requests; ++i) {
+    futures.push_back(batching_predictor.Submit(
+        {{input_name, MakeImage(1 + i % 2, 0.1f * i)}}));
+  }
+  for (int i = 0; i < num_requests; ++i) {
+    HostTensorMap outputs = futures[i].get();
+    std::vector<float> out = ToFloats(outputs.at(output_name));
+
+    HostTensor image = MakeImage(1 + i % 2, 0.1f * i);
+    auto input_t = predictor->GetInputHandle(input_name);
+    input_t->Reshape(image.shape);
+    input_t->CopyFromCpu(reinterpret_cast<const float*>(image.data.data()));
+    ASSERT_TRUE(predictor->Run());
+    auto output_t = predictor->GetOutputHandle(output_name);
+    std::vector<int> shape = output_t->shape();
+    ASSERT_EQ(outputs.at(output_name).shape, shape);
+    std::vector<float> expected(out.size());
+    output_t->CopyToCpu(expected.data());
+    for (size_t j = 0; j < out.size(); ++j) {
+      EXPECT_NEAR(out[j], expected[j], 1e-5);
+    }
+  }
+}
+
+TEST(BatchingPredictor, variable_length) {
+  char dir[] = "/tmp/batching_predictor_XXXXXX";
+  ASSERT_NE(mkdtemp(dir), nullptr);
+  BatchingOptions options;
+  options.max_batch_size = 4;
+  // A batch is only run once its requests have max_batch_size rows, so the
+  // batches do not depend on the timing of the requests.
+  options.max_queue_delay_us = 600 * 1000 * 1000L;
+  options.padded_inputs = {"x"};
+  options.seq_len_buckets = {4};
+  options.unpadded_outputs = {"out"};
+  BatchingPredictor predictor(GetSequenceConfig(dir), options);
+
+  // The rows and the sequence length of each request. Those up to 4 steps
+  // are padded to the bucket 4, the longer ones to the longest of them, 7.
+  // Each of the two batches has 4 rows.
+  const std::vector<std::pair<int, int>> requests = {
+      {1, 3}, {2, 5}, {2, 2}, {1, 7}, {1, 4}, {1, 6}};
+  std::vector<std::future<HostTensorMap>> futures;
+  for (size_t i = 0; i < requests.size(); ++i) {
+    futures.push_back(predictor.Submit(
+        {{"x", MakeSequence(i, requests[i].first, requests[i].second)}}));
+  }
+  for (size_t i = 0; i < requests.size(); ++i) {
+    const int rows = requests[i].first;
+    const int seq_len = requests[i].second;
+    const int padded_len = seq_len <= 4 ? 4 : 7;
+    HostTensorMap outputs = futures[i].get();
+    std::vector<float> x = ToFloats(MakeSequence(i, rows, seq_len));
+
+    // The unpadded output has the steps of the request only.
+    const HostTensor& out = outputs.at("out");
+    ASSERT_EQ(out.shape, std::vector<int>({rows, seq_len, 4}));
+    std::vector<float> out_data = ToFloats(out);
+    for (size_t j = 0; j < x.size(); ++j) {
+      EXPECT_FLOAT_EQ(out_data[j], 2 * x[j] + 1);
+    }
+
+    // The other keeps the zero padding of its bucket.
+    const HostTensor& padded_out = outputs.at("padded_out");
+    ASSERT_EQ(padded_out.shape, std::vector<int>({rows, padded_len, 4}));
+    std::vector<float> padded_data = ToFloats(padded_out);
+    for (int r = 0; r < rows; ++r) {
+      for (int t = 0; t < padded_len; ++t) {
+        for (int c = 0; c < 4; ++c) {
+          float expected = t < seq_len ? x[(r * seq_len + t) * 4 + c] : 0;
+          EXPECT_FLOAT_EQ(padded_data[(r * padded_len + t) * 4 + c], expected);
+        }
+      }
+    }
+  }
+
+  // The padded inputs of a request need the same length to be unpadded.
+  options.padded_inputs = {"x", "y"};
+  BatchingPredictor checked_predictor(GetSequenceConfig(dir), options);
+  EXPECT_THROW(
+      checked_predictor.Submit(
+          {{"x", MakeSequence(0, 1, 3)}, {"y", MakeSequence(0, 1, 4)}}),
+      std::exception);
+  std::filesystem::remove_all(dir);
+}
+
+TEST(BatchingPredictor, load_benchmark) {
+  // The batch size 1 is the baseline of the independent predictors.
+  for (size_t max_batch_size : {1UL, 4UL, 8UL}) {
+    BatchingOptions options;
+    options.max_batch_size = max_batch_size;
+    options.max_queue_delay_us = 2000;
+    options.num_workers = 2;
+    RunLoad(options, std::max(FLAGS_num_threads, 8), FLAGS_repeat * 10);
+  }
+}
+
+}  // namespace services
+}  // namespace paddle_infer
@@ -112,6 +112,95 @@ void threads_run(int thread_num) {
 
 TEST(PD_Predictor, PD_multi_threads_run) { threads_run(10); }
 
+typedef struct BatchingRunParameter {
+  PD_BatchingPredictor* predictor;
+  const char* input_name;
+  std::vector<float> input_data;
+  std::vector<float> out_data;
+} BatchingRunParameter;
+
+void* batching_run(void* thread_param) {
+  struct BatchingRunParameter* param =
+      (struct BatchingRunParameter*)thread_param;
+  std::array<int32_t, 4> shapes = {1, 3, 224, 224};
+  PD_BatchingRequest* request = PD_BatchingRequestCreate();
+  PD_BatchingRequestSetInput(request,
+                             param->input_name,
+                             PD_DATA_FLOAT32,
+                             shapes.size(),
+                             shapes.data(),
+                             param->input_data.data());
+  if (PD_BatchingPredictorRun(param->predictor, request)) {
+    PD_OneDimArrayCstr* output_names =
+        PD_BatchingRequestGetOutputNames(request);
+    PD_OneDimArrayInt32* output_shape =
+        PD_BatchingRequestGetOutputShape(request, output_names->data[0]);
+    int32_t out_size = 1;
+    for (size_t index = 0; index < output_shape->size; ++index) {
+      out_size = out_size * output_shape->data[index];
+    }
+    param->out_data.resize(out_size);
+    PD_BatchingRequestCopyOutputToCpu(
+        request, output_names->data[0], param->out_data.data());
+    PD_OneDimArrayInt32Destroy(output_shape);
+    PD_OneDimArrayCstrDestroy(output_names);
+  }
+  PD_BatchingRequestDestroy(request);
+  return nullptr;
+}
+
+TEST(PD_BatchingPredictor, PD_multi_threads_run) {
+  const int thread_num = 8;
+  auto model_dir = FLAGS_infer_model;
+  PD_Config* config = PD_ConfigCreate();
+  PD_ConfigSetModel(config,
+                    (model_dir + "/__model__").c_str(),
+                    (model_dir + "/__params__").c_str());
+  PD_Predictor* predictor = PD_PredictorCreate(config);
+  PD_OneDimArrayCstr* input_names = PD_PredictorGetInputNames(predictor);
+  std::string input_name = input_names->data[0];
+  PD_OneDimArrayCstrDestroy(input_names);
+
+  config = PD_ConfigCreate();
+  PD_ConfigSetModel(config,
+                    (model_dir + "/__model__").c_str(),
+                    (model_dir + "/__params__").c_str());
+  PD_BatchingPredictor* batching_predictor = PD_BatchingPredictorCreate(
+      config, 4, 10000, 1, nullptr, nullptr, nullptr);
+
+  std::vector<pthread_t> threads(thread_num);
+  std::vector<BatchingRunParameter> params(thread_num);
+  std::vector<RunParameter> expected(thread_num);
+  std::array<int32_t, 4> shapes = {1, 3, 224, 224};
+  for (int i = 0; i < thread_num; ++i) {
+    params[i].predictor = batching_predictor;
+    params[i].input_name = input_name.c_str();
+    params[i].input_data.assign(1 * 3 * 224 * 224, 0.1f * i);
+    expected[i].predictor = predictor;
+    expected[i].shapes = shapes.data();
+    expected[i].shape_size = 4;
+    expected[i].input_data = params[i].input_data.data();
+    expected[i].thread_index = i;
+    run(&expected[i]);
+  }
+  for (int i = 0; i < thread_num; ++i) {
+    pthread_create(&(threads[i]), nullptr, batching_run, &(params[i]));
+  }
+  for (int i = 0; i < thread_num; ++i) {
+    pthread_join(threads[i], nullptr);
+  }
+
+  // Each request gets its own rows of the batched run back.
+  for (int i = 0; i < thread_num; ++i) {
+    ASSERT_EQ(params[i].out_data.size(), expected[i].out_data.size());
+    for (size_t j = 0; j < params[i].out_data.size(); ++j) {
+      ASSERT_NEAR(params[i].out_data[j], expected[i].out_data[j], 1e-5);
+    }
+  }
+  PD_BatchingPredictorDestroy(batching_predictor);
+  PD_PredictorDestroy(predictor);
+}
+
 }  // namespace analysis
 }  // namespace inference
 }  // namespace paddle
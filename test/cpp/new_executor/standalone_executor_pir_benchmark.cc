@@ -0,0 +1,393 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks of the PIR InterpreterCore. Each case generates a program
+// of a given shape, and measures the lowering, the first run (which builds
+// the instructions) and the steady-state runs for every combination of the
+// run mode, the GC mode and the host thread number. The results are written
+// as one JSON object per line, e.g.
+//
+//   standalone_executor_pir_benchmark --bench_num_ops=1024 \
+//       --bench_host_threads=1,2,4,8 --bench_output=/tmp/bench.jsonl
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "paddle/common/flags.h"
+#include "paddle/fluid/framework/new_executor/interpretercore.h"
+#include "paddle/fluid/pir/dialect/operator/ir/control_flow_op.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/transforms/pd_op_to_kernel_pass.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/pir/include/core/builder.h"
+#include "paddle/pir/include/core/ir_context.h"
+#include "paddle/pir/include/core/program.h"
+#include "paddle/pir/include/dialect/control_flow/ir/cf_dialect.h"
+#include "paddle/pir/include/dialect/control_flow/ir/cf_op.h"
+
+COMMON_DECLARE_bool(enable_pir_in_executor_trace_run);
+COMMON_DECLARE_double(eager_delete_tensor_gb);
+
+PD_DEFINE_int32(bench_num_ops,
+                64,
+                "The number of the ops, branches times depth, or loop "
+                "iterations of the generated programs.");
+PD_DEFINE_int32(bench_width, 8, "The number of the fan-out branches.");
+PD_DEFINE_int64(bench_numel, 1024, "The numel of the tensors.");
+PD_DEFINE_int32(bench_warmup, 5, "The runs before the measured ones.");
+PD_DEFINE_int32(bench_repeat, 20, "The number of the measured runs.");
+PD_DEFINE_string(bench_host_threads,
+                 "1,4",
+                 "The comma separated host thread numbers of the "
+                 "multi-thread mode.");
+PD_DEFINE_string(bench_output,
+                 "",
+                 "The file the results are appended to, or stdout if empty.");
+
+PD_DECLARE_KERNEL(full, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(add, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(less_equal, CPU, ALL_LAYOUT);
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+using ProgramBuilder = std::function<std::unique_ptr<pir::Program>()>;
+
+constexpr char kOutName[] = "bench_out";
+
+struct BenchConfig {
+  std::string mode;
+  std::string gc;
+  double eager_delete_tensor_gb;
+  size_t host_num_threads;
+};
+
+pir::IrContext* Context() {
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::ControlFlowDialect>();
+  return ctx;
+}
+
+pir::Value Full(pir::Builder* builder, int64_t numel, float value) {
+  return builder
+      ->Build<paddle::dialect::FullOp>(std::vector<int64_t>{numel},
+                                       value,
+                                       phi::DataType::FLOAT32,
+                                       phi::CPUPlace())
+      .out();
+}
+
+pir::Value Add(pir::Builder* builder, pir::Value x, pir::Value y) {
+  return builder->Build<paddle::dialect::AddOp>(x, y).out();
+}
+
+// x = x + 1, num_ops times.
+std::unique_ptr<pir::Program> BuildChain(int num_ops, int64_t numel) {
+  pir::IrContext* ctx = Context();
+  auto program = std::make_unique<pir::Program>(ctx);
+  pir::Builder builder(ctx, program->block());
+  pir::Value one = Full(&builder, numel, 1.0);
+  pir::Value x = one;
+  for (int i = 0; i < num_ops; ++i) {
+    x = Add(&builder, x, one);
+  }
+  builder.Build<pir::ShadowOutputOp>(x, kOutName);
+  return program;
+}
+
+// width independent chains of depth ops, summed up by a tree of adds.
+std::unique_ptr<pir::Program> BuildFanOut(int width,
+                                          int depth,
+                                          int64_t numel) {
+  pir::IrContext* ctx = Context();
+  auto program = std::make_unique<pir::Program>(ctx);
+  pir::Builder builder(ctx, program->block());
+  pir::Value one = Full(&builder, numel, 1.0);
+  std::vector<pir::Value> branches;
+  for (int i = 0; i < width; ++i) {
+    pir::Value x = one;
+    for (int j = 0; j < depth; ++j) {
+      x = Add(&builder, x, one);
+    }
+    branches.push_back(x);
+  }
+  while (branches.size() > 1) {
+    std::vector<pir::Value> sums;
+    for (size_t i = 0; i + 1 < branches.size(); i += 2) {
+      sums.push_back(Add(&builder, branches[i], branches[i + 1]));
+    }
+    if (branches.size() % 2) {
+      sums.push_back(branches.back());
+    }
+    branches.swap(sums);
+  }
+  builder.Build<pir::ShadowOutputOp>(branches[0], kOutName);
+  return program;
+}
+
+// num_ops if ops in sequence, each of an add in both branches.
+std::unique_ptr<pir::Program> BuildIfChain(int num_ops, int64_t numel) {
+  pir::IrContext* ctx = Context();
+  auto program = std::make_unique<pir::Program>(ctx);
+  pir::Block* block = program->block();
+  pir::Builder builder(ctx, block);
+  pir::Value cond =
+      builder
+          .Build<paddle::dialect::FullOp>(
+              std::vector<int64_t>{1}, true, phi::DataType::BOOL)
+          .out();
+  pir::Value one = Full(&builder, numel, 1.0);
+  pir::Value x = one;
+  for (int i = 0; i < num_ops; ++i) {
+    auto if_op = builder.Build<paddle::dialect::IfOp>(
+        cond, std::vector<pir::Type>{x.type()});
+
+    builder.SetInsertionPointToStart(&if_op.true_block());
+    builder.Build<pir::YieldOp>(std::vector<pir::Value>{Add(&builder, x, one)});
+
+    builder.SetInsertionPointToStart(&if_op.false_block());
+    builder.Build<pir::YieldOp>(std::vector<pir::Value>{Add(&builder, x, x)});
+
+    builder.SetInsertionPointToBlockEnd(block);
+    x = if_op.result(0);
+  }
+  builder.Build<pir::ShadowOutputOp>(x, kOutName);
+  return program;
+}
+
+// A while loop of num_iters iterations of x = x + 1.
+std::unique_ptr<pir::Program> BuildWhile(int num_iters, int64_t numel) {
+  pir::IrContext* ctx = Context();
+  auto program = std::make_unique<pir::Program>(ctx);
+  pir::Builder builder(ctx, program->block());
+  auto i = builder
+               .Build<paddle::dialect::FullOp>(
+                   std::vector<int64_t>{1}, 1, phi::DataType::INT32)
+               .out();
+  auto limit = builder
+                   .Build<paddle::dialect::FullOp>(
+                       std::vector<int64_t>{1}, num_iters, phi::DataType::INT32)
+                   .out();
+  pir::Value x = Full(&builder, numel, 1.0);
+  auto cond = builder.Build<paddle::dialect::LessEqualOp>(i, limit).out();
+  auto while_op = builder.Build<paddle::dialect::WhileOp>(
+      cond, std::vector<pir::Value>{i, limit, x});
+
+  pir::Block& body = while_op.body();
+  builder.SetInsertionPointToStart(&body);
+  auto one_i = builder
+                   .Build<paddle::dialect::FullOp>(
+                       std::vector<int64_t>{1}, 1, phi::DataType::INT32)
+                   .out();
+  auto new_i = Add(&builder, body.arg(0), one_i);
+  auto new_x = Add(&builder, body.arg(2), Full(&builder, numel, 1.0));
+  auto new_cond =
+      builder.Build<paddle::dialect::LessEqualOp>(new_i, body.arg(1)).out();
+  builder.Build<pir::YieldOp>(
+      std::vector<pir::Value>{new_cond, new_i, body.arg(1), new_x});
+
+  builder.SetInsertionPointAfter(while_op);
+  builder.Build<pir::ShadowOutputOp>(while_op->result(2), kOutName);
+  return program;
+}
+
+std::vector<BenchConfig> BenchConfigs() {
+  std::vector<size_t> threads;
+  std::stringstream ss(FLAGS_bench_host_threads);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (!item.empty()) {
+      threads.push_back(std::stoul(item));
+    }
+  }
+  std::vector<BenchConfig> configs;
+  for (auto gc : {std::make_pair("eager", 0.0), std::make_pair("off", -1.0)}) {
+    // The trace mode runs the instructions in the calling thread.
+    configs.push_back({"trace", gc.first, gc.second, 1});
+    for (size_t num : threads) {
+      configs.push_back({"multi_thread", gc.first, gc.second, num});
+    }
+  }
+  return configs;
+}
+
+double Percentile(const std::vector<double>& sorted, double p) {
+  size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void Report(const std::string& line) {
+  if (FLAGS_bench_output.empty()) {
+    std::cout << line << std::endl;
+  } else {
+    std::ofstream out(FLAGS_bench_output, std::ios::app);
+    out << line << std::endl;
+  }
+}
+
+// Returns the output of the last run.
+phi::DenseTensor RunBenchmark(const std::string& case_name,
+                              const ProgramBuilder& build,
+                              const BenchConfig& config) {
+  using Clock = std::chrono::steady_clock;
+  auto elapsed_us = [](Clock::time_point begin) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - begin)
+        .count();
+  };
+
+  bool old_trace_run = FLAGS_enable_pir_in_executor_trace_run;
+  double old_gc = FLAGS_eager_delete_tensor_gb;
+  FLAGS_enable_pir_in_executor_trace_run = config.mode == "trace";
+  FLAGS_eager_delete_tensor_gb = config.eager_delete_tensor_gb;
+
+  auto program = build();
+  size_t num_ops = program->block()->size();
+  auto begin = Clock::now();
+  auto kernel_program = paddle::dialect::PdOpLowerToKernelPass(program.get());
+  double lower_us = elapsed_us(begin);
+
+  auto place = phi::CPUPlace();
+  Scope scope;
+  interpreter::ExecutionConfig execution_config;
+  execution_config.host_num_threads = config.host_num_threads;
+  execution_config.device_num_threads = 1;
+  InterpreterCore core(
+      place, {}, kernel_program->block(), &scope, execution_config);
+  core.SetSkipGcVars({kOutName});
+
+  begin = Clock::now();
+  core.Run({});
+  double first_run_us = elapsed_us(begin);
+
+  for (int i = 0; i < FLAGS_bench_warmup; ++i) {
+    core.Run({});
+  }
+  std::vector<double> run_us;
+  for (int i = 0; i < FLAGS_bench_repeat; ++i) {
+    begin = Clock::now();
+    core.Run({});
+    run_us.push_back(elapsed_us(begin));
+  }
+  double total_us = 0;
+  for (double us : run_us) {
+    total_us += us;
+  }
+  std::sort(run_us.begin(), run_us.end());
+
+  std::stringstream line;
+  line << "{\"case\": \"" << case_name << "\", \"num_ops\": " << num_ops
+       << ", \"numel\": " << FLAGS_bench_numel << ", \"mode\": \""
+       << config.mode << "\", \"gc\": \"" << config.gc
+       << "\", \"host_threads\": " << config.host_num_threads
+       << ", \"lower_us\": " << lower_us
+       << ", \"first_run_us\": " << first_run_us
+       << ", \"runs\": " << run_us.size();
+  if (!run_us.empty()) {
+    line << ", \"run_us_mean\": " << total_us / run_us.size()
+         << ", \"run_us_p50\": " << Percentile(run_us, 0.5)
+         << ", \"run_us_p99\": " << Percentile(run_us, 0.99);
+  }
+  line << "}";
+  Report(line.str());
+
+  Scope* inner_scope =
+      core.local_scope() == nullptr ? &scope : core.local_scope();
+  phi::DenseTensor out =
+      inner_scope->FindVar(kOutName)->Get<phi::DenseTensor>();
+
+  FLAGS_enable_pir_in_executor_trace_run = old_trace_run;
+  FLAGS_eager_delete_tensor_gb = old_gc;
+  return out;
+}
+
+void ExpectAllEqual(const phi::DenseTensor& out, float expected) {
+  ASSERT_EQ(out.numel(), FLAGS_bench_numel);
+  for (int64_t i = 0; i < out.numel(); ++i) {
+    ASSERT_FLOAT_EQ(out.data<float>()[i], expected);
+  }
+}
+
+}  // namespace
+
+TEST(StandaloneExecutorBenchmark, chain) {
+  for (auto& config : BenchConfigs()) {
+    auto out = RunBenchmark(
+        "chain",
+        [] { return BuildChain(FLAGS_bench_num_ops, FLAGS_bench_numel); },
+        config);
+    ExpectAllEqual(out, FLAGS_bench_num_ops + 1);
+  }
+}
+
+TEST(StandaloneExecutorBenchmark, fan_out) {
+  int depth = std::max(FLAGS_bench_num_ops / FLAGS_bench_width, 1);
+  for (auto& config : BenchConfigs()) {
+    auto out = RunBenchmark(
+        "fan_out",
+        [depth] {
+          return BuildFanOut(FLAGS_bench_width, depth, FLAGS_bench_numel);
+        },
+        config);
+    ExpectAllEqual(out, FLAGS_bench_width * (depth + 1));
+  }
+}
+
+TEST(StandaloneExecutorBenchmark, if_chain) {
+  for (auto& config : BenchConfigs()) {
+    auto out = RunBenchmark(
+        "if_chain",
+        [] { return BuildIfChain(FLAGS_bench_num_ops, FLAGS_bench_numel); },
+        config);
+    ExpectAllEqual(out, FLAGS_bench_num_ops + 1);
+  }
+}
+
+TEST(StandaloneExecutorBenchmark, while_loop) {
+  for (auto& config : BenchConfigs()) {
+    auto out = RunBenchmark(
+        "while_loop",
+        [] { return BuildWhile(FLAGS_bench_num_ops, FLAGS_bench_numel); },
+        config);
+    ExpectAllEqual(out, FLAGS_bench_num_ops + 1);
+  }
+}
+
+// The ops of one element, where the cost of the executor dominates.
+TEST(StandaloneExecutorBenchmark, tiny_ops) {
+  int64_t old_numel = FLAGS_bench_numel;
+  FLAGS_bench_numel = 1;
+  for (auto& config : BenchConfigs()) {
+    auto out = RunBenchmark(
+        "tiny_ops",
+        [] { return BuildChain(FLAGS_bench_num_ops * 4, 1); },
+        config);
+    ExpectAllEqual(out, FLAGS_bench_num_ops * 4 + 1);
+  }
+  FLAGS_bench_numel = old_numel;
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -18,18 +18,24 @@
 
 #include <chrono>
 #include <iostream>
+#include <set>
 #include <string>
 
 #include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/core/tensor_utils.h"
 
+#include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
+#include "paddle/fluid/framework/new_executor/pir_adaptor/pir_adaptor_util.h"
 #include "paddle/fluid/framework/new_executor/pir_interpreter.h"
 #include "paddle/fluid/pir/dialect/operator/ir/control_flow_op.h"
 #include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
 #include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/transforms/general/memory_plan_pass.h"
 #include "paddle/fluid/pir/transforms/pd_op_to_kernel_pass.h"
 #include "paddle/pir/include/core/builder.h"
 #include "paddle/pir/include/core/ir_context.h"
 #include "paddle/pir/include/core/program.h"
+#include "paddle/pir/include/pass/pass_manager.h"
 
 #include "paddle/fluid/pir/dialect/operator/ir/op_type.h"
 
@@ -39,6 +45,10 @@
 
 DECLARE_FILE_SYMBOLS(kernel_dialect);
 
+COMMON_DECLARE_bool(enable_infer_meta_cache);
+COMMON_DECLARE_bool(enable_pir_in_executor_trace_run);
+COMMON_DECLARE_bool(new_executor_use_work_stealing);
+
 PD_DECLARE_KERNEL(full, CPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(full_int_array, CPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(uniform, CPU, ALL_LAYOUT);
@@ -98,6 +108,303 @@ TEST(StandaloneExecutor, run) {
   EXPECT_EQ(res3, true);
 }
 
+TEST(StandaloneExecutor, run_with_work_stealing) {
+  FLAGS_new_executor_use_work_stealing = true;
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  pir::Program program((ctx));
+
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+
+  pir::Builder builder = pir::Builder(ctx, program.block());
+
+  // x fans out to 8 adds, whose results are summed up by a tree of adds, so
+  // each level has more ready instructions than the 4 host threads.
+  auto x = builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{2, 2}, 1.0, phi::DataType::FLOAT32, phi::CPUPlace());
+  std::vector<pir::Value> values;
+  for (int k = 0; k < 8; ++k) {
+    auto full = builder.Build<paddle::dialect::FullOp>(
+        std::vector<int64_t>{2, 2}, k, phi::DataType::FLOAT32, phi::CPUPlace());
+    values.push_back(
+        builder.Build<paddle::dialect::AddOp>(x->result(0), full->result(0))
+            ->result(0));
+  }
+  while (values.size() > 1) {
+    std::vector<pir::Value> sums;
+    for (size_t k = 0; k < values.size(); k += 2) {
+      sums.push_back(
+          builder.Build<paddle::dialect::AddOp>(values[k], values[k + 1])
+              ->result(0));
+    }
+    values = sums;
+  }
+
+  std::string out_name = "add_out";
+  builder.Build<pir::ShadowOutputOp>(values[0], out_name);
+
+  auto kernel_program = paddle::dialect::PdOpLowerToKernelPass(&program);
+
+  auto place = phi::CPUPlace();
+  Scope scope;
+
+  InterpreterCore test_core(place, {}, kernel_program->block(), &scope);
+
+  test_core.SetSkipGcVars({out_name});
+
+  // The instructions run on the worker threads in a different order each
+  // time, and have to see the results of all their inputs.
+  for (int i = 0; i < 20; ++i) {
+    test_core.Run({});
+
+    auto out_tensor =
+        test_core.local_scope() == nullptr
+            ? scope.FindVar(out_name)->Get<phi::DenseTensor>()
+            : test_core.local_scope()
+                  ->FindVar(out_name)
+                  ->Get<phi::DenseTensor>();
+
+    // 8 * 1 + (0 + 1 + ... + 7)
+    for (int64_t j = 0; j < out_tensor.numel(); ++j) {
+      EXPECT_EQ(simple_cmp(out_tensor.data<float>()[j], 36.0), true);
+    }
+  }
+  FLAGS_new_executor_use_work_stealing = false;
+}
+
+TEST(StandaloneExecutor, run_with_infer_meta_cache) {
+  FLAGS_enable_infer_meta_cache = true;
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  pir::Program program((ctx));
+
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+
+  pir::Builder builder = pir::Builder(ctx, program.block());
+
+  paddle::dialect::FullOp op1 = builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{2, 3}, 1.0, phi::DataType::FLOAT32, phi::CPUPlace());
+
+  paddle::dialect::FullOp op2 = builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{2, 3}, 2.0, phi::DataType::FLOAT32, phi::CPUPlace());
+
+  auto add_op =
+      builder.Build<paddle::dialect::AddOp>(op1->result(0), op2->result(0));
+
+  std::string out_name = "add_out";
+  builder.Build<pir::ShadowOutputOp>(add_op->result(0), out_name);
+
+  auto kernel_program = paddle::dialect::PdOpLowerToKernelPass(&program);
+
+  auto place = phi::CPUPlace();
+  Scope scope;
+
+  InterpreterCore test_core(place, {}, kernel_program->block(), &scope);
+
+  test_core.SetSkipGcVars({out_name});
+
+  // The first run fills the cache and the others replay it.
+  for (int i = 0; i < 3; ++i) {
+    test_core.Run({});
+
+    auto* out_tensor =
+        test_core.local_scope() == nullptr
+            ? scope.FindVar(out_name)->GetMutable<phi::DenseTensor>()
+            : test_core.local_scope()
+                  ->FindVar(out_name)
+                  ->GetMutable<phi::DenseTensor>();
+
+    EXPECT_EQ(out_tensor->dims(), common::make_ddim({2, 3}));
+    EXPECT_EQ(out_tensor->dtype(), phi::DataType::FLOAT32);
+    EXPECT_EQ(out_tensor->meta().use_gpudnn, true);
+    for (int64_t j = 0; j < out_tensor->numel(); ++j) {
+      EXPECT_EQ(simple_cmp(out_tensor->data<float>()[j], 3.0), true);
+    }
+    // The replayed meta restores use_gpudnn as InferMeta leaves it.
+    phi::DenseTensorUtils::GetMutableMeta(out_tensor)->use_gpudnn = false;
+  }
+  FLAGS_enable_infer_meta_cache = false;
+}
+
+TEST(StandaloneExecutor, run_with_infer_meta_cache_shape_change) {
+  FLAGS_enable_infer_meta_cache = true;
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  pir::Program program(ctx);
+
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+
+  pir::Builder builder = pir::Builder(ctx, program.block());
+
+  pir::OpInfo feed_op_info =
+      ctx->GetRegisteredOpInfo(paddle::dialect::FeedOp::name());
+  pir::Type dense_tensor_dtype =
+      paddle::dialect::DenseTensorType::get(ctx,
+                                            pir::Float32Type::get(ctx),
+                                            common::make_ddim({-1, -1}),
+                                            phi::DataLayout::NCHW,
+                                            phi::LegacyLoD(),
+                                            0);
+  std::vector<pir::Operation*> feed_ops;
+  for (const std::string& name : {"x", "y"}) {
+    pir::AttributeMap attr_map;
+    attr_map["name"] = pir::StrAttribute::get(ctx, name);
+    attr_map["col"] = pir::Int32Attribute::get(ctx, 0);
+    feed_ops.push_back(pir::Operation::Create(
+        {}, attr_map, {dense_tensor_dtype}, feed_op_info));
+    program.block()->push_back(feed_ops.back());
+  }
+
+  auto add_op = builder.Build<paddle::dialect::AddOp>(feed_ops[0]->result(0),
+                                                      feed_ops[1]->result(0));
+  std::string out_name = "add_out";
+  builder.Build<pir::ShadowOutputOp>(add_op->result(0), out_name);
+
+  auto kernel_program = paddle::dialect::PdOpLowerToKernelPass(&program);
+
+  auto place = phi::CPUPlace();
+  Scope scope;
+  InterpreterCore test_core(place, {}, kernel_program->block(), &scope);
+
+  test_core.SetSkipGcVars({out_name});
+
+  phi::DeviceContext* dev_ctx =
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace());
+  auto make_tensor = [&](const phi::DDim& dims, float value) {
+    phi::DenseTensor tensor;
+    tensor.Resize(dims);
+    float* data = dev_ctx->Alloc<float>(&tensor);
+    for (int64_t i = 0; i < tensor.numel(); ++i) {
+      data[i] = value;
+    }
+    return tensor;
+  };
+
+  // A new input shape misses the cache and the output shape is inferred
+  // again, while the shape of the first run is replayed from the cache.
+  for (const phi::DDim& dims : {common::make_ddim({2, 3}),
+                                common::make_ddim({4, 5}),
+                                common::make_ddim({2, 3})}) {
+    test_core.Run({"x", "y"}, {make_tensor(dims, 1.0), make_tensor(dims, 2.0)});
+
+    auto out_tensor =
+        test_core.local_scope() == nullptr
+            ? scope.FindVar(out_name)->Get<phi::DenseTensor>()
+            : test_core.local_scope()
+                  ->FindVar(out_name)
+                  ->Get<phi::DenseTensor>();
+
+    EXPECT_EQ(out_tensor.dims(), dims);
+    for (int64_t j = 0; j < out_tensor.numel(); ++j) {
+      EXPECT_EQ(simple_cmp(out_tensor.data<float>()[j], 3.0), true);
+    }
+  }
+  FLAGS_enable_infer_meta_cache = false;
+}
+
+TEST(StandaloneExecutor, run_with_memory_plan) {
+  FLAGS_enable_pir_in_executor_trace_run = true;
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  pir::Program program((ctx));
+
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+
+  pir::Builder builder = pir::Builder(ctx, program.block());
+
+  auto full_a = builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{2, 3}, 1.0, phi::DataType::FLOAT32, phi::CPUPlace());
+  auto full_b = builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{2, 3}, 2.0, phi::DataType::FLOAT32, phi::CPUPlace());
+  auto add_c = builder.Build<paddle::dialect::AddOp>(full_a->result(0),
+                                                     full_b->result(0));
+  auto full_d = builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{2, 3}, 4.0, phi::DataType::FLOAT32, phi::CPUPlace());
+  auto add_e = builder.Build<paddle::dialect::AddOp>(add_c->result(0),
+                                                     full_d->result(0));
+  auto add_f =
+      builder.Build<paddle::dialect::AddOp>(add_e->result(0), add_e->result(0));
+
+  std::string out_name = "add_out";
+  builder.Build<pir::ShadowOutputOp>(add_f->result(0), out_name);
+
+  auto kernel_program = paddle::dialect::PdOpLowerToKernelPass(&program);
+
+  pir::PassManager pm(ctx, 3);
+  pm.AddPass(pir::CreateMemoryPlanPass());
+  pm.Run(kernel_program.get());
+
+  // a, b and c are live at the first add, c, d and e at the second, and the
+  // output of the last add is not planned.
+  auto* module_op = kernel_program->module_op().operation();
+  auto arena_size =
+      module_op->attribute<pir::Int64Attribute>(pir::kAttrMemoryArenaSize);
+  EXPECT_EQ(arena_size.data(), 3 * 64);
+  std::vector<int64_t> offsets;
+  for (auto& op : *kernel_program->block()) {
+    for (auto result : op.results()) {
+      auto offset =
+          result.attribute<pir::Int64Attribute>(pir::kAttrMemoryOffset);
+      if (offset) {
+        offsets.push_back(offset.data());
+      }
+    }
+  }
+  ASSERT_EQ(offsets.size(), 5UL);
+  EXPECT_NE(offsets[2], offsets[3]);
+  EXPECT_NE(offsets[2], offsets[4]);
+  EXPECT_NE(offsets[3], offsets[4]);
+
+  auto place = phi::CPUPlace();
+  Scope scope;
+
+  // The output hooks only run for inference.
+  interpreter::ExecutionConfig execution_config;
+  execution_config.used_for_inference = true;
+  InterpreterCore test_core(
+      place, {}, kernel_program->block(), &scope, execution_config);
+
+  test_core.SetSkipGcVars({out_name});
+
+  // Each planned value is bound at its offset of the same arena, so the
+  // address of its holder minus its offset is the start of the arena.
+  std::set<uintptr_t> arena_starts;
+  size_t bound_num = 0;
+  test_core.SetOutputHooks({[&](InstructionBase* instr,
+                                ValueExecutionInfo* value_exe_info,
+                                Scope*) {
+    for (auto result : instr->Operation()->results()) {
+      auto offset =
+          result.attribute<pir::Int64Attribute>(pir::kAttrMemoryOffset);
+      if (!offset) {
+        continue;
+      }
+      const auto& tensor =
+          value_exe_info->GetVarByValue(result)->Get<phi::DenseTensor>();
+      ASSERT_TRUE(tensor.IsInitialized());
+      arena_starts.insert(reinterpret_cast<uintptr_t>(tensor.Holder()->ptr()) -
+                          offset.data());
+      ++bound_num;
+    }
+  }});
+
+  for (int i = 0; i < 2; ++i) {
+    arena_starts.clear();
+    bound_num = 0;
+    test_core.Run({});
+    EXPECT_EQ(bound_num, 5UL);
+    EXPECT_EQ(arena_starts.size(), 1UL);
+
+    auto out_tensor =
+        test_core.local_scope() == nullptr
+            ? scope.FindVar(out_name)->Get<phi::DenseTensor>()
+            : test_core.local_scope()
+                  ->FindVar(out_name)
+                  ->Get<phi::DenseTensor>();
+
+    for (int64_t j = 0; j < out_tensor.numel(); ++j) {
+      EXPECT_EQ(simple_cmp(out_tensor.data<float>()[j], 14.0), true);
+    }
+  }
+  FLAGS_enable_pir_in_executor_trace_run = false;
+}
+
 TEST(StandaloneExecutor, run_error) {
   pir::IrContext* ctx = pir::IrContext::Instance();
   pir::Program program((ctx));
@@ -297,6 +297,30 @@ TEST(CustomKernel, custom_kernel_dot) {
   ASSERT_EQ(expect_result[1], actual_result1);
 }
 
+TEST(CustomKernel, register_increases_version) {
+  const std::string op_name = "custom_kernel_version_test";
+  phi::KernelKey fp32_key(
+      phi::Backend::CPU, phi::DataLayout::ALL_LAYOUT, phi::DataType::FLOAT32);
+  auto& factory = phi::KernelFactory::Instance();
+  auto& custom_kernel_map = phi::CustomKernelMap::Instance();
+
+  uint64_t version = factory.version();
+  custom_kernel_map.RegisterCustomKernel(op_name, fp32_key, phi::Kernel());
+  custom_kernel_map.RegisterCustomKernels();
+  EXPECT_GT(factory.version(), version);
+
+  // A kernel existing in Paddle fails the registration, which still drops
+  // the cached selections since the kernels before it may be added.
+  version = factory.version();
+  custom_kernel_map.RegisterCustomKernel(op_name, fp32_key, phi::Kernel());
+  EXPECT_ANY_THROW(custom_kernel_map.RegisterCustomKernels());
+  EXPECT_GT(factory.version(), version);
+
+  custom_kernel_map.Kernels().clear();
+  factory.kernels().erase(op_name);
+  factory.IncreaseVersion();
+}
+
 }  // namespace tests
 }  // namespace phi
 
@@ -12,9 +12,14 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <cstdio>
+#include <fstream>
+
 #include "glog/logging.h"
 #include "gtest/gtest.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/framework/dense_tensor_serialize.h"
 #include "test/cpp/phi/core/allocator.h"
 
 namespace phi {
@@ -304,5 +309,59 @@ TEST(dense_tensor, storage_properties) {
 #endif
 }
 
+#ifndef _WIN32
+TEST(dense_tensor, deserialize_from_mapped_file) {
+  const std::string file_name = "dense_tensor_mapped_file_test.pdiparams";
+  phi::CPUContext dev_ctx;
+  std::vector<DenseTensor> src(3);
+  std::vector<int> numels = {12, 5, 7};
+  for (size_t i = 0; i < src.size(); ++i) {
+    src[i].Resize(common::make_ddim({numels[i]}));
+    float* data = src[i].mutable_data<float>(CPUPlace());
+    for (int j = 0; j < numels[i]; ++j) {
+      data[j] = static_cast<float>(i * 100 + j);
+    }
+  }
+  src[1].set_lod({{0, 2, 5}});
+  {
+    std::ofstream fout(file_name, std::ios::binary);
+    for (auto& tensor : src) {
+      SerializeToStream(fout, tensor, dev_ctx);
+    }
+  }
+
+  auto file =
+      paddle::memory::allocation::AllocateMappedFileAllocation(file_name);
+  std::remove(file_name.c_str());
+  const char* begin = static_cast<const char*>(file->ptr());
+  const char* end = begin + file->size();
+  size_t offset = 0;
+  std::vector<DenseTensor> dst(src.size());
+  for (auto& tensor : dst) {
+    DeserializeFromMappedFile(file, &offset, &tensor);
+    size_t data_offset = offset - tensor.numel() * sizeof(float);
+    const char* data = static_cast<const char*>(tensor.data());
+    // aligned data aliases the mapped file, the rest is copied
+    bool aliased = data >= begin && data < end;
+    EXPECT_EQ(aliased, data_offset % sizeof(float) == 0);
+  }
+  EXPECT_EQ(offset, file->size());
+
+  for (size_t i = 0; i < src.size(); ++i) {
+    EXPECT_EQ(dst[i].dims(), src[i].dims());
+    EXPECT_EQ(dst[i].dtype(), DataType::FLOAT32);
+    EXPECT_EQ(dst[i].lod(), src[i].lod());
+    for (int j = 0; j < numels[i]; ++j) {
+      EXPECT_EQ(dst[i].data<float>()[j], src[i].data<float>()[j]);
+    }
+  }
+
+  // the tensors keep the mapping alive and can be written in place
+  file.reset();
+  dst[0].data<float>()[0] = -1.0f;
+  EXPECT_EQ(dst[0].data<float>()[0], -1.0f);
+}
+#endif
+
 }  // namespace tests
 }  // namespace phi
@@ -72,6 +72,39 @@ TEST(KernelRegistry, SetFP32Input) {
   EXPECT_EQ(output_defs.at(0).dtype, phi::DataType::FLOAT16);
 }
 
+TEST(KernelSelectionCache, SameAsKernelFactory) {
+  phi::KernelSelectionCache cache("test");
+  for (auto dtype : {phi::DataType::FLOAT32,
+                     phi::DataType::FLOAT64,
+                     phi::DataType::FLOAT16,
+                     phi::DataType::FLOAT32}) {
+    phi::KernelKey kernel_key(phi::Backend::CPU, phi::DataLayout::NCHW, dtype);
+    auto expected =
+        phi::KernelFactory::Instance().SelectKernelOrThrowError("test",
+                                                                kernel_key);
+    auto result = cache.Select(kernel_key);
+    EXPECT_EQ(&result.kernel, &expected.kernel);
+    EXPECT_EQ(result.has_fallback_cpu, expected.has_fallback_cpu);
+    EXPECT_EQ(result.is_stride_kernel, expected.is_stride_kernel);
+  }
+
+  // Registering a kernel drops the cached results.
+  phi::KernelKey bf16_key(phi::Backend::CPU,
+                          phi::DataLayout::ALL_LAYOUT,
+                          phi::DataType::BFLOAT16);
+  EXPECT_ANY_THROW(cache.Select(bf16_key));
+  auto fp32_kernel = phi::KernelFactory::Instance().SelectKernel(
+      "test",
+      {phi::Backend::CPU, phi::DataLayout::ALL_LAYOUT, phi::DataType::FLOAT32});
+  auto& test_kernels = phi::KernelFactory::Instance().kernels()["test"];
+  test_kernels[bf16_key] = fp32_kernel;
+  phi::KernelFactory::Instance().IncreaseVersion();
+  EXPECT_EQ(&cache.Select(bf16_key).kernel, &test_kernels[bf16_key]);
+  test_kernels.erase(bf16_key);
+  phi::KernelFactory::Instance().IncreaseVersion();
+  EXPECT_ANY_THROW(cache.Select(bf16_key));
+}
+
 TEST(AttributeType, OStream) {
   std::ostringstream oss;
   oss << phi::AttributeType::UNDEFINED;
@@ -0,0 +1,111 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/parallel_for.h"
+#include "paddle/phi/core/enforce.h"
+
+namespace phi {
+namespace tests {
+
+TEST(ParallelFor, CoverRange) {
+  phi::CPUContext dev_ctx;
+  const int64_t begin = 3;
+  const int64_t end = 100003;
+  std::vector<int> visits(end, 0);
+  std::atomic<int> chunk_num{0};
+  phi::ParallelFor(dev_ctx, begin, end, 1000, [&](int64_t b, int64_t e) {
+    EXPECT_LE(begin, b);
+    EXPECT_LT(b, e);
+    EXPECT_LE(e, end);
+    for (int64_t i = b; i < e; ++i) {
+      ++visits[i];
+    }
+    ++chunk_num;
+  });
+  for (int64_t i = 0; i < end; ++i) {
+    EXPECT_EQ(visits[i], i < begin ? 0 : 1);
+  }
+  EXPECT_LE(chunk_num.load(), (end - begin) / 1000);
+
+  // empty range
+  phi::ParallelFor(
+      dev_ctx, 5, 5, 1, [](int64_t, int64_t) { FAIL() << "empty range"; });
+}
+
+TEST(ParallelFor, ThreadBudget) {
+  phi::CPUContext dev_ctx;
+  dev_ctx.SetNumThreads(1);
+  EXPECT_EQ(phi::GetParallelNumThreads(dev_ctx, 1 << 20, 1), 1);
+  int chunk_num = 0;
+  phi::ParallelFor(
+      dev_ctx, 0, 1 << 20, 1, [&](int64_t, int64_t) { ++chunk_num; });
+  EXPECT_EQ(chunk_num, 1);
+
+  dev_ctx.SetNumThreads(0);
+  // less iterations than the grain size are not split
+  EXPECT_EQ(phi::GetParallelNumThreads(dev_ctx, 100, 1000), 1);
+}
+
+TEST(ParallelFor, Nested) {
+  phi::CPUContext dev_ctx;
+  std::atomic<int64_t> sum{0};
+  phi::ParallelFor(dev_ctx, 0, 64, 1, [&](int64_t b, int64_t e) {
+    for (int64_t i = b; i < e; ++i) {
+      // runs in the calling thread inside a parallel region
+      phi::ParallelFor(dev_ctx, 0, 1000, 1, [&](int64_t ib, int64_t ie) {
+        sum += ie - ib;
+      });
+    }
+  });
+  EXPECT_EQ(sum.load(), 64 * 1000);
+}
+
+TEST(ParallelFor, Exception) {
+  phi::CPUContext dev_ctx;
+  // the chunk ending at 1 << 16 throws, in whichever thread runs it
+  auto check_end = [](int64_t, int64_t e) {
+    PADDLE_ENFORCE_LT(
+        e, 1 << 16, common::errors::OutOfRange("Chunk end out of range."));
+  };
+  EXPECT_THROW(phi::ParallelFor(dev_ctx, 0, 1 << 16, 1, check_end),
+               common::enforce::EnforceNotMet);
+}
+
+TEST(ParallelReduce, Sum) {
+  phi::CPUContext dev_ctx;
+  const int64_t n = 1 << 20;
+  int64_t sum = phi::ParallelReduce(
+      dev_ctx,
+      0,
+      n,
+      1024,
+      int64_t(0),
+      [](int64_t b, int64_t e, int64_t ident) {
+        int64_t partial = ident;
+        for (int64_t i = b; i < e; ++i) {
+          partial += i;
+        }
+        return partial;
+      },
+      [](int64_t a, int64_t b) { return a + b; });
+  EXPECT_EQ(sum, n * (n - 1) / 2);
+}
+
+}  // namespace tests
+}  // namespace phi
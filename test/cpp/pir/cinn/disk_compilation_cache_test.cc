@@ -0,0 +1,220 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/hlir/framework/pir/disk_compilation_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <variant>
+
+#include "paddle/cinn/backends/compiler.h"
+#include "paddle/cinn/cinn.h"
+#include "paddle/cinn/optim/optimize.h"
+#include "paddle/cinn/runtime/cinn_runtime.h"
+#include "paddle/common/flags.h"
+#include "test/cpp/utils/temp_dir.h"
+
+PD_DECLARE_string(cinn_compilation_cache_dir);
+
+namespace cinn::hlir::framework::pir {
+
+namespace {
+
+class DiskCompilationCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    temp_dir_ = std::make_unique<paddle::test::TempDir>("cinn_cache");
+    cache_dir_ = temp_dir_->path();
+    FLAGS_cinn_compilation_cache_dir = cache_dir_;
+  }
+
+  void TearDown() override {
+    FLAGS_cinn_compilation_cache_dir = "";
+    temp_dir_.reset();
+  }
+
+  CompilationCacheEntry MakeEntry(const std::string& key) {
+    CompilationCacheEntry entry;
+    entry.key = key;
+    entry.host_fn_name = "fn_add_0";
+    entry.infer_fn_name = "infer_shape_fn_add_0";
+    entry.have_cx86_kernel = true;
+    entry.symbol_args_map[2] = CINNKernelInfo::ArgDimIdx{0, 1};
+    entry.symbol_args_map[3] = CINNKernelInfo::ArgValueIdx{1, 0};
+    entry.temp_space_sizes = {128, -1};
+    // object code is binary
+    entry.object_code = std::string("\x7f" "ELF\0\x01\x02", 7);
+    return entry;
+  }
+
+  std::unique_ptr<paddle::test::TempDir> temp_dir_;
+  std::string cache_dir_;
+};
+
+// Compiles B = A + 1 of 16 floats for the host into fn_add_one.
+std::unique_ptr<backends::Compiler> CompileAddOne(const Target& target) {
+  Context::Global().ResetNameId();
+  Placeholder<float> A("A", {Expr(16)});
+  ir::Tensor B =
+      Compute({Expr(16)}, [&](Var i) { return A(i) + Expr(1.f); }, "B");
+  ast_gen_ius::TensorGroup tensor_group({A, B});
+  auto func = lang::LowerToAst("fn_add_one", {A, B}, &tensor_group);
+  ir::Module::Builder builder("module_add_one", target);
+  builder.AddFunction(optim::Optimize(func, target));
+  auto compiler = backends::Compiler::Create(target);
+  compiler->Build(builder.Build());
+  compiler->EndCompile();
+  return compiler;
+}
+
+}  // namespace
+
+TEST_F(DiskCompilationCacheTest, RoundTrip) {
+  Target target = common::DefaultHostTarget();
+  EXPECT_TRUE(DiskCompilationCache::Instance().Enabled(target));
+  std::string key = DiskCompilationCache::EntryKey(target, "group_0");
+  ASSERT_TRUE(DiskCompilationCache::WriteEntry(MakeEntry(key)));
+
+  CompilationCacheEntry entry;
+  ASSERT_TRUE(DiskCompilationCache::ReadEntry(key, &entry));
+  CompilationCacheEntry expected = MakeEntry(key);
+  EXPECT_EQ(entry.key, expected.key);
+  EXPECT_EQ(entry.host_fn_name, expected.host_fn_name);
+  EXPECT_EQ(entry.infer_fn_name, expected.infer_fn_name);
+  EXPECT_EQ(entry.have_cx86_kernel, expected.have_cx86_kernel);
+  ASSERT_EQ(entry.symbol_args_map.size(), 2UL);
+  auto dim_idx = std::get<CINNKernelInfo::ArgDimIdx>(entry.symbol_args_map[2]);
+  EXPECT_EQ(dim_idx.arg_idx, 0);
+  EXPECT_EQ(dim_idx.dim_idx, 1);
+  auto value_idx =
+      std::get<CINNKernelInfo::ArgValueIdx>(entry.symbol_args_map[3]);
+  EXPECT_EQ(value_idx.arg_idx, 1);
+  EXPECT_EQ(value_idx.value_idx, 0);
+  EXPECT_EQ(entry.temp_space_sizes, expected.temp_space_sizes);
+  EXPECT_EQ(entry.object_code, expected.object_code);
+}
+
+TEST_F(DiskCompilationCacheTest, CompiledObject) {
+  Target target = common::DefaultHostTarget();
+  std::string key = DiskCompilationCache::EntryKey(target, "group_add_one");
+  // The object code is only for the CPU it is compiled on.
+  EXPECT_NE(key.find("\ncpu: "), std::string::npos);
+  EXPECT_NE(key.find("\nfeatures: "), std::string::npos);
+
+  auto compiler = CompileAddOne(target);
+  ASSERT_NE(compiler->Lookup("fn_add_one"), nullptr);
+  CompilationCacheEntry saved = MakeEntry(key);
+  saved.host_fn_name = "fn_add_one";
+  saved.object_code = compiler->GetObjectCode();
+  ASSERT_FALSE(saved.object_code.empty());
+  ASSERT_TRUE(DiskCompilationCache::WriteEntry(saved));
+
+  CompilationCacheEntry entry;
+  ASSERT_TRUE(DiskCompilationCache::ReadEntry(key, &entry));
+  ASSERT_EQ(entry.object_code, saved.object_code);
+
+  // Link the object read back into a new compiler and run it.
+  auto loaded = backends::Compiler::Create(target);
+  loaded->LoadObjectCode(entry.object_code);
+  auto fn = reinterpret_cast<void (*)(void*, int32_t)>(
+      loaded->Lookup(entry.host_fn_name));
+  ASSERT_NE(fn, nullptr);
+  auto* a = cinn_buffer_t::new_(cinn_x86_device, cinn_float32_t(), {16});
+  auto* b = cinn_buffer_t::new_(cinn_x86_device, cinn_float32_t(), {16});
+  cinn_buffer_malloc(nullptr, a);
+  cinn_buffer_malloc(nullptr, b);
+  auto* a_data = reinterpret_cast<float*>(a->memory);
+  auto* b_data = reinterpret_cast<float*>(b->memory);
+  for (int i = 0; i < 16; ++i) {
+    a_data[i] = i;
+    b_data[i] = 0.f;
+  }
+  cinn_pod_value_t args[] = {cinn_pod_value_t(a), cinn_pod_value_t(b)};
+  fn(args, 2);
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_FLOAT_EQ(b_data[i], i + 1.f);
+  }
+  cinn_buffer_free(nullptr, a);
+  cinn_buffer_free(nullptr, b);
+  cinn_buffer_t::delete_(a);
+  cinn_buffer_t::delete_(b);
+}
+
+TEST_F(DiskCompilationCacheTest, KeyMismatch) {
+  Target target = common::DefaultHostTarget();
+  std::string key = DiskCompilationCache::EntryKey(target, "group_0");
+  std::string other_key = DiskCompilationCache::EntryKey(target, "group_1");
+  ASSERT_NE(key, other_key);
+  ASSERT_TRUE(DiskCompilationCache::WriteEntry(MakeEntry(other_key)));
+  // An entry of another key in the file of the key, as for a hash collision
+  std::filesystem::rename(DiskCompilationCache::EntryPath(other_key),
+                          DiskCompilationCache::EntryPath(key));
+  CompilationCacheEntry entry;
+  EXPECT_FALSE(DiskCompilationCache::ReadEntry(key, &entry));
+}
+
+TEST_F(DiskCompilationCacheTest, VersionInvalidation) {
+  Target target = common::DefaultHostTarget();
+  std::string old_key =
+      DiskCompilationCache::EntryKey(target, "group_0", "paddle: old");
+  std::string key = DiskCompilationCache::EntryKey(target, "group_0");
+  ASSERT_NE(old_key, key);
+  ASSERT_TRUE(DiskCompilationCache::WriteEntry(MakeEntry(old_key)));
+  CompilationCacheEntry entry;
+  EXPECT_TRUE(DiskCompilationCache::ReadEntry(old_key, &entry));
+  EXPECT_FALSE(DiskCompilationCache::ReadEntry(key, &entry));
+}
+
+TEST_F(DiskCompilationCacheTest, MissingOrCorruptFile) {
+  Target target = common::DefaultHostTarget();
+  std::string key = DiskCompilationCache::EntryKey(target, "group_0");
+  CompilationCacheEntry entry;
+  EXPECT_FALSE(DiskCompilationCache::ReadEntry(key, &entry));
+
+  ASSERT_TRUE(DiskCompilationCache::WriteEntry(MakeEntry(key)));
+  std::string path = DiskCompilationCache::EntryPath(key);
+  auto size = std::filesystem::file_size(path);
+  std::filesystem::resize_file(path, size - 1);
+  EXPECT_FALSE(DiskCompilationCache::ReadEntry(key, &entry));
+
+  {
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    ofs << "not a compilation cache entry";
+  }
+  EXPECT_FALSE(DiskCompilationCache::ReadEntry(key, &entry));
+
+  // a file with trailing bytes is corrupt as well
+  ASSERT_TRUE(DiskCompilationCache::WriteEntry(MakeEntry(key)));
+  {
+    std::ofstream ofs(path, std::ios::binary | std::ios::app);
+    ofs << "x";
+  }
+  EXPECT_FALSE(DiskCompilationCache::ReadEntry(key, &entry));
+}
+
+TEST_F(DiskCompilationCacheTest, Enabled) {
+  EXPECT_TRUE(
+      DiskCompilationCache::Instance().Enabled(common::DefaultHostTarget()));
+  EXPECT_FALSE(
+      DiskCompilationCache::Instance().Enabled(common::DefaultNVGPUTarget()));
+  FLAGS_cinn_compilation_cache_dir = "";
+  EXPECT_FALSE(
+      DiskCompilationCache::Instance().Enabled(common::DefaultHostTarget()));
+}
+
+}  // namespace cinn::hlir::framework::pir
@@ -0,0 +1,117 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/transforms/gpu/fused_weight_only_linear_pass.h"
+#include "paddle/phi/common/place.h"
+#include "paddle/pir/include/core/builtin_dialect.h"
+#include "paddle/pir/include/pass/pass_manager.h"
+
+// out = matmul(x, w) + bias with fp32 weights of shape [128, 64].
+void BuildProgram(pir::Builder &builder) {  // NOLINT
+  paddle::dialect::FullOp full_input_op =
+      builder.Build<paddle::dialect::FullOp>(std::vector<int64_t>{2, 16, 128},
+                                             1.5);
+  paddle::dialect::FullOp full_weight_op =
+      builder.Build<paddle::dialect::FullOp>(std::vector<int64_t>{128, 64},
+                                             0.5);
+  paddle::dialect::FullOp full_bias_op =
+      builder.Build<paddle::dialect::FullOp>(std::vector<int64_t>{64}, 1.0);
+  paddle::dialect::MatmulOp matmul_op =
+      builder.Build<paddle::dialect::MatmulOp>(full_input_op.out(),
+                                               full_weight_op.out());
+  paddle::dialect::AddOp add_op = builder.Build<paddle::dialect::AddOp>(
+      matmul_op.out(), full_bias_op.out());
+  builder.Build<paddle::dialect::FetchOp>(add_op.out(), "out", 0);
+}
+
+size_t CountOps(const pir::Program &program, const std::string &name) {
+  size_t count = 0;
+  for (const auto &op : *program.block()) {
+    if (op.name() == name) ++count;
+  }
+  return count;
+}
+
+void RunPass(pir::Program *program,
+             const std::string &algo,
+             const phi::Place *place) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  pir::PassManager pm(ctx);
+  std::unique_ptr<pir::Pass> pass = pir::CreateFusedWeightOnlyLinearPass();
+  pass->Set("weight_only_algo", new std::string(algo));
+  if (place != nullptr) {
+    pass->Set(pir::Pass::kPlaceAttr, new phi::Place(*place));
+  }
+  pm.AddPass(std::move(pass));
+  pm.EnableIRPrinting();
+
+  PADDLE_ENFORCE_EQ(pm.Run(program),
+                    true,
+                    common::errors::Unavailable("pm fail to run program"));
+}
+
+// At a CPU place, the fp32 weights are quantized with arch 0 for the CPU
+// kernel, and int4 weights are quantized without the copies to the host.
+TEST(DrrTest, FusedWeightOnlyLinearCPU) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::BuiltinDialect>();
+  for (std::string algo : {"weight_only_int8", "weight_only_int4"}) {
+    pir::Program program(ctx);
+    pir::Builder builder = pir::Builder(ctx, program.block());
+    BuildProgram(builder);
+
+    phi::Place place = phi::CPUPlace();
+    RunPass(&program, algo, &place);
+
+    EXPECT_EQ(CountOps(program, paddle::dialect::MatmulOp::name()), 0u);
+    EXPECT_EQ(CountOps(program, paddle::dialect::AddOp::name()), 0u);
+    EXPECT_EQ(CountOps(program, paddle::dialect::MemcpyD2hOp::name()), 0u);
+    EXPECT_EQ(CountOps(program, paddle::dialect::MemcpyH2dOp::name()), 0u);
+    ASSERT_EQ(CountOps(program, paddle::dialect::WeightQuantizeOp::name()), 1u);
+    EXPECT_EQ(CountOps(program, paddle::dialect::WeightOnlyLinearOp::name()),
+              1u);
+    for (auto &op : *program.block()) {
+      if (!op.isa<paddle::dialect::WeightQuantizeOp>()) continue;
+      EXPECT_EQ(op.attribute<pir::Int32Attribute>("arch").data(), 0);
+      EXPECT_EQ(op.attribute<pir::StrAttribute>("algo").AsString(), algo);
+    }
+  }
+}
+
+// Without a CPU place, the fp32 weights are left to matmul.
+TEST(DrrTest, FusedWeightOnlyLinearNoPlace) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::BuiltinDialect>();
+  pir::Program program(ctx);
+  pir::Builder builder = pir::Builder(ctx, program.block());
+  BuildProgram(builder);
+
+  RunPass(&program, "weight_only_int8", nullptr);
+
+  EXPECT_EQ(CountOps(program, paddle::dialect::MatmulOp::name()), 1u);
+  EXPECT_EQ(CountOps(program, paddle::dialect::AddOp::name()), 1u);
+  EXPECT_EQ(CountOps(program, paddle::dialect::WeightQuantizeOp::name()), 0u);
+  EXPECT_EQ(CountOps(program, paddle::dialect::WeightOnlyLinearOp::name()),
+            0u);
+}
@@ -0,0 +1,104 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <chrono>  // NOLINT
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/serialize_deserialize/include/binary_json.h"
+#include "paddle/fluid/pir/serialize_deserialize/include/interface.h"
+#include "paddle/pir/include/core/builtin_dialect.h"
+#include "paddle/pir/include/core/operation.h"
+#include "paddle/pir/include/core/program.h"
+
+namespace {
+
+// Builds a chain of full, matmul, add and relu ops, about 4 * layer_num ops.
+void BuildProgram(pir::Program* program, int layer_num) {
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  pir::Builder builder = pir::Builder(ctx, program->block());
+  pir::Value x =
+      builder.Build<paddle::dialect::FullOp>(std::vector<int64_t>{16, 64}, 1.0)
+          .out();
+  for (int i = 0; i < layer_num; ++i) {
+    auto w = builder.Build<paddle::dialect::FullOp>(
+        std::vector<int64_t>{64, 64}, 0.5);
+    auto b =
+        builder.Build<paddle::dialect::FullOp>(std::vector<int64_t>{64}, 0.1);
+    auto matmul = builder.Build<paddle::dialect::MatmulOp>(x, w.out());
+    auto add = builder.Build<paddle::dialect::AddOp>(matmul.out(), b.out());
+    x = builder.Build<paddle::dialect::ReluOp>(add.out()).out();
+  }
+}
+
+// Returns the average seconds of ReadModule over repeat runs.
+double TimeReadModule(const std::string& file_path, int repeat) {
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeat; ++i) {
+    pir::Program program(ctx);
+    pir::ReadModule(file_path, &program, 1);
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+             .count() /
+         repeat;
+}
+
+}  // namespace
+
+TEST(ProgramLoadBenchmark, JsonVsBinary) {
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::BuiltinDialect>();
+  pir::Program program(ctx);
+  BuildProgram(&program, 2000);
+
+  const std::string json_path = "./test_program_load.json";
+  const std::string binary_path = "./test_program_load.pirb";
+  pir::WriteModule(program, json_path, 1, true, false, true);
+  pir::WriteModule(program, binary_path, 1, true, false, true, true);
+
+  // both encodings decode to the same json document
+  EXPECT_EQ(pir::ReadModuleJson(json_path), pir::ReadModuleJson(binary_path));
+
+  pir::Program json_program(ctx);
+  pir::ReadModule(json_path, &json_program, 1);
+  pir::Program binary_program(ctx);
+  pir::ReadModule(binary_path, &binary_program, 1);
+  ASSERT_EQ(json_program.block()->size(), program.block()->size());
+  ASSERT_EQ(binary_program.block()->size(), program.block()->size());
+  auto json_it = json_program.block()->begin();
+  for (auto& op : *binary_program.block()) {
+    EXPECT_EQ(op.name(), json_it->name());
+    EXPECT_EQ(op.attributes(), json_it->attributes());
+    ++json_it;
+  }
+
+  const int repeat = 3;
+  double json_seconds = TimeReadModule(json_path, repeat);
+  double binary_seconds = TimeReadModule(binary_path, repeat);
+  LOG(INFO) << "ReadModule of " << program.block()->size()
+            << " ops, json: " << std::filesystem::file_size(json_path)
+            << " bytes " << json_seconds * 1000
+            << " ms, binary: " << std::filesystem::file_size(binary_path)
+            << " bytes " << binary_seconds * 1000 << " ms";
+  EXPECT_LT(std::filesystem::file_size(binary_path),
+            std::filesystem::file_size(json_path));
+}
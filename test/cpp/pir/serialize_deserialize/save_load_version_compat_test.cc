@@ -25,6 +25,7 @@
 #include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
 #include "paddle/fluid/pir/dialect/operator/ir/op_type.h"
 #include "paddle/fluid/pir/dialect/operator/utils/utils.h"
+#include "paddle/fluid/pir/serialize_deserialize/include/binary_json.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/interface.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/ir_deserialize.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/version_compat.h"
@@ -75,8 +76,7 @@ TEST(save_load_version_compat, op_patch_test) {
 bool ReadModuleForTest(const std::string &file_path,
                        pir::Program *program,
                        uint64_t pir_version) {
-  std::ifstream f(file_path);
-  Json data = Json::parse(f);
+  Json data = pir::ReadModuleJson(file_path);
   pir::PatchBuilder builder(pir_version);
 
   if (data.contains(BASE_CODE) && data[BASE_CODE].contains(MAGIC) &&
@@ -179,6 +179,42 @@ TEST(save_load_version_compat, attribute_patch_test1) {
             pir::Float64Type::get(ctx));
 }
 
+// Test for patches applied to a program saved in binary encoding.
+TEST(save_load_version_compat, binary_attribute_patch_test) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<test::TestDialect>();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+
+  pir::Program program(ctx);
+  pir::Type fp32_dtype = pir::Float32Type::get(ctx);
+  pir::OpInfo op_info = ctx->GetRegisteredOpInfo(pir::ParameterOp::name());
+  std::unordered_map<std::string, pir::Attribute> op_attribute{
+      {"parameter_name", pir::StrAttribute::get(ctx, "a")}};
+  pir::Operation *op =
+      pir::Operation::Create({}, op_attribute, {fp32_dtype}, op_info);
+  program.block()->push_back(op);
+
+  pir::WriteModule(program,
+                   "./test_save_load_binary",
+                   /*pir_version*/ 1,
+                   true,
+                   false,
+                   true,
+                   /*binary*/ true);
+  pir::Program new_program(ctx);
+  ReadModuleForTest("./test_save_load_binary", &new_program, 2);
+
+  // Same patches as attribute_patch_test1.
+  EXPECT_EQ(new_program.block()
+                ->front()
+                .attribute("parameter_name")
+                .dyn_cast<::pir::StrAttribute>()
+                .AsString(),
+            "fc_0");
+  EXPECT_EQ(new_program.block()->front().result(0).type(),
+            pir::Float64Type::get(ctx));
+}
+
 // Test for op I/O and op attribute modification.
 TEST(save_load_version_compat, op_patch_test1) {
   pir::IrContext *ctx = pir::IrContext::Instance();
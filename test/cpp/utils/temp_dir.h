@@ -0,0 +1,51 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+#include <filesystem>
+#include <string>
+
+namespace paddle {
+namespace test {
+
+// A new directory under the temp directory, named prefix followed by random
+// characters. It is removed with its files when the TempDir is destroyed,
+// also when an assertion of the test fails.
+class TempDir {
+ public:
+  explicit TempDir(const std::string& prefix) {
+    std::string dir_template =
+        (std::filesystem::temp_directory_path() / (prefix + "_XXXXXX"))
+            .string();
+    EXPECT_NE(mkdtemp(dir_template.data()), nullptr);
+    path_ = dir_template;
+  }
+
+  TempDir(const TempDir&) = delete;
+  TempDir& operator=(const TempDir&) = delete;
+
+  ~TempDir() { std::filesystem::remove_all(path_); }
+
+  const std::string& path() const { return path_; }
+
+ private:
+  std::string path_;
+};
+
+}  // namespace test
+}  // namespace paddle
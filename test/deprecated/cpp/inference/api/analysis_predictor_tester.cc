@@ -28,6 +28,8 @@
 #include "paddle/fluid/inference/api/paddle_api.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/utils/io_utils.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/backends/cpu/cpu_info.h"
 #include "test/cpp/inference/api/tester_helper.h"
 
@@ -838,4 +840,92 @@ TEST(AnalysisPredictor, OutputTensorHookFunc) {
   }
 }
 
+TEST(AnalysisPredictor, CpuMathLibraryNumThreads) {
+  Config config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  config.DisableMKLDNN();
+  config.SetCpuMathLibraryNumThreads(3);
+  auto predictor = CreatePredictor(config);
+
+  // the hooks run after the kernels, with the contexts the kernels run on
+  int num_hooks = 0;
+  predictor->RegisterOutputHook([&num_hooks](const std::string& type,
+                                             const std::string& var_name,
+                                             const paddle::Tensor& tensor) {
+    auto* cpu_context = static_cast<phi::CPUContext*>(
+        phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+    EXPECT_EQ(cpu_context->GetNumThreads(), 3);
+    ++num_hooks;
+  });
+  for (auto& name : {"firstw", "secondw", "thirdw", "forthw"}) {
+    auto input = predictor->GetInputHandle(name);
+    input->Reshape({4, 1});
+    auto* data = input->mutable_data<int64_t>(PlaceType::kCPU);
+    for (int i = 0; i < 4; i++) {
+      data[i] = i;
+    }
+  }
+  ASSERT_TRUE(predictor->Run());
+  EXPECT_GT(num_hooks, 0);
+
+  // out of Run the context of the pool is used again
+  auto* cpu_context = static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+  EXPECT_EQ(cpu_context->GetNumThreads(), 0);
+}
+
+TEST(AnalysisPredictor, RestoreDeviceContexts) {
+  auto create_predictor = [](int num_threads) {
+    Config config;
+    config.SetModel(FLAGS_dirname);
+    config.DisableGpu();
+    config.DisableMKLDNN();
+    config.SetCpuMathLibraryNumThreads(num_threads);
+    auto predictor = CreatePredictor(config);
+    for (auto& name : {"firstw", "secondw", "thirdw", "forthw"}) {
+      auto input = predictor->GetInputHandle(name);
+      input->Reshape({4, 1});
+      auto* data = input->mutable_data<int64_t>(PlaceType::kCPU);
+      for (int i = 0; i < 4; i++) {
+        data[i] = i;
+      }
+    }
+    return predictor;
+  };
+  auto get_num_threads = []() {
+    return static_cast<phi::CPUContext*>(
+               phi::DeviceContextPool::Instance().Get(phi::CPUPlace()))
+        ->GetNumThreads();
+  };
+
+  // A predictor run from a hook of another one gives the contexts back to
+  // the outer run.
+  auto outer = create_predictor(3);
+  auto inner = create_predictor(2);
+  int num_inner_runs = 0;
+  outer->RegisterOutputHook([&](const std::string& type,
+                                const std::string& var_name,
+                                const paddle::Tensor& tensor) {
+    if (num_inner_runs == 0) {
+      ASSERT_TRUE(inner->Run());
+      ++num_inner_runs;
+    }
+    EXPECT_EQ(get_num_threads(), 3);
+  });
+  ASSERT_TRUE(outer->Run());
+  EXPECT_EQ(num_inner_runs, 1);
+  EXPECT_EQ(get_num_threads(), 0);
+
+  // A run that throws gives the contexts back as well.
+  auto failed = create_predictor(3);
+  failed->RegisterOutputHook([](const std::string& type,
+                                const std::string& var_name,
+                                const paddle::Tensor& tensor) {
+    PADDLE_THROW(common::errors::Fatal("Fail the run."));
+  });
+  EXPECT_ANY_THROW(failed->Run());
+  EXPECT_EQ(get_num_threads(), 0);
+}
+
 }  // namespace paddle_infer
@@ -0,0 +1,85 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import unittest
+
+import numpy as np
+
+import paddle
+import paddle.distributed as dist
+from paddle import nn
+
+
+class LinearNet(nn.Layer):
+    def __init__(self):
+        super().__init__()
+        # about 1MB each, so that the reducer splits them into several groups
+        self._linear1 = nn.Linear(512, 512)
+        self._linear2 = nn.Linear(512, 512)
+        self._linear3 = nn.Linear(512, 1)
+
+    def forward(self, x):
+        return self._linear3(self._linear2(self._linear1(x)))
+
+
+def train():
+    assert paddle.get_flags('FLAGS_gloo_async_comm')['FLAGS_gloo_async_comm']
+    dist.init_parallel_env()
+    rank = dist.get_rank()
+
+    layer = LinearNet()
+    dp_layer = paddle.DataParallel(
+        layer, comm_buffer_size=1, last_comm_buffer_size=1
+    )
+    rng = np.random.RandomState(rank)
+    inputs = paddle.to_tensor(rng.randn(16, 512).astype('float32'))
+    labels = paddle.to_tensor(rng.randn(16, 1).astype('float32'))
+    loss_fn = nn.MSELoss()
+
+    for _ in range(3):
+        # the gradients of each rank, averaged by hand
+        with dp_layer.no_sync():
+            loss_fn(dp_layer(inputs), labels).backward()
+        expected = []
+        for param in layer.parameters():
+            grads = []
+            dist.all_gather(grads, param.grad)
+            expected.append(np.mean([grad.numpy() for grad in grads], axis=0))
+        dp_layer.clear_gradients()
+
+        # the gradients reduced by the reducer, with the gloo tasks run on
+        # the communication thread
+        loss_fn(dp_layer(inputs), labels).backward()
+        for param, grad in zip(layer.parameters(), expected):
+            np.testing.assert_allclose(
+                param.grad.numpy(), grad, rtol=1e-5, atol=1e-6
+            )
+        dp_layer.clear_gradients()
+
+
+class TestGlooAsyncReducer(unittest.TestCase):
+    def setUp(self):
+        os.environ['FLAGS_gloo_async_comm'] = '1'
+        # the reducer splits the gradients right after scheduling the
+        # allreduce with a stream safe allocator, see EagerReducer
+        os.environ['FLAGS_allocator_strategy'] = 'auto_growth'
+        os.environ['FLAGS_use_stream_safe_cuda_allocator'] = '1'
+
+    def test_reduced_gradients(self):
+        dist.spawn(train, backend='gloo', nprocs=2)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -72,7 +72,7 @@ class TestAddmm(unittest.TestCase):
         np.testing.assert_allclose(
             sp_out.numpy(), dense_out.numpy(), rtol=1e-05
         )
-        if get_cuda_version() >= 11030:
+        if not sp_out.place.is_gpu_place() or get_cuda_version() >= 11030:
             dense_out.backward()
             sp_out.backward()
             np.testing.assert_allclose(
@@ -105,6 +105,14 @@ class TestAddmm(unittest.TestCase):
         self.check_result([8, 16, 10], [8, 16, 12], [8, 12, 10], 'coo')
         self.check_result([8, 16, 10], [8, 16, 12], [8, 12, 10], 'csr')
 
+    def test_addmm_cpu(self):
+        origin_device = paddle.get_device()
+        paddle.set_device('cpu')
+        self.check_result([16, 10], [16, 12], [12, 10], 'coo')
+        self.check_result([16, 10], [16, 12], [12, 10], 'csr')
+        self.check_result([8, 16, 10], [8, 16, 12], [8, 12, 10], 'csr')
+        paddle.set_device(origin_device)
+
 
 class TestAddmmStatic(unittest.TestCase):
 
@@ -308,6 +308,104 @@ class TestMaskedMatmul(unittest.TestCase):
         )
 
 
+class TestMatmulCPU(unittest.TestCase):
+    def setUp(self):
+        self.origin_device = paddle.get_device()
+        paddle.set_device('cpu')
+
+    def tearDown(self):
+        paddle.set_device(self.origin_device)
+
+    def to_sparse(self, x, format):
+        if format == "coo":
+            return x.to_sparse_coo(len(x.shape))
+        return x.to_sparse_csr()
+
+    # x: sparse, y: dense, out: dense
+    def check_sparse_dense(self, x_shape, y_shape, format):
+        mask = paddle.randint(0, 2, x_shape[-2:]).astype('float64')
+        origin_x = paddle.rand(x_shape) * mask
+        origin_y = paddle.rand(y_shape)
+
+        dense_x = origin_x.detach()
+        dense_x.stop_gradient = False
+        dense_y = origin_y.detach()
+        dense_y.stop_gradient = False
+        dense_out = paddle.matmul(dense_x, dense_y)
+        dense_out.backward()
+
+        sp_x = self.to_sparse(origin_x.detach(), format)
+        sp_x.stop_gradient = False
+        sp_y = origin_y.detach()
+        sp_y.stop_gradient = False
+        sp_out = paddle.sparse.matmul(sp_x, sp_y)
+        sp_out.backward()
+
+        np.testing.assert_allclose(
+            sp_out.numpy(), dense_out.numpy(), rtol=1e-05
+        )
+        np.testing.assert_allclose(
+            sp_x.grad.to_dense().numpy(),
+            (dense_x.grad * mask).numpy(),
+            rtol=1e-05,
+        )
+        np.testing.assert_allclose(
+            sp_y.grad.numpy(), dense_y.grad.numpy(), rtol=1e-05
+        )
+
+    # x: sparse, y: sparse, out: sparse
+    def check_sparse_sparse(self, x_shape, y_shape, format):
+        origin_x = paddle.rand(x_shape)
+        origin_x = origin_x * (origin_x > 0.5).astype('float64')
+        origin_y = paddle.rand(y_shape)
+        origin_y = origin_y * (origin_y > 0.5).astype('float64')
+
+        sp_x = self.to_sparse(origin_x.detach(), format)
+        sp_y = self.to_sparse(origin_y.detach(), format)
+        sp_out = paddle.sparse.matmul(sp_x, sp_y)
+
+        np.testing.assert_allclose(
+            sp_out.to_dense().numpy(),
+            paddle.matmul(origin_x, origin_y).numpy(),
+            rtol=1e-05,
+        )
+
+    def test_matmul_sparse_dense(self):
+        for format in ['coo', 'csr']:
+            self.check_sparse_dense([16, 12], [12, 10], format)
+            self.check_sparse_dense([8, 16, 12], [8, 12, 10], format)
+
+    def test_matmul_sparse_sparse(self):
+        for format in ['coo', 'csr']:
+            self.check_sparse_sparse([16, 12], [12, 10], format)
+            self.check_sparse_sparse([8, 16, 12], [8, 12, 10], format)
+
+    def test_masked_matmul(self):
+        np_mask = np.random.rand(10, 6) < 0.2
+        np_x = np.random.rand(10, 12)
+        np_y = np.random.rand(12, 6)
+        np_out = sp.csr_matrix(np.matmul(np_x, np_y) * np_mask)
+
+        np_out_grad = sp.csr_matrix(np.ones([10, 6]) * np_mask)
+        np_x_grad = np_out_grad @ np_y.transpose(1, 0)
+        np_y_grad = (np_out_grad.transpose() @ np_x).transpose(1, 0)
+
+        x = paddle.to_tensor(np_x, stop_gradient=False)
+        y = paddle.to_tensor(np_y, stop_gradient=False)
+        mask = paddle.to_tensor(np.ones([10, 6]) * np_mask).to_sparse_csr()
+        out = paddle.sparse.masked_matmul(x, y, mask)
+
+        np.testing.assert_allclose(np_out.indptr, out.crows().numpy())
+        np.testing.assert_allclose(np_out.indices, out.cols().numpy())
+        np.testing.assert_allclose(
+            np_out.data, out.values().numpy(), rtol=1e-05
+        )
+
+        out.backward()
+        np.testing.assert_allclose(np_x_grad, x.grad.numpy(), rtol=1e-05)
+        np.testing.assert_allclose(np_y_grad, y.grad.numpy(), rtol=1e-05)
+
+
 class TestMatmulSparseDenseStatic(unittest.TestCase):
     # x: sparse, y: dense, out: dense
     def check_result(self, x_shape, y_shape):
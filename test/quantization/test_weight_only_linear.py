@@ -879,5 +879,89 @@ class WeightOnlyLinearBackwardAndWeightDequantizeTestCase(unittest.TestCase):
             )
 
 
+class WeightOnlyLinearCPUTestCase(unittest.TestCase):
+    def config(self):
+        self.batch = 1
+        self.token = 1
+        self.in_features = 128
+        self.out_features = 256
+        self.weight_dtype = "int8"
+        self.group_size = -1
+
+    def setUp(self):
+        self.config()
+        self.origin_device = paddle.get_device()
+        paddle.set_device('cpu')
+
+    def tearDown(self):
+        paddle.set_device(self.origin_device)
+
+    def dequantize(self, weight, scale):
+        weight = weight.numpy().reshape([self.out_features, -1])
+        if self.weight_dtype == "int4":
+            low = np.left_shift(weight, 4) >> 4
+            high = weight >> 4
+            weight = np.stack([low, high], axis=-1)
+            weight = weight.reshape([self.out_features, -1])
+        scale = scale.numpy()
+        if self.group_size == -1:
+            return weight * scale[:, None]
+        return weight * np.repeat(scale, self.group_size, axis=0).T
+
+    def test_weight_only_linear(self):
+        x = paddle.rand([self.batch, self.token, self.in_features])
+        float_weight = paddle.randn([self.in_features, self.out_features])
+        bias = paddle.rand([self.out_features])
+        weight, scale = Q.weight_quantize(
+            float_weight,
+            algo="weight_only_" + self.weight_dtype,
+            arch=0,
+            group_size=self.group_size,
+        )
+        out = Q.weight_only_linear(
+            x,
+            weight,
+            bias=bias,
+            weight_scale=scale,
+            weight_dtype=self.weight_dtype,
+            arch=0,
+            group_size=self.group_size,
+        )
+        dequantized = self.dequantize(weight, scale)
+        out_expect = x.numpy() @ dequantized.T + bias.numpy()
+        np.testing.assert_allclose(
+            out.numpy(), out_expect, rtol=1e-4, atol=1e-4
+        )
+        # The quantization error is bounded by half a step.
+        step = scale.numpy()
+        if self.group_size > 0:
+            step = np.repeat(step, self.group_size, axis=0)
+        np.testing.assert_array_less(
+            np.abs(dequantized.T - float_weight.numpy()), step * 0.5 + 1e-6
+        )
+
+
+class WeightOnlyLinearCPUTestCase1(WeightOnlyLinearCPUTestCase):
+    def config(self):
+        super().config()
+        self.weight_dtype = "int4"
+
+
+class WeightOnlyLinearCPUTestCase2(WeightOnlyLinearCPUTestCase):
+    def config(self):
+        super().config()
+        self.token = 32
+        self.group_size = 64
+
+
+class WeightOnlyLinearCPUTestCase3(WeightOnlyLinearCPUTestCase):
+    def config(self):
+        super().config()
+        self.batch = 2
+        self.token = 3
+        self.weight_dtype = "int4"
+        self.group_size = 128
+
+
 if __name__ == '__main__':
     unittest.main()